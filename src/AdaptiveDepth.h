@@ -0,0 +1,226 @@
+/**
+ * @file AdaptiveDepth.h
+ * @brief Closed-loop ring depth and prefill for DirettaSync
+ *
+ * The ring is still sized once per format (DirettaBuffer::calculateBufferSize);
+ * this controller decides how much of it the producer keeps queued, and how
+ * much is prefilled before playback starts. It watches what eats into that
+ * margin:
+ *  - delivery jitter: the longest gap between sendAudio() pushes beyond the
+ *    audio that the previous push carried (network stalls, decode spikes)
+ *  - near-underruns: getNewStream() finding less than LOW_WATER_PCT of the
+ *    target queued, and real underruns, while the producer is still pushing
+ *    (a ring draining at end of track or on pause is not trouble)
+ *
+ * Once per window the target is raised at once on trouble, and stepped down
+ * by LOWER_PCT after QUIET_WINDOWS quiet windows, never below what the
+ * decaying peak jitter needs. The target is kept in ms across format
+ * changes: it describes the source, not the format.
+ *
+ * Threads: onPush() audio thread, onConsume()/onUnderrun() SDK worker,
+ * setFormat() under the ring reconfigure guard, the rest any thread.
+ */
+
+#ifndef ADAPTIVE_DEPTH_H
+#define ADAPTIVE_DEPTH_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+class AdaptiveDepth {
+public:
+    static constexpr uint64_t WINDOW_US = 2000000;
+    static constexpr uint32_t QUIET_WINDOWS = 5;     // 10 s without trouble before stepping down
+    static constexpr uint32_t RAISE_PCT = 150;
+    static constexpr uint32_t LOWER_PCT = 90;
+    static constexpr uint32_t LOW_WATER_PCT = 25;    // Near-underrun below this share of the target
+    static constexpr uint32_t GAP_DECAY_PCT = 90;    // Peak jitter memory, per window
+
+    static constexpr uint32_t DEFAULT_MIN_MS = 60;
+    static constexpr uint32_t DEFAULT_MAX_MS = 1000;
+    static constexpr uint32_t INITIAL_MS = 400;
+
+    void configure(uint32_t minMs, uint32_t maxMs) {
+        m_minMs = std::max<uint32_t>(minMs, 10);
+        m_maxMs = std::max(maxMs, m_minMs);
+        m_targetMs.store(std::min(std::max(INITIAL_MS, m_minMs), m_maxMs), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief New ring geometry (call from configureRingPCM/DSD)
+     * @param bytesPerSecond Ring bytes per second of audio
+     * @param ringSize Ring capacity in bytes
+     */
+    void setFormat(size_t bytesPerSecond, size_t ringSize) {
+        m_bytesPerSecond.store(bytesPerSecond, std::memory_order_relaxed);
+        m_ringSize.store(ringSize, std::memory_order_relaxed);
+        m_resetProducer.store(true, std::memory_order_relaxed);
+        m_resetConsumer.store(true, std::memory_order_relaxed);
+    }
+
+    uint32_t targetMs() const { return m_targetMs.load(std::memory_order_relaxed); }
+
+    // Prefill half the target: playback starts sooner, the producer tops up the rest
+    uint32_t prefillMs() const { return std::max(targetMs() / 2, m_minMs / 2); }
+
+    /**
+     * @brief Bytes the producer keeps queued, within what the ring can hold
+     */
+    size_t targetBytes() const {
+        size_t bytes = static_cast<size_t>(
+            static_cast<uint64_t>(m_bytesPerSecond.load(std::memory_order_relaxed)) * targetMs() / 1000);
+        size_t ring = m_ringSize.load(std::memory_order_relaxed);
+        return std::min(bytes, ring - ring / 8);
+    }
+
+    //=========================================================================
+    // Producer side (sendAudio - audio thread only)
+    //=========================================================================
+
+    /**
+     * @param nowUs Steady clock (us)
+     * @param bytes Ring bytes just pushed
+     * @param steady false while prefilling: restarts the gap measurement
+     */
+    void onPush(uint64_t nowUs, size_t bytes, bool steady) {
+        uint64_t lastUs = m_lastPushUs.load(std::memory_order_relaxed);
+        if (m_resetProducer.exchange(false, std::memory_order_relaxed)) {
+            lastUs = 0;
+        }
+        if (steady && lastUs != 0) {
+            uint64_t gapUs = nowUs - lastUs;
+            if (gapUs > m_lastPushAudioUs) {
+                uint64_t excess = gapUs - m_lastPushAudioUs;
+                if (excess > m_windowGapUs.load(std::memory_order_relaxed)) {
+                    m_windowGapUs.store(excess, std::memory_order_relaxed);
+                }
+            }
+        }
+        m_lastPushUs.store(nowUs, std::memory_order_relaxed);
+        size_t bps = m_bytesPerSecond.load(std::memory_order_relaxed);
+        m_lastPushAudioUs = bps ? static_cast<uint64_t>(bytes) * 1000000 / bps : 0;
+    }
+
+    //=========================================================================
+    // Consumer side (getNewStream - SDK worker thread only)
+    //=========================================================================
+
+    /**
+     * @brief Fill level seen by a streaming callback; runs the controller once per window
+     * @return true if the target changed (caller may log)
+     */
+    bool onConsume(size_t avail, uint64_t nowUs) {
+        if (m_resetConsumer.exchange(false, std::memory_order_relaxed)) {
+            m_windowStartUs = nowUs;
+            m_windowMinFill = SIZE_MAX;
+            m_lowActive = false;
+        }
+        size_t target = targetBytes();
+        if (avail < target * LOW_WATER_PCT / 100 && producing(nowUs)) {
+            if (!m_lowActive) {
+                m_lowActive = true;
+                m_windowNearUnderruns++;
+                bump(m_nearUnderruns);
+            }
+        } else {
+            m_lowActive = false;
+        }
+        m_windowMinFill = std::min(m_windowMinFill, avail);
+
+        if (nowUs - m_windowStartUs < WINDOW_US) return false;
+        m_windowStartUs = nowUs;
+        return evaluate(target);
+    }
+
+    void onUnderrun(uint64_t nowUs) {
+        if (producing(nowUs)) m_windowUnderruns++;
+    }
+
+    std::string json() const {
+        std::ostringstream os;
+        os << "{\"target_ms\":" << targetMs() << ",\"target\":" << targetBytes()
+           << ",\"min_ms\":" << m_minMs << ",\"max_ms\":" << m_maxMs
+           << ",\"peak_gap_ms\":" << m_peakGapUs.load(std::memory_order_relaxed) / 1000
+           << ",\"near_underruns\":" << m_nearUnderruns.load(std::memory_order_relaxed)
+           << ",\"raises\":" << m_raises.load(std::memory_order_relaxed)
+           << ",\"lowers\":" << m_lowers.load(std::memory_order_relaxed) << "}";
+        return os.str();
+    }
+
+private:
+    // Pushed within half the target: a longer silence is a drain, and a
+    // stall that long still shows up as a push gap once it ends
+    bool producing(uint64_t nowUs) const {
+        uint64_t lastUs = m_lastPushUs.load(std::memory_order_relaxed);
+        return lastUs != 0 && nowUs - lastUs < static_cast<uint64_t>(targetMs()) * 500;
+    }
+
+    bool evaluate(size_t targetBytes) {
+        uint64_t gapUs = m_windowGapUs.exchange(0, std::memory_order_relaxed);
+        uint64_t peakUs = std::max(gapUs, m_peakGapUs.load(std::memory_order_relaxed) * GAP_DECAY_PCT / 100);
+        m_peakGapUs.store(peakUs, std::memory_order_relaxed);
+
+        // A stall of G ms drains G ms of queue: keep it above the low water mark
+        uint32_t current = targetMs();
+        uint32_t needMs = static_cast<uint32_t>(peakUs / 1000 * 100 / (100 - LOW_WATER_PCT)) + m_minMs / 2;
+        uint32_t next = current;
+
+        bool trouble = m_windowUnderruns > 0 || m_windowNearUnderruns > 0;
+        if (trouble) {
+            next = std::max(current * RAISE_PCT / 100, needMs);
+            m_quietWindows = 0;
+        } else if (needMs > current) {
+            next = needMs;
+            m_quietWindows = 0;
+        } else if (m_windowMinFill != SIZE_MAX && m_windowMinFill > targetBytes / 2 &&
+                   ++m_quietWindows >= QUIET_WINDOWS) {
+            next = std::max(current * LOWER_PCT / 100, needMs);
+            m_quietWindows = 0;
+        }
+        next = std::min(std::max(next, m_minMs), m_maxMs);
+
+        m_windowUnderruns = 0;
+        m_windowNearUnderruns = 0;
+        m_windowMinFill = SIZE_MAX;
+
+        if (next == current) return false;
+        bump(next > current ? m_raises : m_lowers);
+        m_targetMs.store(next, std::memory_order_relaxed);
+        return true;
+    }
+
+    static void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    uint32_t m_minMs = DEFAULT_MIN_MS;
+    uint32_t m_maxMs = DEFAULT_MAX_MS;
+    std::atomic<uint32_t> m_targetMs{INITIAL_MS};
+    std::atomic<size_t> m_bytesPerSecond{0};
+    std::atomic<size_t> m_ringSize{0};
+    std::atomic<bool> m_resetProducer{false};
+    std::atomic<bool> m_resetConsumer{true};
+
+    // Producer-written
+    alignas(64) std::atomic<uint64_t> m_lastPushUs{0};
+    uint64_t m_lastPushAudioUs = 0;
+    std::atomic<uint64_t> m_windowGapUs{0};    // Reset by the consumer each window
+
+    // Consumer-written
+    alignas(64) uint64_t m_windowStartUs = 0;
+    size_t m_windowMinFill = SIZE_MAX;
+    uint32_t m_windowUnderruns = 0;
+    uint32_t m_windowNearUnderruns = 0;
+    uint32_t m_quietWindows = 0;
+    bool m_lowActive = false;
+    std::atomic<uint64_t> m_peakGapUs{0};
+    std::atomic<uint64_t> m_nearUnderruns{0};
+    std::atomic<uint64_t> m_raises{0};
+    std::atomic<uint64_t> m_lowers{0};
+};
+
+#endif // ADAPTIVE_DEPTH_H
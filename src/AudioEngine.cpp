@@ -8,8 +8,16 @@
 #include <thread>
 #include <cstring>
 #include <cstdlib>
+#include <cmath>
 #include <algorithm>
-#include "memcpyfast_audio.h"
+#include <cctype>
+#include "AudioKernels.h"
+#include "AudioTiming.h"
+#include "ThreadPlacement.h"
+#include "TraceRecorder.h"
+#include "ReadAheadIO.h"
+#include "TrackCache.h"
+#include "PolyphaseResampler.h"
 
 extern "C" {
 
@@ -98,6 +106,42 @@ void AudioBuffer::growCapacity(size_t needed) {
     m_capacity = newCapacity;
 }
 
+// ============================================================================
+// DecodeAheadQueue - SPSC, preallocated blocks
+// ============================================================================
+
+void DecodeAheadQueue::reset(size_t depth, size_t bytesPerBlock) {
+    m_depth = std::min(std::max<size_t>(depth, 1), MAX_BLOCKS);
+    for (size_t i = 0; i < m_depth; i++) {
+        m_blocks[i].buffer.ensureCapacity(bytesPerBlock);
+        m_blocks[i].samples = 0;
+    }
+    m_head.store(0, std::memory_order_relaxed);
+    m_tail.store(0, std::memory_order_release);
+}
+
+DecodeAheadQueue::Block* DecodeAheadQueue::producerSlot() {
+    size_t head = m_head.load(std::memory_order_relaxed);
+    size_t tail = m_tail.load(std::memory_order_acquire);
+    if (head - tail >= m_depth) return nullptr;
+    return &m_blocks[head % m_depth];
+}
+
+void DecodeAheadQueue::producerCommit() {
+    m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+DecodeAheadQueue::Block* DecodeAheadQueue::consumerFront() {
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    size_t head = m_head.load(std::memory_order_acquire);
+    if (head == tail) return nullptr;
+    return &m_blocks[tail % m_depth];
+}
+
+void DecodeAheadQueue::consumerPop() {
+    m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
 // ============================================================================
 // AudioDecoder
 // ============================================================================
@@ -112,6 +156,8 @@ AudioDecoder::AudioDecoder()
     , m_packet(nullptr)
     , m_frame(nullptr)
     , m_dsdRemainderCount(0)
+    , m_dsdRemainderOffset(0)
+    , m_dsdRemainderStride(0)
     , m_pcmFifo(nullptr)
     , m_resampleBufferCapacity(0)
     , m_bypassMode(false)
@@ -123,58 +169,267 @@ AudioDecoder::~AudioDecoder() {
     close();
 }
 
-bool AudioDecoder::open(const std::string& url) {
-    std::cout << "[AudioDecoder] Opening: " << url.substr(0, 80) << "..." << std::endl;
+// Tag value as float ("-6.54 dB", "0.988212"). Container metadata first,
+// then the stream's (Ogg/Opus keep their comments on the stream).
+static bool readTagFloat(const AVFormatContext* format, const AVStream* stream,
+                         const char* key, float& value) {
+    for (const AVDictionary* dict : {format->metadata, stream->metadata}) {
+        const AVDictionaryEntry* entry = av_dict_get(dict, key, nullptr, 0);
+        if (!entry || !entry->value) continue;
+        char* end = nullptr;
+        float parsed = std::strtof(entry->value, &end);
+        if (end != entry->value && std::isfinite(parsed)) {
+            value = parsed;
+            return true;
+        }
+    }
+    return false;
+}
 
-    // Open input file
-    m_formatContext = avformat_alloc_context();
-    if (!m_formatContext) {
-        std::cerr << "[AudioDecoder] Failed to allocate format context" << std::endl;
+// FFmpeg demuxer the MIME type or URL extension already names, nullptr if
+// neither does. A MIME type wins over the extension (transcoding servers
+// keep the original file name); raw PCM (audio/L16...) is never forced.
+static const char* knownDemuxer(const std::string& url, const std::string& mimeType) {
+    struct Known { const char* key; const char* demuxer; };
+    static const Known kMime[] = {
+        {"audio/flac", "flac"}, {"audio/x-flac", "flac"},
+        {"audio/wav", "wav"}, {"audio/x-wav", "wav"}, {"audio/wave", "wav"}, {"audio/vnd.wave", "wav"},
+        {"audio/aiff", "aiff"}, {"audio/x-aiff", "aiff"},
+        {"audio/dsf", "dsf"}, {"audio/x-dsf", "dsf"},
+        {"audio/dff", "iff"}, {"audio/x-dff", "iff"},
+        {"audio/mpeg", "mp3"}, {"audio/mp3", "mp3"},
+        {"audio/mp4", "mov"}, {"audio/m4a", "mov"}, {"audio/x-m4a", "mov"},
+    };
+    static const Known kExtension[] = {
+        {"flac", "flac"}, {"wav", "wav"}, {"aif", "aiff"}, {"aiff", "aiff"},
+        {"dsf", "dsf"}, {"dff", "iff"}, {"mp3", "mp3"}, {"m4a", "mov"}, {"mp4", "mov"},
+    };
+    auto lower = [](std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return text;
+    };
+
+    std::string mime = lower(mimeType.substr(0, mimeType.find(';')));
+    if (!mime.empty()) {
+        for (const Known& k : kMime) {
+            if (mime == k.key) return k.demuxer;
+        }
+        if (mime.compare(0, 7, "audio/l") == 0) return nullptr;
+    }
+
+    std::string path = url.substr(0, url.find_first_of("?#"));
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos || path.find('/', dot) != std::string::npos) return nullptr;
+    std::string extension = lower(path.substr(dot + 1));
+    for (const Known& k : kExtension) {
+        if (extension == k.key) return k.demuxer;
+    }
+    return nullptr;
+}
+
+// av_read_frame() with its latency in the trace: network and demuxer stalls
+static int tracedReadFrame(AVFormatContext* context, AVPacket* packet) {
+    uint64_t start = Trace::ticks();
+    int ret = av_read_frame(context, packet);
+    Trace::record(Trace::Event::ReadFrame, ret < 0 ? 1 : 0,
+                  ret < 0 ? 0u : static_cast<uint32_t>(packet->size), Trace::ticks() - start);
+    return ret;
+}
+
+// MIME type of the first res protocolInfo in DIDL-Lite metadata
+// ("http-get:*:audio/flac:*"), empty if there is none
+static std::string protocolInfoMime(const std::string& metadata) {
+    size_t pos = metadata.find("protocolInfo=\"");
+    if (pos == std::string::npos) return std::string();
+    size_t end = metadata.find('"', pos + 14);
+    std::string info = metadata.substr(pos + 14, end == std::string::npos ? std::string::npos : end - pos - 14);
+    size_t first = info.find(':');
+    size_t second = first == std::string::npos ? first : info.find(':', first + 1);
+    if (second == std::string::npos) return std::string();
+    size_t third = info.find(':', second + 1);
+    return info.substr(second + 1, third == std::string::npos ? std::string::npos : third - second - 1);
+}
+
+// Numeric attribute of the first DIDL-Lite res element, 0 if absent
+static uint32_t resAttribute(const std::string& metadata, const std::string& name) {
+    size_t res = metadata.find("<res ");
+    if (res == std::string::npos) return 0;
+    size_t tagEnd = metadata.find('>', res);
+    size_t pos = metadata.find(" " + name + "=\"", res);
+    if (pos == std::string::npos || pos > tagEnd) return 0;
+    return static_cast<uint32_t>(std::strtoul(metadata.c_str() + pos + name.size() + 3, nullptr, 10));
+}
+
+bool AudioEngine::announcedTrackInfo(const std::string& metadata, TrackInfo& info) {
+    std::string mime = protocolInfoMime(metadata);
+    std::transform(mime.begin(), mime.end(), mime.begin(), ::tolower);
+    if (mime.find("dsd") != std::string::npos || mime.find("dsf") != std::string::npos ||
+        mime.find("dff") != std::string::npos) {
         return false;
     }
+    uint32_t rate = resAttribute(metadata, "sampleFrequency");
+    uint32_t bits = resAttribute(metadata, "bitsPerSample");
+    uint32_t channels = resAttribute(metadata, "nrAudioChannels");
+    if (rate == 0 || channels == 0 || (bits != 16 && bits != 24 && bits != 32)) {
+        return false;
+    }
+    info.sampleRate = rate;
+    info.bitDepth = bits;
+    info.channels = channels;
+    info.isDSD = false;
+    info.isCompressed = !(mime.find("wav") != std::string::npos ||
+                          mime.find("aif") != std::string::npos ||
+                          mime.find("audio/l16") == 0 || mime.find("audio/l24") == 0);
+    return true;
+}
 
-    // Configure FFmpeg options for robust HTTP streaming (Qobuz)
-    AVDictionary* options = nullptr;
+// Rate families: multiples of 44.1 kHz, everything else goes with 48 kHz
+static bool isRateFamily44(uint32_t rate) {
+    return rate > 0 && rate % 11025 == 0;
+}
+
+// One channel of a decoded frame as float (+-1.0 full scale), for the polyphase input
+static void frameChannelToFloat(const AVFrame* frame, size_t channel, size_t channels,
+                                size_t frames, float* dst) {
+    const AVSampleFormat fmt = static_cast<AVSampleFormat>(frame->format);
+    const bool planar = av_sample_fmt_is_planar(fmt);
+    const uint8_t* plane = frame->extended_data[planar ? channel : 0];
+    const size_t stride = planar ? 1 : channels;
+    const size_t offset = planar ? 0 : channel;
+
+    switch (fmt) {
+        case AV_SAMPLE_FMT_S16:
+        case AV_SAMPLE_FMT_S16P: {
+            const int16_t* src = reinterpret_cast<const int16_t*>(plane) + offset;
+            for (size_t i = 0; i < frames; i++) dst[i] = src[i * stride] * (1.0f / 32768.0f);
+            break;
+        }
+        case AV_SAMPLE_FMT_S32:
+        case AV_SAMPLE_FMT_S32P: {
+            const int32_t* src = reinterpret_cast<const int32_t*>(plane) + offset;
+            for (size_t i = 0; i < frames; i++) dst[i] = src[i * stride] * (1.0f / 2147483648.0f);
+            break;
+        }
+        case AV_SAMPLE_FMT_FLT:
+        case AV_SAMPLE_FMT_FLTP: {
+            const float* src = reinterpret_cast<const float*>(plane) + offset;
+            for (size_t i = 0; i < frames; i++) dst[i] = src[i * stride];
+            break;
+        }
+        case AV_SAMPLE_FMT_DBL:
+        case AV_SAMPLE_FMT_DBLP: {
+            const double* src = reinterpret_cast<const double*>(plane) + offset;
+            for (size_t i = 0; i < frames; i++) dst[i] = static_cast<float>(src[i * stride]);
+            break;
+        }
+        default:
+            std::fill_n(dst, frames, 0.0f);  // Rejected by initPolyphase()
+            break;
+    }
+}
 
+void AudioDecoder::setHttpOptions(AVDictionary** options) {
     // Automatic reconnection on connection loss
-    av_dict_set(&options, "reconnect", "1", 0);
-    av_dict_set(&options, "reconnect_streamed", "1", 0);
-    av_dict_set(&options, "reconnect_delay_max", "5", 0);  // Max 5 seconds between retries
+    av_dict_set(options, "reconnect", "1", 0);
+    av_dict_set(options, "reconnect_streamed", "1", 0);
+    av_dict_set(options, "reconnect_delay_max", "5", 0);  // Max 5 seconds between retries
 
     // Timeout to avoid blocking indefinitely
-    av_dict_set(&options, "timeout", "10000000", 0);  // 10 seconds in microseconds
+    av_dict_set(options, "timeout", "10000000", 0);  // 10 seconds in microseconds
 
     // Improved network buffering
-    av_dict_set(&options, "buffer_size", "32768", 0);  // 32KB buffer
+    av_dict_set(options, "buffer_size", "32768", 0);  // 32KB buffer
 
     // HTTP persistent connections
-    av_dict_set(&options, "http_persistent", "1", 0);
-    av_dict_set(&options, "multiple_requests", "1", 0);
+    av_dict_set(options, "http_persistent", "1", 0);
+    av_dict_set(options, "multiple_requests", "1", 0);
 
     // User-Agent (some servers check it)
-    av_dict_set(&options, "user_agent", "DirettaRenderer/1.0", 0);
+    av_dict_set(options, "user_agent", "DirettaRenderer/1.0", 0);
 
     // IMPORTANT: Ignore file size to avoid premature EOF
-    av_dict_set(&options, "ignore_eof", "1", 0);
+    av_dict_set(options, "ignore_eof", "1", 0);
+}
+
+bool AudioDecoder::open(const std::string& url) {
+    std::cout << "[AudioDecoder] Opening: " << url.substr(0, 80) << "..." << std::endl;
+
+    // Open input file
+    m_formatContext = avformat_alloc_context();
+    if (!m_formatContext) {
+        std::cerr << "[AudioDecoder] Failed to allocate format context" << std::endl;
+        return false;
+    }
+    // FFmpeg's own protocols poll this while blocked (see interrupt())
+    m_formatContext->interrupt_callback.callback = &AudioDecoder::interruptCallback;
+    m_formatContext->interrupt_callback.opaque = this;
+
+    // Configure FFmpeg options for robust HTTP streaming (Qobuz)
+    AVDictionary* options = nullptr;
+    setHttpOptions(&options);
 
     DEBUG_LOG("[AudioDecoder] Opening with streaming options (reconnect enabled)");
 
-    if (avformat_open_input(&m_formatContext, url.c_str(), nullptr, &options) < 0) {
+    // Fast probe: the container is known, so skip content probing and read
+    // only the first packets for stream info instead of FFmpeg's 5 MB / 5 s
+    const char* demuxer = m_fastProbe ? knownDemuxer(url, m_mimeHint) : nullptr;
+    auto* inputFormat = demuxer ? av_find_input_format(demuxer) : nullptr;
+    if (inputFormat) {
+        av_dict_set(&options, "probesize", "32768", 0);
+        av_dict_set(&options, "analyzeduration", "100000", 0);  // 100 ms
+    }
+    auto openStart = std::chrono::steady_clock::now();
+
+    // Network sources: HTTP options go to the read-ahead thread's connection,
+    // the demuxer reads from its ring through a custom AVIOContext
+    if (m_trackCache) {
+        m_cacheReader = m_trackCache->open(url);
+        if (m_cacheReader) {
+            m_formatContext->pb = m_cacheReader->context();
+        }
+    }
+    if (!m_cacheReader && m_readAheadBytes > 0 && ReadAheadIO::isNetworkUrl(url)) {
+        m_readAhead = std::make_unique<ReadAheadIO>(m_readAheadBytes, g_verbose);
+        if (m_readAhead->open(url, &options)) {
+            m_formatContext->pb = m_readAhead->context();
+        } else {
+            m_readAhead.reset();  // Fall back to FFmpeg's own HTTP reader
+        }
+    }
+
+    if (avformat_open_input(&m_formatContext, url.c_str(), inputFormat, &options) < 0) {
         std::cerr << "[AudioDecoder] Failed to open input: " << url << std::endl;
         av_dict_free(&options);
         avformat_free_context(m_formatContext);
         m_formatContext = nullptr;
-        return false;
+        m_readAhead.reset();
+        m_cacheReader.reset();
+        return inputFormat ? reopenWithFullProbe(url) : false;
     }
 
     // Free unused options
     av_dict_free(&options);
+    auto inputOpened = std::chrono::steady_clock::now();
 
     // Retrieve stream information
     if (avformat_find_stream_info(m_formatContext, nullptr) < 0) {
         std::cerr << "[AudioDecoder] Failed to find stream info" << std::endl;
         avformat_close_input(&m_formatContext);
-        return false;
+        m_readAhead.reset();
+        m_cacheReader.reset();
+        return inputFormat ? reopenWithFullProbe(url) : false;
+    }
+
+    if (m_fastProbe) {
+        auto now = std::chrono::steady_clock::now();
+        std::cout << "[AudioDecoder] Opened in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(now - openStart).count()
+                  << "ms (input "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(inputOpened - openStart).count()
+                  << "ms, stream info "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(now - inputOpened).count()
+                  << "ms, " << (inputFormat ? demuxer : "full probe") << ")" << std::endl;
     }
 
     // Log duration information
@@ -310,6 +565,19 @@ bool AudioDecoder::open(const std::string& url) {
     m_trackInfo.channels = codecpar->ch_layout.nb_channels;
     m_trackInfo.codec = codec->name;
 
+    // ReplayGain tags - only read here; whether they apply is the renderer's call
+    m_trackInfo.hasTrackGain = readTagFloat(m_formatContext, audioStream, "REPLAYGAIN_TRACK_GAIN",
+                                            m_trackInfo.trackGainDb);
+    m_trackInfo.hasAlbumGain = readTagFloat(m_formatContext, audioStream, "REPLAYGAIN_ALBUM_GAIN",
+                                            m_trackInfo.albumGainDb);
+    readTagFloat(m_formatContext, audioStream, "REPLAYGAIN_TRACK_PEAK", m_trackInfo.trackPeak);
+    readTagFloat(m_formatContext, audioStream, "REPLAYGAIN_ALBUM_PEAK", m_trackInfo.albumPeak);
+    if (m_trackInfo.hasTrackGain || m_trackInfo.hasAlbumGain) {
+        DEBUG_LOG("[AudioDecoder] ReplayGain: track " << m_trackInfo.trackGainDb
+                  << " dB (peak " << m_trackInfo.trackPeak << "), album "
+                  << m_trackInfo.albumGainDb << " dB (peak " << m_trackInfo.albumPeak << ")");
+    }
+
     // Classify codec complexity for buffer optimization
     // Uncompressed formats (WAV/AIFF): minimal latency
     // Compressed formats (FLAC/ALAC): need decoding buffer
@@ -414,6 +682,11 @@ bool AudioDecoder::open(const std::string& url) {
                 AVPacket* testPkt = av_packet_alloc();
                 int ret = av_read_frame(m_formatContext, testPkt);
                 if (ret >= 0 && testPkt->stream_index == m_audioStreamIndex) {
+                    // Seek index: packets are fixed [block L][block R] from the data start
+                    if (i == 0 && testPkt->pos >= 0 && m_trackInfo.channels > 0) {
+                        m_dsdDataStart = testPkt->pos;
+                        m_dsdBlockBytes = static_cast<size_t>(testPkt->size) / m_trackInfo.channels;
+                    }
                     std::cout << "[DSD DIAGNOSTIC] Packet " << i << ":" << std::endl;
                     std::cout << "  stream_index: " << testPkt->stream_index << std::endl;
                     std::cout << "  size: " << testPkt->size << " bytes" << std::endl;
@@ -456,6 +729,10 @@ bool AudioDecoder::open(const std::string& url) {
             // DO NOT open codec for DSD!
             // We'll read raw packets with av_read_frame()
             DEBUG_LOG("[AudioDecoder] DSD Native mode ready");
+            DEBUG_LOG("[AudioDecoder] Seek index: " << (m_dsdBlockBytes > 0
+                      ? "DSD block layout, " + std::to_string(m_dsdBlockBytes) + " bytes/ch from offset " +
+                        std::to_string(m_dsdDataStart)
+                      : std::string("none (time-based seek)")));
 
             // Calculate duration
             if (audioStream->duration != AV_NOPTS_VALUE) {
@@ -588,6 +865,35 @@ bool AudioDecoder::open(const std::string& url) {
     return true;
 }
 
+bool AudioDecoder::reopenWithFullProbe(const std::string& url) {
+    std::cout << "[AudioDecoder] Fast probe failed, retrying with full probing" << std::endl;
+    m_fastProbe = false;
+    bool opened = open(url);
+    m_fastProbe = true;
+    return opened;
+}
+
+int AudioDecoder::interruptCallback(void* opaque) {
+    return static_cast<AudioDecoder*>(opaque)->m_interrupted.load(std::memory_order_acquire) ? 1 : 0;
+}
+
+void AudioDecoder::interrupt() {
+    m_interrupted.store(true, std::memory_order_release);
+    if (m_readAhead) m_readAhead->interruptReads(true);
+    if (m_cacheReader) m_cacheReader->interruptReads(true);
+}
+
+void AudioDecoder::clearInterrupt() {
+    m_interrupted.store(false, std::memory_order_release);
+    if (m_readAhead) m_readAhead->interruptReads(false);
+    if (m_cacheReader) m_cacheReader->interruptReads(false);
+    // The aborted read left its error on the I/O context: let the next seek start clean
+    if (m_formatContext && m_formatContext->pb) {
+        m_formatContext->pb->error = 0;
+        m_formatContext->pb->eof_reached = 0;
+    }
+}
+
 void AudioDecoder::close() {
     if (m_swrContext) {
         swr_free(&m_swrContext);
@@ -605,74 +911,119 @@ void AudioDecoder::close() {
         av_audio_fifo_free(m_pcmFifo);
         m_pcmFifo = nullptr;
     }
+    m_polyphase.reset();
     if (m_formatContext) {
         avformat_close_input(&m_formatContext);
     }
+    m_readAhead.reset();  // Custom pb outlives the format context
+    m_cacheReader.reset();
     m_audioStreamIndex = -1;
     m_eof = false;
     m_rawDSD = false;
+    m_dsdRemainderCount = 0;
+    m_dsdRemainderOffset = 0;
+    m_dsdDataStart = -1;
+    m_dsdBlockBytes = 0;
+    m_dsdSeekTargetByte = -1;
+    m_seekTargetSample = -1;
     m_resampleBufferCapacity = 0;
     m_bypassMode = false;
     m_resamplerInitialized = false;
 }
 
+//=============================================================================
+// DSD raw read helpers
+//=============================================================================
+
+// MSB<->LSB bit reversal for DFF sources
+static const uint8_t kDsdBitReverse[256] = {
+    0x00,0x80,0x40,0xC0,0x20,0xA0,0x60,0xE0,0x10,0x90,0x50,0xD0,0x30,0xB0,0x70,0xF0,
+    0x08,0x88,0x48,0xC8,0x28,0xA8,0x68,0xE8,0x18,0x98,0x58,0xD8,0x38,0xB8,0x78,0xF8,
+    0x04,0x84,0x44,0xC4,0x24,0xA4,0x64,0xE4,0x14,0x94,0x54,0xD4,0x34,0xB4,0x74,0xF4,
+    0x0C,0x8C,0x4C,0xCC,0x2C,0xAC,0x6C,0xEC,0x1C,0x9C,0x5C,0xDC,0x3C,0xBC,0x7C,0xFC,
+    0x02,0x82,0x42,0xC2,0x22,0xA2,0x62,0xE2,0x12,0x92,0x52,0xD2,0x32,0xB2,0x72,0xF2,
+    0x0A,0x8A,0x4A,0xCA,0x2A,0xAA,0x6A,0xEA,0x1A,0x9A,0x5A,0xDA,0x3A,0xBA,0x7A,0xFA,
+    0x06,0x86,0x46,0xC6,0x26,0xA6,0x66,0xE6,0x16,0x96,0x56,0xD6,0x36,0xB6,0x76,0xF6,
+    0x0E,0x8E,0x4E,0xCE,0x2E,0xAE,0x6E,0xEE,0x1E,0x9E,0x5E,0xDE,0x3E,0xBE,0x7E,0xFE,
+    0x01,0x81,0x41,0xC1,0x21,0xA1,0x61,0xE1,0x11,0x91,0x51,0xD1,0x31,0xB1,0x71,0xF1,
+    0x09,0x89,0x49,0xC9,0x29,0xA9,0x69,0xE9,0x19,0x99,0x59,0xD9,0x39,0xB9,0x79,0xF9,
+    0x05,0x85,0x45,0xC5,0x25,0xA5,0x65,0xE5,0x15,0x95,0x55,0xD5,0x35,0xB5,0x75,0xF5,
+    0x0D,0x8D,0x4D,0xCD,0x2D,0xAD,0x6D,0xED,0x1D,0x9D,0x5D,0xDD,0x3D,0xBD,0x7D,0xFD,
+    0x03,0x83,0x43,0xC3,0x23,0xA3,0x63,0xE3,0x13,0x93,0x53,0xD3,0x33,0xB3,0x73,0xF3,
+    0x0B,0x8B,0x4B,0xCB,0x2B,0xAB,0x6B,0xEB,0x1B,0x9B,0x5B,0xDB,0x3B,0xBB,0x7B,0xFB,
+    0x07,0x87,0x47,0xC7,0x27,0xA7,0x67,0xE7,0x17,0x97,0x57,0xD7,0x37,0xB7,0x77,0xF7,
+    0x0F,0x8F,0x4F,0xCF,0x2F,0xAF,0x6F,0xEF,0x1F,0x9F,0x5F,0xDF,0x3F,0xBF,0x7F,0xFF
+};
+
+/**
+ * Copy one channel block of raw DSD, optionally bit-reversing on the fly
+ */
+static inline void copyDSDBlock(uint8_t* dst, const uint8_t* src, size_t len,
+                                const uint8_t* bitReverse) {
+    if (len == 0) return;
+    if (bitReverse) {
+        for (size_t i = 0; i < len; i++) {
+            dst[i] = bitReverse[src[i]];
+        }
+    } else {
+        memcpy_audio(dst, src, len);
+    }
+}
+
 size_t AudioDecoder::readSamples(AudioBuffer& buffer, size_t numSamples,
-                                uint32_t outputRate, uint32_t outputBits) {
+                                uint32_t outputRate, uint32_t outputBits,
+                                const DirectWrite* direct) {
+    m_lastDirectSamples = 0;
 
     // ══════════════════════════════════════════════════════════════
     // DSD NATIVE MODE - Read raw packets without decoding
     // ══════════════════════════════════════════════════════════════
 
     if (m_rawDSD) {
-        if (m_eof) {
+        const size_t channels = m_trackInfo.channels;
+        if (channels == 0 || (m_eof && m_dsdRemainderCount == 0)) {
             return 0;
         }
 
         // Calculate bytes needed
-        size_t totalBytesNeeded = (numSamples * m_trackInfo.channels) / 8;
-        size_t bytesPerChannelNeeded = totalBytesNeeded / m_trackInfo.channels;
+        size_t totalBytesNeeded = (numSamples * channels) / 8;
+        size_t bytesPerChannelNeeded = totalBytesNeeded / channels;
 
-        // Vectors to collect L and R data
-        std::vector<uint8_t> leftData;
-        std::vector<uint8_t> rightData;
-        leftData.reserve(bytesPerChannelNeeded);
-        rightData.reserve(bytesPerChannelNeeded);
+        // Output is planar [all L][all R]: channel c starts at c * bytesPerChannelNeeded.
+        // Packet blocks are copied straight into place (grow-only buffer, no per-call allocation)
+        buffer.resize(bytesPerChannelNeeded * channels);
+        uint8_t* out = buffer.data();
+        size_t filled = 0;  // bytes per channel written so far
 
-        // Ensure output buffer is large enough
-        if (buffer.size() < totalBytesNeeded) {
-            buffer.resize(totalBytesNeeded);
-        }
+        // Bit reversal for DFF (MSB) files - DSF is LSB, no reversal needed.
+        // Applied while copying, so each byte is touched once.
+        const uint8_t* bitReverse = (m_trackInfo.codec.find("msbf") != std::string::npos)
+            ? kDsdBitReverse : nullptr;
 
         // Use remaining data from previous reads
+        // Planar layout: channel c at c * m_dsdRemainderStride, read cursor advances (no memmove)
         if (m_dsdRemainderCount > 0) {
-            size_t remainingPerCh = m_dsdRemainderCount / 2;
+            size_t remainingPerCh = m_dsdRemainderCount / channels;
             size_t toUse = std::min(remainingPerCh, bytesPerChannelNeeded);
 
-            leftData.insert(leftData.end(),
-                           m_dsdRemainderBuffer.data(),
-                           m_dsdRemainderBuffer.data() + toUse);
-            rightData.insert(rightData.end(),
-                            m_dsdRemainderBuffer.data() + remainingPerCh,
-                            m_dsdRemainderBuffer.data() + remainingPerCh + toUse);
-
-            if (toUse < remainingPerCh) {
-                size_t leftover = remainingPerCh - toUse;
-                memmove(m_dsdRemainderBuffer.data(),
-                        m_dsdRemainderBuffer.data() + toUse,
-                        leftover);
-                memmove(m_dsdRemainderBuffer.data() + leftover,
-                        m_dsdRemainderBuffer.data() + remainingPerCh + toUse,
-                        leftover);
-                m_dsdRemainderCount = leftover * 2;
-            } else {
-                m_dsdRemainderCount = 0;
+            for (size_t ch = 0; ch < channels; ch++) {
+                copyDSDBlock(out + ch * bytesPerChannelNeeded,
+                             m_dsdRemainderBuffer.data() + ch * m_dsdRemainderStride + m_dsdRemainderOffset,
+                             toUse, bitReverse);
             }
+
+            m_dsdRemainderOffset += toUse;
+            m_dsdRemainderCount -= toUse * channels;
+            if (m_dsdRemainderCount == 0) {
+                m_dsdRemainderOffset = 0;
+            }
+            filled = toUse;
         }
 
         // Read packets until we have enough data
         // DSF layout: each packet is [blockSize L][blockSize R]
-        while (leftData.size() < bytesPerChannelNeeded && !m_eof) {
-            int ret = av_read_frame(m_formatContext, m_packet);
+        while (filled < bytesPerChannelNeeded && !m_eof) {
+            int ret = tracedReadFrame(m_formatContext, m_packet);
             if (ret < 0) {
                 if (ret == AVERROR_EOF) {
                     m_eof = true;
@@ -687,17 +1038,29 @@ size_t AudioDecoder::readSamples(AudioBuffer& buffer, size_t numSamples,
 
             m_packetCount++;
             size_t packetSize = m_packet->size;
-            size_t blockSize = packetSize / 2;  // Each channel gets half
+            size_t blockSize = packetSize / channels;  // Each channel gets an equal block
+
+            // First packet after a seek: start at the target byte inside the block
+            size_t skip = 0;
+            if (m_dsdSeekTargetByte >= 0) {
+                skip = dsdSeekSkip(m_packet, blockSize, channels);
+                if (skip >= blockSize) {
+                    av_packet_unref(m_packet);
+                    continue;  // Whole block before the target
+                }
+            }
+            const size_t usable = blockSize - skip;
 
-            // L is first half, R is second half
-            const uint8_t* pktL = m_packet->data;
-            const uint8_t* pktR = m_packet->data + blockSize;
+            const uint8_t* pktL = m_packet->data + skip;
+            const uint8_t* pktR = m_packet->data + blockSize + skip;
 
-            size_t stillNeed = bytesPerChannelNeeded - leftData.size();
-            size_t toTake = std::min(blockSize, stillNeed);
+            size_t stillNeed = bytesPerChannelNeeded - filled;
+            size_t toTake = std::min(usable, stillNeed);
 
-            leftData.insert(leftData.end(), pktL, pktL + toTake);
-            rightData.insert(rightData.end(), pktR, pktR + toTake);
+            for (size_t ch = 0; ch < channels; ch++) {
+                copyDSDBlock(out + ch * bytesPerChannelNeeded + filled,
+                             m_packet->data + ch * blockSize + skip, toTake, bitReverse);
+            }
 
             // Debug first few packets
             if (m_packetCount <= 3) {
@@ -706,80 +1069,68 @@ size_t AudioDecoder::readSamples(AudioBuffer& buffer, size_t numSamples,
                           << " block=" << blockSize
                           << " took=" << toTake << std::endl;
                 std::cout << "[DSD READ]   L[0..7]: ";
-                for (size_t i = 0; i < 8 && i < blockSize; i++) printf("%02X ", pktL[i]);
-                printf("\n");
-                std::cout << "[DSD READ]   R[0..7]: ";
-                for (size_t i = 0; i < 8 && i < blockSize; i++) printf("%02X ", pktR[i]);
+                for (size_t i = 0; i < 8 && i < usable; i++) printf("%02X ", pktL[i]);
                 printf("\n");
+                if (channels > 1) {
+                    std::cout << "[DSD READ]   R[0..7]: ";
+                    for (size_t i = 0; i < 8 && i < usable; i++) printf("%02X ", pktR[i]);
+                    printf("\n");
+                }
             }
 
-            // Save excess
-            if (toTake < blockSize) {
-                size_t excess = blockSize - toTake;
-                if (m_dsdRemainderBuffer.size() < excess * 2) {
-                    m_dsdRemainderBuffer.resize(excess * 2);
+            // Save excess (remainder is empty here: it was drained before reading packets)
+            if (toTake < usable) {
+                size_t excess = usable - toTake;
+                if (m_dsdRemainderStride < excess) {
+                    m_dsdRemainderStride = excess;
+                    m_dsdRemainderBuffer.resize(excess * channels);
                 }
-                memcpy_audio(m_dsdRemainderBuffer.data(), pktL + toTake, excess);
-                memcpy_audio(m_dsdRemainderBuffer.data() + excess, pktR + toTake, excess);
-                m_dsdRemainderCount = excess * 2;
+                for (size_t ch = 0; ch < channels; ch++) {
+                    memcpy_audio(m_dsdRemainderBuffer.data() + ch * m_dsdRemainderStride,
+                                 m_packet->data + ch * blockSize + skip + toTake, excess);
+                }
+                m_dsdRemainderOffset = 0;
+                m_dsdRemainderCount = excess * channels;
             }
 
+            filled += toTake;
             av_packet_unref(m_packet);
         }
 
-        // Build output: [all L][all R]
-        size_t actualPerCh = std::min(leftData.size(), rightData.size());
-        size_t totalBytes = actualPerCh * 2;
-
-        if (actualPerCh > 0) {
-            memcpy_audio(buffer.data(), leftData.data(), actualPerCh);
-            memcpy_audio(buffer.data() + actualPerCh, rightData.data(), actualPerCh);
+        // Short read (EOF): close the gaps so the output stays [all L][all R].
+        // Whole 4-byte groups only, so the ring's SIMD DSD kernels get an aligned stride.
+        if (filled < bytesPerChannelNeeded) {
+            filled &= ~static_cast<size_t>(3);
+            for (size_t ch = 1; ch < channels; ch++) {
+                std::memmove(out + ch * filled, out + ch * bytesPerChannelNeeded, filled);
+            }
         }
 
+        size_t actualPerCh = filled;
+        size_t totalBytes = actualPerCh * channels;
+
         // Debug output
         if (m_packetCount <= 5) {
             std::cout << "[DSD OUT] " << totalBytes << " bytes, " << actualPerCh << " per ch" << std::endl;
             std::cout << "[DSD OUT]   L: ";
             for (size_t i = 0; i < 8 && i < actualPerCh; i++) printf("%02X ", buffer.data()[i]);
             printf("\n");
-            std::cout << "[DSD OUT]   R: ";
-            for (size_t i = 0; i < 8 && i < actualPerCh; i++) printf("%02X ", buffer.data()[actualPerCh + i]);
-            printf("\n");
-        }
-
-        // Bit reversal for DFF (MSB) files - DSF is LSB, no reversal needed
-        if (m_trackInfo.codec.find("msbf") != std::string::npos) {
-            static const uint8_t rev[256] = {
-                0x00,0x80,0x40,0xC0,0x20,0xA0,0x60,0xE0,0x10,0x90,0x50,0xD0,0x30,0xB0,0x70,0xF0,
-                0x08,0x88,0x48,0xC8,0x28,0xA8,0x68,0xE8,0x18,0x98,0x58,0xD8,0x38,0xB8,0x78,0xF8,
-                0x04,0x84,0x44,0xC4,0x24,0xA4,0x64,0xE4,0x14,0x94,0x54,0xD4,0x34,0xB4,0x74,0xF4,
-                0x0C,0x8C,0x4C,0xCC,0x2C,0xAC,0x6C,0xEC,0x1C,0x9C,0x5C,0xDC,0x3C,0xBC,0x7C,0xFC,
-                0x02,0x82,0x42,0xC2,0x22,0xA2,0x62,0xE2,0x12,0x92,0x52,0xD2,0x32,0xB2,0x72,0xF2,
-                0x0A,0x8A,0x4A,0xCA,0x2A,0xAA,0x6A,0xEA,0x1A,0x9A,0x5A,0xDA,0x3A,0xBA,0x7A,0xFA,
-                0x06,0x86,0x46,0xC6,0x26,0xA6,0x66,0xE6,0x16,0x96,0x56,0xD6,0x36,0xB6,0x76,0xF6,
-                0x0E,0x8E,0x4E,0xCE,0x2E,0xAE,0x6E,0xEE,0x1E,0x9E,0x5E,0xDE,0x3E,0xBE,0x7E,0xFE,
-                0x01,0x81,0x41,0xC1,0x21,0xA1,0x61,0xE1,0x11,0x91,0x51,0xD1,0x31,0xB1,0x71,0xF1,
-                0x09,0x89,0x49,0xC9,0x29,0xA9,0x69,0xE9,0x19,0x99,0x59,0xD9,0x39,0xB9,0x79,0xF9,
-                0x05,0x85,0x45,0xC5,0x25,0xA5,0x65,0xE5,0x15,0x95,0x55,0xD5,0x35,0xB5,0x75,0xF5,
-                0x0D,0x8D,0x4D,0xCD,0x2D,0xAD,0x6D,0xED,0x1D,0x9D,0x5D,0xDD,0x3D,0xBD,0x7D,0xFD,
-                0x03,0x83,0x43,0xC3,0x23,0xA3,0x63,0xE3,0x13,0x93,0x53,0xD3,0x33,0xB3,0x73,0xF3,
-                0x0B,0x8B,0x4B,0xCB,0x2B,0xAB,0x6B,0xEB,0x1B,0x9B,0x5B,0xDB,0x3B,0xBB,0x7B,0xFB,
-                0x07,0x87,0x47,0xC7,0x27,0xA7,0x67,0xE7,0x17,0x97,0x57,0xD7,0x37,0xB7,0x77,0xF7,
-                0x0F,0x8F,0x4F,0xCF,0x2F,0xAF,0x6F,0xEF,0x1F,0x9F,0x5F,0xDF,0x3F,0xBF,0x7F,0xFF
-            };
-            for (size_t i = 0; i < totalBytes; i++) {
-                buffer.data()[i] = rev[buffer.data()[i]];
+            if (channels > 1) {
+                std::cout << "[DSD OUT]   R: ";
+                for (size_t i = 0; i < 8 && i < actualPerCh; i++) printf("%02X ", buffer.data()[actualPerCh + i]);
+                printf("\n");
             }
         }
 
-        return (totalBytes * 8) / m_trackInfo.channels;
+        return (totalBytes * 8) / channels;
     }
 
     // ══════════════════════════════════════════════════════════════
     // PCM MODE - Normal decoding with resampling
     // ══════════════════════════════════════════════════════════════
 
-    if (!m_codecContext || m_eof) {
+    // After EOF the FIFO may still hold the last frame's excess (or a resampler tail)
+    if (!m_codecContext || (m_eof && !(m_pcmFifo && av_audio_fifo_size(m_pcmFifo) > 0))) {
         return 0;
     }
 
@@ -809,10 +1160,47 @@ size_t AudioDecoder::readSamples(AudioBuffer& buffer, size_t numSamples,
 
     uint8_t* outputPtr = buffer.data();
 
-    // First, drain any samples from FIFO (O(1) read from circular buffer)
+    // Bypass PCM: frames go straight to direct while it takes them. After
+    // the first one it declines, the rest of this call goes to the buffer,
+    // which the caller sends after the direct frames (order is kept)
+    bool directOpen = direct && *direct && m_bypassMode;
+    const uint32_t channels = m_trackInfo.channels;
+    auto toDirect = [&](size_t samples, const DirectFill& fill) -> size_t {
+        size_t n = directOpen ? (*direct)(samples, outputRate, outputBits, channels, fill) : 0;
+        if (n == 0) directOpen = false;
+        m_lastDirectSamples += n;
+        return n;
+    };
+    auto copyDirect = [&](const uint8_t* src, size_t samples) -> size_t {
+        size_t done = 0;
+        while (directOpen && done < samples) {
+            // More than one span only at the wrap of a non-mirrored ring
+            const uint8_t* from = src + done * bytesPerSample;
+            done += toDirect(samples - done, [from, bytesPerSample](uint8_t* region, size_t maxFrames) {
+                memcpy_audio(region, from, maxFrames * bytesPerSample);
+                return maxFrames;
+            });
+        }
+        return done;
+    };
+
+    // First, drain any samples from FIFO (O(1) read from circular buffer):
+    // the overflow tail of the last frame
+    while (directOpen && m_pcmFifo && av_audio_fifo_size(m_pcmFifo) > 0 && totalSamplesRead < numSamples) {
+        size_t samplesToRead = std::min(static_cast<size_t>(av_audio_fifo_size(m_pcmFifo)),
+                                        numSamples - totalSamplesRead);
+        totalSamplesRead += toDirect(samplesToRead, [this](uint8_t* region, size_t maxFrames) -> size_t {
+            void* ptrs[1] = { region };
+            int samplesRead = av_audio_fifo_read(m_pcmFifo, ptrs, static_cast<int>(maxFrames));
+            return samplesRead > 0 ? static_cast<size_t>(samplesRead) : 0;
+        });
+    }
+    if (totalSamplesRead >= numSamples) {
+        return totalSamplesRead;
+    }
     if (m_pcmFifo && av_audio_fifo_size(m_pcmFifo) > 0) {
         int fifoSamples = av_audio_fifo_size(m_pcmFifo);
-        int samplesToRead = std::min(fifoSamples, (int)numSamples);
+        int samplesToRead = std::min(fifoSamples, (int)(numSamples - totalSamplesRead));
 
         uint8_t* readPtrs[1] = { outputPtr };
         int samplesRead = av_audio_fifo_read(m_pcmFifo, (void**)readPtrs, samplesToRead);
@@ -842,7 +1230,7 @@ size_t AudioDecoder::readSamples(AudioBuffer& buffer, size_t numSamples,
 
     while (totalSamplesRead < numSamples && !m_eof) {
         // Read packet
-        int ret = av_read_frame(m_formatContext, m_packet);
+        int ret = tracedReadFrame(m_formatContext, m_packet);
 
         if (ret < 0) {
             // Log position when EOF occurs
@@ -901,6 +1289,12 @@ size_t AudioDecoder::readSamples(AudioBuffer& buffer, size_t numSamples,
                 return totalSamplesRead;
             }
 
+            // First frames after a seek: drop the pre-roll before the target sample
+            if (m_seekTargetSample >= 0 && !trimSeekPreroll(m_frame)) {
+                av_frame_unref(m_frame);
+                continue;
+            }
+
             // Process frame
             size_t frameSamples = m_frame->nb_samples;
 
@@ -935,12 +1329,16 @@ size_t AudioDecoder::readSamples(AudioBuffer& buffer, size_t numSamples,
                 size_t samplesNeeded = numSamples - totalSamplesRead;
 
                 if (m_bypassMode) {
-                    // BYPASS PATH: Direct copy from decoded frame (bit-perfect)
+                    // BYPASS PATH: Direct copy from decoded frame (bit-perfect),
+                    // into the output's ring when it lends one
                     size_t samplesToCopy = std::min(frameSamples, samplesNeeded);
                     size_t bytesToCopy = samplesToCopy * bytesPerSample;
+                    size_t bytesDirect = copyDirect(m_frame->data[0], samplesToCopy) * bytesPerSample;
 
-                    memcpy_audio(outputPtr, m_frame->data[0], bytesToCopy);
-                    outputPtr += bytesToCopy;
+                    if (bytesDirect < bytesToCopy) {
+                        memcpy_audio(outputPtr, m_frame->data[0] + bytesDirect, bytesToCopy - bytesDirect);
+                        outputPtr += bytesToCopy - bytesDirect;
+                    }
                     totalSamplesRead += samplesToCopy;
 
                     // Store excess in FIFO
@@ -954,6 +1352,16 @@ size_t AudioDecoder::readSamples(AudioBuffer& buffer, size_t numSamples,
                             std::cerr << "[AudioDecoder] FIFO write failed: " << written << std::endl;
                         }
                     }
+                } else if (m_polyphase) {
+                    // Native polyphase: planar float in, output format straight out
+                    const size_t channels = m_trackInfo.channels;
+                    for (size_t ch = 0; ch < channels; ch++) {
+                        frameChannelToFloat(m_frame, ch, channels, frameSamples,
+                                            m_polyphase->input(ch, frameSamples));
+                    }
+                    m_polyphase->commit(frameSamples);
+                    totalSamplesRead += polyphaseOutput(outputPtr, samplesNeeded,
+                                                        outputBits, bytesPerSample);
                 } else if (m_swrContext) {
                     // Max possible output samples for this frame (upper bound)
                     int64_t maxOutSamples = av_rescale_rnd(
@@ -1055,6 +1463,13 @@ size_t AudioDecoder::readSamples(AudioBuffer& buffer, size_t numSamples,
         }
     }
 
+    // End of stream: play out the filter tail (no-op once it has been produced)
+    if (m_eof && m_polyphase) {
+        m_polyphase->finish();
+        totalSamplesRead += polyphaseOutput(outputPtr, numSamples - totalSamplesRead,
+                                            outputBits, bytesPerSample);
+    }
+
     // Unref for reuse (no deallocation)
     av_packet_unref(m_packet);
     av_frame_unref(m_frame);
@@ -1062,6 +1477,35 @@ size_t AudioDecoder::readSamples(AudioBuffer& buffer, size_t numSamples,
     return totalSamplesRead;
 }
 
+size_t AudioDecoder::polyphaseOutput(uint8_t*& outputPtr, size_t samplesNeeded,
+                                     uint32_t outputBits, size_t bytesPerSample) {
+    // Straight into the caller's buffer first
+    size_t produced = m_polyphase->produce(outputPtr, samplesNeeded, outputBits);
+    outputPtr += produced * bytesPerSample;
+
+    // Rest of what this input allows goes to the FIFO for the next call
+    size_t excess = m_polyphase->available();
+    if (excess > 0 && m_pcmFifo) {
+        size_t tempBufferSize = excess * bytesPerSample;
+        if (tempBufferSize > m_resampleBufferCapacity) {
+            size_t newCapacity = static_cast<size_t>(tempBufferSize * 1.5);
+            m_resampleBuffer.resize(newCapacity);
+            m_resampleBufferCapacity = m_resampleBuffer.size();
+        }
+        excess = m_polyphase->produce(m_resampleBuffer.data(), excess, outputBits);
+
+        uint8_t* excessPtrs[1] = { m_resampleBuffer.data() };
+        int written = av_audio_fifo_write(m_pcmFifo, (void**)excessPtrs, excess);
+        if (written < 0) {
+            std::cerr << "[AudioDecoder] FIFO write failed: " << written << std::endl;
+        } else if ((size_t)written != excess) {
+            std::cerr << "[AudioDecoder] FIFO partial write: " << written
+                      << "/" << excess << " samples" << std::endl;
+        }
+    }
+    return produced;
+}
+
 bool AudioDecoder::canBypass(uint32_t outputRate, uint32_t outputBits) const {
     // DSD never uses bypass (handled separately)
     if (m_trackInfo.isDSD) {
@@ -1148,6 +1592,11 @@ bool AudioDecoder::initResampler(uint32_t outputRate, uint32_t outputBits) {
 
     m_bypassMode = false;
 
+    // Native engine selected for this rate family
+    if (initPolyphase(outputRate, outputBits)) {
+        return true;
+    }
+
     // Free existing resampler
     if (m_swrContext) {
         swr_free(&m_swrContext);
@@ -1228,6 +1677,59 @@ bool AudioDecoder::initResampler(uint32_t outputRate, uint32_t outputBits) {
     return true;
 }
 
+bool AudioDecoder::initPolyphase(uint32_t outputRate, uint32_t outputBits) {
+    m_polyphase.reset();
+
+    const uint32_t inputRate = static_cast<uint32_t>(m_codecContext->sample_rate);
+    bool selected = isRateFamily44(inputRate) ? m_nativeResampler44 : m_nativeResampler48;
+    if (!selected || inputRate == outputRate) {
+        return false;  // Format-only conversions stay on libswresample
+    }
+
+    switch (m_codecContext->sample_fmt) {
+        case AV_SAMPLE_FMT_S16: case AV_SAMPLE_FMT_S16P:
+        case AV_SAMPLE_FMT_S32: case AV_SAMPLE_FMT_S32P:
+        case AV_SAMPLE_FMT_FLT: case AV_SAMPLE_FMT_FLTP:
+        case AV_SAMPLE_FMT_DBL: case AV_SAMPLE_FMT_DBLP:
+            break;
+        default:
+            DEBUG_LOG("[AudioDecoder] Polyphase: format "
+                      << av_get_sample_fmt_name(m_codecContext->sample_fmt)
+                      << " not supported, using libswresample");
+            return false;
+    }
+
+    auto resampler = std::make_unique<PolyphaseResampler>(inputRate, outputRate, m_trackInfo.channels);
+    if (!resampler->valid()) {
+        std::cerr << "[AudioDecoder] No polyphase filter for " << inputRate << "Hz -> "
+                  << outputRate << "Hz, using libswresample" << std::endl;
+        return false;
+    }
+
+    if (m_pcmFifo) {
+        av_audio_fifo_free(m_pcmFifo);
+        m_pcmFifo = nullptr;
+    }
+    AVSampleFormat outFormat = (outputBits == 16) ? AV_SAMPLE_FMT_S16 : AV_SAMPLE_FMT_S32;
+    size_t fifoSize = 8192;
+    if (outputRate > 96000) fifoSize = 16384;
+    if (outputRate > 192000) fifoSize = 32768;
+
+    m_pcmFifo = av_audio_fifo_alloc(outFormat, m_trackInfo.channels, fifoSize);
+    if (!m_pcmFifo) {
+        std::cerr << "[AudioDecoder] Failed to allocate PCM FIFO" << std::endl;
+        return false;
+    }
+
+    std::cout << "[AudioDecoder] Resampler: polyphase " << inputRate << "Hz -> " << outputRate
+              << "Hz, " << outputBits << "bit (L/M " << resampler->up() << "/" << resampler->down()
+              << ", " << resampler->taps() << " taps/phase)" << std::endl;
+
+    m_polyphase = std::move(resampler);
+    m_resamplerInitialized = true;
+    return true;
+}
+
 // ============================================================================
 // AudioEngine
 // ============================================================================
@@ -1244,7 +1746,64 @@ AudioEngine::AudioEngine()
 
 AudioEngine::~AudioEngine() {
     stop();
+    cancelPreload();
     waitForPreloadThread();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stopDecodeAhead(true);
+}
+
+void AudioEngine::setTrackCache(size_t bytes) {
+    if (bytes == 0) {
+        m_trackCache.reset();
+        return;
+    }
+    // Downloads open the source exactly as a streaming decoder would
+    AVDictionary* options = nullptr;
+    AudioDecoder::setHttpOptions(&options);
+    m_trackCache = std::make_unique<TrackCache>(bytes, g_verbose, options);
+    av_dict_free(&options);
+}
+
+void AudioEngine::setUpsampling(bool family44, uint32_t rate, bool native) {
+    UpsampleRule& rule = m_upsample[family44 ? 0 : 1];
+    rule.rate = rate;
+    rule.native = native;
+    if (rate == 0) return;
+
+    std::cout << "[AudioEngine] Upsampling " << (family44 ? "44.1k" : "48k") << " family to "
+              << rate << "Hz (" << (native ? "polyphase" : "libswresample") << ")" << std::endl;
+    if (!native) return;
+
+    // Shared coefficient tables for every source rate of the family below the target
+    auto start = std::chrono::steady_clock::now();
+    size_t filters = 0;
+    for (uint32_t source = family44 ? 44100 : 48000; source < rate; source *= 2) {
+        if (PolyphaseResampler::filterFor(source, rate)) {
+            filters++;
+        } else {
+            std::cerr << "[AudioEngine] " << source << "Hz -> " << rate
+                      << "Hz needs too large a filter, libswresample will be used" << std::endl;
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    DEBUG_LOG("[AudioEngine] " << filters << " polyphase filters built in " << elapsed.count() << " ms");
+}
+
+uint32_t AudioEngine::outputRateFor(const TrackInfo& info) const {
+    if (info.isDSD || info.sampleRate == 0) {
+        return info.sampleRate;
+    }
+    const UpsampleRule& rule = m_upsample[isRateFamily44(info.sampleRate) ? 0 : 1];
+    return std::max(rule.rate, info.sampleRate);
+}
+
+uint32_t AudioEngine::outputBitsFor(const TrackInfo& info) const {
+    // Filtered output has more than 16 bits of resolution to keep
+    if (outputRateFor(info) != info.sampleRate) {
+        return std::max<uint32_t>(info.bitDepth, 24);
+    }
+    return info.bitDepth;
 }
 
 void AudioEngine::waitForPreloadThread() {
@@ -1253,6 +1812,93 @@ void AudioEngine::waitForPreloadThread() {
     }
 }
 
+void AudioEngine::requestPreload(const std::string& uri, const std::string& metadata) {
+    std::lock_guard<std::mutex> lock(m_preloadMutex);
+
+    // Already requested (in flight, parked, or failed): don't reopen
+    if (uri == m_preloadRequestURI) return;
+
+    m_preloadRequestURI = uri;
+    m_preloadRequestMime = protocolInfoMime(metadata);
+    m_preloadAttemptedURI.clear();
+    if (m_preloadedURI != uri) {
+        m_preloadedDecoder.reset();
+        m_preloadedURI.clear();
+    }
+    if (uri.empty()) return;
+
+    // A running job picks the new request up after its current open
+    if (!m_preloadRunning.load(std::memory_order_acquire)) {
+        waitForPreloadThread();  // Previous job already finished its loop
+        m_preloadRunning.store(true, std::memory_order_release);
+        m_preloadThread = std::thread(&AudioEngine::preloadThreadFunc, this);
+    }
+}
+
+void AudioEngine::cancelPreload() {
+    std::unique_ptr<AudioDecoder> discard;
+    {
+        std::lock_guard<std::mutex> lock(m_preloadMutex);
+        if (m_preloadRunning.load(std::memory_order_acquire) || m_preloadedDecoder) {
+            std::cout << "[AudioEngine] Cancelling ongoing preload" << std::endl;
+        }
+        m_preloadRequestURI.clear();
+        m_preloadedURI.clear();
+        discard = std::move(m_preloadedDecoder);
+    }
+    // Decoder closes (network teardown) outside the lock
+}
+
+void AudioEngine::preloadThreadFunc() {
+    ThreadPlacement::apply(ThreadPlacement::Role::Preload);
+    for (;;) {
+        std::string uri;
+        std::string mime;
+        {
+            std::lock_guard<std::mutex> lock(m_preloadMutex);
+            if (m_preloadRequestURI.empty() || m_preloadRequestURI == m_preloadAttemptedURI) {
+                m_preloadRunning.store(false, std::memory_order_release);
+                return;
+            }
+            uri = m_preloadRequestURI;
+            mime = m_preloadRequestMime;
+        }
+
+        DEBUG_LOG("[AudioEngine] Preloading next track in background...");
+
+        // Slow part (HTTP open + stream probing) runs without any engine lock
+        auto decoder = std::make_unique<AudioDecoder>();
+        decoder->setReadAhead(m_readAheadBytes);
+        decoder->setTrackCache(m_trackCache.get());
+        decoder->setNativeResampler(m_upsample[0].native, m_upsample[1].native);
+        decoder->setFastProbe(m_fastProbe, mime);
+        bool opened = decoder->open(uri);
+        if (!opened) {
+            std::cerr << "[AudioEngine] Failed to preload next track" << std::endl;
+            decoder.reset();
+        }
+
+        std::lock_guard<std::mutex> lock(m_preloadMutex);
+        m_preloadAttemptedURI = uri;
+        if (opened && uri == m_preloadRequestURI) {
+            m_preloadedDecoder = std::move(decoder);
+            m_preloadedURI = uri;
+            DEBUG_LOG("[AudioEngine] Next track ready: " << m_preloadedDecoder->getTrackInfo().codec);
+        }
+        // Stale result (request changed meanwhile) is dropped with 'decoder'
+    }
+}
+
+std::unique_ptr<AudioDecoder> AudioEngine::takePreloadedDecoder(const std::string& uri) {
+    std::lock_guard<std::mutex> lock(m_preloadMutex);
+    if (!m_preloadedDecoder || uri.empty() || m_preloadedURI != uri) {
+        return nullptr;
+    }
+    m_preloadedURI.clear();
+    m_preloadRequestURI.clear();  // Consumed: the same URI may be queued again
+    return std::move(m_preloadedDecoder);
+}
+
 void AudioEngine::setAudioCallback(const AudioCallback& callback) {
     m_audioCallback = callback;
 }
@@ -1270,6 +1916,7 @@ void AudioEngine::setCurrentURI(const std::string& uri, const std::string& metad
 
     m_currentURI = uri;
     m_currentMetadata = metadata;
+    if (m_trackCache) m_trackCache->prefetch(uri);
 
     // NOUVEAU : Forcer la réouverture même si l'URI est la même (pour Stop)
     if (uriChanged || forceReopen) {
@@ -1278,6 +1925,7 @@ void AudioEngine::setCurrentURI(const std::string& uri, const std::string& metad
                   << " - closing decoders to load new track" << std::endl;
 
         // Fermer les décodeurs pour forcer réouverture
+        stopDecodeAhead(true);
         m_currentDecoder.reset();
         m_nextDecoder.reset();
 
@@ -1300,10 +1948,8 @@ void AudioEngine::setCurrentURI(const std::string& uri, const std::string& metad
         m_isDraining = false;
 
         // Arrêter le préchargement en cours si existant
-        if (m_preloadRunning.load(std::memory_order_acquire)) {
-            m_preloadRunning.store(false, std::memory_order_release);
-            std::cout << "[AudioEngine] Cancelling ongoing preload" << std::endl;
-        }
+        cancelPreload();
+        m_nextFormatChange = false;
 
         // Si on est en PLAYING, on va automatiquement ouvrir la nouvelle piste
         // au prochain process()
@@ -1321,12 +1967,32 @@ void AudioEngine::setNextURI(const std::string& uri, const std::string& metadata
     }
     m_pendingNextTrack.store(true, std::memory_order_release);
     std::cout << "[AudioEngine] Next URI queued (gapless)" << std::endl;
+
+    // Start the download before the preload opens it
+    if (m_trackCache) m_trackCache->prefetch(uri);
+
+    // Open it now, in the background, so it is ready long before EOF
+    requestPreload(uri, metadata);
 }
 
 void AudioEngine::setTrackEndCallback(const TrackEndCallback& callback) {
     m_trackEndCallback = callback;
 }
 
+bool AudioEngine::prepare() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_currentURI.empty() || m_state == State::PAUSED) {
+        return false;
+    }
+
+    stopDecodeAhead();
+    if (m_currentDecoder && !m_currentDecoder->isEOF()) {
+        return true;
+    }
+    return openCurrentTrack();
+}
+
 bool AudioEngine::play() {
     std::lock_guard<std::mutex> lock(m_mutex);
 
@@ -1344,6 +2010,9 @@ bool AudioEngine::play() {
 
     std::cout << "[AudioEngine] Play" << std::endl;
 
+    // A worker left over from a deferred stop() must not race isEOF() below
+    stopDecodeAhead();
+
     // Open current track if not already open OR if at EOF
     if (!m_currentDecoder || m_currentDecoder->isEOF()) {
         std::cout << "[AudioEngine] Opening track (new or after EOF)" << std::endl;
@@ -1360,14 +2029,8 @@ bool AudioEngine::play() {
     m_isDraining = false;
 
     // Preload next track in background if set (for gapless)
-    // Use joinable thread instead of detached to prevent use-after-free
-    if (!m_nextURI.empty() && !m_nextDecoder && !m_preloadRunning.load(std::memory_order_acquire)) {
-        waitForPreloadThread();
-        m_preloadRunning.store(true, std::memory_order_release);
-        m_preloadThread = std::thread([this]() {
-            preloadNextTrack();
-            m_preloadRunning.store(false, std::memory_order_release);
-        });
+    if (!m_nextURI.empty() && !m_nextDecoder) {
+        requestPreload(m_nextURI, m_nextMetadata);
     }
 
     return true;
@@ -1379,6 +2042,7 @@ void AudioEngine::stop() {
 
     // Changer l'état SANS mutex (atomic)
     m_state.store(State::STOPPED);
+    m_decodeRunning.store(false, std::memory_order_release);
 
     // Clear pending flags
     m_pendingNextTrack.store(false, std::memory_order_release);
@@ -1388,8 +2052,9 @@ void AudioEngine::stop() {
         m_pendingNextMetadata.clear();
     }
 
-    // Wait for preload thread before cleanup
-    waitForPreloadThread();
+    // Drop any background preload (the job never touches engine state,
+    // so there is nothing to wait for here)
+    cancelPreload();
 
     std::cout << "[AudioEngine] State changed to STOPPED" << std::endl;
 
@@ -1399,6 +2064,7 @@ void AudioEngine::stop() {
         std::cout << "[AudioEngine] Cleaning up decoders and state..." << std::endl;
 
         // Fermer les décodeurs
+        stopDecodeAhead(true);
         m_currentDecoder.reset();
         m_nextDecoder.reset();
 
@@ -1432,10 +2098,11 @@ void AudioEngine::pause() {
 }
 
 double AudioEngine::getPosition() const {
-    if (m_currentTrackInfo.sampleRate == 0) {
+    TrackSnapshot track = m_track.load();
+    if (track->value.outputRate == 0) {
         return 0.0;
     }
-    return static_cast<double>(m_samplesPlayed) / m_currentTrackInfo.sampleRate;
+    return static_cast<double>(m_samplesPlayed) / track->value.outputRate;
 }
 
 bool AudioEngine::process(size_t samplesNeeded) {
@@ -1466,10 +2133,18 @@ bool AudioEngine::process(size_t samplesNeeded) {
                     targetSeconds = 0;
                 }
 
+                // Queued blocks are from the old position; the worker
+                // restarts from the new one on the next read below
+                stopDecodeAhead(true);
+
                 // Perform the actual seek
-                if (m_currentDecoder->seek(targetSeconds)) {
+                uint64_t seekStart = Trace::ticks();
+                bool seeked = m_currentDecoder->seek(targetSeconds);
+                Trace::record(Trace::Event::Seek, seeked ? 0 : 1, static_cast<uint32_t>(targetSeconds * 1000),
+                              Trace::ticks() - seekStart);
+                if (seeked) {
                     // Update position
-                    m_samplesPlayed = static_cast<uint64_t>(targetSeconds * info.sampleRate);
+                    m_samplesPlayed = static_cast<uint64_t>(targetSeconds * outputRateFor(info));
 
                     // Reset drainage counters
                     m_silenceCount = 0;
@@ -1478,6 +2153,11 @@ bool AudioEngine::process(size_t samplesNeeded) {
                     std::cout << "[AudioEngine] Seek completed to " << targetSeconds << "s" << std::endl;
                     DEBUG_LOG("[AudioEngine] Position updated to "
                               << m_samplesPlayed << " samples (" << targetSeconds << "s)");
+
+                    // Sample-accurate landing: downstream only needs its stale tail dropped
+                    if (m_seekCallback) {
+                        m_seekCallback(targetSeconds);
+                    }
                 } else {
                     std::cerr << "[AudioEngine] Seek failed in decoder" << std::endl;
                 }
@@ -1503,6 +2183,7 @@ bool AudioEngine::process(size_t samplesNeeded) {
             m_pendingNextMetadata.clear();
         }
         m_pendingNextTrack.store(false, std::memory_order_release);
+        m_nextFormatChange = false;
         std::cout << "[AudioEngine] Pending next URI applied (gapless)" << std::endl;
     }
 
@@ -1526,37 +2207,66 @@ bool AudioEngine::process(size_t samplesNeeded) {
     }
 
     // Determine output format
-    uint32_t outputRate = m_currentTrackInfo.sampleRate;
-    uint32_t outputBits = m_currentTrackInfo.bitDepth;
+    // Source format (bit-perfect) unless the track's rate family is upsampled;
+    // DSD always keeps its native rate
+    uint32_t outputRate = outputRateFor(m_currentTrackInfo);
+    uint32_t outputBits = outputBitsFor(m_currentTrackInfo);
     uint32_t outputChannels = m_currentTrackInfo.channels;
 
-    // For DSD, keep native rate and bit depth
-    if (!m_currentTrackInfo.isDSD) {
-        // For PCM, we can target specific output format if needed
-        // For now, keep source format (bit-perfect)
-    }
+    // Read samples: from the decode-ahead queue, or straight from the decoder
+    size_t samplesRead = 0;
+    size_t directSamples = 0;  // Of samplesRead, already in the output (m_directWrite)
+    const AudioBuffer* output = &m_buffer;
+    bool decoderEOF;
+    uint64_t readStart = Trace::ticks();
 
-    // Read samples from decoder
-    size_t samplesRead = m_currentDecoder->readSamples(
-        m_buffer,
-        samplesNeeded,
-        outputRate,
-        outputBits
-    );
+    if (m_decodeAheadEnabled) {
+        if (m_decodeThread.joinable() && m_decodeChunk != samplesNeeded) {
+            stopDecodeAhead();  // Chunk size changed with format
+        }
+        if (!m_decodeThread.joinable()) {
+            startDecodeAhead(samplesNeeded, outputRate, outputBits);
+        }
+
+        // Load the done flag BEFORE peeking: done implies every block is visible
+        bool done = m_decodeDone.load(std::memory_order_acquire);
+        DecodeAheadQueue::Block* block = m_decodeQueue.consumerFront();
+        if (block) {
+            samplesRead = block->samples;
+            output = &block->buffer;
+        } else if (!done) {
+            Trace::record(Trace::Event::Decode, Trace::DECODE_QUEUE_EMPTY, 0, Trace::ticks() - readStart);
+            return false;  // Worker behind (decode/network stall) - nothing to send yet
+        }
+        decoderEOF = m_decodeEOF.load(std::memory_order_acquire);
+    } else {
+        samplesRead = m_currentDecoder->readSamples(
+            m_buffer,
+            samplesNeeded,
+            outputRate,
+            outputBits,
+            m_directWrite ? &m_directWrite : nullptr
+        );
+        directSamples = m_currentDecoder->lastDirectSamples();
+        decoderEOF = m_currentDecoder->isEOF();
+    }
+    Trace::record(Trace::Event::Decode, m_decodeAheadEnabled ? Trace::DECODE_QUEUE : Trace::DECODE_READ,
+                  static_cast<uint32_t>(samplesRead), Trace::ticks() - readStart);
 
     // CRITICAL: Preload next track as soon as EOF flag is set (for gapless)
     // Check AFTER readSamples() because EOF flag is set during the read
-    if (!m_nextDecoder && !m_nextURI.empty() && m_currentDecoder->isEOF()) {
-        std::cout << "[AudioEngine] EOF flag detected, preloading next track for gapless..." << std::endl;
+    // Non-blocking: adopts the decoder the background job opened, if ready
+    if (!m_nextDecoder && !m_nextURI.empty() && decoderEOF) {
         preloadNextTrack();
     }
 
     if (samplesRead > 0) {
-        // Call audio callback to send data to output
-        if (m_audioCallback) {
+        // Call audio callback to send data to output (the buffered rest
+        // when the decoder wrote into the output itself)
+        if (m_audioCallback && samplesRead > directSamples) {
             bool continuePlayback = m_audioCallback(
-                m_buffer,
-                samplesRead,
+                *output,
+                samplesRead - directSamples,
                 outputRate,
                 outputBits,
                 outputChannels
@@ -1572,6 +2282,10 @@ bool AudioEngine::process(size_t samplesNeeded) {
         m_samplesPlayed += samplesRead;
     }
 
+    if (output != &m_buffer) {
+        m_decodeQueue.consumerPop();
+    }
+
     // Check for actual end of data (no more samples can be read)
     if (samplesRead == 0) {
 
@@ -1582,6 +2296,11 @@ bool AudioEngine::process(size_t samplesNeeded) {
             m_silenceCount = 0;
         }
 
+        // Last chance for a preload that finished since EOF was flagged
+        if (!m_nextDecoder && !m_nextURI.empty()) {
+            preloadNextTrack();
+        }
+
         // Check if we have a next track ready for gapless
         if (m_nextDecoder) {
             std::cout << "[AudioEngine] Transitioning to next track (gapless)..." << std::endl;
@@ -1601,7 +2320,9 @@ bool AudioEngine::process(size_t samplesNeeded) {
 
             // Signal track end to allow clean transition
             if (m_trackEndCallback) {
+                m_formatTransition.store(true, std::memory_order_release);
                 m_trackEndCallback();
+                m_formatTransition.store(false, std::memory_order_release);
             }
 
             // Apply next URI as current
@@ -1609,6 +2330,7 @@ bool AudioEngine::process(size_t samplesNeeded) {
             m_currentMetadata = nextMetadata;
             m_nextURI.clear();
             m_nextMetadata.clear();
+            m_nextFormatChange = false;
 
             // Reset for new track
             m_isDraining = false;
@@ -1617,6 +2339,7 @@ bool AudioEngine::process(size_t samplesNeeded) {
 
             // Stop current playback (will close DirettaOutput)
             std::cout << "[AudioEngine] Stopping for format change..." << std::endl;
+            stopDecodeAhead(true);
             m_currentDecoder.reset();
 
             // Reopen with new track (will be done in next process() call via openCurrentTrack())
@@ -1655,6 +2378,19 @@ bool AudioEngine::process(size_t samplesNeeded) {
     return true;
 }
 
+// Caller holds m_mutex: publishes are serialized
+void AudioEngine::publishTrack() {
+    PlayingTrack track;
+    track.trackNumber = m_trackNumber;
+    track.info = m_currentTrackInfo;
+    track.uri = m_currentURI;
+    track.metadata = m_currentMetadata;
+    track.outputRate = outputRateFor(m_currentTrackInfo);
+    track.outputBits = outputBitsFor(m_currentTrackInfo);
+    uint64_t version = m_track.publish(std::move(track));
+    DEBUG_LOG("[AudioEngine] Track snapshot v" << version);
+}
+
 bool AudioEngine::openCurrentTrack() {
     // Note: This function is called from play() which already holds the mutex
 
@@ -1665,16 +2401,29 @@ bool AudioEngine::openCurrentTrack() {
 
     std::cout << "[AudioEngine] Opening track: " << m_currentURI.substr(0, 80) << "..." << std::endl;
 
-    // Create decoder
-    m_currentDecoder = std::make_unique<AudioDecoder>();
+    stopDecodeAhead(true);
 
-    if (!m_currentDecoder->open(m_currentURI)) {
-        std::cerr << "[AudioEngine] Failed to open track" << std::endl;
-        m_currentDecoder.reset();
-        return false;
+    // Reuse a decoder the background preload already opened for this URI
+    // (format-change transitions), otherwise open it here
+    m_currentDecoder = takePreloadedDecoder(m_currentURI);
+    if (m_currentDecoder) {
+        DEBUG_LOG("[AudioEngine] Using preloaded decoder");
+    } else {
+        m_currentDecoder = std::make_unique<AudioDecoder>();
+        m_currentDecoder->setReadAhead(m_readAheadBytes);
+        m_currentDecoder->setTrackCache(m_trackCache.get());
+        m_currentDecoder->setNativeResampler(m_upsample[0].native, m_upsample[1].native);
+        m_currentDecoder->setFastProbe(m_fastProbe, protocolInfoMime(m_currentMetadata));
+
+        if (!m_currentDecoder->open(m_currentURI)) {
+            std::cerr << "[AudioEngine] Failed to open track" << std::endl;
+            m_currentDecoder.reset();
+            return false;
+        }
     }
 
     m_currentTrackInfo = m_currentDecoder->getTrackInfo();
+    publishTrack();
 
     std::cout << "[AudioEngine] Track opened: ";
     if (m_currentTrackInfo.isDSD) {
@@ -1699,23 +2448,27 @@ bool AudioEngine::preloadNextTrack() {
         return false;
     }
 
-    DEBUG_LOG("[AudioEngine] Preloading next track for gapless...");
-
-    // Create decoder for next track
-    m_nextDecoder = std::make_unique<AudioDecoder>();
+    // Already known not to be gapless-compatible
+    if (m_nextFormatChange) {
+        return false;
+    }
 
-    if (!m_nextDecoder->open(m_nextURI)) {
-        std::cerr << "[AudioEngine] Failed to preload next track" << std::endl;
-        m_nextDecoder.reset();
+    // Never open inline: take the decoder the background job prepared
+    m_nextDecoder = takePreloadedDecoder(m_nextURI);
+    if (!m_nextDecoder) {
+        requestPreload(m_nextURI, m_nextMetadata);  // No-op if already in flight
         return false;
     }
 
+    std::cout << "[AudioEngine] Next track preloaded, ready for gapless" << std::endl;
+
     // Check format compatibility for gapless playback
     // Format changes require clean stop/start to avoid audio artifacts
     TrackInfo nextInfo = m_nextDecoder->getTrackInfo();
+    // Compared as sent: two source rates upsampled to the same output stay gapless
     bool formatWillChange = (
-        nextInfo.sampleRate != m_currentTrackInfo.sampleRate ||
-        nextInfo.bitDepth != m_currentTrackInfo.bitDepth ||
+        outputRateFor(nextInfo) != outputRateFor(m_currentTrackInfo) ||
+        outputBitsFor(nextInfo) != outputBitsFor(m_currentTrackInfo) ||
         nextInfo.channels != m_currentTrackInfo.channels ||
         nextInfo.isDSD != m_currentTrackInfo.isDSD ||
         nextInfo.isCompressed != m_currentTrackInfo.isCompressed
@@ -1735,8 +2488,17 @@ bool AudioEngine::preloadNextTrack() {
                   << (nextInfo.isDSD ? " (DSD)" : ""));
         DEBUG_LOG("[AudioEngine] Will use stop/start sequence instead of gapless");
 
-        // Don't keep nextDecoder - force stop/start sequence
+        // Don't keep nextDecoder - force stop/start sequence. Park it again
+        // so openCurrentTrack() can reuse it instead of reopening the URI
+        {
+            std::lock_guard<std::mutex> lock(m_preloadMutex);
+            if (m_preloadRequestURI == m_nextURI) {
+                m_preloadedDecoder = std::move(m_nextDecoder);
+                m_preloadedURI = m_nextURI;
+            }
+        }
         m_nextDecoder.reset();
+        m_nextFormatChange = true;
 
         // CRITICAL FIX (v1.0.16): Keep m_nextURI!
         // Do NOT clear m_nextURI - it will be used for non-gapless transition
@@ -1760,6 +2522,7 @@ void AudioEngine::transitionToNextTrack() {
     m_currentURI = m_nextURI;
     m_currentMetadata = m_nextMetadata;
 
+    stopDecodeAhead(true);
     m_currentDecoder = std::move(m_nextDecoder);
     m_trackNumber++;
     m_samplesPlayed = 0;
@@ -1767,34 +2530,138 @@ void AudioEngine::transitionToNextTrack() {
     // Clear next URI after moving to current
     m_nextURI.clear();
     m_nextMetadata.clear();
+    m_nextFormatChange = false;
 
     if (m_currentDecoder) {
         m_currentTrackInfo = m_currentDecoder->getTrackInfo();
+        publishTrack();
         if (m_trackChangeCallback) {
             m_trackChangeCallback(m_trackNumber, m_currentTrackInfo, m_currentURI, m_currentMetadata);
         }
     }
 }
 
+// ============================================================================
+// Decode-ahead worker
+// ============================================================================
+
+void AudioEngine::startDecodeAhead(size_t samplesNeeded, uint32_t outputRate, uint32_t outputBits) {
+    // Called from process() with m_mutex held and no worker running
+    if (!m_currentDecoder || outputRate == 0 || samplesNeeded == 0) return;
+
+    const TrackInfo& info = m_currentTrackInfo;
+    uint32_t channels = info.channels > 0 ? info.channels : 2;
+
+    // Depth: enough blocks to cover the compressed-format jitter target
+    size_t blockUs = (samplesNeeded * 1000000ULL) / outputRate;
+    if (blockUs == 0) blockUs = 1;
+    size_t targetUs = static_cast<size_t>(AudioTiming::JITTER_TARGET_COMPRESSED) * 1000;
+    size_t depth = (targetUs + blockUs - 1) / blockUs + 1;
+
+    // Worst case block size: raw DSD bytes, or S32 PCM
+    size_t bytesPerBlock = info.isDSD
+        ? (samplesNeeded * channels) / 8
+        : samplesNeeded * channels * 4;
+
+    m_decodeQueue.reset(depth, bytesPerBlock);
+    m_decodeDone.store(false, std::memory_order_relaxed);
+    m_decodeEOF.store(false, std::memory_order_relaxed);
+    m_decodeChunk = samplesNeeded;
+    m_decodeRunning.store(true, std::memory_order_release);
+
+    // When the queue is full, re-check twice per block consumed
+    auto idleWait = std::chrono::microseconds(std::max<size_t>(blockUs / 2, 500));
+    m_decodeDecoder = m_currentDecoder.get();
+    m_decodeThread = std::thread(&AudioEngine::decodeAheadThreadFunc, this,
+                                 m_decodeDecoder, samplesNeeded,
+                                 outputRate, outputBits, idleWait);
+
+    DEBUG_LOG("[AudioEngine] Decode-ahead started: " << m_decodeQueue.depth()
+              << " blocks x " << samplesNeeded << " samples (~"
+              << (m_decodeQueue.depth() * blockUs / 1000) << "ms)");
+}
+
+void AudioEngine::stopDecodeAhead(bool abandonRead) {
+    // Called with m_mutex held; the worker never takes m_mutex, but it can sit
+    // in av_read_frame() on a stalled stream for the whole network timeout.
+    // When its read position is being dropped anyway (stop, seek, track
+    // change) the read is interrupted rather than waited out under the lock
+    m_decodeRunning.store(false, std::memory_order_release);
+    if (m_decodeThread.joinable()) {
+        if (abandonRead && m_decodeDecoder) m_decodeDecoder->interrupt();
+        m_decodeThread.join();
+        if (abandonRead && m_decodeDecoder) m_decodeDecoder->clearInterrupt();
+    }
+    m_decodeDecoder = nullptr;
+    m_decodeQueue.reset(m_decodeQueue.depth(), 0);
+    m_decodeDone.store(false, std::memory_order_relaxed);
+    m_decodeEOF.store(false, std::memory_order_relaxed);
+    m_decodeChunk = 0;
+}
+
+void AudioEngine::decodeAheadThreadFunc(AudioDecoder* decoder, size_t chunk, uint32_t outputRate,
+                                        uint32_t outputBits, std::chrono::microseconds idleWait) {
+    ThreadPlacement::apply(ThreadPlacement::Role::Decode);
+    while (m_decodeRunning.load(std::memory_order_acquire)) {
+        DecodeAheadQueue::Block* block = m_decodeQueue.producerSlot();
+        if (!block) {
+            std::this_thread::sleep_for(idleWait);  // Full: audio thread is behind us
+            continue;
+        }
+
+        uint64_t readStart = Trace::ticks();
+        block->samples = decoder->readSamples(block->buffer, chunk, outputRate, outputBits);
+        Trace::record(Trace::Event::Decode, Trace::DECODE_READ, static_cast<uint32_t>(block->samples),
+                      Trace::ticks() - readStart);
+
+        if (decoder->isEOF()) {
+            m_decodeEOF.store(true, std::memory_order_release);
+        }
+        if (block->samples == 0) {
+            m_decodeDone.store(true, std::memory_order_release);
+            break;
+        }
+        m_decodeQueue.producerCommit();
+    }
+}
+
 bool AudioDecoder::seek(double seconds) {
     if (!m_formatContext || m_audioStreamIndex < 0) {
         std::cerr << "[AudioDecoder] Cannot seek: no file open" << std::endl;
         return false;
     }
+    if (seconds < 0) {
+        seconds = 0;
+    }
 
     // DSD native mode - seek at container level (no codec involved)
     if (m_rawDSD) {
         std::cout << "[AudioDecoder] DSD seek to " << seconds << " seconds..." << std::endl;
 
-        AVStream* stream = m_formatContext->streams[m_audioStreamIndex];
-        int64_t timestamp = av_rescale_q(
-            static_cast<int64_t>(seconds * AV_TIME_BASE),
-            AV_TIME_BASE_Q,
-            stream->time_base
-        );
+        // Per-channel byte of the target (1 byte = 8 DSD samples)
+        const size_t channels = m_trackInfo.channels;
+        int64_t targetByte = static_cast<int64_t>(seconds * m_trackInfo.sampleRate) / 8;
 
-        int ret = av_seek_frame(m_formatContext, m_audioStreamIndex,
+        // Layout index: jump straight to the block holding the target
+        int ret = -1;
+        if (m_dsdDataStart >= 0 && m_dsdBlockBytes > 0 && channels > 0) {
+            int64_t block = targetByte / static_cast<int64_t>(m_dsdBlockBytes);
+            int64_t pos = m_dsdDataStart + block * static_cast<int64_t>(m_dsdBlockBytes * channels);
+            ret = av_seek_frame(m_formatContext, m_audioStreamIndex, pos, AVSEEK_FLAG_BYTE);
+            if (ret < 0) {
+                DEBUG_LOG("[AudioDecoder] DSD byte seek refused, using timestamp seek");
+            }
+        }
+        if (ret < 0) {
+            AVStream* stream = m_formatContext->streams[m_audioStreamIndex];
+            int64_t timestamp = av_rescale_q(
+                static_cast<int64_t>(seconds * AV_TIME_BASE),
+                AV_TIME_BASE_Q,
+                stream->time_base
+            );
+            ret = av_seek_frame(m_formatContext, m_audioStreamIndex,
                                 timestamp, AVSEEK_FLAG_BACKWARD);
+        }
         if (ret < 0) {
             char errbuf[AV_ERROR_MAX_STRING_SIZE];
             av_strerror(ret, errbuf, sizeof(errbuf));
@@ -1804,12 +2671,14 @@ bool AudioDecoder::seek(double seconds) {
 
         // Clear stale buffered data from before the seek
         m_dsdRemainderCount = 0;
+        m_dsdRemainderOffset = 0;
+        m_dsdSeekTargetByte = targetByte;
         m_eof = false;
 
         // Reset packet counter for cleaner debug output
         m_packetCount = 0;
 
-        std::cout << "[AudioDecoder] DSD seek successful to ~" << seconds << "s" << std::endl;
+        std::cout << "[AudioDecoder] DSD seek successful to " << seconds << "s" << std::endl;
         return true;
     }
 
@@ -1825,6 +2694,7 @@ bool AudioDecoder::seek(double seconds) {
 
     // Effectuer le seek
     // AVSEEK_FLAG_BACKWARD : cherche le keyframe le plus proche AVANT la position
+    // (FLAC: FFmpeg's index holds the SEEKTABLE and grows while playing)
     int ret = av_seek_frame(m_formatContext, m_audioStreamIndex, timestamp, AVSEEK_FLAG_BACKWARD);
     if (ret < 0) {
         char errbuf[AV_ERROR_MAX_STRING_SIZE];
@@ -1836,6 +2706,16 @@ bool AudioDecoder::seek(double seconds) {
     // Vider les buffers du codec
     if (m_codecContext) {
         avcodec_flush_buffers(m_codecContext);
+        // Landed at or before the target: readSamples() drops the difference
+        m_seekTargetSample = static_cast<int64_t>(seconds * m_codecContext->sample_rate + 0.5);
+    }
+
+    // Drop resampler history from the old position
+    if (m_swrContext && m_resamplerInitialized && !m_bypassMode) {
+        swr_init(m_swrContext);
+    }
+    if (m_polyphase) {
+        m_polyphase->reset();
     }
 
     // Reset PCM FIFO (clear stale samples)
@@ -1844,11 +2724,64 @@ bool AudioDecoder::seek(double seconds) {
     }
     m_eof = false;
 
-    std::cout << "[AudioDecoder] Seek successful to ~" << seconds << "s" << std::endl;
+    std::cout << "[AudioDecoder] Seek successful to " << seconds << "s" << std::endl;
 
     return true;
 }
 
+bool AudioDecoder::trimSeekPreroll(AVFrame* frame) {
+    int64_t ts = frame->best_effort_timestamp != AV_NOPTS_VALUE
+        ? frame->best_effort_timestamp : frame->pts;
+    if (ts == AV_NOPTS_VALUE || !m_codecContext || m_codecContext->sample_rate <= 0) {
+        DEBUG_LOG("[AudioDecoder] Seek: no frame timestamps, position is approximate");
+        m_seekTargetSample = -1;
+        return true;
+    }
+
+    AVStream* stream = m_formatContext->streams[m_audioStreamIndex];
+    int64_t frameStart = av_rescale_q(ts, stream->time_base, AVRational{1, m_codecContext->sample_rate});
+    int64_t skip = m_seekTargetSample - frameStart;
+    if (skip >= frame->nb_samples) {
+        return false;  // Entirely before the target
+    }
+
+    if (skip > 0) {
+        // Advance the plane pointers (the frame's buffers are unref'd as usual)
+        const AVSampleFormat fmt = static_cast<AVSampleFormat>(frame->format);
+        const int channels = frame->ch_layout.nb_channels;
+        const size_t bytes = static_cast<size_t>(skip) * av_get_bytes_per_sample(fmt);
+        if (av_sample_fmt_is_planar(fmt)) {
+            for (int ch = 0; ch < channels; ch++) {
+                if (frame->extended_data != frame->data) frame->extended_data[ch] += bytes;
+                if (ch < AV_NUM_DATA_POINTERS) frame->data[ch] += bytes;
+            }
+        } else {
+            if (frame->extended_data != frame->data) frame->extended_data[0] += bytes * channels;
+            frame->data[0] += bytes * channels;
+        }
+        frame->nb_samples -= static_cast<int>(skip);
+    }
+
+    DEBUG_LOG("[AudioDecoder] Seek pre-roll trimmed: " << (m_seekTargetSample - std::max<int64_t>(frameStart, 0))
+              << " samples");
+    m_seekTargetSample = -1;
+    return true;
+}
+
+size_t AudioDecoder::dsdSeekSkip(const AVPacket* packet, size_t blockSize, size_t channels) {
+    // Where this block starts (per channel); unknown position: take it as the target
+    int64_t landed = m_dsdSeekTargetByte;
+    if (packet->pos >= 0 && m_dsdDataStart >= 0) {
+        landed = (packet->pos - m_dsdDataStart) / static_cast<int64_t>(channels);
+    }
+    int64_t skip = m_dsdSeekTargetByte - landed;
+    if (skip >= static_cast<int64_t>(blockSize)) {
+        return blockSize;  // Keep target: the block holding it is still ahead
+    }
+    m_dsdSeekTargetByte = -1;
+    return skip > 0 ? static_cast<size_t>(skip) : 0;
+}
+
 // ============================================================================
 // AudioEngine::seek() - Seek avec mise à jour de la position
 // ============================================================================
@@ -1933,5 +2866,5 @@ bool AudioEngine::seek(const std::string& timeStr) {
 }
 
 uint32_t AudioEngine::getCurrentSampleRate() const {
-    return m_currentTrackInfo.sampleRate;
+    return m_track.load()->value.info.sampleRate;
 }
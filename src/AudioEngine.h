@@ -8,6 +8,10 @@
 #include <condition_variable>
 #include <functional>
 #include <thread>
+#include <array>
+#include <chrono>
+
+#include "TrackSnapshot.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -40,12 +44,37 @@ struct TrackInfo {
     enum class S24Alignment { Unknown, LsbAligned, MsbAligned };
     S24Alignment s24Alignment = S24Alignment::Unknown;
 
+    // ReplayGain tags (Vorbis comment / ID3 TXXX / APE REPLAYGAIN_*)
+    bool hasTrackGain = false;
+    bool hasAlbumGain = false;
+    float trackGainDb = 0.0f;
+    float albumGainDb = 0.0f;
+    float trackPeak = 0.0f;    // Linear sample peak, 0 = not tagged
+    float albumPeak = 0.0f;
+
     TrackInfo() : sampleRate(0), bitDepth(0), channels(2), duration(0),
                   isDSD(false), dsdRate(0), isCompressed(true),
                   dsdSourceFormat(DSDSourceFormat::Unknown),
                   s24Alignment(S24Alignment::Unknown) {}
 };
 
+/**
+ * @brief The playing track as published to other threads
+ *
+ * Built once per track change (see AudioEngine::trackSnapshot()), never
+ * modified afterwards, so readers hold it without locks or string copies.
+ */
+struct PlayingTrack {
+    int trackNumber = 0;
+    TrackInfo info;
+    std::string uri;
+    std::string metadata;
+    uint32_t outputRate = 0;  // Rate sent to the sink (upsampled if configured)
+    uint32_t outputBits = 0;
+};
+
+using TrackSnapshot = SnapshotCell<PlayingTrack>::Ptr;
+
 /**
  * @brief Audio buffer for streaming
  *
@@ -83,14 +112,117 @@ private:
     void growCapacity(size_t needed);
 };
 
+/**
+ * @brief Lock-free SPSC queue of preallocated decode blocks
+ *
+ * Filled by the decode-ahead worker, drained by the audio thread. Blocks
+ * are reused in place, so steady-state decoding never allocates. Head and
+ * tail are free-running counters; depth() bounds how far the producer may
+ * run ahead of the consumer.
+ */
+class DecodeAheadQueue {
+public:
+    static constexpr size_t MAX_BLOCKS = 64;
+
+    struct Block {
+        AudioBuffer buffer;
+        size_t samples = 0;
+    };
+
+    /**
+     * @brief Empty the queue and set its depth (no producer may be running)
+     * @param depth Blocks the producer may fill ahead (clamped to MAX_BLOCKS)
+     * @param bytesPerBlock Capacity to reserve in each used block
+     */
+    void reset(size_t depth, size_t bytesPerBlock);
+
+    // Producer side: slot to fill, or nullptr if the queue is full
+    Block* producerSlot();
+    void producerCommit();
+
+    // Consumer side: oldest filled block, or nullptr if empty
+    Block* consumerFront();
+    void consumerPop();
+
+    size_t size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+    size_t depth() const { return m_depth; }
+
+private:
+    std::array<Block, MAX_BLOCKS> m_blocks;
+    size_t m_depth = 0;
+    alignas(64) std::atomic<size_t> m_head{0};  // Blocks committed (producer)
+    alignas(64) std::atomic<size_t> m_tail{0};  // Blocks consumed (consumer)
+};
+
+class ReadAheadIO;
+class TrackCache;
+class TrackCacheReader;
+class PolyphaseResampler;
+
 /**
  * @brief Audio decoder for a single track
  */
 class AudioDecoder {
 public:
+    /**
+     * @brief Writes up to maxFrames output frames at region, returns frames written
+     */
+    using DirectFill = std::function<size_t(uint8_t* region, size_t maxFrames)>;
+
+    /**
+     * @brief Output that lends its own memory for bypass PCM
+     *
+     * Calls fill with a writable span (e.g. the output ring's free region)
+     * for frames in the given output format.
+     * @return Frames committed; 0 = no span now, the frames go to the buffer
+     */
+    using DirectWrite = std::function<size_t(size_t maxFrames, uint32_t sampleRate, uint32_t bitDepth,
+                                             uint32_t channels, const DirectFill& fill)>;
+
     AudioDecoder();
     ~AudioDecoder();
 
+    /**
+     * @brief Buffer network sources through a read-ahead ring (call before open)
+     * @param bytes Read-ahead target, 0 = FFmpeg's own HTTP buffering only
+     */
+    void setReadAhead(size_t bytes) { m_readAheadBytes = bytes; }
+
+    /**
+     * @brief Open http(s) sources from the track cache when it accepts them
+     * @param cache Owned by AudioEngine, outlives the decoder (nullptr = off)
+     */
+    void setTrackCache(TrackCache* cache) { m_trackCache = cache; }
+
+    /**
+     * @brief Rate conversion on the native polyphase engine instead of
+     *        libswresample, per source family (call before the first read)
+     * @param family44 Sources at multiples of 44.1 kHz
+     * @param family48 Sources at multiples of 48 kHz (and anything else)
+     */
+    void setNativeResampler(bool family44, bool family48) {
+        m_nativeResampler44 = family44;
+        m_nativeResampler48 = family48;
+    }
+
+    /**
+     * @brief Fast probe: force the demuxer named by the MIME type or URL
+     *        extension and cap probing; falls back to a full probe on failure
+     * @param mimeType protocolInfo MIME type of the track, empty if unknown
+     */
+    void setFastProbe(bool enabled, const std::string& mimeType = std::string()) {
+        m_fastProbe = enabled;
+        m_mimeHint = mimeType;
+    }
+
+    /**
+     * @brief FFmpeg protocol options for network sources (reconnect,
+     *        timeouts, user agent); shared with the track cache downloads
+     */
+    static void setHttpOptions(AVDictionary** options);
+
     /**
      * @brief Open and decode a URL
      * @param url Audio file URL
@@ -103,6 +235,16 @@ public:
      */
     void close();
 
+    /**
+     * @brief Make a read blocked on the network return now (any thread)
+     *
+     * Protocol, read-ahead and cache reads fail with AVERROR_EXIT while set,
+     * which ends the current readSamples() at EOF. A decoder that is kept
+     * afterwards (seek) calls clearInterrupt() first.
+     */
+    void interrupt();
+    void clearInterrupt();
+
     /**
      * @brief Get track information
      * @return Track info
@@ -115,10 +257,19 @@ public:
      * @param numSamples Number of samples to read
      * @param outputRate Target sample rate
      * @param outputBits Target bit depth
+     * @param direct In bypass mode, copy frames here first, in order, until it
+     *        declines one; the rest goes to buffer (see lastDirectSamples())
      * @return Number of samples actually read (0 = EOF)
      */
     size_t readSamples(AudioBuffer& buffer, size_t numSamples,
-                      uint32_t outputRate, uint32_t outputBits);
+                      uint32_t outputRate, uint32_t outputBits,
+                      const DirectWrite* direct = nullptr);
+
+    /**
+     * @brief Samples of the last readSamples() that went to direct, not to
+     *        the buffer (the buffer holds only the rest)
+     */
+    size_t lastDirectSamples() const { return m_lastDirectSamples; }
 
     /**
      * @brief Check if EOF reached
@@ -128,13 +279,27 @@ public:
 
     /**
      * @brief Seek to a specific position in the audio file
+     *
+     * Sample-accurate: the demuxer lands at or before the target (DSF:
+     * exact block from the layout index), then the pre-roll up to the
+     * target sample is dropped inside the decoder on the next read.
      * @param seconds Position in seconds
      * @return true if successful, false otherwise
      */
     bool seek(double seconds);
 
 private:
+    bool reopenWithFullProbe(const std::string& url);
+    static int interruptCallback(void* opaque);
+    std::atomic<bool> m_interrupted{false};
+
     AVFormatContext* m_formatContext;
+    std::unique_ptr<ReadAheadIO> m_readAhead;  // Custom pb for network sources
+    size_t m_readAheadBytes = 0;
+    std::unique_ptr<TrackCacheReader> m_cacheReader;  // Custom pb over a cached track
+    TrackCache* m_trackCache = nullptr;
+    bool m_fastProbe = false;
+    std::string m_mimeHint;
     AVCodecContext* m_codecContext;
     SwrContext* m_swrContext;
     int m_audioStreamIndex;
@@ -147,16 +312,26 @@ private:
     AVFrame* m_frame;        // Reusable for decoded frames (PCM)
 
     // DSD remainder buffer (byte-level L/R channel buffering)
+    // Planar: channel c at c * m_dsdRemainderStride; consumed from
+    // m_dsdRemainderOffset forward, so leftovers never need a memmove
     AudioBuffer m_dsdRemainderBuffer;
-    size_t m_dsdRemainderCount;
+    size_t m_dsdRemainderCount;    // Total bytes left (all channels)
+    size_t m_dsdRemainderOffset;   // Per-channel read cursor
+    size_t m_dsdRemainderStride;   // Per-channel capacity
 
     // PCM FIFO for sample overflow (O(1) circular buffer)
     AVAudioFifo* m_pcmFifo = nullptr;
+    size_t m_lastDirectSamples = 0;
 
     // Reusable resample buffer (eliminates per-call allocation)
     AudioBuffer m_resampleBuffer;
     size_t m_resampleBufferCapacity = 0;
 
+    // Native polyphase resampler (replaces m_swrContext when selected)
+    std::unique_ptr<PolyphaseResampler> m_polyphase;
+    bool m_nativeResampler44 = false;
+    bool m_nativeResampler48 = false;
+
     // Debug/diagnostic counters (instance variables, NOT static!)
     // These were previously static variables causing race conditions when
     // multiple AudioDecoder instances run concurrently (e.g., gapless preload)
@@ -168,7 +343,19 @@ private:
     bool m_bypassMode = false;
     bool m_resamplerInitialized = false;
 
+    // Sample-accurate seek
+    // DSF layout index (from the first packet at open): data start + block size
+    int64_t m_dsdDataStart = -1;         // Byte offset of the first DSD packet
+    size_t m_dsdBlockBytes = 0;          // Per-channel bytes per DSD packet
+    int64_t m_dsdSeekTargetByte = -1;    // Per-channel byte to resume at, -1 = none
+    int64_t m_seekTargetSample = -1;     // PCM: source-rate sample to resume at, -1 = none
+    bool trimSeekPreroll(AVFrame* frame);
+    size_t dsdSeekSkip(const AVPacket* packet, size_t blockSize, size_t channels);
+
     bool initResampler(uint32_t outputRate, uint32_t outputBits);
+    bool initPolyphase(uint32_t outputRate, uint32_t outputBits);
+    size_t polyphaseOutput(uint8_t*& outputPtr, size_t samplesNeeded,
+                           uint32_t outputBits, size_t bytesPerSample);
     bool canBypass(uint32_t outputRate, uint32_t outputBits) const;
 };
 
@@ -215,6 +402,13 @@ public:
      */
     using TrackEndCallback = std::function<void()>;
 
+    /**
+     * @brief Callback after a seek lands (audio thread, before the first
+     *        sample from the new position is produced)
+     * @param seconds New position
+     */
+    using SeekCallback = std::function<void(double)>;
+
     /**
      * @brief Constructor
      */
@@ -243,6 +437,23 @@ public:
      */
     void setTrackEndCallback(const TrackEndCallback& callback);
 
+    /**
+     * @brief Set seek callback (e.g. drop stale audio queued downstream)
+     * @param callback Callback function
+     */
+    void setSeekCallback(const SeekCallback& callback) { m_seekCallback = callback; }
+
+    /**
+     * @brief Let bit-perfect PCM be decoded straight into the output
+     *
+     * In decoder bypass mode (no resampling or conversion) each frame is
+     * copied once, from the decoded frame into the span direct lends, and
+     * only frames it declines reach the audio callback. Not used with the
+     * decode-ahead worker (the output has a single producer thread).
+     * @param direct Callback (empty = off)
+     */
+    void setDirectWriteCallback(const AudioDecoder::DirectWrite& direct) { m_directWrite = direct; }
+
     /**
      * @brief Set current track URI
      * @param uri Track URI
@@ -257,6 +468,16 @@ public:
      */
     void setNextURI(const std::string& uri, const std::string& metadata = "");
 
+    /**
+     * @brief Open the current track ahead of play() without starting
+     *        playback, so the HTTP open and probe overlap the DAC
+     *        stabilization delay and a sink warm-up started before it
+     *
+     * Runs synchronously on the caller's thread.
+     * @return true if a decoder for the current URI is ready
+     */
+    bool prepare();
+
     /**
      * @brief Start playback
      * @return true if successful, false otherwise
@@ -286,10 +507,16 @@ public:
     int getTrackNumber() const { return m_trackNumber; }
 
     /**
-     * @brief Get current track info
-     * @return Track information
+     * @brief Current track as an immutable snapshot (any thread, never null)
+     *
+     * Published on every track change; version 0 until the first track opens.
+     */
+    TrackSnapshot trackSnapshot() const { return m_track.load(); }
+
+    /**
+     * @brief Version of the latest track snapshot; cheap enough per buffer
      */
-    const TrackInfo& getCurrentTrackInfo() const { return m_currentTrackInfo; }
+    uint64_t trackVersion() const { return m_track.version(); }
 
     /**
      * @brief Get playback position in seconds
@@ -324,7 +551,74 @@ public:
      */
     bool process(size_t samplesNeeded);
 
+    /**
+     * @brief Enable the decode-ahead worker (call before playback starts)
+     *
+     * When enabled, a dedicated thread decodes up to
+     * AudioTiming::JITTER_TARGET_COMPRESSED ms ahead into a DecodeAheadQueue,
+     * and process() only dequeues blocks and runs the audio callback.
+     */
+    void setDecodeAhead(bool enabled) { m_decodeAheadEnabled = enabled; }
+    void setReadAhead(size_t bytes) { m_readAheadBytes = bytes; }
+
+    /**
+     * @brief Fast probe for every decoder opened from now on (see
+     *        AudioDecoder::setFastProbe()); the MIME type comes from the
+     *        protocolInfo in the track's metadata
+     */
+    void setFastProbe(bool enabled) { m_fastProbe = enabled; }
+
+    /**
+     * @brief Cache whole network tracks in RAM, up to bytes in total (0 = off)
+     *
+     * Call before playback starts. setCurrentURI()/setNextURI() then start the
+     * download, and decoders opened for those URIs read from memory.
+     */
+    void setTrackCache(size_t bytes);
+
+    /**
+     * @brief Upsample one PCM rate family to a fixed output rate (call before playback)
+     *
+     * Sources below the rate are converted (never down), and sent with at
+     * least 24 bits. Native filters are built here, not at the first track.
+     * @param family44 true: multiples of 44.1 kHz, false: the 48 kHz family
+     * @param rate Output rate, 0 = off (source rate, bit-perfect)
+     * @param native Polyphase engine (true) or libswresample
+     */
+    void setUpsampling(bool family44, uint32_t rate, bool native);
+
+    /**
+     * @brief Rate the current track is sent at (source rate unless upsampled)
+     */
+    uint32_t getOutputRate() const { return m_track.load()->value.outputRate; }
+
+    /**
+     * @brief Rate and bits a track is sent at (upsampling rules applied)
+     */
+    uint32_t outputRateFor(const TrackInfo& info) const;
+    uint32_t outputBitsFor(const TrackInfo& info) const;
+
+    /**
+     * @brief PCM format announced by the first DIDL-Lite res element
+     *        (sampleFrequency, bitsPerSample, nrAudioChannels), before
+     *        any decoder has opened the track
+     *
+     * isCompressed follows the protocolInfo MIME type (WAV, AIFF and L16
+     * are not). A hint only: the decoder's probe has the final say.
+     * @return false if an attribute is missing or the MIME type is DSD
+     */
+    static bool announcedTrackInfo(const std::string& metadata, TrackInfo& info);
+
+    /**
+     * @brief True while the track-end callback fires for a format-change
+     *        transition (playback continues with the next URI)
+     */
+    bool isFormatTransition() const { return m_formatTransition.load(std::memory_order_acquire); }
+
 private:
+    // Declared first: destroyed after every decoder reading from it
+    std::unique_ptr<TrackCache> m_trackCache;
+
     std::atomic<State> m_state;
     std::atomic<int> m_trackNumber;
 
@@ -333,8 +627,11 @@ private:
     std::string m_currentMetadata;
     std::string m_nextURI;
     std::string m_nextMetadata;
-    TrackInfo m_currentTrackInfo;
+    TrackInfo m_currentTrackInfo;  // Audio/control thread under m_mutex; others read m_track
+    SnapshotCell<PlayingTrack> m_track;
     TrackEndCallback m_trackEndCallback;
+    SeekCallback m_seekCallback;
+    AudioDecoder::DirectWrite m_directWrite;
 
     // Decoders
     std::unique_ptr<AudioDecoder> m_currentDecoder;
@@ -356,7 +653,15 @@ private:
     int m_silenceCount;  // Pour drainage du buffer Diretta
     bool m_isDraining;   // Flag pour éviter de re-logger "Track finished"
 
+    // Upsampling per rate family ([0] = 44.1 kHz, [1] = 48 kHz), see setUpsampling()
+    struct UpsampleRule {
+        uint32_t rate = 0;
+        bool native = true;
+    };
+    UpsampleRule m_upsample[2];
+
     // Helper functions
+    void publishTrack();
     bool openCurrentTrack();
     bool preloadNextTrack();
     void transitionToNextTrack();
@@ -367,14 +672,46 @@ private:
     std::string m_pendingNextURI;
     std::string m_pendingNextMetadata;
 
-    // Preload thread management (replaces detached thread)
+    // Background gapless preload: the job opens the requested URI off the
+    // audio thread and parks the decoder here; process() only adopts it.
+    // All m_preload* strings/decoder are guarded by m_preloadMutex.
     std::thread m_preloadThread;
     std::atomic<bool> m_preloadRunning{false};
+    std::mutex m_preloadMutex;
+    std::string m_preloadRequestURI;     // URI the job should have open
+    std::string m_preloadAttemptedURI;   // Last URI the job finished opening
+    std::string m_preloadRequestMime;    // protocolInfo MIME of m_preloadRequestURI
+    std::string m_preloadedURI;          // URI of m_preloadedDecoder
+    std::unique_ptr<AudioDecoder> m_preloadedDecoder;
+    bool m_nextFormatChange = false;     // Next track rejected for gapless (audio thread)
     void waitForPreloadThread();
+    void requestPreload(const std::string& uri, const std::string& metadata);
+    void cancelPreload();
+    void preloadThreadFunc();
+    std::unique_ptr<AudioDecoder> takePreloadedDecoder(const std::string& uri);
+
+    // Decode-ahead worker (optional, see setDecodeAhead())
+    // Only the worker touches the decoder while it runs; every path that
+    // seeks, replaces or resets m_currentDecoder calls stopDecodeAhead() first
+    bool m_decodeAheadEnabled = false;
+    size_t m_readAheadBytes = 0;  // Network read-ahead per decoder (0 = off)
+    bool m_fastProbe = false;     // Forced demuxer + capped probing per decoder
+    DecodeAheadQueue m_decodeQueue;
+    std::thread m_decodeThread;
+    std::atomic<bool> m_decodeRunning{false};
+    std::atomic<bool> m_decodeDone{false};  // Worker reached end of stream
+    std::atomic<bool> m_decodeEOF{false};   // Decoder EOF flag (gapless preload trigger)
+    size_t m_decodeChunk = 0;
+    AudioDecoder* m_decodeDecoder = nullptr;  // Decoder the worker reads
+    void startDecodeAhead(size_t samplesNeeded, uint32_t outputRate, uint32_t outputBits);
+    void stopDecodeAhead(bool abandonRead = false);
+    void decodeAheadThreadFunc(AudioDecoder* decoder, size_t chunk, uint32_t outputRate,
+                               uint32_t outputBits, std::chrono::microseconds idleWait);
 
     // Async seek mechanism to avoid deadlock
     // The UPnP thread sets these flags, the audio thread processes the seek
     std::atomic<bool> m_seekRequested{false};
+    std::atomic<bool> m_formatTransition{false};
     std::atomic<double> m_seekTarget{0.0};
 
     // Prevent copying
@@ -0,0 +1,1273 @@
+/**
+ * @file AudioKernels.h
+ * @brief Runtime-dispatched copy and format-conversion kernels
+ *
+ * All ISA variants are compiled into one binary (x86 kernels carry their
+ * own target attributes). AudioKernels::init() probes the CPU once and
+ * binds the best kernel for each operation; until then the baseline
+ * kernels for the build architecture are active, so callers never see
+ * an unbound pointer.
+ */
+
+#ifndef AUDIO_KERNELS_H
+#define AUDIO_KERNELS_H
+
+#include "memcpyfast_audio.h"
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <mutex>
+
+namespace AudioKernels {
+
+//=============================================================================
+// Format-conversion kernels
+//
+// Used by DirettaRingBuffer's push paths. The scalar versions are the
+// reference implementation and the fallback for any ISA without a kernel.
+//=============================================================================
+
+/**
+ * Scalar tail for the stereo DSD kernels: whole 4-byte groups only,
+ * same bit reversal / byte swap semantics as the vector body.
+ */
+inline size_t interleaveDSDStereoTail(uint8_t* dst, const uint8_t* srcL, const uint8_t* srcR,
+                                      size_t bytesPerChannel, const uint8_t* bitReversalTable,
+                                      bool needByteSwap) {
+    size_t outputBytes = 0;
+    for (size_t i = 0; i + 4 <= bytesPerChannel; i += 4) {
+        for (const uint8_t* ch : {srcL, srcR}) {
+            for (int j = 0; j < 4; j++) {
+                uint8_t b = ch[i + static_cast<size_t>(needByteSwap ? 3 - j : j)];
+                if (bitReversalTable) b = bitReversalTable[b];
+                dst[outputBytes++] = b;
+            }
+        }
+    }
+    return outputBytes;
+}
+
+/**
+ * Scalar tail for the multichannel DSD kernels: whole 4-byte groups from
+ * byte offset begin of each channel block.
+ */
+inline size_t interleaveDSDGroupsTail(uint8_t* dst, const uint8_t* src, size_t bytesPerChannel,
+                                      size_t begin, int numChannels,
+                                      const uint8_t* bitReversalTable, bool needByteSwap) {
+    size_t outputBytes = 0;
+    for (size_t i = begin; i + 4 <= bytesPerChannel; i += 4) {
+        for (int ch = 0; ch < numChannels; ch++) {
+            const uint8_t* in = src + static_cast<size_t>(ch) * bytesPerChannel + i;
+            for (int j = 0; j < 4; j++) {
+                uint8_t b = in[needByteSwap ? 3 - j : j];
+                if (bitReversalTable) b = bitReversalTable[b];
+                dst[outputBytes++] = b;
+            }
+        }
+    }
+    return outputBytes;
+}
+
+#if defined(MEMCPY_AUDIO_X86)
+AUDIO_TARGET_AVX2
+inline __m256i simd_bit_reverse(__m256i x) {
+    static const __m256i nibble_reverse = _mm256_setr_epi8(
+        0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE,
+        0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF,
+        0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE,
+        0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF
+    );
+
+    __m256i mask_0f = _mm256_set1_epi8(0x0F);
+    __m256i lo_nibbles = _mm256_and_si256(x, mask_0f);
+    __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi16(x, 4), mask_0f);
+
+    __m256i lo_reversed = _mm256_shuffle_epi8(nibble_reverse, lo_nibbles);
+    __m256i hi_reversed = _mm256_shuffle_epi8(nibble_reverse, hi_nibbles);
+
+    return _mm256_or_si256(_mm256_slli_epi16(lo_reversed, 4), hi_reversed);
+}
+
+#endif // MEMCPY_AUDIO_X86
+
+//-------------------------------------------------------------------------
+// Scalar reference kernels
+//-------------------------------------------------------------------------
+
+inline size_t convert24BitPacked_Scalar(uint8_t* dst, const uint8_t* src, size_t numSamples) {
+    for (size_t i = 0; i < numSamples; i++) {
+        dst[i * 3 + 0] = src[i * 4 + 0];
+        dst[i * 3 + 1] = src[i * 4 + 1];
+        dst[i * 3 + 2] = src[i * 4 + 2];
+    }
+    return numSamples * 3;
+}
+
+inline size_t convert24BitPackedShifted_Scalar(uint8_t* dst, const uint8_t* src, size_t numSamples) {
+    for (size_t i = 0; i < numSamples; i++) {
+        dst[i * 3 + 0] = src[i * 4 + 1];
+        dst[i * 3 + 1] = src[i * 4 + 2];
+        dst[i * 3 + 2] = src[i * 4 + 3];
+    }
+    return numSamples * 3;
+}
+
+inline size_t convert16To32_Scalar(uint8_t* dst, const uint8_t* src, size_t numSamples) {
+    for (size_t i = 0; i < numSamples; i++) {
+        dst[i * 4 + 0] = 0x00;
+        dst[i * 4 + 1] = 0x00;
+        dst[i * 4 + 2] = src[i * 2 + 0];
+        dst[i * 4 + 3] = src[i * 2 + 1];
+    }
+    return numSamples * 4;
+}
+
+inline size_t convertDSDPlanar_Scalar(
+    uint8_t* dst,
+    const uint8_t* src,
+    size_t totalInputBytes,
+    int numChannels,
+    const uint8_t* bitReversalTable,
+    bool needByteSwap
+) {
+    size_t bytesPerChannel = totalInputBytes / static_cast<size_t>(numChannels);
+    size_t outputBytes = 0;
+
+    for (size_t i = 0; i < bytesPerChannel; i += 4) {
+        for (int ch = 0; ch < numChannels; ch++) {
+            uint8_t group[4] = {0, 0, 0, 0};
+            for (int j = 0; j < 4 && (i + static_cast<size_t>(j)) < bytesPerChannel; j++) {
+                uint8_t b = src[static_cast<size_t>(ch) * bytesPerChannel + i + static_cast<size_t>(j)];
+                if (bitReversalTable) b = bitReversalTable[b];
+                group[j] = b;
+            }
+
+            if (needByteSwap) {
+                dst[outputBytes++] = group[3];
+                dst[outputBytes++] = group[2];
+                dst[outputBytes++] = group[1];
+                dst[outputBytes++] = group[0];
+            } else {
+                dst[outputBytes++] = group[0];
+                dst[outputBytes++] = group[1];
+                dst[outputBytes++] = group[2];
+                dst[outputBytes++] = group[3];
+            }
+        }
+    }
+
+    return outputBytes;
+}
+
+#if defined(MEMCPY_AUDIO_X86)
+//-------------------------------------------------------------------------
+// AVX2 kernels (x64)
+//-------------------------------------------------------------------------
+
+/**
+ * Convert S24_P32 to packed 24-bit using AVX2
+ * Input: 4 bytes per sample (24-bit in 32-bit container)
+ * Output: 3 bytes per sample (packed)
+ * Returns: number of output bytes written
+ */
+AUDIO_TARGET_AVX2
+inline size_t convert24BitPacked_AVX2(uint8_t* dst, const uint8_t* src, size_t numSamples) {
+    size_t outputBytes = 0;
+
+    static const __m256i shuffle_mask = _mm256_setr_epi8(
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1
+    );
+
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        if (i + 16 <= numSamples) {
+            _mm_prefetch(reinterpret_cast<const char*>(src + (i + 16) * 4), _MM_HINT_T0);
+        }
+
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        __m256i shuffled = _mm256_shuffle_epi8(in, shuffle_mask);
+
+        __m128i lo = _mm256_castsi256_si128(shuffled);
+        __m128i hi = _mm256_extracti128_si256(shuffled, 1);
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + outputBytes), lo);
+        uint32_t lo_tail;
+        std::memcpy(&lo_tail, reinterpret_cast<const char*>(&lo) + 8, 4);
+        std::memcpy(dst + outputBytes + 8, &lo_tail, 4);
+        outputBytes += 12;
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + outputBytes), hi);
+        uint32_t hi_tail;
+        std::memcpy(&hi_tail, reinterpret_cast<const char*>(&hi) + 8, 4);
+        std::memcpy(dst + outputBytes + 8, &hi_tail, 4);
+        outputBytes += 12;
+    }
+
+    for (; i < numSamples; i++) {
+        dst[outputBytes + 0] = src[i * 4 + 0];
+        dst[outputBytes + 1] = src[i * 4 + 1];
+        dst[outputBytes + 2] = src[i * 4 + 2];
+        outputBytes += 3;
+    }
+
+    _mm256_zeroupper();
+    return outputBytes;
+}
+
+AUDIO_TARGET_AVX2
+inline size_t convert24BitPackedShifted_AVX2(uint8_t* dst, const uint8_t* src, size_t numSamples) {
+    size_t outputBytes = 0;
+
+    static const __m256i shuffle_mask = _mm256_setr_epi8(
+        1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1, -1, -1, -1,
+        1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1, -1, -1, -1
+    );
+
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        if (i + 16 <= numSamples) {
+            _mm_prefetch(reinterpret_cast<const char*>(src + (i + 16) * 4), _MM_HINT_T0);
+        }
+
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        __m256i shuffled = _mm256_shuffle_epi8(in, shuffle_mask);
+
+        __m128i lo = _mm256_castsi256_si128(shuffled);
+        __m128i hi = _mm256_extracti128_si256(shuffled, 1);
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + outputBytes), lo);
+        uint32_t lo_tail;
+        std::memcpy(&lo_tail, reinterpret_cast<const char*>(&lo) + 8, 4);
+        std::memcpy(dst + outputBytes + 8, &lo_tail, 4);
+        outputBytes += 12;
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + outputBytes), hi);
+        uint32_t hi_tail;
+        std::memcpy(&hi_tail, reinterpret_cast<const char*>(&hi) + 8, 4);
+        std::memcpy(dst + outputBytes + 8, &hi_tail, 4);
+        outputBytes += 12;
+    }
+
+    for (; i < numSamples; i++) {
+        dst[outputBytes + 0] = src[i * 4 + 1];
+        dst[outputBytes + 1] = src[i * 4 + 2];
+        dst[outputBytes + 2] = src[i * 4 + 3];
+        outputBytes += 3;
+    }
+
+    _mm256_zeroupper();
+    return outputBytes;
+}
+
+/**
+ * Convert 16-bit to 32-bit using AVX2
+ * Input: 2 bytes per sample (16-bit)
+ * Output: 4 bytes per sample (16-bit value in upper 16 bits)
+ * Returns: number of output bytes written
+ */
+AUDIO_TARGET_AVX2
+inline size_t convert16To32_AVX2(uint8_t* dst, const uint8_t* src, size_t numSamples) {
+    size_t outputBytes = 0;
+
+    size_t i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2));
+        __m256i zero = _mm256_setzero_si256();
+
+        __m256i lo = _mm256_unpacklo_epi16(zero, in);
+        __m256i hi = _mm256_unpackhi_epi16(zero, in);
+
+        __m256i out0 = _mm256_permute2x128_si256(lo, hi, 0x20);
+        __m256i out1 = _mm256_permute2x128_si256(lo, hi, 0x31);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + outputBytes), out0);
+        outputBytes += 32;
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + outputBytes), out1);
+        outputBytes += 32;
+    }
+
+    for (; i < numSamples; i++) {
+        dst[outputBytes + 0] = 0x00;
+        dst[outputBytes + 1] = 0x00;
+        dst[outputBytes + 2] = src[i * 2 + 0];
+        dst[outputBytes + 3] = src[i * 2 + 1];
+        outputBytes += 4;
+    }
+
+    _mm256_zeroupper();
+    return outputBytes;
+}
+
+/**
+ * Convert 5.1 / 7.1 DSD planar to interleaved using AVX2
+ * 32 bytes (eight 4-byte groups) per channel per iteration: the channel
+ * rows form an 8x8 matrix of 32-bit groups (6 channels: two zero rows),
+ * transposed with unpack/permute so each output register holds one group
+ * for every channel. 6-channel groups are 24 bytes; the full-width stores
+ * overlap and the next group overwrites the padding, except for the last
+ * group, which is stored in 16 + 8 bytes.
+ */
+template <int Channels>
+AUDIO_TARGET_AVX2
+inline size_t convertDSDPlanarMulti_AVX2(uint8_t* dst, const uint8_t* src, size_t bytesPerChannel,
+                                         const uint8_t* bitReversalTable, bool needByteSwap) {
+    static_assert(Channels == 6 || Channels == 8, "5.1 or 7.1 layouts only");
+    constexpr size_t groupBytes = static_cast<size_t>(Channels) * 4;
+
+    const __m256i byteswap_mask = _mm256_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+    );
+
+    size_t outputBytes = 0;
+    size_t i = 0;
+    for (; i + 32 <= bytesPerChannel; i += 32) {
+        __m256i r[8];
+        for (int ch = 0; ch < 8; ch++) {
+            if (ch >= Channels) {
+                r[ch] = _mm256_setzero_si256();
+                continue;
+            }
+            r[ch] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+                src + static_cast<size_t>(ch) * bytesPerChannel + i));
+            if (bitReversalTable) r[ch] = simd_bit_reverse(r[ch]);
+            if (needByteSwap) r[ch] = _mm256_shuffle_epi8(r[ch], byteswap_mask);
+        }
+
+        // Pairs of rows: [a0 b0 a1 b1 | a4 b4 a5 b5], [a2 b2 a3 b3 | a6 b6 a7 b7]
+        __m256i t[8];
+        for (int k = 0; k < 8; k += 2) {
+            t[k] = _mm256_unpacklo_epi32(r[k], r[k + 1]);
+            t[k + 1] = _mm256_unpackhi_epi32(r[k], r[k + 1]);
+        }
+        // Four rows: u[g] (g < 4) holds group g in the low lane, g + 4 in the high
+        __m256i u[8];
+        for (int k = 0; k < 8; k += 4) {
+            u[k + 0] = _mm256_unpacklo_epi64(t[k], t[k + 2]);
+            u[k + 1] = _mm256_unpackhi_epi64(t[k], t[k + 2]);
+            u[k + 2] = _mm256_unpacklo_epi64(t[k + 1], t[k + 3]);
+            u[k + 3] = _mm256_unpackhi_epi64(t[k + 1], t[k + 3]);
+        }
+        __m256i out[8];
+        for (int g = 0; g < 4; g++) {
+            out[g] = _mm256_permute2x128_si256(u[g], u[g + 4], 0x20);
+            out[g + 4] = _mm256_permute2x128_si256(u[g], u[g + 4], 0x31);
+        }
+
+        for (int g = 0; g < 8; g++) {
+            uint8_t* p = dst + outputBytes + static_cast<size_t>(g) * groupBytes;
+            if (Channels == 8 || g < 7) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), out[g]);
+            } else {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(out[g]));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(p + 16), _mm256_extracti128_si256(out[g], 1));
+            }
+        }
+        outputBytes += 8 * groupBytes;
+    }
+
+    outputBytes += interleaveDSDGroupsTail(dst + outputBytes, src, bytesPerChannel, i, Channels,
+                                           bitReversalTable, needByteSwap);
+    _mm256_zeroupper();
+    return outputBytes;
+}
+
+/**
+ * Convert DSD planar to interleaved using AVX2 (stereo, 5.1 and 7.1)
+ * Input: [L channel bytes][R channel bytes] planar
+ * Output: [4B L][4B R][4B L][4B R]... interleaved
+ * Falls back to scalar for other channel counts
+ */
+AUDIO_TARGET_AVX2
+inline size_t convertDSDPlanar_AVX2(
+    uint8_t* dst,
+    const uint8_t* src,
+    size_t totalInputBytes,
+    int numChannels,
+    const uint8_t* bitReversalTable,
+    bool needByteSwap
+) {
+    size_t bytesPerChannel = totalInputBytes / static_cast<size_t>(numChannels);
+    size_t outputBytes = 0;
+
+    if (numChannels == 2) {
+        const uint8_t* srcL = src;
+        const uint8_t* srcR = src + bytesPerChannel;
+
+        static const __m256i byteswap_mask = _mm256_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+        );
+
+        size_t i = 0;
+        for (; i + 32 <= bytesPerChannel; i += 32) {
+            __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcL + i));
+            __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcR + i));
+
+            if (bitReversalTable) {
+                left = simd_bit_reverse(left);
+                right = simd_bit_reverse(right);
+            }
+
+            __m256i interleaved_lo = _mm256_unpacklo_epi32(left, right);
+            __m256i interleaved_hi = _mm256_unpackhi_epi32(left, right);
+
+            if (needByteSwap) {
+                interleaved_lo = _mm256_shuffle_epi8(interleaved_lo, byteswap_mask);
+                interleaved_hi = _mm256_shuffle_epi8(interleaved_hi, byteswap_mask);
+            }
+
+            __m256i out0 = _mm256_permute2x128_si256(interleaved_lo, interleaved_hi, 0x20);
+            __m256i out1 = _mm256_permute2x128_si256(interleaved_lo, interleaved_hi, 0x31);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + outputBytes), out0);
+            outputBytes += 32;
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + outputBytes), out1);
+            outputBytes += 32;
+        }
+
+        outputBytes += interleaveDSDStereoTail(dst + outputBytes, srcL + i, srcR + i,
+                                               bytesPerChannel - i, bitReversalTable, needByteSwap);
+
+        _mm256_zeroupper();
+    } else if (numChannels == 6) {
+        outputBytes = convertDSDPlanarMulti_AVX2<6>(dst, src, bytesPerChannel,
+                                                    bitReversalTable, needByteSwap);
+    } else if (numChannels == 8) {
+        outputBytes = convertDSDPlanarMulti_AVX2<8>(dst, src, bytesPerChannel,
+                                                    bitReversalTable, needByteSwap);
+    } else {
+        outputBytes = convertDSDPlanar_Scalar(dst, src, totalInputBytes, numChannels,
+                                              bitReversalTable, needByteSwap);
+    }
+
+    return outputBytes;
+}
+#endif // MEMCPY_AUDIO_X86
+
+#if defined(MEMCPY_AUDIO_NEON)
+//-------------------------------------------------------------------------
+// NEON kernels (aarch64: Pi 5, Rockchip, Neoverse)
+//
+// Structured loads/stores (vld4/vst3, vld2/vst4, vst2) do the byte
+// de-interleave and re-interleave in hardware, so no shuffle tables
+// are needed. 16 samples (or 16 DSD bytes per channel) per iteration.
+//-------------------------------------------------------------------------
+
+/**
+ * Convert S24_P32 to packed 24-bit using NEON
+ * vld4 splits bytes 0..3 of each sample into separate registers,
+ * vst3 writes back bytes 0..2 packed.
+ */
+inline size_t convert24BitPacked_NEON(uint8_t* dst, const uint8_t* src, size_t numSamples) {
+    size_t i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        __builtin_prefetch(src + (i + 32) * 4);
+
+        uint8x16x4_t in = vld4q_u8(src + i * 4);
+        uint8x16x3_t out;
+        out.val[0] = in.val[0];
+        out.val[1] = in.val[1];
+        out.val[2] = in.val[2];
+        vst3q_u8(dst + i * 3, out);
+    }
+
+    return i * 3 + convert24BitPacked_Scalar(dst + i * 3, src + i * 4, numSamples - i);
+}
+
+inline size_t convert24BitPackedShifted_NEON(uint8_t* dst, const uint8_t* src, size_t numSamples) {
+    size_t i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        __builtin_prefetch(src + (i + 32) * 4);
+
+        uint8x16x4_t in = vld4q_u8(src + i * 4);
+        uint8x16x3_t out;
+        out.val[0] = in.val[1];
+        out.val[1] = in.val[2];
+        out.val[2] = in.val[3];
+        vst3q_u8(dst + i * 3, out);
+    }
+
+    return i * 3 + convert24BitPackedShifted_Scalar(dst + i * 3, src + i * 4, numSamples - i);
+}
+
+/**
+ * Convert 16-bit to 32-bit using NEON
+ * Output: 16-bit value in upper 16 bits (same layout as the AVX2 kernel)
+ */
+inline size_t convert16To32_NEON(uint8_t* dst, const uint8_t* src, size_t numSamples) {
+    const uint8x16_t zero = vdupq_n_u8(0);
+
+    size_t i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        uint8x16x2_t in = vld2q_u8(src + i * 2);
+        uint8x16x4_t out;
+        out.val[0] = zero;
+        out.val[1] = zero;
+        out.val[2] = in.val[0];
+        out.val[3] = in.val[1];
+        vst4q_u8(dst + i * 4, out);
+    }
+
+    return i * 4 + convert16To32_Scalar(dst + i * 4, src + i * 2, numSamples - i);
+}
+
+/**
+ * Convert 5.1 / 7.1 DSD planar to interleaved using NEON
+ * 16 bytes (four 4-byte groups) per channel per iteration. Channels 0-3
+ * and 4-7 are 4x4 transposes of 32-bit groups (vtrn + vcombine); for 5.1
+ * channels 4-5 are a single vtrn, stored as 8-byte halves.
+ */
+template <int Channels>
+inline size_t convertDSDPlanarMulti_NEON(uint8_t* dst, const uint8_t* src, size_t bytesPerChannel,
+                                         const uint8_t* bitReversalTable, bool needByteSwap) {
+    static_assert(Channels == 6 || Channels == 8, "5.1 or 7.1 layouts only");
+    constexpr size_t groupBytes = static_cast<size_t>(Channels) * 4;
+
+    size_t outputBytes = 0;
+    size_t i = 0;
+    for (; i + 16 <= bytesPerChannel; i += 16) {
+        uint32x4_t r[Channels];
+        for (int ch = 0; ch < Channels; ch++) {
+            uint8x16_t v = vld1q_u8(src + static_cast<size_t>(ch) * bytesPerChannel + i);
+            if (bitReversalTable) v = vrbitq_u8(v);
+            if (needByteSwap) v = vrev32q_u8(v);
+            r[ch] = vreinterpretq_u32_u8(v);
+        }
+
+        // [a0 b0 a2 b2], [a1 b1 a3 b3]
+        uint32x4x2_t p = vtrnq_u32(r[0], r[1]);
+        uint32x4x2_t q = vtrnq_u32(r[2], r[3]);
+        uint32x4_t lo[4] = {
+            vcombine_u32(vget_low_u32(p.val[0]), vget_low_u32(q.val[0])),
+            vcombine_u32(vget_low_u32(p.val[1]), vget_low_u32(q.val[1])),
+            vcombine_u32(vget_high_u32(p.val[0]), vget_high_u32(q.val[0])),
+            vcombine_u32(vget_high_u32(p.val[1]), vget_high_u32(q.val[1]))
+        };
+
+        uint8_t* out = dst + outputBytes;
+        uint32x4x2_t s = vtrnq_u32(r[4], r[5]);
+        if constexpr (Channels == 8) {
+            uint32x4x2_t t = vtrnq_u32(r[6], r[7]);
+            uint32x4_t hi[4] = {
+                vcombine_u32(vget_low_u32(s.val[0]), vget_low_u32(t.val[0])),
+                vcombine_u32(vget_low_u32(s.val[1]), vget_low_u32(t.val[1])),
+                vcombine_u32(vget_high_u32(s.val[0]), vget_high_u32(t.val[0])),
+                vcombine_u32(vget_high_u32(s.val[1]), vget_high_u32(t.val[1]))
+            };
+            for (int g = 0; g < 4; g++) {
+                vst1q_u32(reinterpret_cast<uint32_t*>(out + g * groupBytes), lo[g]);
+                vst1q_u32(reinterpret_cast<uint32_t*>(out + g * groupBytes + 16), hi[g]);
+            }
+        } else {
+            uint32x2_t hi[4] = {
+                vget_low_u32(s.val[0]), vget_low_u32(s.val[1]),
+                vget_high_u32(s.val[0]), vget_high_u32(s.val[1])
+            };
+            for (int g = 0; g < 4; g++) {
+                vst1q_u32(reinterpret_cast<uint32_t*>(out + g * groupBytes), lo[g]);
+                vst1_u32(reinterpret_cast<uint32_t*>(out + g * groupBytes + 16), hi[g]);
+            }
+        }
+        outputBytes += 4 * groupBytes;
+    }
+
+    return outputBytes + interleaveDSDGroupsTail(dst + outputBytes, src, bytesPerChannel, i, Channels,
+                                                 bitReversalTable, needByteSwap);
+}
+
+/**
+ * Convert DSD planar to interleaved using NEON (stereo, 5.1 and 7.1)
+ * vrbit handles MSB<->LSB, vrev32 the LITTLE endian byte swap,
+ * vst2 interleaves the 4-byte groups. Falls back to scalar for other
+ * channel counts.
+ */
+inline size_t convertDSDPlanar_NEON(
+    uint8_t* dst,
+    const uint8_t* src,
+    size_t totalInputBytes,
+    int numChannels,
+    const uint8_t* bitReversalTable,
+    bool needByteSwap
+) {
+    if (numChannels == 6) {
+        return convertDSDPlanarMulti_NEON<6>(dst, src, totalInputBytes / 6,
+                                             bitReversalTable, needByteSwap);
+    }
+    if (numChannels == 8) {
+        return convertDSDPlanarMulti_NEON<8>(dst, src, totalInputBytes / 8,
+                                             bitReversalTable, needByteSwap);
+    }
+    if (numChannels != 2) {
+        return convertDSDPlanar_Scalar(dst, src, totalInputBytes, numChannels,
+                                       bitReversalTable, needByteSwap);
+    }
+
+    size_t bytesPerChannel = totalInputBytes / 2;
+    const uint8_t* srcL = src;
+    const uint8_t* srcR = src + bytesPerChannel;
+    size_t outputBytes = 0;
+
+    size_t i = 0;
+    for (; i + 16 <= bytesPerChannel; i += 16) {
+        uint8x16_t left = vld1q_u8(srcL + i);
+        uint8x16_t right = vld1q_u8(srcR + i);
+
+        if (bitReversalTable) {
+            left = vrbitq_u8(left);
+            right = vrbitq_u8(right);
+        }
+        if (needByteSwap) {
+            left = vrev32q_u8(left);
+            right = vrev32q_u8(right);
+        }
+
+        uint32x4x2_t out;
+        out.val[0] = vreinterpretq_u32_u8(left);
+        out.val[1] = vreinterpretq_u32_u8(right);
+        vst2q_u32(reinterpret_cast<uint32_t*>(dst + outputBytes), out);
+        outputBytes += 32;
+    }
+
+    outputBytes += interleaveDSDStereoTail(dst + outputBytes, srcL + i, srcR + i,
+                                           bytesPerChannel - i, bitReversalTable, needByteSwap);
+    return outputBytes;
+}
+#endif // MEMCPY_AUDIO_NEON
+
+//=============================================================================
+// Gain kernels (software volume / ReplayGain)
+//
+// Only used when the gain is not unity; at 1.0 the ring keeps the plain
+// conversion kernels above, so the bit-perfect path is untouched. Samples
+// are scaled in float (24-bit mantissa covers every source depth we carry)
+// and clipped to the output range. Outputs narrower than the float result
+// (16-bit, packed 24-bit) get TPDF dither of +-1 LSB.
+//
+// The dither is a hash of the running sample index rather than a stateful
+// generator, so the vector kernels produce exactly the scalar sequence and
+// a block can be converted in any chunking. Each kernel takes the index of
+// its first sample; the caller advances it by numSamples.
+//=============================================================================
+
+inline uint32_t ditherHash(uint32_t x) {
+    x *= 0x9E3779B1u;
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    return x;
+}
+
+// Sum of two 16-bit uniforms from one hash: triangular in (-1, 1) LSB
+inline float ditherTPDF(uint32_t index) {
+    uint32_t h = ditherHash(index);
+    int32_t sum = static_cast<int32_t>((h & 0xFFFF) + (h >> 16)) - 65535;
+    return static_cast<float>(sum) * (1.0f / 65536.0f);
+}
+
+inline int32_t gainScaleClip(float x, float scale, float dither, float lo, float hi) {
+    float v = x * scale + dither;
+    v = v < lo ? lo : (v > hi ? hi : v);
+    return static_cast<int32_t>(std::lrintf(v));
+}
+
+// Largest float below 2^31 (the int32 clip point)
+constexpr float kInt32MaxFloat = 2147483520.0f;
+
+//-------------------------------------------------------------------------
+// Scalar reference kernels
+//-------------------------------------------------------------------------
+
+template <bool MsbAligned>
+inline size_t convert24BitPackedGainImpl_Scalar(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                                                float gain, uint32_t ditherIndex) {
+    for (size_t i = 0; i < numSamples; i++) {
+        int32_t s;
+        std::memcpy(&s, src + i * 4, 4);
+        // LSB-aligned: sign-extend the low 24 bits (top byte may be junk)
+        s = MsbAligned ? (s >> 8) : static_cast<int32_t>(static_cast<uint32_t>(s) << 8) >> 8;
+        int32_t y = gainScaleClip(static_cast<float>(s), gain,
+                                  ditherTPDF(ditherIndex + static_cast<uint32_t>(i)),
+                                  -8388608.0f, 8388607.0f);
+        dst[i * 3 + 0] = static_cast<uint8_t>(y);
+        dst[i * 3 + 1] = static_cast<uint8_t>(y >> 8);
+        dst[i * 3 + 2] = static_cast<uint8_t>(y >> 16);
+    }
+    return numSamples * 3;
+}
+
+inline size_t convert24BitPackedGain_Scalar(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                                            float gain, uint32_t ditherIndex) {
+    return convert24BitPackedGainImpl_Scalar<false>(dst, src, numSamples, gain, ditherIndex);
+}
+
+inline size_t convert24BitPackedShiftedGain_Scalar(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                                                   float gain, uint32_t ditherIndex) {
+    return convert24BitPackedGainImpl_Scalar<true>(dst, src, numSamples, gain, ditherIndex);
+}
+
+// 16-bit in, 32-bit out: the gain lands in the extra 16 bits, no dither needed
+inline size_t convert16To32Gain_Scalar(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                                       float gain, uint32_t /*ditherIndex*/) {
+    const float scale = gain * 65536.0f;
+    for (size_t i = 0; i < numSamples; i++) {
+        int16_t s;
+        std::memcpy(&s, src + i * 2, 2);
+        int32_t y = gainScaleClip(static_cast<float>(s), scale, 0.0f,
+                                  -2147483648.0f, kInt32MaxFloat);
+        std::memcpy(dst + i * 4, &y, 4);
+    }
+    return numSamples * 4;
+}
+
+inline size_t applyGain16_Scalar(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                                 float gain, uint32_t ditherIndex) {
+    for (size_t i = 0; i < numSamples; i++) {
+        int16_t s;
+        std::memcpy(&s, src + i * 2, 2);
+        int16_t y = static_cast<int16_t>(gainScaleClip(static_cast<float>(s), gain,
+                                         ditherTPDF(ditherIndex + static_cast<uint32_t>(i)),
+                                         -32768.0f, 32767.0f));
+        std::memcpy(dst + i * 2, &y, 2);
+    }
+    return numSamples * 2;
+}
+
+inline size_t applyGain32_Scalar(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                                 float gain, uint32_t /*ditherIndex*/) {
+    for (size_t i = 0; i < numSamples; i++) {
+        int32_t s;
+        std::memcpy(&s, src + i * 4, 4);
+        int32_t y = gainScaleClip(static_cast<float>(s), gain, 0.0f,
+                                  -2147483648.0f, kInt32MaxFloat);
+        std::memcpy(dst + i * 4, &y, 4);
+    }
+    return numSamples * 4;
+}
+
+#if defined(MEMCPY_AUDIO_X86)
+//-------------------------------------------------------------------------
+// AVX2 gain kernels: 8 samples per step
+//-------------------------------------------------------------------------
+
+AUDIO_TARGET_AVX2
+inline __m256 ditherTPDF_AVX2(uint32_t firstIndex) {
+    __m256i x = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(firstIndex)),
+                                 _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(0x9E3779B1u)));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(0x85EBCA6Bu)));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 13));
+    __m256i sum = _mm256_add_epi32(_mm256_and_si256(x, _mm256_set1_epi32(0xFFFF)),
+                                   _mm256_srli_epi32(x, 16));
+    sum = _mm256_sub_epi32(sum, _mm256_set1_epi32(65535));
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(sum), _mm256_set1_ps(1.0f / 65536.0f));
+}
+
+AUDIO_TARGET_AVX2
+inline __m256i gainScaleClip_AVX2(__m256i s, __m256 scale, __m256 dither, __m256 lo, __m256 hi) {
+    __m256 v = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(s), scale), dither);
+    v = _mm256_min_ps(_mm256_max_ps(v, lo), hi);
+    return _mm256_cvtps_epi32(v);
+}
+
+template <bool MsbAligned>
+AUDIO_TARGET_AVX2
+inline size_t convert24BitPackedGainImpl_AVX2(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                                              float gain, uint32_t ditherIndex) {
+    const __m256i shuffle_mask = _mm256_setr_epi8(
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1
+    );
+    const __m256 scale = _mm256_set1_ps(gain);
+    const __m256 lo = _mm256_set1_ps(-8388608.0f);
+    const __m256 hi = _mm256_set1_ps(8388607.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        in = MsbAligned ? _mm256_srai_epi32(in, 8) : _mm256_srai_epi32(_mm256_slli_epi32(in, 8), 8);
+        __m256i y = gainScaleClip_AVX2(in, scale,
+                                       ditherTPDF_AVX2(ditherIndex + static_cast<uint32_t>(i)), lo, hi);
+        __m256i shuffled = _mm256_shuffle_epi8(y, shuffle_mask);
+
+        alignas(32) uint8_t packed[32];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(packed), shuffled);
+        std::memcpy(dst + i * 3, packed, 12);
+        std::memcpy(dst + i * 3 + 12, packed + 16, 12);
+    }
+
+    _mm256_zeroupper();
+    return i * 3 + convert24BitPackedGainImpl_Scalar<MsbAligned>(
+        dst + i * 3, src + i * 4, numSamples - i, gain, ditherIndex + static_cast<uint32_t>(i));
+}
+
+AUDIO_TARGET_AVX2
+inline size_t convert24BitPackedGain_AVX2(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                                          float gain, uint32_t ditherIndex) {
+    return convert24BitPackedGainImpl_AVX2<false>(dst, src, numSamples, gain, ditherIndex);
+}
+
+AUDIO_TARGET_AVX2
+inline size_t convert24BitPackedShiftedGain_AVX2(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                                                 float gain, uint32_t ditherIndex) {
+    return convert24BitPackedGainImpl_AVX2<true>(dst, src, numSamples, gain, ditherIndex);
+}
+
+AUDIO_TARGET_AVX2
+inline size_t convert16To32Gain_AVX2(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                                     float gain, uint32_t ditherIndex) {
+    const __m256 scale = _mm256_set1_ps(gain * 65536.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 lo = _mm256_set1_ps(-2147483648.0f);
+    const __m256 hi = _mm256_set1_ps(kInt32MaxFloat);
+
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        __m256i in = _mm256_cvtepi16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4),
+                            gainScaleClip_AVX2(in, scale, zero, lo, hi));
+    }
+
+    _mm256_zeroupper();
+    return i * 4 + convert16To32Gain_Scalar(dst + i * 4, src + i * 2, numSamples - i,
+                                            gain, ditherIndex);
+}
+
+AUDIO_TARGET_AVX2
+inline size_t applyGain16_AVX2(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                               float gain, uint32_t ditherIndex) {
+    const __m256 scale = _mm256_set1_ps(gain);
+    const __m256 lo = _mm256_set1_ps(-32768.0f);
+    const __m256 hi = _mm256_set1_ps(32767.0f);
+
+    size_t i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2));
+        __m256i a = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(in));
+        __m256i b = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(in, 1));
+        uint32_t base = ditherIndex + static_cast<uint32_t>(i);
+        a = gainScaleClip_AVX2(a, scale, ditherTPDF_AVX2(base), lo, hi);
+        b = gainScaleClip_AVX2(b, scale, ditherTPDF_AVX2(base + 8), lo, hi);
+        // packs works per 128-bit lane: restore sample order afterwards
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 2), packed);
+    }
+
+    _mm256_zeroupper();
+    return i * 2 + applyGain16_Scalar(dst + i * 2, src + i * 2, numSamples - i,
+                                      gain, ditherIndex + static_cast<uint32_t>(i));
+}
+
+AUDIO_TARGET_AVX2
+inline size_t applyGain32_AVX2(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                               float gain, uint32_t ditherIndex) {
+    const __m256 scale = _mm256_set1_ps(gain);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 lo = _mm256_set1_ps(-2147483648.0f);
+    const __m256 hi = _mm256_set1_ps(kInt32MaxFloat);
+
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4),
+                            gainScaleClip_AVX2(in, scale, zero, lo, hi));
+    }
+
+    _mm256_zeroupper();
+    return i * 4 + applyGain32_Scalar(dst + i * 4, src + i * 4, numSamples - i,
+                                      gain, ditherIndex);
+}
+#endif // MEMCPY_AUDIO_X86
+
+#if defined(MEMCPY_AUDIO_NEON)
+//-------------------------------------------------------------------------
+// NEON gain kernels: 4 samples per vector
+//-------------------------------------------------------------------------
+
+inline float32x4_t ditherTPDF_NEON(uint32_t firstIndex) {
+    static const uint32_t kLane[4] = {0, 1, 2, 3};
+    uint32x4_t x = vaddq_u32(vdupq_n_u32(firstIndex), vld1q_u32(kLane));
+    x = vmulq_u32(x, vdupq_n_u32(0x9E3779B1u));
+    x = veorq_u32(x, vshrq_n_u32(x, 16));
+    x = vmulq_u32(x, vdupq_n_u32(0x85EBCA6Bu));
+    x = veorq_u32(x, vshrq_n_u32(x, 13));
+    int32x4_t sum = vreinterpretq_s32_u32(vaddq_u32(vandq_u32(x, vdupq_n_u32(0xFFFF)),
+                                                    vshrq_n_u32(x, 16)));
+    sum = vsubq_s32(sum, vdupq_n_s32(65535));
+    return vmulq_n_f32(vcvtq_f32_s32(sum), 1.0f / 65536.0f);
+}
+
+inline int32x4_t gainScaleClip_NEON(int32x4_t s, float scale, float32x4_t dither,
+                                    float32x4_t lo, float32x4_t hi) {
+    float32x4_t v = vaddq_f32(vmulq_n_f32(vcvtq_f32_s32(s), scale), dither);
+    v = vminq_f32(vmaxq_f32(v, lo), hi);
+    return vcvtnq_s32_f32(v);
+}
+
+template <bool MsbAligned>
+inline size_t convert24BitPackedGainImpl_NEON(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                                              float gain, uint32_t ditherIndex) {
+    const float32x4_t lo = vdupq_n_f32(-8388608.0f);
+    const float32x4_t hi = vdupq_n_f32(8388607.0f);
+
+    size_t i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        alignas(16) int32_t scaled[16];
+        for (size_t v = 0; v < 16; v += 4) {
+            int32x4_t in = vld1q_s32(reinterpret_cast<const int32_t*>(src + (i + v) * 4));
+            in = MsbAligned ? vshrq_n_s32(in, 8) : vshrq_n_s32(vshlq_n_s32(in, 8), 8);
+            vst1q_s32(scaled + v, gainScaleClip_NEON(
+                in, gain, ditherTPDF_NEON(ditherIndex + static_cast<uint32_t>(i + v)), lo, hi));
+        }
+        // Same vld4/vst3 byte repack as convert24BitPacked_NEON
+        uint8x16x4_t bytes = vld4q_u8(reinterpret_cast<const uint8_t*>(scaled));
+        uint8x16x3_t out;
+        out.val[0] = bytes.val[0];
+        out.val[1] = bytes.val[1];
+        out.val[2] = bytes.val[2];
+        vst3q_u8(dst + i * 3, out);
+    }
+
+    return i * 3 + convert24BitPackedGainImpl_Scalar<MsbAligned>(
+        dst + i * 3, src + i * 4, numSamples - i, gain, ditherIndex + static_cast<uint32_t>(i));
+}
+
+inline size_t convert24BitPackedGain_NEON(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                                          float gain, uint32_t ditherIndex) {
+    return convert24BitPackedGainImpl_NEON<false>(dst, src, numSamples, gain, ditherIndex);
+}
+
+inline size_t convert24BitPackedShiftedGain_NEON(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                                                 float gain, uint32_t ditherIndex) {
+    return convert24BitPackedGainImpl_NEON<true>(dst, src, numSamples, gain, ditherIndex);
+}
+
+inline size_t convert16To32Gain_NEON(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                                     float gain, uint32_t ditherIndex) {
+    const float scale = gain * 65536.0f;
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t lo = vdupq_n_f32(-2147483648.0f);
+    const float32x4_t hi = vdupq_n_f32(kInt32MaxFloat);
+
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        int16x8_t in = vld1q_s16(reinterpret_cast<const int16_t*>(src + i * 2));
+        int32_t* out = reinterpret_cast<int32_t*>(dst + i * 4);
+        vst1q_s32(out, gainScaleClip_NEON(vmovl_s16(vget_low_s16(in)), scale, zero, lo, hi));
+        vst1q_s32(out + 4, gainScaleClip_NEON(vmovl_s16(vget_high_s16(in)), scale, zero, lo, hi));
+    }
+
+    return i * 4 + convert16To32Gain_Scalar(dst + i * 4, src + i * 2, numSamples - i,
+                                            gain, ditherIndex);
+}
+
+inline size_t applyGain16_NEON(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                               float gain, uint32_t ditherIndex) {
+    const float32x4_t lo = vdupq_n_f32(-32768.0f);
+    const float32x4_t hi = vdupq_n_f32(32767.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        int16x8_t in = vld1q_s16(reinterpret_cast<const int16_t*>(src + i * 2));
+        uint32_t base = ditherIndex + static_cast<uint32_t>(i);
+        int32x4_t a = gainScaleClip_NEON(vmovl_s16(vget_low_s16(in)), gain,
+                                         ditherTPDF_NEON(base), lo, hi);
+        int32x4_t b = gainScaleClip_NEON(vmovl_s16(vget_high_s16(in)), gain,
+                                         ditherTPDF_NEON(base + 4), lo, hi);
+        vst1q_s16(reinterpret_cast<int16_t*>(dst + i * 2),
+                  vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+
+    return i * 2 + applyGain16_Scalar(dst + i * 2, src + i * 2, numSamples - i,
+                                      gain, ditherIndex + static_cast<uint32_t>(i));
+}
+
+inline size_t applyGain32_NEON(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                               float gain, uint32_t ditherIndex) {
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t lo = vdupq_n_f32(-2147483648.0f);
+    const float32x4_t hi = vdupq_n_f32(kInt32MaxFloat);
+
+    size_t i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        int32x4_t in = vld1q_s32(reinterpret_cast<const int32_t*>(src + i * 4));
+        vst1q_s32(reinterpret_cast<int32_t*>(dst + i * 4),
+                  gainScaleClip_NEON(in, gain, zero, lo, hi));
+    }
+
+    return i * 4 + applyGain32_Scalar(dst + i * 4, src + i * 4, numSamples - i,
+                                      gain, ditherIndex);
+}
+#endif // MEMCPY_AUDIO_NEON
+
+//=============================================================================
+// FIR dot product (PolyphaseResampler)
+//
+// One output sample = one dot product of a filter phase with the input
+// history. Four (scalar) or two vector accumulators hide the add latency;
+// the summation order differs per ISA, so results agree to float rounding,
+// not bit for bit.
+//=============================================================================
+
+inline float dotF32_Scalar(const float* a, const float* b, size_t n) {
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; i++) s0 += a[i] * b[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+#if defined(MEMCPY_AUDIO_X86)
+AUDIO_TARGET_AVX2
+inline float dotF32_AVX2(const float* a, const float* b, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    float result = _mm_cvtss_f32(sum);
+    _mm256_zeroupper();
+    return result + dotF32_Scalar(a + i, b + i, n - i);
+}
+
+AUDIO_TARGET_BEGIN_AVX512
+inline float dotF32_AVX512(const float* a, const float* b, size_t n) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+    }
+    if (i + 16 <= n) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+        i += 16;
+    }
+    // Fold 512 -> 256 with zero-masked extracts: GCC 12 implements the
+    // unmasked ones (and the casts and _mm512_reduce_add_ps built on them)
+    // over an _mm256_undefined_pd(), which trips -Wuninitialized at -O2
+    __m512d acc = _mm512_castps_pd(_mm512_add_ps(acc0, acc1));
+    __m256 half = _mm256_add_ps(_mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xF, acc, 0)),
+                                _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xF, acc, 1)));
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(half), _mm256_extractf128_ps(half, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    float result = _mm_cvtss_f32(sum);
+    _mm256_zeroupper();
+    return result + dotF32_Scalar(a + i, b + i, n - i);
+}
+AUDIO_TARGET_END
+#endif // MEMCPY_AUDIO_X86
+
+#if defined(MEMCPY_AUDIO_NEON)
+inline float dotF32_NEON(const float* a, const float* b, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    float32x4_t acc2 = vdupq_n_f32(0.0f);
+    float32x4_t acc3 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        acc2 = vfmaq_f32(acc2, vld1q_f32(a + i + 8), vld1q_f32(b + i + 8));
+        acc3 = vfmaq_f32(acc3, vld1q_f32(a + i + 12), vld1q_f32(b + i + 12));
+    }
+    float result = vaddvq_f32(vaddq_f32(vaddq_f32(acc0, acc1), vaddq_f32(acc2, acc3)));
+    return result + dotF32_Scalar(a + i, b + i, n - i);
+}
+#endif // MEMCPY_AUDIO_NEON
+
+//=============================================================================
+// Dispatch table
+//=============================================================================
+
+enum class Isa { Scalar, SSE2, AVX2, AVX512, NEON };
+
+using CopyFn = void* (*)(void* dst, const void* src, size_t len);
+using FixedCopyFn = void (*)(void* dst, const void* src, size_t len);
+using ConvertFn = size_t (*)(uint8_t* dst, const uint8_t* src, size_t numSamples);
+using DSDPlanarFn = size_t (*)(uint8_t* dst, const uint8_t* src, size_t totalInputBytes,
+                               int numChannels, const uint8_t* bitReversalTable, bool needByteSwap);
+using GainFn = size_t (*)(uint8_t* dst, const uint8_t* src, size_t numSamples,
+                          float gain, uint32_t ditherIndex);
+using DotFn = float (*)(const float* a, const float* b, size_t n);
+
+struct Table {
+    Isa isa;
+
+    CopyFn copy;                 // memcpy_audio: bulk PCM/DSD copies
+    FixedCopyFn copyFixed;       // memcpy_audio_fixed: staged ring writes
+    ConvertFn pack24;            // S24_P32 LSB-aligned -> packed 24-bit
+    ConvertFn pack24Shifted;     // S24_P32 MSB-aligned -> packed 24-bit
+    ConvertFn convert16To32;
+    DSDPlanarFn dsdPlanar;
+    GainFn pack24Gain;           // pack24 + gain + TPDF dither
+    GainFn pack24ShiftedGain;    // pack24Shifted + gain + TPDF dither
+    GainFn convert16To32Gain;    // 16 -> 32 + gain (no dither needed)
+    GainFn gain16;               // 16-bit direct + gain + TPDF dither
+    GainFn gain32;               // 32-bit direct + gain
+    DotFn dot;                   // float FIR dot product (resampler)
+
+    const char* copyName;
+    const char* copyFixedName;
+    const char* convertName;
+};
+
+inline const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::SSE2:   return "SSE2";
+        case Isa::AVX2:   return "AVX2";
+        case Isa::AVX512: return "AVX-512";
+        case Isa::NEON:   return "NEON";
+        default:          return "scalar";
+    }
+}
+
+/**
+ * Kernel set for an ISA. Falls back to the baseline set when the ISA is
+ * not available on this build architecture (does not probe the CPU).
+ */
+constexpr Table tableFor(Isa isa) {
+#if defined(MEMCPY_AUDIO_X86)
+    if (isa == Isa::AVX512) {
+        // Only the FIR dot has an AVX-512 kernel: the AVX2 conversions already
+        // saturate store bandwidth at the ring's 64KB staging granularity
+        return Table{Isa::AVX512,
+                     memcpy_audio_bulk_avx512, memcpy_audio_fixed_avx2,
+                     convert24BitPacked_AVX2, convert24BitPackedShifted_AVX2,
+                     convert16To32_AVX2, convertDSDPlanar_AVX2,
+                     convert24BitPackedGain_AVX2, convert24BitPackedShiftedGain_AVX2,
+                     convert16To32Gain_AVX2, applyGain16_AVX2, applyGain32_AVX2,
+                     dotF32_AVX512,
+                     "AVX-512 (>=32KB) / AVX2", "AVX2", "AVX2"};
+    }
+    if (isa == Isa::AVX2) {
+        return Table{Isa::AVX2,
+                     memcpy_audio_bulk_avx2, memcpy_audio_fixed_avx2,
+                     convert24BitPacked_AVX2, convert24BitPackedShifted_AVX2,
+                     convert16To32_AVX2, convertDSDPlanar_AVX2,
+                     convert24BitPackedGain_AVX2, convert24BitPackedShiftedGain_AVX2,
+                     convert16To32Gain_AVX2, applyGain16_AVX2, applyGain32_AVX2,
+                     dotF32_AVX2,
+                     "AVX2", "AVX2", "AVX2"};
+    }
+    if (isa != Isa::Scalar) {
+        return Table{Isa::SSE2,
+                     memcpy_audio_bulk_libc, memcpy_audio_fixed_sse2,
+                     convert24BitPacked_Scalar, convert24BitPackedShifted_Scalar,
+                     convert16To32_Scalar, convertDSDPlanar_Scalar,
+                     convert24BitPackedGain_Scalar, convert24BitPackedShiftedGain_Scalar,
+                     convert16To32Gain_Scalar, applyGain16_Scalar, applyGain32_Scalar,
+                     dotF32_Scalar,
+                     "libc", "SSE2", "scalar"};
+    }
+#elif defined(MEMCPY_AUDIO_NEON)
+    if (isa != Isa::Scalar) {
+        return Table{Isa::NEON,
+                     memcpy_audio_bulk_libc, memcpy_audio_fixed_neon,
+                     convert24BitPacked_NEON, convert24BitPackedShifted_NEON,
+                     convert16To32_NEON, convertDSDPlanar_NEON,
+                     convert24BitPackedGain_NEON, convert24BitPackedShiftedGain_NEON,
+                     convert16To32Gain_NEON, applyGain16_NEON, applyGain32_NEON,
+                     dotF32_NEON,
+                     "libc", "NEON", "NEON"};
+    }
+#else
+    (void)isa;
+#endif
+    return Table{Isa::Scalar,
+                 memcpy_audio_bulk_libc, memcpy_audio_fixed_scalar,
+                 convert24BitPacked_Scalar, convert24BitPackedShifted_Scalar,
+                 convert16To32_Scalar, convertDSDPlanar_Scalar,
+                 convert24BitPackedGain_Scalar, convert24BitPackedShiftedGain_Scalar,
+                 convert16To32Gain_Scalar, applyGain16_Scalar, applyGain32_Scalar,
+                 dotF32_Scalar,
+                 "libc", "scalar", "scalar"};
+}
+
+/**
+ * Best ISA the running CPU supports
+ */
+inline Isa detectBestIsa() {
+    AudioCpuFeatures cpu = detect_audio_cpu_features();
+    if (cpu.avx512) return Isa::AVX512;
+    if (cpu.avx2) return Isa::AVX2;
+    if (cpu.sse2) return Isa::SSE2;
+    if (cpu.neon) return Isa::NEON;
+    return Isa::Scalar;
+}
+
+inline bool isSupported(Isa isa) {
+    if (isa == Isa::Scalar) return true;
+    AudioCpuFeatures cpu = detect_audio_cpu_features();
+    switch (isa) {
+        case Isa::SSE2:   return cpu.sse2;
+        case Isa::AVX2:   return cpu.avx2;
+        case Isa::AVX512: return cpu.avx512;
+        case Isa::NEON:   return cpu.neon;
+        default:          return false;
+    }
+}
+
+// Baseline until init(): SSE2 on x86-64, NEON on aarch64
+#if defined(MEMCPY_AUDIO_X86)
+inline Table g_active = tableFor(Isa::SSE2);
+#elif defined(MEMCPY_AUDIO_NEON)
+inline Table g_active = tableFor(Isa::NEON);
+#else
+inline Table g_active = tableFor(Isa::Scalar);
+#endif
+
+inline const Table& active() { return g_active; }
+
+/**
+ * Bind the best kernels for this CPU. Idempotent; call before any audio
+ * thread starts (DirettaSync::enable), the table is not swapped atomically.
+ */
+inline void init() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        g_active = tableFor(detectBestIsa());
+        std::cout << "[AudioKernels] ISA: " << isaName(g_active.isa) << std::endl;
+        std::cout << "[AudioKernels]   memcpy_audio:       " << g_active.copyName << std::endl;
+        std::cout << "[AudioKernels]   memcpy_audio_fixed: " << g_active.copyFixedName << std::endl;
+        std::cout << "[AudioKernels]   24-bit pack, 16->32, DSD interleave, gain: "
+                  << g_active.convertName << std::endl;
+        std::cout << "[AudioKernels]   FIR dot: "
+                  << (g_active.isa == Isa::AVX512 ? "AVX-512" : g_active.convertName) << std::endl;
+    });
+}
+
+} // namespace AudioKernels
+
+//=============================================================================
+// Copy entry points (dispatched)
+//=============================================================================
+
+static inline void* memcpy_audio(void* dst, const void* src, size_t len) {
+    memcpy_audio_check_overlap(dst, src, len);
+    return AudioKernels::g_active.copy(dst, src, len);
+}
+
+static inline void memcpy_audio_fixed(void* dst, const void* src, size_t size) {
+    AudioKernels::g_active.copyFixed(dst, src, size);
+}
+
+#endif // AUDIO_KERNELS_H
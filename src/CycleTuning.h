@@ -0,0 +1,146 @@
+/**
+ * @file CycleTuning.h
+ * @brief Learned cycle time and transfer mode per Diretta target
+ *
+ * DirettaCycleCalculator derives the cycle time from the MTU alone and
+ * applyTransferMode() picks a mode by format; neither knows how a given
+ * target and link behave. --auto-tune probes a few candidates per rate
+ * family against the live target (silence, a few seconds each), scores them
+ * by underruns and callback-interval jitter, and persists the winner keyed
+ * by target name and network interface. Later open() calls look the
+ * family up here first.
+ *
+ * Search: transfer modes at the calculated cycle time, then cycle-time
+ * multiples with the best mode (coordinate descent, 3 + 4 trials per family).
+ *
+ * File format, one entry per line, '#' comments:
+ *   <target>\t<interface>\t<family>\t<cycle_us>\t<mode>\t<score>
+ */
+
+#ifndef CYCLE_TUNING_H
+#define CYCLE_TUNING_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "StateFile.h"
+
+namespace CycleTuning {
+
+enum class Family { Pcm44, Pcm48, Dsd, Count };
+
+inline const char* familyName(Family family) {
+    switch (family) {
+        case Family::Pcm44: return "pcm44";
+        case Family::Pcm48: return "pcm48";
+        default:            return "dsd";
+    }
+}
+
+inline Family familyFromName(const std::string& name) {
+    if (name == "pcm44") return Family::Pcm44;
+    if (name == "pcm48") return Family::Pcm48;
+    if (name == "dsd") return Family::Dsd;
+    return Family::Count;
+}
+
+// rate: PCM sample rate or DSD bit rate
+inline Family familyOf(uint32_t rate, bool isDsd) {
+    if (isDsd) return Family::Dsd;
+    return (rate % 11025 == 0) ? Family::Pcm44 : Family::Pcm48;
+}
+
+// Transfer modes by name; the index is DirettaTransferMode's value
+inline const char* const kModeNames[] = {"fix_auto", "var_auto", "var_max"};
+constexpr int MODE_COUNT = 3;
+
+inline int modeFromName(const std::string& name) {
+    for (int i = 0; i < MODE_COUNT; i++) {
+        if (name == kModeNames[i]) return i;
+    }
+    return -1;
+}
+
+// Cycle-time multiples tried around the calculated value (percent)
+constexpr unsigned CYCLE_STEPS_PCT[] = {50, 75, 150, 200};
+
+/**
+ * Lower is better. One underrun outweighs any amount of interval jitter;
+ * jitter is the coefficient of variation of the callback interval.
+ */
+inline double score(uint64_t underruns, double meanIntervalUs, double stddevIntervalUs) {
+    double cv = meanIntervalUs > 0 ? stddevIntervalUs / meanIntervalUs : 1.0;
+    return static_cast<double>(underruns) * 10.0 + cv;
+}
+
+struct Entry {
+    std::string target;
+    std::string iface;
+    Family family = Family::Pcm44;
+    uint32_t cycleUs = 0;
+    int mode = 0;
+    double score = 0.0;
+};
+
+class Store {
+public:
+    /**
+     * @return false if the file exists but could not be read; a missing
+     *         file is an empty store
+     */
+    bool load(const std::string& path) {
+        m_entries.clear();
+        return StateFile::load(path, 6, [this](const std::vector<std::string>& fields) {
+            Entry e;
+            e.target = fields[0];
+            e.iface = fields[1];
+            e.family = familyFromName(fields[2]);
+            e.cycleUs = static_cast<uint32_t>(std::strtoul(fields[3].c_str(), nullptr, 10));
+            e.mode = modeFromName(fields[4]);
+            e.score = std::strtod(fields[5].c_str(), nullptr);
+            if (e.family == Family::Count || e.cycleUs == 0 || e.mode < 0) return;
+            set(e);
+        });
+    }
+
+    bool save(const std::string& path) const {
+        return StateFile::save(path,
+            "# Diretta cycle-time auto-tune results (--auto-tune)\n"
+            "# target\tinterface\tfamily\tcycle_us\tmode\tscore\n",
+            [this](std::ostream& out) {
+                for (const Entry& e : m_entries) {
+                    out << e.target << '\t' << e.iface << '\t' << familyName(e.family) << '\t'
+                        << e.cycleUs << '\t' << kModeNames[e.mode] << '\t' << e.score << '\n';
+                }
+            });
+    }
+
+    const Entry* find(const std::string& target, const std::string& iface, Family family) const {
+        for (const Entry& e : m_entries) {
+            if (e.target == target && e.iface == iface && e.family == family) return &e;
+        }
+        return nullptr;
+    }
+
+    void set(const Entry& entry) {
+        for (Entry& e : m_entries) {
+            if (e.target == entry.target && e.iface == entry.iface && e.family == entry.family) {
+                e = entry;
+                return;
+            }
+        }
+        m_entries.push_back(entry);
+    }
+
+    size_t size() const { return m_entries.size(); }
+
+private:
+    std::vector<Entry> m_entries;
+};
+
+} // namespace CycleTuning
+
+#endif // CYCLE_TUNING_H
@@ -11,6 +11,11 @@
 #include "UPnPDevice.hpp"
 #include "AudioEngine.h"
 #include "AudioTiming.h"
+#include "ThreadPlacement.h"
+#include "ReadAheadIO.h"
+#include "TrackCache.h"
+#include "DsdModulator.h"
+#include "TraceRecorder.h"
 #include <chrono>
 #include <ctime>
 #include <iomanip>
@@ -19,15 +24,17 @@
 #include <unistd.h>
 #include <cstring>
 #include <algorithm>
+#include <cmath>
 
 extern bool g_verbose;
 #define DEBUG_LOG(x) if (g_verbose) { std::cout << x << std::endl; }
 
-// Hybrid flow control constants
+// Event-driven flow control: the producer blocks on the ring's free-space
+// watermark (DirettaSync::waitForSpace); these are only upper bounds
 namespace FlowControl {
-    constexpr int MICROSLEEP_US = 500;
-    constexpr int MAX_WAIT_MS = 20;
-    constexpr int MAX_RETRIES = MAX_WAIT_MS * 1000 / MICROSLEEP_US;  // 40 retries
+    constexpr int MICROSLEEP_US = 500;     // PCM: retry pause when the wait can't block
+    constexpr int MAX_WAIT_MS = 20;        // PCM: max stall without progress
+    constexpr int DSD_MAX_WAIT_MS = 500;   // DSD: atomic push budget
     constexpr float CRITICAL_BUFFER_LEVEL = 0.10f;
 }
 
@@ -79,8 +86,17 @@ DirettaRenderer::Config::Config() {
 // Constructor / Destructor
 //=============================================================================
 
+struct DirettaRenderer::CallbackFormat {
+    uint64_t version = ~0ULL;      // Snapshot the format was built from (~0 = none yet)
+    uint64_t sinkVersion = ~0ULL;  // Snapshot the sink was last opened/checked for
+    TrackSnapshot track;
+    AudioFormat format;
+    bool modulate = false;
+};
+
 DirettaRenderer::DirettaRenderer(const Config& config)
     : m_config(config)
+    , m_callbackFormat(std::make_unique<CallbackFormat>())
 {
     DEBUG_LOG("[DirettaRenderer] Created");
 }
@@ -121,6 +137,12 @@ bool DirettaRenderer::start() {
 
     DEBUG_LOG("[DirettaRenderer] Starting...");
 
+    if (m_config.traceFile.empty()) {
+        Trace::Recorder::instance().disable();
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+
     try {
         // Create and enable DirettaSync
         std::cout << "[DirettaRenderer] Checking Diretta Target..." << std::endl;
@@ -128,18 +150,55 @@ bool DirettaRenderer::start() {
         m_direttaSync = std::make_unique<DirettaSync>();
         m_direttaSync->setTargetIndex(m_config.targetIndex);
 
-        if (!m_direttaSync->verifyTargetAvailable()) {
+        // Known target: advertise now, discovery is confirmed in the background
+        bool cachedTarget = m_direttaSync->loadTargetCache(m_config.targetCacheFile,
+                                                           m_config.networkInterface);
+
+        if (!cachedTarget && !m_direttaSync->verifyTargetAvailable()) {
             std::cerr << "[DirettaRenderer] No Diretta Target found!" << std::endl;
             std::cerr << "[DirettaRenderer] Run: ./bin/DirettaRendererUPnP --list-targets" << std::endl;
             return false;
         }
 
         DirettaConfig syncConfig;
+        syncConfig.fastFormatSwitch = m_config.fastFormatSwitch;
+        syncConfig.fastStart = m_config.fastStart;
+        syncConfig.adaptiveBuffer = m_config.adaptiveBuffer;
+        syncConfig.adaptiveMinMs = static_cast<unsigned int>(m_config.adaptiveMinMs);
+        syncConfig.adaptiveMaxMs = static_cast<unsigned int>(m_config.adaptiveMaxMs);
+        syncConfig.hugePages = m_config.hugePages;
+        syncConfig.lockMemory = m_config.lockMemory;
+        syncConfig.tuningFile = m_config.tuningFile;
+        syncConfig.networkInterface = m_config.networkInterface;
         if (!m_direttaSync->enable(syncConfig)) {
             std::cerr << "[DirettaRenderer] Failed to enable DirettaSync" << std::endl;
             return false;
         }
 
+        if (m_config.autoTune && !m_direttaSync->autoTune()) {
+            std::cerr << "[DirettaRenderer] Auto-tune failed, using calculated settings" << std::endl;
+        }
+
+        // Fan-out followers: a missing one is skipped, the primary carries on
+        for (int index : m_config.fanOutTargets) {
+            auto follower = std::make_unique<FanOutTarget>();
+            follower->sync = std::make_unique<DirettaSync>();
+            follower->sync->setTargetIndex(index);
+            follower->sync->loadTargetCache(m_config.targetCacheFile, m_config.networkInterface);
+            if (!follower->sync->enable(syncConfig)) {
+                std::cerr << "[DirettaRenderer] Fan-out target #" << (index + 1)
+                          << " not available, skipped" << std::endl;
+                continue;
+            }
+            if (m_config.autoTune) {
+                follower->sync->autoTune();
+            }
+            m_fanOut.push_back(std::move(follower));
+        }
+        if (!m_fanOut.empty()) {
+            std::cout << "[DirettaRenderer] Fan-out: " << m_fanOut.size() << " follower target(s)" << std::endl;
+        }
+
         std::cout << "[DirettaRenderer] Diretta Target ready" << std::endl;
 
         // Create UPnP device
@@ -152,9 +211,22 @@ bool DirettaRenderer::start() {
         upnpConfig.networkInterface = m_config.networkInterface;
 
         m_upnp = std::make_unique<UPnPDevice>(upnpConfig);
+        if (m_config.softVolume) {
+            // Start at unity so playback stays bit-perfect until the first SetVolume
+            m_upnp->setVolume(100);
+        }
 
         // Create AudioEngine
         m_audioEngine = std::make_unique<AudioEngine>();
+        m_audioEngine->setDecodeAhead(m_config.decodeAhead);
+        m_audioEngine->setReadAhead(static_cast<size_t>(m_config.readAheadMB) << 20);
+        m_audioEngine->setFastProbe(m_config.fastStart);
+        m_audioEngine->setTrackCache(static_cast<size_t>(m_config.trackCacheMB) << 20);
+        m_audioEngine->setUpsampling(true, m_config.upsample44.rate, m_config.upsample44.native);
+        m_audioEngine->setUpsampling(false, m_config.upsample48.rate, m_config.upsample48.native);
+        if (m_config.pcmToDsd > 0) {
+            reportDsdHeadroom();
+        }
 
         //=====================================================================
         // Audio Callback - Simplified
@@ -179,32 +251,54 @@ bool DirettaRenderer::start() {
                     ~Guard() { flag.store(false, std::memory_order_release); }
                 } guard{m_callbackRunning};
 
-                const TrackInfo& trackInfo = m_audioEngine->getCurrentTrackInfo();
-
-                // Build format
-                AudioFormat format(sampleRate, bitDepth, channels);
-                format.isDSD = trackInfo.isDSD;
-                format.isCompressed = trackInfo.isCompressed;
-
-                if (trackInfo.isDSD) {
-                    format.bitDepth = 1;
-                    // Use detected source format (from file extension or codec)
-                    if (trackInfo.dsdSourceFormat == TrackInfo::DSDSourceFormat::DSF) {
-                        format.dsdFormat = AudioFormat::DSDFormat::DSF;
-                        DEBUG_LOG("[Callback] DSD format: DSF (LSB first)");
-                    } else if (trackInfo.dsdSourceFormat == TrackInfo::DSDSourceFormat::DFF) {
-                        format.dsdFormat = AudioFormat::DSDFormat::DFF;
-                        DEBUG_LOG("[Callback] DSD format: DFF (MSB first)");
-                    } else {
-                        // Fallback to codec string if detection failed
-                        format.dsdFormat = (trackInfo.codec.find("lsb") != std::string::npos)
-                            ? AudioFormat::DSDFormat::DSF
-                            : AudioFormat::DSDFormat::DFF;
-                        DEBUG_LOG("[Callback] DSD format: "
-                                  << (format.dsdFormat == AudioFormat::DSDFormat::DSF ? "DSF" : "DFF")
-                                  << " (from codec fallback)");
+                m_direttaSync->startupTimeline().mark(StartupTimeline::Phase::FirstDecode);
+
+                // Build the format once per track snapshot: same version, same format
+                CallbackFormat& cb = *m_callbackFormat;
+                uint64_t trackVersion = m_audioEngine->trackVersion();
+                if (trackVersion != cb.version) {
+                    cb.track = m_audioEngine->trackSnapshot();
+                    cb.version = cb.track->version;
+                    const TrackInfo& trackInfo = cb.track->value.info;
+
+                    AudioFormat format(sampleRate, bitDepth, channels);
+                    format.isDSD = trackInfo.isDSD;
+                    format.isCompressed = trackInfo.isCompressed;
+
+                    if (trackInfo.isDSD) {
+                        format.bitDepth = 1;
+                        // Use detected source format (from file extension or codec)
+                        if (trackInfo.dsdSourceFormat == TrackInfo::DSDSourceFormat::DSF) {
+                            format.dsdFormat = AudioFormat::DSDFormat::DSF;
+                            DEBUG_LOG("[Callback] DSD format: DSF (LSB first)");
+                        } else if (trackInfo.dsdSourceFormat == TrackInfo::DSDSourceFormat::DFF) {
+                            format.dsdFormat = AudioFormat::DSDFormat::DFF;
+                            DEBUG_LOG("[Callback] DSD format: DFF (MSB first)");
+                        } else {
+                            // Fallback to codec string if detection failed
+                            format.dsdFormat = (trackInfo.codec.find("lsb") != std::string::npos)
+                                ? AudioFormat::DSDFormat::DSF
+                                : AudioFormat::DSDFormat::DFF;
+                            DEBUG_LOG("[Callback] DSD format: "
+                                      << (format.dsdFormat == AudioFormat::DSDFormat::DSF ? "DSF" : "DFF")
+                                      << " (from codec fallback)");
+                        }
                     }
+
+                    // PCM -> DSD: the sink gets a DSD stream, modulated below
+                    cb.modulate = m_config.pcmToDsd > 0 && !trackInfo.isDSD &&
+                                  prepareDsdModulator(sampleRate, channels);
+                    if (cb.modulate) {
+                        format = AudioFormat(m_dsdModulator->dsdRate(), 1, channels);
+                        format.isDSD = true;
+                        format.isCompressed = trackInfo.isCompressed;
+                        format.dsdFormat = AudioFormat::DSDFormat::DFF;  // MSB first
+                    }
+                    cb.format = format;
                 }
+                const TrackInfo& trackInfo = cb.track->value.info;
+                const AudioFormat& format = cb.format;
+                const bool modulate = cb.modulate;
 
                 // Open/resume connection if needed
                 // Check isPlaying() not isOpen() - after stopPlayback(), isOpen() is true
@@ -213,9 +307,13 @@ bool DirettaRenderer::start() {
                 // CRITICAL FIX: Also check for format changes!
                 // When transitioning DSD→PCM (or vice versa), DirettaSync may still be
                 // "playing" but with the wrong format. We must call open() to reconfigure.
-                bool needsOpen = !m_direttaSync->isPlaying();
+                // Only a new snapshot can bring a new format, so the sink is
+                // compared once per version rather than on every buffer.
+                // A warm-up (see warmUpSink()) still goes through open(),
+                // which adopts it or reconfigures for the decoded format.
+                bool needsOpen = !m_direttaSync->isPlaying() || m_direttaSync->isWarm();
 
-                if (!needsOpen && m_direttaSync->isOpen()) {
+                if (!needsOpen && cb.sinkVersion != cb.version && m_direttaSync->isOpen()) {
                     // Check if format has changed
                     const AudioFormat& currentSyncFormat = m_direttaSync->getFormat();
                     bool formatChanged = (currentSyncFormat.sampleRate != format.sampleRate ||
@@ -232,46 +330,92 @@ bool DirettaRenderer::start() {
                                   << format.bitDepth << "bit "
                                   << (format.isDSD ? "DSD" : "PCM") << std::endl;
 
-                        // Stop current playback to trigger full reopen
-                        m_direttaSync->stopPlayback(true);
+                        // Stop current playback to trigger full reopen. Fast switch
+                        // keeps it running so open() can play out the old tail
+                        if (!m_direttaSync->fastFormatSwitchEnabled()) {
+                            m_direttaSync->stopPlayback(true);
+                            for (auto& follower : m_fanOut) follower->sync->stopPlayback(true);
+                        }
                         needsOpen = true;
+                    } else {
+                        cb.sinkVersion = cb.version;
                     }
                 }
 
                 if (needsOpen) {
-                    if (!m_direttaSync->open(format)) {
+                    // Followers open alongside the primary (each open takes a second or more)
+                    std::vector<std::thread> followerOpens;
+                    for (auto& follower : m_fanOut) {
+                        follower->slip.reset();
+                        followerOpens.emplace_back([&follower, format]() {
+                            // Spawned from the audio callback: drop its RT placement
+                            ThreadPlacement::apply(ThreadPlacement::Role::Main);
+                            if (!follower->sync->open(format)) {
+                                std::cerr << "[Callback] Fan-out target failed to open" << std::endl;
+                            }
+                        });
+                    }
+                    bool opened = m_direttaSync->open(format);
+                    for (auto& t : followerOpens) t.join();
+                    if (!opened) {
                         std::cerr << "[Callback] Failed to open DirettaSync" << std::endl;
                         return false;
                     }
+                    if (modulate) {
+                        m_dsdModulator->reset();  // No filter history from before the reopen
+                    }
+                    cb.sinkVersion = cb.version;
 
                     // Propagate S24 alignment hint AFTER open() completes
-                    if (trackInfo.s24Alignment == TrackInfo::S24Alignment::LsbAligned) {
-                        m_direttaSync->setS24PackModeHint(DirettaRingBuffer::S24PackMode::LsbAligned);
+                    // (resampled output is always full-scale S32: MSB-aligned)
+                    auto setHint = [this](DirettaRingBuffer::S24PackMode mode) {
+                        m_direttaSync->setS24PackModeHint(mode);
+                        for (auto& follower : m_fanOut) follower->sync->setS24PackModeHint(mode);
+                    };
+                    if (!trackInfo.isDSD && sampleRate != trackInfo.sampleRate) {
+                        setHint(DirettaRingBuffer::S24PackMode::MsbAligned);
+                        DEBUG_LOG("[Callback] S24 hint propagated: MsbAligned (resampled)");
+                    } else if (trackInfo.s24Alignment == TrackInfo::S24Alignment::LsbAligned) {
+                        setHint(DirettaRingBuffer::S24PackMode::LsbAligned);
                         DEBUG_LOG("[Callback] S24 hint propagated: LsbAligned");
                     } else if (trackInfo.s24Alignment == TrackInfo::S24Alignment::MsbAligned) {
-                        m_direttaSync->setS24PackModeHint(DirettaRingBuffer::S24PackMode::MsbAligned);
+                        setHint(DirettaRingBuffer::S24PackMode::MsbAligned);
                         DEBUG_LOG("[Callback] S24 hint propagated: MsbAligned");
                     }
                 }
 
                 // Send audio (DirettaSync handles all format conversions)
-                if (trackInfo.isDSD) {
-                    // DSD: Atomic send with retry
-                    int retryCount = 0;
-                    const int maxRetries = 100;
-                    size_t sent = 0;
-
-                    while (sent == 0 && retryCount < maxRetries) {
-                        sent = m_direttaSync->sendAudio(buffer.data(), samples);
-
-                        if (sent == 0) {
-                            std::this_thread::sleep_for(std::chrono::milliseconds(5));
-                            retryCount++;
+                if (format.isDSD) {
+                    const uint8_t* dsdData = buffer.data();
+                    size_t dsdSamples = samples;
+                    if (modulate) {
+                        // Gain goes into the modulator: DirettaSync never scales DSD
+                        dsdSamples = m_dsdModulator->process(buffer.data(), samples, bitDepth,
+                                                             m_direttaSync->gain(), m_dsdBuffer);
+                        dsdData = m_dsdBuffer.data();
+                        if (dsdSamples == 0) {
+                            return true;  // Front-end filter still filling
                         }
                     }
 
+                    // DSD: Atomic send, waiting for the space watermark between attempts
+                    auto deadline = std::chrono::steady_clock::now()
+                        + std::chrono::milliseconds(FlowControl::DSD_MAX_WAIT_MS);
+                    size_t sent = m_direttaSync->sendAudio(dsdData, dsdSamples);
+
+                    while (sent == 0) {
+                        auto now = std::chrono::steady_clock::now();
+                        if (now >= deadline) break;
+                        bool ready = m_direttaSync->waitForSpace(dsdSamples,
+                            std::chrono::duration_cast<std::chrono::microseconds>(deadline - now));
+                        sent = m_direttaSync->sendAudio(dsdData, dsdSamples);
+                        if (!ready) break;  // Timed out or stopping
+                    }
+
                     if (sent == 0) {
                         std::cerr << "[Callback] DSD timeout" << std::endl;
+                    } else if (!m_fanOut.empty()) {
+                        sendToFollowers(dsdData, dsdSamples, true, format.sampleRate, channels, 0);
                     }
                 } else {
                     // PCM: Incremental send with hybrid flow control
@@ -283,23 +427,40 @@ bool DirettaRenderer::start() {
                     float bufferLevel = m_direttaSync->getBufferLevel();
                     bool criticalMode = (bufferLevel < FlowControl::CRITICAL_BUFFER_LEVEL);
 
-                    int retryCount = 0;
+                    const auto maxWait = std::chrono::milliseconds(FlowControl::MAX_WAIT_MS);
+                    auto deadline = std::chrono::steady_clock::now() + maxWait;
 
-                    while (remainingSamples > 0 && retryCount < FlowControl::MAX_RETRIES) {
+                    while (remainingSamples > 0) {
                         size_t sent = m_direttaSync->sendAudio(audioData, remainingSamples);
 
                         if (sent > 0) {
                             size_t samplesConsumed = sent / bytesPerSample;
+                            if (!m_fanOut.empty()) {
+                                sendToFollowers(audioData, samplesConsumed, false, sampleRate,
+                                                channels, bytesPerSample);
+                            }
                             remainingSamples -= samplesConsumed;
                             audioData += sent;
-                            retryCount = 0;
-                        } else {
-                            if (criticalMode) {
-                                DEBUG_LOG("[Audio] Early-return, buffer critical: " << bufferLevel);
-                                break;
-                            }
-                            std::this_thread::sleep_for(std::chrono::microseconds(FlowControl::MICROSLEEP_US));
-                            retryCount++;
+                            deadline = std::chrono::steady_clock::now() + maxWait;
+                            continue;
+                        }
+
+                        if (criticalMode) {
+                            DEBUG_LOG("[Audio] Early-return, buffer critical: " << bufferLevel);
+                            break;
+                        }
+
+                        // Budget is per stall: only MAX_WAIT_MS without progress drops the rest
+                        auto now = std::chrono::steady_clock::now();
+                        if (now >= deadline) break;
+                        // Sleep until the consumer frees room for the rest of the chunk.
+                        // The wait refuses at once while the sink is not online yet
+                        // (or stopping): retry on a short sleep until the budget runs out
+                        if (!m_direttaSync->waitForSpace(remainingSamples,
+                                std::chrono::duration_cast<std::chrono::microseconds>(deadline - now))) {
+                            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                                std::chrono::microseconds(FlowControl::MICROSLEEP_US),
+                                deadline - std::chrono::steady_clock::now()));
                         }
                     }
                 }
@@ -308,6 +469,38 @@ bool DirettaRenderer::start() {
             }
         );
 
+        // Bit-perfect PCM: the decoder copies frames straight into the ring,
+        // once the target plays the same format. Anything else (first chunk
+        // of a track, format change, modulation, gain, fan-out followers,
+        // full ring) declines here and goes through the audio callback above
+        if (m_fanOut.empty()) {
+            m_audioEngine->setDirectWriteCallback(
+                [this, track = TrackSnapshot()](size_t maxFrames, uint32_t sampleRate, uint32_t bitDepth,
+                                                uint32_t channels,
+                                                const AudioDecoder::DirectFill& fill) mutable -> size_t {
+                    m_callbackRunning.store(true, std::memory_order_seq_cst);
+                    struct Guard {
+                        std::atomic<bool>& flag;
+                        ~Guard() { flag.store(false, std::memory_order_release); }
+                    } guard{m_callbackRunning};
+                    if (m_shutdownRequested.load(std::memory_order_seq_cst)) return 0;
+                    if (!m_direttaSync->isPlaying()) return 0;
+
+                    // Decoding thread's own snapshot, reloaded only on a new version
+                    if (!track || track->version != m_audioEngine->trackVersion()) {
+                        track = m_audioEngine->trackSnapshot();
+                    }
+                    const AudioFormat& current = m_direttaSync->getFormat();
+                    if (current.isDSD || current.sampleRate != sampleRate || current.bitDepth != bitDepth ||
+                        current.channels != channels ||
+                        current.isCompressed != track->value.info.isCompressed) {
+                        return 0;
+                    }
+                    size_t bytesPerFrame = ((bitDepth == 24 || bitDepth == 32) ? 4 : bitDepth / 8) * channels;
+                    return m_direttaSync->writeDirect(maxFrames, bytesPerFrame, fill);
+                });
+        }
+
         //=====================================================================
         // Track Change Callback
         //=====================================================================
@@ -324,6 +517,8 @@ bool DirettaRenderer::start() {
                     std::cout << "/" << info.channels << "ch" << std::endl;
                 }
 
+                setTrackReplayGain(info);
+
                 m_upnp->setCurrentURI(uri);
                 m_upnp->setCurrentMetadata(metadata);
                 m_upnp->notifyTrackChange(uri, metadata);
@@ -331,13 +526,28 @@ bool DirettaRenderer::start() {
             }
         );
 
+        // Seek lands sample-accurately: only the stale ring tail has to go
+        m_audioEngine->setSeekCallback([this](double /*seconds*/) {
+            if (m_direttaSync && m_direttaSync->isOpen()) {
+                m_direttaSync->discardForSeek();
+            }
+            for (auto& follower : m_fanOut) {
+                if (follower->sync->isOpen()) follower->sync->discardForSeek();
+                follower->slip.reset();
+            }
+        });
+
         m_audioEngine->setTrackEndCallback([this]() {
             std::cout << "[DirettaRenderer] 🏁 Track ended naturally" << std::endl;
 
             // Stop Diretta playback to prevent underrun log spam
             // This sets m_stopRequested which outputs silence instead of logging underruns
-            if (m_direttaSync) {
+            // (not for a fast format switch: the ring keeps draining into open())
+            bool keepDraining = m_direttaSync && m_direttaSync->fastFormatSwitchEnabled() &&
+                                m_audioEngine->isFormatTransition();
+            if (m_direttaSync && !keepDraining) {
                 m_direttaSync->stopPlayback(true);
+                for (auto& follower : m_fanOut) follower->sync->stopPlayback(true);
             }
 
             // Notify control point that track finished
@@ -378,6 +588,9 @@ bool DirettaRenderer::start() {
                     m_direttaSync->stopPlayback(true);
                     // m_direttaSync->close();  // Removed
                 }
+                for (auto& follower : m_fanOut) {
+                    if (follower->sync->isOpen()) follower->sync->stopPlayback(true);
+                }
 
                 m_upnp->notifyStateChange("STOPPED");
             }
@@ -404,6 +617,9 @@ bool DirettaRenderer::start() {
             if (m_direttaSync && m_direttaSync->isOpen() && m_direttaSync->isPaused()) {
                 DEBUG_LOG("[DirettaRenderer] Resuming from pause");
                 m_direttaSync->resumePlayback();
+                for (auto& follower : m_fanOut) {
+                    if (follower->sync->isPaused()) follower->sync->resumePlayback();
+                }
                 m_audioEngine->play();
                 m_upnp->notifyStateChange("PLAYING");
                 return;
@@ -415,14 +631,28 @@ bool DirettaRenderer::start() {
                 m_audioEngine->setCurrentURI(m_currentURI, m_currentMetadata, true);
             }
 
+            if (m_direttaSync) m_direttaSync->startupTimeline().begin();
+
             // DAC stabilization delay
             auto now = std::chrono::steady_clock::now();
             auto timeSinceStop = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastStopTime);
-            if (timeSinceStop.count() < 100) {
+            if (m_config.fastStart) {
+                // Bring the sink up for the announced format while the track
+                // opens during the delay, then wait out only the rest
+                warmUpSink();
+                m_audioEngine->prepare();
+                auto settled = m_lastStopTime + std::chrono::milliseconds(100);
+                if (timeSinceStop.count() < 100 && std::chrono::steady_clock::now() < settled) {
+                    std::this_thread::sleep_until(settled);
+                }
+            } else if (timeSinceStop.count() < 100) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(100));
             }
 
             m_audioEngine->play();
+            if (m_direttaSync) {
+                m_direttaSync->startupTimeline().mark(StartupTimeline::Phase::DecoderOpen);
+            }
             m_upnp->notifyStateChange("PLAYING");
         };
 
@@ -436,6 +666,9 @@ bool DirettaRenderer::start() {
             if (m_direttaSync && m_direttaSync->isPlaying()) {
                 m_direttaSync->pausePlayback();
             }
+            for (auto& follower : m_fanOut) {
+                if (follower->sync->isPlaying()) follower->sync->pausePlayback();
+            }
             m_upnp->notifyStateChange("PAUSED_PLAYBACK");
         };
 
@@ -460,6 +693,7 @@ bool DirettaRenderer::start() {
                 m_direttaSync->stopPlayback(true);
                 // m_direttaSync->close();  // Removed - keep connection open
             }
+            for (auto& follower : m_fanOut) follower->sync->stopPlayback(true);
 
             m_upnp->notifyStateChange("STOPPED");
         };
@@ -474,6 +708,12 @@ bool DirettaRenderer::start() {
             }
         };
 
+        if (m_config.softVolume) {
+            callbacks.onVolume = [this](int volume, bool mute) {
+                setVolumeState(volume, mute);
+            };
+        }
+
         m_upnp->setCallbacks(callbacks);
 
         // Start UPnP server
@@ -482,6 +722,10 @@ bool DirettaRenderer::start() {
             return false;
         }
 
+        std::cout << "[DirettaRenderer] Advertised after "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - startTime).count()
+                  << "ms (target " << (cachedTarget ? "from cache" : "discovered") << ")" << std::endl;
         DEBUG_LOG("[DirettaRenderer] UPnP: " << m_upnp->getDeviceURL());
 
         // Start threads
@@ -518,6 +762,9 @@ void DirettaRenderer::stop() {
     if (m_direttaSync) {
         m_direttaSync->disable();
     }
+    for (auto& follower : m_fanOut) {
+        follower->sync->disable();
+    }
 
     if (m_upnp) {
         m_upnp->stop();
@@ -536,6 +783,7 @@ void DirettaRenderer::stop() {
 
 void DirettaRenderer::upnpThreadFunc() {
     DEBUG_LOG("[UPnP Thread] Started");
+    ThreadPlacement::apply(ThreadPlacement::Role::UPnP);
 
     while (m_running) {
         std::this_thread::sleep_for(std::chrono::seconds(1));
@@ -553,6 +801,7 @@ size_t DirettaRenderer::selectChunkSize(uint32_t sampleRate, bool isDSD) const {
 
 void DirettaRenderer::audioThreadFunc() {
     DEBUG_LOG("[Audio Thread] Started");
+    ThreadPlacement::apply(ThreadPlacement::Role::Audio);
 
     using Clock = std::chrono::steady_clock;
 
@@ -560,6 +809,7 @@ void DirettaRenderer::audioThreadFunc() {
     size_t currentChunk = 0;
     uint32_t lastSampleRate = 0;
     std::chrono::microseconds period{0};
+    TrackSnapshot track;  // Reloaded only when the engine publishes a new one
 
     while (m_running) {
         if (!m_audioEngine) {
@@ -576,8 +826,11 @@ void DirettaRenderer::audioThreadFunc() {
             continue;
         }
 
-        const auto& trackInfo = m_audioEngine->getCurrentTrackInfo();
-        uint32_t sampleRate = trackInfo.sampleRate;
+        if (!track || track->version != m_audioEngine->trackVersion()) {
+            track = m_audioEngine->trackSnapshot();
+        }
+        const TrackInfo& trackInfo = track->value.info;
+        uint32_t sampleRate = track->value.outputRate;  // Upsampled rate if configured
 
         if (sampleRate == 0) {
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
@@ -599,8 +852,19 @@ void DirettaRenderer::audioThreadFunc() {
                       << ", period=" << period.count() << "us");
         }
 
-        // Steady cadence: process then sleep until next wake
-        m_audioEngine->process(currentChunk);
+        bool produced = m_audioEngine->process(currentChunk);
+
+        // Event-driven while streaming: wake when the consumer has freed
+        // room for the next chunk rather than on a fixed timer. The period
+        // bounds the wait. A refused wait (draining, stopping, sink not yet
+        // online) returns at once, so it falls back to the steady cadence.
+        if (produced && m_direttaSync && m_direttaSync->isOpen() &&
+            m_direttaSync->waitForSpace(currentChunk, period * 2)) {
+            nextWake = Clock::now();
+            continue;
+        }
+
+        // Steady cadence: sleep until next wake
 
         nextWake += period;
         auto now = Clock::now();
@@ -615,10 +879,197 @@ void DirettaRenderer::audioThreadFunc() {
     DEBUG_LOG("[Audio Thread] Stopped");
 }
 
+//=============================================================================
+// Software gain
+//=============================================================================
+
+namespace {
+
+// UPnP 0-100 -> linear: 0.5 dB per step below 100 (50 = -25 dB), 0 = silence
+float volumeToGain(int volume, bool mute) {
+    if (mute || volume <= 0) return 0.0f;
+    if (volume >= 100) return 1.0f;
+    return std::pow(10.0f, (static_cast<float>(volume) - 100.0f) * 0.5f / 20.0f);
+}
+
+// Tagged gain + preamp, limited by the tagged peak so the boost never clips.
+// A missing album gain falls back to the track gain and vice versa; untagged
+// tracks play at unity.
+float replayGainFor(const TrackInfo& info, DirettaRenderer::ReplayGainMode mode, float preampDb) {
+    if (mode == DirettaRenderer::ReplayGainMode::Off || info.isDSD) return 1.0f;
+
+    bool album = (mode == DirettaRenderer::ReplayGainMode::Album && info.hasAlbumGain) ||
+                 !info.hasTrackGain;
+    if (album && !info.hasAlbumGain) return 1.0f;
+
+    float gainDb = (album ? info.albumGainDb : info.trackGainDb) + preampDb;
+    float peak = album ? info.albumPeak : info.trackPeak;
+    float gain = std::pow(10.0f, gainDb / 20.0f);
+    if (peak > 0.0f) gain = std::min(gain, 1.0f / peak);
+    return gain;
+}
+
+} // namespace
+
+void DirettaRenderer::setVolumeState(int volume, bool mute) {
+    std::lock_guard<std::mutex> lock(m_gainMutex);
+    m_volume = volume;
+    m_mute = mute;
+    applyGain();
+}
+
+void DirettaRenderer::setTrackReplayGain(const TrackInfo& info) {
+    if (m_config.replayGain == ReplayGainMode::Off) return;
+    std::lock_guard<std::mutex> lock(m_gainMutex);
+    m_replayGain = replayGainFor(info, m_config.replayGain, m_config.replayGainPreampDb);
+    DEBUG_LOG("[DirettaRenderer] ReplayGain: " << (20.0f * std::log10(std::max(m_replayGain, 1e-6f)))
+              << " dB" << (info.hasTrackGain || info.hasAlbumGain ? "" : " (untagged)"));
+    applyGain();
+}
+
+// Caller holds m_gainMutex
+void DirettaRenderer::applyGain() {
+    if (!m_direttaSync) return;
+    float volume = m_config.softVolume ? volumeToGain(m_volume, m_mute) : 1.0f;
+    m_direttaSync->setGain(volume * m_replayGain);
+    for (auto& follower : m_fanOut) follower->sync->setGain(volume * m_replayGain);
+}
+
+void DirettaRenderer::warmUpSink() {
+    // PCM -> DSD output depends on the modulator the callback builds
+    if (!m_direttaSync || m_direttaSync->isOpen() || m_config.pcmToDsd > 0) {
+        return;
+    }
+    TrackInfo announced;
+    if (!AudioEngine::announcedTrackInfo(m_currentMetadata, announced)) {
+        return;
+    }
+    AudioFormat format(m_audioEngine->outputRateFor(announced),
+                       m_audioEngine->outputBitsFor(announced), announced.channels);
+    format.isCompressed = announced.isCompressed;
+    if (!m_direttaSync->warmUp(format)) {
+        return;
+    }
+    for (auto& follower : m_fanOut) {
+        follower->sync->warmUp(format);
+    }
+}
+
+bool DirettaRenderer::prepareDsdModulator(uint32_t sampleRate, uint32_t channels) {
+    if (m_dsdModulator && m_dsdModulator->inputRate() == sampleRate &&
+        m_dsdModulator->channels() == channels) {
+        return m_dsdModulator->valid();
+    }
+
+    m_dsdModulator = std::make_unique<DsdModulator>(static_cast<uint32_t>(m_config.pcmToDsd),
+                                                    sampleRate, channels);
+    if (!m_dsdModulator->valid()) {
+        std::cerr << "[DirettaRenderer] PCM->DSD not available for " << sampleRate
+                  << "Hz, sending PCM" << std::endl;
+        return false;
+    }
+    std::cout << "[DirettaRenderer] PCM->DSD" << m_config.pcmToDsd << ": " << sampleRate << "Hz/"
+              << channels << "ch -> " << m_dsdModulator->dsdRate() << "Hz" << std::endl;
+    return true;
+}
+
+void DirettaRenderer::reportDsdHeadroom() const {
+    // Stereo from 44.1 kHz on this machine: pick the highest rate well above 1x
+    double selected = 0.0;
+    std::cout << "[DirettaRenderer] PCM->DSD real-time factor (stereo):";
+    for (uint32_t multiple : {64u, 128u, 256u}) {
+        double factor = DsdModulator::benchmark(multiple, 2);
+        if (static_cast<int>(multiple) == m_config.pcmToDsd) selected = factor;
+        std::cout << " DSD" << multiple << " " << std::fixed << std::setprecision(1) << factor << "x";
+    }
+    std::cout << std::defaultfloat << std::endl;
+
+    if (selected < 1.5) {
+        std::cerr << "[DirettaRenderer] WARNING: DSD" << m_config.pcmToDsd
+                  << " has little CPU headroom here (" << selected << "x real-time)" << std::endl;
+    }
+}
+
+void DirettaRenderer::sendToFollowers(const uint8_t* data, size_t samples, bool dsd, uint32_t rate,
+                                      uint32_t channels, size_t bytesPerFrame) {
+    // Slip units: frames, or 32-bit groups per channel for DSD (samples = bits per channel)
+    size_t units = dsd ? samples / 32 : samples;
+    double unitsPerMs = dsd ? rate / 32000.0 : rate / 1000.0;
+    double chunkMs = units / unitsPerMs;
+    double primaryMs = m_direttaSync->getBufferedMs();
+
+    for (auto& follower : m_fanOut) {
+        if (!follower->sync->isOpen()) continue;
+        // Compare as if this chunk were already queued, like the primary's
+        long slip = follower->slip.update(follower->sync->getBufferedMs() + chunkMs, primaryMs,
+                                          units, unitsPerMs);
+        size_t count = samples;
+        const uint8_t* out = dsd
+            ? FanOut::slipDsdPlanar(data, count, static_cast<int>(channels), slip, follower->staging)
+            : FanOut::slipPcm(data, count, bytesPerFrame, slip, follower->staging);
+        // Never waits: a follower without room loses the chunk and slips back in
+        follower->sync->sendAudio(out, count);
+    }
+}
+
+void DirettaRenderer::dumpStats() {
+    if (!m_direttaSync) return;
+    std::cout << "[Stats] " << m_direttaSync->statsJson() << std::endl;
+    for (size_t i = 0; i < m_fanOut.size(); i++) {
+        std::cout << "[Stats] {\"fanout\":" << i << ",\"slip\":" << m_fanOut[i]->slip.json()
+                  << ",\"sync\":" << m_fanOut[i]->sync->statsJson() << "}" << std::endl;
+    }
+    if (m_config.pcmToDsd > 0) {
+        std::cout << "[Stats] " << DsdModulator::statsJson() << std::endl;
+    }
+    if (m_config.readAheadMB > 0) {
+        std::cout << "[Stats] " << ReadAheadIO::statsJson() << std::endl;
+    }
+    if (m_config.trackCacheMB > 0) {
+        std::cout << "[Stats] " << TrackCache::statsJson() << std::endl;
+    }
+}
+
+void DirettaRenderer::dumpTrace() {
+    Trace::Recorder& recorder = Trace::Recorder::instance();
+    // Keep the previous dump: the interesting underrun is not always the last one
+    std::rename(m_config.traceFile.c_str(), (m_config.traceFile + ".1").c_str());
+    long records = recorder.dump(m_config.traceFile);
+    if (records < 0) {
+        std::cerr << "[Trace] Failed to write " << m_config.traceFile << std::endl;
+    } else {
+        std::cout << "[Trace] Dump on " << Trace::freezeReasonName(recorder.reason())
+                  << ": " << records << " events written to " << m_config.traceFile
+                  << " (inspect with trace_analyze)" << std::endl;
+    }
+    recorder.thaw();
+}
+
 void DirettaRenderer::positionThreadFunc() {
     DEBUG_LOG("[Position Thread] Started");
+    ThreadPlacement::apply(ThreadPlacement::Role::Position);
+
+    auto lastStats = std::chrono::steady_clock::now();
 
     while (m_running) {
+        // Telemetry: periodic (--stats) or on demand (SIGUSR1)
+        auto now = std::chrono::steady_clock::now();
+        bool statsDue = m_config.statsIntervalSec > 0 &&
+                        now - lastStats >= std::chrono::seconds(m_config.statsIntervalSec);
+        if (statsDue || m_statsRequested.exchange(false, std::memory_order_relaxed)) {
+            dumpStats();
+            lastStats = now;
+        }
+
+        // Trace dump asked for by an underrun or SIGUSR2
+        if (Trace::Recorder::instance().dumpDue()) {
+            dumpTrace();
+        }
+
+        if (m_direttaSync && m_direttaSync->startupTimeline().takeReport()) {
+            std::cout << "[Startup] " << m_direttaSync->startupTimeline().json() << std::endl;
+        }
+
         if (!m_audioEngine || !m_upnp) {
             std::this_thread::sleep_for(std::chrono::seconds(1));
             continue;
@@ -630,7 +1081,8 @@ void DirettaRenderer::positionThreadFunc() {
             double positionSeconds = m_audioEngine->getPosition();
             int position = static_cast<int>(positionSeconds);
 
-            const auto& trackInfo = m_audioEngine->getCurrentTrackInfo();
+            TrackSnapshot track = m_audioEngine->trackSnapshot();
+            const TrackInfo& trackInfo = track->value.info;
             int duration = 0;
             if (trackInfo.sampleRate > 0) {
                 duration = trackInfo.duration / trackInfo.sampleRate;
@@ -16,22 +16,56 @@
 #include <condition_variable>
 #include <chrono>
 #include <iostream>
+#include <vector>
+
+#include "FanOut.h"
 
 // Forward declarations
 class UPnPDevice;
 class AudioEngine;
 class DirettaSync;
+class DsdModulator;
 struct AudioFormat;
+struct TrackInfo;
 
 class DirettaRenderer {
 public:
+    enum class ReplayGainMode { Off, Track, Album };
+
+    struct Upsample {
+        uint32_t rate = 0;    // Output rate for the family, 0 = off (bit-perfect)
+        bool native = true;   // Polyphase engine, false = libswresample
+    };
+
     struct Config {
         std::string name = "Diretta UPnP Renderer";
         int port = 49152;
         std::string uuid;
         bool gaplessEnabled = true;
+        bool decodeAhead = false;      // Decode on a worker thread ahead of the feed
+        int readAheadMB = 0;           // Network read-ahead per stream (MB), 0 = off
+        int trackCacheMB = 0;          // Whole-track RAM cache budget (MB), 0 = off
+        bool fastFormatSwitch = false; // Reconfigure Diretta in place on format change
+        bool fastStart = false;        // Overlap sink bring-up with decode/prefill on Play
+        bool adaptiveBuffer = false;   // Ring depth/prefill follow measured source jitter
+        int adaptiveMinMs = 60;
+        int adaptiveMaxMs = 1000;
+        bool autoTune = false;         // Probe cycle time/transfer mode at startup
+        std::string tuningFile = "/var/lib/diretta-renderer/tuning.conf";  // Empty = off
+        bool softVolume = false;       // Apply UPnP Volume/Mute as PCM gain
+        ReplayGainMode replayGain = ReplayGainMode::Off;
+        float replayGainPreampDb = 0.0f;
+        Upsample upsample44;           // Sources at multiples of 44.1 kHz
+        Upsample upsample48;           // Sources at multiples of 48 kHz
+        int pcmToDsd = 0;              // Send PCM as DSD64/128/256, 0 = off
+        int statsIntervalSec = 0;      // Periodic "[Stats]" telemetry dump, 0 = off
+        bool hugePages = false;        // 2 MiB pages for the Diretta ring
+        bool lockMemory = false;       // mlock audio buffers
         int targetIndex = -1;  // -1 = interactive, >= 0 = specific
         std::string networkInterface;  // Empty = auto-detect
+        std::vector<int> fanOutTargets;  // Extra target indices fed from the same decoder
+        std::string targetCacheFile = "/var/lib/diretta-renderer/target.cache";  // Empty = always discover
+        std::string traceFile = "/var/lib/diretta-renderer/trace.bin";  // Empty = no trace recording
 
         Config();
     };
@@ -44,6 +78,9 @@ public:
 
     bool isRunning() const { return m_running; }
 
+    // Ask for one "[Stats]" telemetry dump (async-signal-safe, e.g. SIGUSR1)
+    void requestStatsDump() { m_statsRequested.store(true, std::memory_order_relaxed); }
+
 private:
     // Thread functions
     void audioThreadFunc();
@@ -61,6 +98,16 @@ private:
     std::unique_ptr<AudioEngine> m_audioEngine;
     std::unique_ptr<DirettaSync> m_direttaSync;
 
+    // Fan-out followers (--fan-out): same audio as m_direttaSync, slip-compensated
+    struct FanOutTarget {
+        std::unique_ptr<DirettaSync> sync;
+        SlipControl slip;
+        std::vector<uint8_t> staging;
+    };
+    std::vector<std::unique_ptr<FanOutTarget>> m_fanOut;
+    void sendToFollowers(const uint8_t* data, size_t samples, bool dsd, uint32_t rate,
+                         uint32_t channels, size_t bytesPerFrame);
+
     // Threads
     std::thread m_audioThread;
     std::thread m_upnpThread;
@@ -78,12 +125,41 @@ private:
     std::atomic<bool> m_callbackRunning{false};
     std::atomic<bool> m_shutdownRequested{false};
 
+    // Telemetry dump (position thread)
+    std::atomic<bool> m_statsRequested{false};
+    void dumpStats();
+    void dumpTrace();
+
     // DAC stabilization timing
     std::chrono::steady_clock::time_point m_lastStopTime;
 
+    // Fast start: sink bring-up for the current track's DIDL format,
+    // started before the decoder opens (UPnP thread, under m_mutex)
+    void warmUpSink();
+
     // Quantized chunk size selection (replaces adaptive sizing)
     size_t selectChunkSize(uint32_t sampleRate, bool isDSD) const;
 
     // Track URI for gapless S24 hint updates
     std::string m_lastProcessedURI;
+
+    // Software gain: UPnP volume x ReplayGain, pushed to DirettaSync
+    void setVolumeState(int volume, bool mute);
+    void setTrackReplayGain(const TrackInfo& info);
+    void applyGain();
+    std::mutex m_gainMutex;
+    int m_volume = 100;
+    bool m_mute = false;
+    float m_replayGain = 1.0f;   // Linear, current track
+
+    // PCM -> DSD conversion (audio callback only, see Config::pcmToDsd)
+    std::unique_ptr<DsdModulator> m_dsdModulator;
+    std::vector<uint8_t> m_dsdBuffer;
+    bool prepareDsdModulator(uint32_t sampleRate, uint32_t channels);
+    void reportDsdHeadroom() const;
+
+    // Sink format built from one track snapshot (audio callback only):
+    // rebuilt and checked against the sink only when the version moves
+    struct CallbackFormat;
+    std::unique_ptr<CallbackFormat> m_callbackFormat;
 };
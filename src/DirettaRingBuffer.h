@@ -18,12 +18,71 @@
 #include <cstdlib>
 #include <new>
 #include <type_traits>
-#include <immintrin.h>
-#include "memcpyfast_audio.h"
+#include <chrono>
+#include <thread>
+#include <string>
+#include "AudioKernels.h"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#endif
 
 // Maximum ring buffer size for zero-copy SDK 148 support
 static constexpr size_t RING_BUFFER_SIZE = 1024 * 1024;  // 1MB
 
+/**
+ * @brief Page policy for the ring and its staging buffers
+ *
+ * Every field is a request; DirettaRingBuffer::memoryDescription() reports
+ * what was granted (huge pages need a hugetlb pool or shmem THP, mlock needs
+ * RLIMIT_MEMLOCK or CAP_IPC_LOCK).
+ */
+struct RingMemoryPolicy {
+    bool hugePages = false;   // 2 MiB pages (hugetlbfs memfd, else THP advice)
+    bool lockMemory = false;  // mlock so the callback never takes a major fault
+    bool prefault = true;     // Populate page tables at resize, not on first touch
+};
+
+namespace RingMemory {
+
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+inline bool lock(const void* ptr, size_t len) {
+#if defined(__linux__)
+    return len == 0 || mlock(ptr, len) == 0;
+#else
+    (void)ptr; (void)len;
+    return false;
+#endif
+}
+
+inline void unlock(const void* ptr, size_t len) {
+#if defined(__linux__)
+    if (len) munlock(ptr, len);
+#else
+    (void)ptr; (void)len;
+#endif
+}
+
+// madvise needs a page-aligned start: advise the huge-page-aligned interior
+inline bool adviseHugePages(void* ptr, size_t len) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    uintptr_t begin = (reinterpret_cast<uintptr_t>(ptr) + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+    uintptr_t end = (reinterpret_cast<uintptr_t>(ptr) + len) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+    if (end <= begin) return false;
+    return madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE) == 0;
+#else
+    (void)ptr; (void)len;
+    return false;
+#endif
+}
+
+} // namespace RingMemory
+
 template <typename T, size_t Alignment>
 class AlignedAllocator {
 public:
@@ -92,10 +151,19 @@ bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<T,
  * - 24-bit packing (4 bytes in -> 3 bytes out)
  * - 16-bit to 32-bit upsampling
  * - DSD planar-to-interleaved conversion with optional bit reversal
+ *
+ * Mirrored mode (Linux, default): the same physical pages are mapped twice
+ * back to back (memfd + mmap), so data_[i] and data_[i + size] alias and
+ * every read/write region is contiguous - no split copies around the wrap.
+ * Falls back to a plain aligned allocation if the mapping is unavailable.
  */
 class DirettaRingBuffer {
 public:
     DirettaRingBuffer() = default;
+    ~DirettaRingBuffer() { releaseStorage(); }
+
+    DirettaRingBuffer(const DirettaRingBuffer&) = delete;
+    DirettaRingBuffer& operator=(const DirettaRingBuffer&) = delete;
 
     /**
      * @brief Resize buffer and set silence byte
@@ -103,7 +171,7 @@ public:
     void resize(size_t newSize, uint8_t silenceByte) {
         size_ = roundUpPow2(newSize);
         mask_ = size_ - 1;
-        buffer_.resize(size_);
+        allocateStorage(size_);
         silenceByte_.store(silenceByte, std::memory_order_release);
         clear();
         fillWithSilence();
@@ -111,6 +179,39 @@ public:
     }
 
     size_t size() const { return size_; }
+
+    /**
+     * @brief Select mirrored (double-mapped) storage; applies on next resize()
+     */
+    void setMirrorMode(bool enabled) {
+        m_mirrorWanted = enabled;
+        m_policyDirty = true;
+    }
+    bool isMirrored() const { return m_mirrored; }
+
+    /**
+     * @brief Set page/lock policy; storage is reallocated on next resize()
+     */
+    void setMemoryPolicy(const RingMemoryPolicy& policy) {
+        m_policy = policy;
+        m_policyDirty = true;
+        if (policy.lockMemory) lockStaging();
+    }
+
+    /**
+     * @brief What the kernel actually granted, e.g. "hugetlb mlock prefault"
+     */
+    std::string memoryDescription() const {
+        std::string desc = m_hugeGranted == HugeGrant::HugeTlb ? "hugetlb"
+                         : m_hugeGranted == HugeGrant::Advised ? "thp-advised" : "4k";
+        if (m_policy.lockMemory) {
+            desc += (m_locked && m_stagingLocked) ? " mlock" : " mlock-denied";
+        }
+        if (m_policy.prefault) desc += " prefault";
+        if (m_storageReused) desc += " reused";
+        return desc;
+    }
+
     uint8_t silenceByte() const { return silenceByte_.load(std::memory_order_acquire); }
 
     size_t getAvailable() const {
@@ -140,12 +241,35 @@ public:
         m_s24Hint = S24PackMode::Unknown;
         m_s24DetectionConfirmed = false;
         m_deferredSampleCount = 0;
+        wakeSpaceWaiter();
+    }
+
+    /**
+     * @brief Producer side: drop queued data beyond the first keep bytes
+     *
+     * Retracts writePos towards readPos, so the next push continues right
+     * after the kept head (no prefill, no silence gap). Producer thread only.
+     * The consumer may still hold a region it read before the retract; it
+     * takes one buffer per callback, so keep must cover two buffers.
+     * @return Bytes dropped
+     */
+    size_t discardQueued(size_t keep) {
+        if (size_ == 0) return 0;
+        size_t wp = writePos_.load(std::memory_order_acquire);
+        size_t rp = readPos_.load(std::memory_order_acquire);
+        size_t avail = (wp - rp) & mask_;
+        if (avail <= keep) return 0;
+        writePos_.store((rp + keep) & mask_, std::memory_order_release);
+        return avail - keep;
     }
 
     void fillWithSilence() {
-        std::memset(buffer_.data(), silenceByte_.load(std::memory_order_relaxed), size_);
+        std::memset(data_, silenceByte_.load(std::memory_order_relaxed), size_);
     }
 
+    // Per-path conversion staging: bounds one converted push (output bytes)
+    static constexpr size_t STAGING_SIZE = 65536;
+
     const uint8_t* getStaging24BitPack() const { return m_staging24BitPack; }
     const uint8_t* getStaging16To32() const { return m_staging16To32; }
     const uint8_t* getStagingDSD() const { return m_stagingDSD; }
@@ -168,12 +292,12 @@ public:
         size_t rp = readPos_.load(std::memory_order_acquire);
 
         // Contiguous space from writePos to either readPos or end of buffer
-        size_t toEnd = size_ - wp;
+        // (mirrored: the whole free space is contiguous)
         size_t totalFree = (rp - wp - 1) & mask_;
-        size_t contiguous = std::min(toEnd, totalFree);
+        size_t contiguous = std::min(contiguousFrom(wp), totalFree);
 
         if (contiguous >= needed) {
-            region = buffer_.data() + wp;
+            region = data_ + wp;
             available = contiguous;
             return true;
         }
@@ -213,10 +337,10 @@ public:
 
         if (total < needed) return false;  // Underrun
 
-        size_t contiguous = std::min(size_ - rp, total);
-        if (contiguous < needed) return false;  // Wrap
+        size_t contiguous = std::min(contiguousFrom(rp), total);
+        if (contiguous < needed) return false;  // Wrap (never when mirrored)
 
-        region = buffer_.data() + rp;
+        region = data_ + rp;
         avail = contiguous;
         return true;
     }
@@ -232,6 +356,70 @@ public:
     void advanceReadPos(size_t bytes) {
         size_t rp = readPos_.load(std::memory_order_relaxed);
         readPos_.store((rp + bytes) & mask_, std::memory_order_release);
+        signalFreeSpace();
+    }
+
+    //=========================================================================
+    // Free-space watermark (event-driven producer)
+    //=========================================================================
+
+    /**
+     * @brief Block the producer until free space reaches a watermark
+     *
+     * The consumer checks the watermark each time it releases data
+     * (advanceReadPos/pop) and wakes the producer once it is crossed, so
+     * the producer wakes once per chunk of consumed data instead of
+     * polling on a timer. Single waiter only (the producer thread).
+     *
+     * Wakes that leave the watermark unmet (spurious, EINTR, a
+     * wakeSpaceWaiter() from another path) go back to sleep for the time
+     * left; only the deadline or @p abort ends the wait early.
+     *
+     * @param bytes Free bytes to wait for (clamped to capacity)
+     * @param timeout Upper bound on the wait
+     * @param abort Checked after every wake: true gives up (stop, reconfigure)
+     * @return true if at least @p bytes are free on return
+     */
+    template <typename Abort>
+    bool waitForFreeSpace(size_t bytes, std::chrono::microseconds timeout, Abort&& abort) {
+        if (size_ == 0) return false;
+        bytes = std::min(bytes, size_ - 1);
+        if (getFreeSpace() >= bytes) return true;
+        if (timeout.count() <= 0) return false;
+
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        m_spaceWatermark.store(bytes, std::memory_order_relaxed);
+        m_spaceWaiting.store(true, std::memory_order_relaxed);
+
+        while (!abort()) {
+            uint32_t seq = m_spaceSeq.load(std::memory_order_acquire);
+            // Pairs with the fence in signalFreeSpace(): either we see the
+            // consumer's new readPos here, or it sees m_spaceWaiting
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (getFreeSpace() >= bytes) break;
+
+            auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(
+                deadline - std::chrono::steady_clock::now());
+            if (remaining.count() <= 0) break;
+            futexWait(seq, remaining);
+        }
+        m_spaceWaiting.store(false, std::memory_order_relaxed);
+        return getFreeSpace() >= bytes;
+    }
+
+    bool waitForFreeSpace(size_t bytes, std::chrono::microseconds timeout) {
+        return waitForFreeSpace(bytes, timeout, [] { return false; });
+    }
+
+    /**
+     * @brief Wake a blocked producer regardless of free space
+     *
+     * Used on stop/reconfigure so the producer re-checks its abort
+     * condition instead of sitting out its timeout.
+     */
+    void wakeSpaceWaiter() {
+        m_spaceSeq.fetch_add(1, std::memory_order_release);
+        futexWake();
     }
 
     //=========================================================================
@@ -261,21 +449,84 @@ public:
         if (len > free) len = free;
         if (len == 0) return 0;
 
-        size_t firstChunk = std::min(len, size_ - wp);
-        memcpy_audio(buffer_.data() + wp, data, firstChunk);
+        size_t firstChunk = std::min(len, contiguousFrom(wp));
+        memcpy_audio(data_ + wp, data, firstChunk);
         if (firstChunk < len) {
-            memcpy_audio(buffer_.data(), data + firstChunk, len - firstChunk);
+            memcpy_audio(data_, data + firstChunk, len - firstChunk);
+        }
+
+        writePos_.store((wp + len) & mask_, std::memory_order_release);
+        return len;
+    }
+
+    // Sample widths pushWithGain() can scale
+    static bool gainSupported(size_t bytesPerSample) {
+        return bytesPerSample == 2 || bytesPerSample == 4;
+    }
+
+    /**
+     * @brief Push PCM with software gain (same layout as push())
+     * @param bytesPerSample 2 (gain + TPDF dither) or 4 (gain only)
+     * @return Input bytes consumed (whole samples)
+     *
+     * Scales straight into the ring; only a block straddling the wrap point
+     * goes through staging. Other widths (see gainSupported()) fall back to
+     * an unscaled push(), except that gain 0 still writes silence.
+     */
+    size_t pushWithGain(const uint8_t* data, size_t len, size_t bytesPerSample, float gain) {
+        if (size_ == 0) return 0;
+        if (!gainSupported(bytesPerSample)) {
+            if (gain != 0.0f || bytesPerSample == 0) return push(data, len);
+            return pushSilence(std::min(len, getFreeSpace()) / bytesPerSample * bytesPerSample);
         }
 
+        size_t numSamples = std::min(len, getFreeSpace()) / bytesPerSample;
+        if (numSamples == 0) return 0;
+
+        AudioKernels::GainFn scale = (bytesPerSample == 2)
+            ? AudioKernels::active().gain16
+            : AudioKernels::active().gain32;
+
+        size_t bytes = numSamples * bytesPerSample;
+        uint8_t* region;
+        size_t contiguous;
+        if (getDirectWriteRegion(bytes, region, contiguous)) {
+            scale(region, data, numSamples, gain, m_ditherIndex);
+            commitDirectWrite(bytes);
+        } else {
+            numSamples = std::min(numSamples, STAGING_SIZE / bytesPerSample);
+            bytes = numSamples * bytesPerSample;
+            scale(m_staging16To32, data, numSamples, gain, m_ditherIndex);
+            writeToRing(m_staging16To32, bytes);
+        }
+        m_ditherIndex += static_cast<uint32_t>(numSamples);
+        return bytes;
+    }
+
+    /**
+     * @brief Write len bytes of the silence byte, all or nothing (mute on
+     *        paths without a gain kernel)
+     * @return len, or 0 if it does not fit
+     */
+    size_t pushSilence(size_t len) {
+        if (size_ == 0 || len == 0 || len > getFreeSpace()) return 0;
+        uint8_t silence = silenceByte_.load(std::memory_order_relaxed);
+        size_t wp = writePos_.load(std::memory_order_relaxed);
+        size_t firstChunk = std::min(len, contiguousFrom(wp));
+        std::memset(data_ + wp, silence, firstChunk);
+        if (firstChunk < len) {
+            std::memset(data_, silence, len - firstChunk);
+        }
         writePos_.store((wp + len) & mask_, std::memory_order_release);
         return len;
     }
 
     /**
      * @brief Push with 24-bit packing (4 bytes in -> 3 bytes out, S24_P32 format)
+     * @param gain Software gain; 1.0 keeps the bit-exact pack kernels
      * @return Input bytes consumed
      */
-    size_t push24BitPacked(const uint8_t* data, size_t inputSize) {
+    size_t push24BitPacked(const uint8_t* data, size_t inputSize, float gain = 1.0f) {
         if (size_ == 0) return 0;
         size_t numSamples = inputSize / 4;
         if (numSamples == 0) return 0;
@@ -319,9 +570,18 @@ public:
             effectiveMode = (m_s24Hint != S24PackMode::Unknown) ? m_s24Hint : S24PackMode::LsbAligned;
         }
 
-        size_t stagedBytes = (effectiveMode == S24PackMode::MsbAligned)
-            ? convert24BitPackedShifted_AVX2(m_staging24BitPack, data, numSamples)
-            : convert24BitPacked_AVX2(m_staging24BitPack, data, numSamples);
+        const AudioKernels::Table& kernels = AudioKernels::active();
+        bool msbAligned = (effectiveMode == S24PackMode::MsbAligned);
+        size_t stagedBytes;
+        if (gain == 1.0f) {
+            stagedBytes = msbAligned
+                ? kernels.pack24Shifted(m_staging24BitPack, data, numSamples)
+                : kernels.pack24(m_staging24BitPack, data, numSamples);
+        } else {
+            stagedBytes = (msbAligned ? kernels.pack24ShiftedGain : kernels.pack24Gain)(
+                m_staging24BitPack, data, numSamples, gain, m_ditherIndex);
+            m_ditherIndex += static_cast<uint32_t>(numSamples);
+        }
         size_t written = writeToRing(m_staging24BitPack, stagedBytes);
         size_t samplesWritten = written / 3;
 
@@ -330,9 +590,10 @@ public:
 
     /**
      * @brief Push with 16-to-32 bit upsampling
+     * @param gain Software gain; 1.0 keeps the bit-exact shift kernel
      * @return Input bytes consumed
      */
-    size_t push16To32(const uint8_t* data, size_t inputSize) {
+    size_t push16To32(const uint8_t* data, size_t inputSize, float gain = 1.0f) {
         if (size_ == 0) return 0;
         size_t numSamples = inputSize / 2;
         if (numSamples == 0) return 0;
@@ -347,7 +608,9 @@ public:
 
         prefetch_audio_buffer(data, numSamples * 2);
 
-        size_t stagedBytes = convert16To32_AVX2(m_staging16To32, data, numSamples);
+        size_t stagedBytes = (gain == 1.0f)
+            ? AudioKernels::active().convert16To32(m_staging16To32, data, numSamples)
+            : AudioKernels::active().convert16To32Gain(m_staging16To32, data, numSamples, gain, 0);
         size_t written = writeToRing(m_staging16To32, stagedBytes);
         size_t samplesWritten = written / 4;
 
@@ -365,237 +628,51 @@ public:
      * @param numChannels Number of audio channels
      * @param bitReverseTable Lookup table for MSB<->LSB conversion (nullptr if not needed)
      * @param byteSwap If true, swap byte order within 4-byte groups (for LITTLE endian targets)
-     * @return Input bytes consumed
+     * @return Input bytes consumed (all or nothing)
+     *
+     * The planar stride is inputSize / numChannels, so a partial write cannot
+     * be expressed: returns 0 until the whole block fits. The common case
+     * converts straight into the ring; only a block straddling the wrap point
+     * goes through the staging buffer (blocks are one DSD_CHUNK, well under
+     * STAGING_SIZE).
      */
     size_t pushDSDPlanar(const uint8_t* data, size_t inputSize, int numChannels,
                          const uint8_t* bitReverseTable, bool byteSwap = false) {
         if (size_ == 0) return 0;
-        if (numChannels == 0) return 0;
+        if (numChannels <= 0) return 0;
 
-        size_t maxBytes = inputSize;
-        if (maxBytes > STAGING_SIZE) maxBytes = STAGING_SIZE;
-        size_t free = getFreeSpace();
-        if (maxBytes > free) maxBytes = free;
+        size_t channels = static_cast<size_t>(numChannels);
+        size_t bytesPerChannel = inputSize / channels;
+        if (bytesPerChannel == 0) return 0;
+        size_t usableInput = bytesPerChannel * channels;
 
-        size_t bytesPerChannel = maxBytes / static_cast<size_t>(numChannels);
-        size_t completeGroups = bytesPerChannel / 4;
-        size_t usableInput = completeGroups * 4 * static_cast<size_t>(numChannels);
-        if (usableInput == 0) return 0;
+        // A trailing partial 4-byte group (end of file only) is zero-padded by
+        // the scalar kernel; the SIMD kernels require whole groups
+        bool wholeGroups = (bytesPerChannel % 4) == 0;
+        size_t outputBytes = ((bytesPerChannel + 3) / 4) * 4 * channels;
+        if (outputBytes > getFreeSpace()) return 0;
 
         prefetch_audio_buffer(data, usableInput);
 
-        size_t stagedBytes = convertDSDPlanar_AVX2(
-            m_stagingDSD, data, usableInput, numChannels, bitReverseTable, byteSwap);
-        size_t written = writeToRing(m_stagingDSD, stagedBytes);
-
-        return written;
-    }
-
-    /**
-     * Convert S24_P32 to packed 24-bit using AVX2
-     * Input: 4 bytes per sample (24-bit in 32-bit container)
-     * Output: 3 bytes per sample (packed)
-     * Returns: number of output bytes written
-     */
-    size_t convert24BitPacked_AVX2(uint8_t* dst, const uint8_t* src, size_t numSamples) {
-        size_t outputBytes = 0;
-
-        static const __m256i shuffle_mask = _mm256_setr_epi8(
-            0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
-            0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1
-        );
-
-        size_t i = 0;
-        for (; i + 8 <= numSamples; i += 8) {
-            if (i + 16 <= numSamples) {
-                _mm_prefetch(reinterpret_cast<const char*>(src + (i + 16) * 4), _MM_HINT_T0);
-            }
-
-            __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
-            __m256i shuffled = _mm256_shuffle_epi8(in, shuffle_mask);
-
-            __m128i lo = _mm256_castsi256_si128(shuffled);
-            __m128i hi = _mm256_extracti128_si256(shuffled, 1);
-
-            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + outputBytes), lo);
-            uint32_t lo_tail;
-            std::memcpy(&lo_tail, reinterpret_cast<const char*>(&lo) + 8, 4);
-            std::memcpy(dst + outputBytes + 8, &lo_tail, 4);
-            outputBytes += 12;
-
-            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + outputBytes), hi);
-            uint32_t hi_tail;
-            std::memcpy(&hi_tail, reinterpret_cast<const char*>(&hi) + 8, 4);
-            std::memcpy(dst + outputBytes + 8, &hi_tail, 4);
-            outputBytes += 12;
-        }
-
-        for (; i < numSamples; i++) {
-            dst[outputBytes + 0] = src[i * 4 + 0];
-            dst[outputBytes + 1] = src[i * 4 + 1];
-            dst[outputBytes + 2] = src[i * 4 + 2];
-            outputBytes += 3;
-        }
-
-        _mm256_zeroupper();
-        return outputBytes;
-    }
-
-    size_t convert24BitPackedShifted_AVX2(uint8_t* dst, const uint8_t* src, size_t numSamples) {
-        size_t outputBytes = 0;
-
-        static const __m256i shuffle_mask = _mm256_setr_epi8(
-            1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1, -1, -1, -1,
-            1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1, -1, -1, -1
-        );
-
-        size_t i = 0;
-        for (; i + 8 <= numSamples; i += 8) {
-            if (i + 16 <= numSamples) {
-                _mm_prefetch(reinterpret_cast<const char*>(src + (i + 16) * 4), _MM_HINT_T0);
-            }
-
-            __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
-            __m256i shuffled = _mm256_shuffle_epi8(in, shuffle_mask);
-
-            __m128i lo = _mm256_castsi256_si128(shuffled);
-            __m128i hi = _mm256_extracti128_si256(shuffled, 1);
-
-            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + outputBytes), lo);
-            uint32_t lo_tail;
-            std::memcpy(&lo_tail, reinterpret_cast<const char*>(&lo) + 8, 4);
-            std::memcpy(dst + outputBytes + 8, &lo_tail, 4);
-            outputBytes += 12;
-
-            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + outputBytes), hi);
-            uint32_t hi_tail;
-            std::memcpy(&hi_tail, reinterpret_cast<const char*>(&hi) + 8, 4);
-            std::memcpy(dst + outputBytes + 8, &hi_tail, 4);
-            outputBytes += 12;
-        }
-
-        for (; i < numSamples; i++) {
-            dst[outputBytes + 0] = src[i * 4 + 1];
-            dst[outputBytes + 1] = src[i * 4 + 2];
-            dst[outputBytes + 2] = src[i * 4 + 3];
-            outputBytes += 3;
-        }
-
-        _mm256_zeroupper();
-        return outputBytes;
-    }
-
-    /**
-     * Convert 16-bit to 32-bit using AVX2
-     * Input: 2 bytes per sample (16-bit)
-     * Output: 4 bytes per sample (16-bit value in upper 16 bits)
-     * Returns: number of output bytes written
-     */
-    size_t convert16To32_AVX2(uint8_t* dst, const uint8_t* src, size_t numSamples) {
-        size_t outputBytes = 0;
-
-        size_t i = 0;
-        for (; i + 16 <= numSamples; i += 16) {
-            __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2));
-            __m256i zero = _mm256_setzero_si256();
-
-            __m256i lo = _mm256_unpacklo_epi16(zero, in);
-            __m256i hi = _mm256_unpackhi_epi16(zero, in);
+        AudioKernels::DSDPlanarFn convert = wholeGroups
+            ? AudioKernels::active().dsdPlanar
+            : AudioKernels::convertDSDPlanar_Scalar;
 
-            __m256i out0 = _mm256_permute2x128_si256(lo, hi, 0x20);
-            __m256i out1 = _mm256_permute2x128_si256(lo, hi, 0x31);
-
-            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + outputBytes), out0);
-            outputBytes += 32;
-            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + outputBytes), out1);
-            outputBytes += 32;
-        }
-
-        for (; i < numSamples; i++) {
-            dst[outputBytes + 0] = 0x00;
-            dst[outputBytes + 1] = 0x00;
-            dst[outputBytes + 2] = src[i * 2 + 0];
-            dst[outputBytes + 3] = src[i * 2 + 1];
-            outputBytes += 4;
+        uint8_t* region;
+        size_t contiguous;
+        if (getDirectWriteRegion(outputBytes, region, contiguous)) {
+            convert(region, data, usableInput, numChannels, bitReverseTable, byteSwap);
+            commitDirectWrite(outputBytes);
+            return usableInput;
         }
 
-        _mm256_zeroupper();
-        return outputBytes;
-    }
-
-    /**
-     * Convert DSD planar to interleaved using AVX2 (stereo only)
-     * Input: [L channel bytes][R channel bytes] planar
-     * Output: [4B L][4B R][4B L][4B R]... interleaved
-     * Falls back to scalar for non-stereo
-     */
-    size_t convertDSDPlanar_AVX2(
-        uint8_t* dst,
-        const uint8_t* src,
-        size_t totalInputBytes,
-        int numChannels,
-        const uint8_t* bitReversalTable,
-        bool needByteSwap
-    ) {
-        size_t bytesPerChannel = totalInputBytes / static_cast<size_t>(numChannels);
-        size_t outputBytes = 0;
-
-        if (numChannels == 2) {
-            const uint8_t* srcL = src;
-            const uint8_t* srcR = src + bytesPerChannel;
-
-            static const __m256i byteswap_mask = _mm256_setr_epi8(
-                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
-                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
-            );
-
-            size_t i = 0;
-            for (; i + 32 <= bytesPerChannel; i += 32) {
-                __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcL + i));
-                __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcR + i));
-
-                if (bitReversalTable) {
-                    left = simd_bit_reverse(left);
-                    right = simd_bit_reverse(right);
-                }
-
-                __m256i interleaved_lo = _mm256_unpacklo_epi32(left, right);
-                __m256i interleaved_hi = _mm256_unpackhi_epi32(left, right);
-
-                if (needByteSwap) {
-                    interleaved_lo = _mm256_shuffle_epi8(interleaved_lo, byteswap_mask);
-                    interleaved_hi = _mm256_shuffle_epi8(interleaved_hi, byteswap_mask);
-                }
-
-                __m256i out0 = _mm256_permute2x128_si256(interleaved_lo, interleaved_hi, 0x20);
-                __m256i out1 = _mm256_permute2x128_si256(interleaved_lo, interleaved_hi, 0x31);
-
-                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + outputBytes), out0);
-                outputBytes += 32;
-                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + outputBytes), out1);
-                outputBytes += 32;
-            }
+        if (outputBytes > STAGING_SIZE) return 0;
 
-            for (; i + 4 <= bytesPerChannel; i += 4) {
-                for (int j = 0; j < 4; j++) {
-                    uint8_t b = srcL[i + j];
-                    if (bitReversalTable) b = bitReversalTable[b];
-                    dst[outputBytes++] = b;
-                }
-                for (int j = 0; j < 4; j++) {
-                    uint8_t b = srcR[i + j];
-                    if (bitReversalTable) b = bitReversalTable[b];
-                    dst[outputBytes++] = b;
-                }
-            }
+        size_t stagedBytes = convert(m_stagingDSD, data, usableInput, numChannels,
+                                     bitReverseTable, byteSwap);
+        writeToRing(m_stagingDSD, stagedBytes);
 
-            _mm256_zeroupper();
-        } else {
-            outputBytes = convertDSDPlanar_Scalar(dst, src, totalInputBytes, numChannels,
-                                                  bitReversalTable, needByteSwap);
-        }
-
-        return outputBytes;
+        return usableInput;
     }
 
     //=========================================================================
@@ -617,27 +694,176 @@ public:
         if (len == 0) return 0;
 
         // rp already loaded, reuse directly
-        size_t firstChunk = std::min(len, size_ - rp);
+        size_t firstChunk = std::min(len, contiguousFrom(rp));
 
-        memcpy_audio(dest, buffer_.data() + rp, firstChunk);
+        memcpy_audio(dest, data_ + rp, firstChunk);
         if (firstChunk < len) {
-            memcpy_audio(dest + firstChunk, buffer_.data(), len - firstChunk);
+            memcpy_audio(dest + firstChunk, data_, len - firstChunk);
         }
 
         readPos_.store((rp + len) & mask_, std::memory_order_release);
+        signalFreeSpace();
         return len;
     }
 
-    uint8_t* data() { return buffer_.data(); }
-    const uint8_t* data() const { return buffer_.data(); }
+    uint8_t* data() { return data_; }
+    const uint8_t* data() const { return data_; }
 
 private:
+    /**
+     * Consumer side of the watermark: one fence and a relaxed load when
+     * nobody is waiting, a futex wake only when the watermark is crossed
+     */
+    void signalFreeSpace() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!m_spaceWaiting.load(std::memory_order_relaxed)) return;
+        if (getFreeSpace() < m_spaceWatermark.load(std::memory_order_relaxed)) return;
+        wakeSpaceWaiter();
+    }
+
+    void futexWait(uint32_t expected, std::chrono::microseconds timeout) {
+#if defined(__linux__)
+        struct timespec ts;
+        ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000);
+        ts.tv_nsec = static_cast<long>((timeout.count() % 1000000) * 1000);
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_spaceSeq),
+                FUTEX_WAIT_PRIVATE, expected, &ts, nullptr, 0);
+#else
+        // No futex: bounded short sleeps, still re-checking the sequence
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (m_spaceSeq.load(std::memory_order_acquire) == expected &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::microseconds(250));
+        }
+#endif
+    }
+
+    void futexWake() {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_spaceSeq),
+                FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+    }
+
+    // Bytes that can be addressed linearly from pos
+    size_t contiguousFrom(size_t pos) const {
+        return m_mirrored ? size_ : size_ - pos;
+    }
+
+    void allocateStorage(size_t size) {
+        // Same size and policy: keep the locked, prefaulted pages
+        if (data_ && size == m_storageSize && !m_policyDirty) {
+            m_storageReused = true;
+            return;
+        }
+        releaseStorage();
+        m_policyDirty = false;
+        m_storageReused = false;
+        m_hugeGranted = HugeGrant::None;
+
+        if (m_mirrorWanted &&
+            ((m_policy.hugePages && mapMirror(size, true)) || mapMirror(size, false))) {
+            buffer_.clear();
+            buffer_.shrink_to_fit();
+        } else {
+            buffer_.resize(size);  // Capacity survives format changes
+            data_ = buffer_.data();
+            if (m_policy.hugePages && RingMemory::adviseHugePages(data_, size)) {
+                m_hugeGranted = HugeGrant::Advised;
+            }
+        }
+        m_storageSize = size;
+
+        if (m_policy.lockMemory) {
+            // Both views of a mirror: mlock also populates the second half's page tables
+            m_locked = RingMemory::lock(data_, m_mirrored ? size * 2 : size);
+        }
+    }
+
+    void releaseStorage() {
+        if (m_locked && !m_mirrored) {
+            RingMemory::unlock(data_, m_storageSize);
+        }
+        m_locked = false;
+#if defined(__linux__)
+        if (m_mirrored) {
+            munmap(m_mapBase, m_mapLength);  // Drops the mlock with the mapping
+        }
+#endif
+        m_mirrored = false;
+        m_mapBase = nullptr;
+        m_mapLength = 0;
+        m_storageSize = 0;
+        data_ = nullptr;
+    }
+
+    bool mapMirror(size_t size, bool hugetlb) {
+#if defined(__linux__) && defined(SYS_memfd_create)
+        long page = sysconf(_SC_PAGESIZE);
+        size_t granule = hugetlb ? RingMemory::HUGE_PAGE_SIZE : static_cast<size_t>(page);
+        if (page <= 0 || size % granule != 0) return false;
+
+        unsigned int flags = 1U /* MFD_CLOEXEC */ | (hugetlb ? 4U /* MFD_HUGETLB */ : 0U);
+        int fd = static_cast<int>(syscall(SYS_memfd_create, "diretta-ring", flags));
+        if (fd < 0) return false;
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            close(fd);
+            return false;
+        }
+
+        // Reserve 2x address space (plus alignment slack for huge pages),
+        // then map the memfd into both halves
+        size_t slack = hugetlb ? granule : 0;
+        void* base = mmap(nullptr, size * 2 + slack, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        uintptr_t aligned = (reinterpret_cast<uintptr_t>(base) + slack) & ~(uintptr_t)(granule - 1);
+        if (!hugetlb) aligned = reinterpret_cast<uintptr_t>(base);
+        uint8_t* lo = reinterpret_cast<uint8_t*>(aligned);
+
+        int mapFlags = MAP_SHARED | MAP_FIXED | (m_policy.prefault ? MAP_POPULATE : 0);
+        void* first = mmap(lo, size, PROT_READ | PROT_WRITE, mapFlags, fd, 0);
+        void* second = (first == lo)
+            ? mmap(lo + size, size, PROT_READ | PROT_WRITE, mapFlags, fd, 0)
+            : MAP_FAILED;
+        close(fd);  // Mappings keep the pages alive
+
+        if (first != lo || second != lo + size) {
+            munmap(base, size * 2 + slack);
+            return false;
+        }
+        if (!hugetlb && m_policy.hugePages) {
+            // shmem THP only when shmem_enabled allows "advise"
+            if (madvise(lo, size * 2, MADV_HUGEPAGE) == 0) m_hugeGranted = HugeGrant::Advised;
+        }
+        if (hugetlb) m_hugeGranted = HugeGrant::HugeTlb;
+        data_ = lo;
+        m_mapBase = base;
+        m_mapLength = size * 2 + slack;
+        m_mirrored = true;
+        return true;
+#else
+        (void)size;
+        (void)hugetlb;
+        return false;
+#endif
+    }
+
+    void lockStaging() {
+        if (m_stagingLocked) return;
+        m_stagingLocked = RingMemory::lock(m_staging24BitPack, STAGING_SIZE) &&
+                          RingMemory::lock(m_staging16To32, STAGING_SIZE) &&
+                          RingMemory::lock(m_stagingDSD, STAGING_SIZE);
+    }
+
     /**
      * Write staged data to ring buffer with efficient wraparound handling
      * Uses memcpy_audio_fixed for consistent timing
      */
     size_t writeToRing(const uint8_t* staged, size_t len) {
-        size_t size = buffer_.size();
+        size_t size = size_;
         if (size == 0 || len == 0) return 0;
 
         size_t writePos = writePos_.load(std::memory_order_relaxed);
@@ -652,8 +878,8 @@ private:
         }
         if (len == 0) return 0;
 
-        uint8_t* ring = buffer_.data();
-        size_t firstChunk = std::min(len, size - writePos);
+        uint8_t* ring = data_;
+        size_t firstChunk = std::min(len, contiguousFrom(writePos));
 
         if (firstChunk > 0) {
             memcpy_audio_fixed(ring + writePos, staged, firstChunk);
@@ -670,61 +896,6 @@ private:
         return len;
     }
 
-    size_t convertDSDPlanar_Scalar(
-        uint8_t* dst,
-        const uint8_t* src,
-        size_t totalInputBytes,
-        int numChannels,
-        const uint8_t* bitReversalTable,
-        bool needByteSwap
-    ) {
-        size_t bytesPerChannel = totalInputBytes / static_cast<size_t>(numChannels);
-        size_t outputBytes = 0;
-
-        for (size_t i = 0; i < bytesPerChannel; i += 4) {
-            for (int ch = 0; ch < numChannels; ch++) {
-                uint8_t group[4] = {0, 0, 0, 0};
-                for (int j = 0; j < 4 && (i + static_cast<size_t>(j)) < bytesPerChannel; j++) {
-                    uint8_t b = src[static_cast<size_t>(ch) * bytesPerChannel + i + static_cast<size_t>(j)];
-                    if (bitReversalTable) b = bitReversalTable[b];
-                    group[j] = b;
-                }
-
-                if (needByteSwap) {
-                    dst[outputBytes++] = group[3];
-                    dst[outputBytes++] = group[2];
-                    dst[outputBytes++] = group[1];
-                    dst[outputBytes++] = group[0];
-                } else {
-                    dst[outputBytes++] = group[0];
-                    dst[outputBytes++] = group[1];
-                    dst[outputBytes++] = group[2];
-                    dst[outputBytes++] = group[3];
-                }
-            }
-        }
-
-        return outputBytes;
-    }
-
-    static __m256i simd_bit_reverse(__m256i x) {
-        static const __m256i nibble_reverse = _mm256_setr_epi8(
-            0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE,
-            0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF,
-            0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE,
-            0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF
-        );
-
-        __m256i mask_0f = _mm256_set1_epi8(0x0F);
-        __m256i lo_nibbles = _mm256_and_si256(x, mask_0f);
-        __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi16(x, 4), mask_0f);
-
-        __m256i lo_reversed = _mm256_shuffle_epi8(nibble_reverse, lo_nibbles);
-        __m256i hi_reversed = _mm256_shuffle_epi8(nibble_reverse, hi_nibbles);
-
-        return _mm256_or_si256(_mm256_slli_epi16(lo_reversed, 4), hi_reversed);
-    }
-
     static size_t roundUpPow2(size_t value) {
         if (value < 2) {
             return 2;
@@ -736,20 +907,43 @@ private:
         return result;
     }
 
-    static constexpr size_t STAGING_SIZE = 65536;
     alignas(64) uint8_t m_staging24BitPack[STAGING_SIZE];
     alignas(64) uint8_t m_staging16To32[STAGING_SIZE];
     alignas(64) uint8_t m_stagingDSD[STAGING_SIZE];
 
     static constexpr size_t kRingAlignment = 64;
 
-    std::vector<uint8_t, AlignedAllocator<uint8_t, kRingAlignment>> buffer_;
+    std::vector<uint8_t, AlignedAllocator<uint8_t, kRingAlignment>> buffer_;  // Fallback storage
+    uint8_t* data_ = nullptr;       // Ring base (mirror mapping or buffer_)
+    bool m_mirrorWanted = true;
+    bool m_mirrored = false;
+    void* m_mapBase = nullptr;      // Mirror reservation (for munmap)
+    size_t m_mapLength = 0;
+    size_t m_storageSize = 0;
+
+    // Memory policy requested vs granted
+    enum class HugeGrant { None, Advised, HugeTlb };
+    RingMemoryPolicy m_policy;
+    bool m_policyDirty = false;
+    bool m_storageReused = false;
+    bool m_locked = false;
+    bool m_stagingLocked = false;
+    uint32_t m_ditherIndex = 0;     // Producer-only: sample index for the gain kernels' TPDF dither
+    HugeGrant m_hugeGranted = HugeGrant::None;
     size_t size_ = 0;
     size_t mask_ = 0;
     alignas(64) std::atomic<size_t> writePos_{0};
     alignas(64) std::atomic<size_t> readPos_{0};
     std::atomic<uint8_t> silenceByte_{0};
 
+    // Free-space watermark state (own cache line: written by the producer
+    // only when it blocks, read by the consumer on every release)
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                  "futex word must be a plain 32-bit integer");
+    alignas(64) std::atomic<uint32_t> m_spaceSeq{0};
+    std::atomic<bool> m_spaceWaiting{false};
+    std::atomic<size_t> m_spaceWatermark{0};
+
 public:
     enum class S24PackMode { Unknown, LsbAligned, MsbAligned, Deferred };
 
@@ -8,10 +8,20 @@
 
 #include "DirettaSync.h"
 #include "AudioTiming.h"
+#include "ThreadPlacement.h"
+#include "TraceRecorder.h"
 #include <stdexcept>
 #include <iomanip>
+#include <type_traits>
 
 namespace {
+// Fields a sink configuration depends on (the DSD bit order does not count)
+bool sameSinkFormat(const AudioFormat& a, const AudioFormat& b) {
+    return a.sampleRate == b.sampleRate && a.bitDepth == b.bitDepth &&
+           a.channels == b.channels && a.isDSD == b.isDSD &&
+           a.isCompressed == b.isCompressed;
+}
+
 class RingAccessGuard {
 public:
     RingAccessGuard(std::atomic<int>& users, const std::atomic<bool>& reconfiguring)
@@ -43,6 +53,41 @@ private:
     std::atomic<int>& users_;
     bool active_;
 };
+
+// AdaptiveDepth time base
+uint64_t steadyMicros(std::chrono::steady_clock::time_point t) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count());
+}
+
+// The primary and every --fan-out follower read-modify-write the same
+// target cache and tuning files: one writer at a time, merged with the file
+std::mutex& stateFileMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+// Target cache: the SDK address is stored as its raw bytes when it is a
+// plain value type (otherwise there is no cache and every start discovers).
+// A stale or foreign address is caught by the background revalidation.
+std::string encodeAddress(const ACQUA::IPAddress& address) {
+    if constexpr (std::is_trivially_copyable<ACQUA::IPAddress>::value) {
+        return TargetCache::toHex(&address, sizeof(address));
+    } else {
+        return std::string();
+    }
+}
+
+bool decodeAddress(const std::string& hex, ACQUA::IPAddress& address) {
+    if constexpr (std::is_trivially_copyable<ACQUA::IPAddress>::value) {
+        ACQUA::IPAddress decoded;
+        if (!TargetCache::fromHex(hex, &decoded, sizeof(decoded))) return false;
+        address = decoded;
+        return true;
+    } else {
+        return false;
+    }
+}
 } // namespace
 
 //=============================================================================
@@ -95,23 +140,64 @@ bool DirettaSync::enable(const DirettaConfig& config) {
     m_config = config;
     DIRETTA_LOG("Enabling...");
 
-    if (!discoverTarget()) {
-        DIRETTA_LOG("Failed to discover target");
-        return false;
+    RingMemoryPolicy memPolicy;
+    memPolicy.hugePages = config.hugePages;
+    memPolicy.lockMemory = config.lockMemory;
+    m_ringBuffer.setMemoryPolicy(memPolicy);
+
+    if (config.adaptiveBuffer) {
+        m_depth.configure(config.adaptiveMinMs, config.adaptiveMaxMs);
+        DIRETTA_LOG("Adaptive buffer: " << config.adaptiveMinMs << "-" << config.adaptiveMaxMs
+                    << " ms, starting at " << m_depth.targetMs() << " ms");
     }
 
-    if (!measureMTU()) {
-        DIRETTA_LOG("MTU measurement failed, using fallback");
+    // Bind copy/conversion kernels for this CPU before any audio thread runs
+    AudioKernels::init();
+
+    bool fastStart = m_cacheHit;
+    if (fastStart) {
+        // Address set by loadTargetCache(); Find and the MTU probe run in the background
+        m_targetName = m_cachedTarget.name;
+        if (m_mtuOverride > 0 || config.mtu > 0) {
+            measureMTU();
+        } else {
+            m_effectiveMTU = m_cachedTarget.mtu;
+        }
+        std::cout << "[DirettaSync] Cached target '" << m_targetName << "', MTU " << m_effectiveMTU
+                  << " (revalidating in background)" << std::endl;
+    } else {
+        if (!discoverTarget()) {
+            DIRETTA_LOG("Failed to discover target");
+            return false;
+        }
+
+        if (!measureMTU()) {
+            DIRETTA_LOG("MTU measurement failed, using fallback");
+        }
     }
 
     m_calculator = std::make_unique<DirettaCycleCalculator>(m_effectiveMTU);
 
-    if (!openSyncConnection()) {
+    if (!config.tuningFile.empty()) {
+        if (!m_tuning.load(config.tuningFile)) {
+            std::cerr << "[DirettaSync] Cannot read tuning file " << config.tuningFile << std::endl;
+        } else if (m_tuning.size() > 0) {
+            DIRETTA_LOG("Loaded " << m_tuning.size() << " tuning entries from " << config.tuningFile);
+        }
+    }
+
+    if (!openSyncConnection(!fastStart)) {
         DIRETTA_LOG("Failed to open sync connection");
         return false;
     }
 
     m_enabled = true;
+    if (fastStart) {
+        m_targetStale = false;
+        m_validationThread = std::thread(&DirettaSync::revalidateTarget, this);
+    } else {
+        saveTargetCache();
+    }
     DIRETTA_LOG("Enabled, MTU=" << m_effectiveMTU);
     return true;
 }
@@ -119,6 +205,14 @@ bool DirettaSync::enable(const DirettaConfig& config) {
 void DirettaSync::disable() {
     DIRETTA_LOG("Disabling...");
 
+    {
+        std::lock_guard<std::mutex> lock(m_validationMutex);
+        if (m_validationThread.joinable()) {
+            m_validationThread.join();
+        }
+    }
+    awaitSinkStart();
+
     if (m_open) {
         close();
     }
@@ -134,7 +228,7 @@ void DirettaSync::disable() {
     DIRETTA_LOG("Disabled");
 }
 
-bool DirettaSync::openSyncConnection() {
+bool DirettaSync::openSyncConnection(bool inquireSink) {
     ACQUA::Clock cycleTime = ACQUA::Clock::MicroSeconds(m_config.cycleTime);
 
     DIRETTA_LOG("Opening DIRETTA::Sync with threadMode=" << m_config.threadMode);
@@ -156,10 +250,12 @@ bool DirettaSync::openSyncConnection() {
         return false;
     }
 
-    inquirySupportFormat(m_targetAddress);
+    if (inquireSink) {
+        inquirySupportFormat(m_targetAddress);
 
-    if (g_verbose) {
-        logSinkCapabilities();
+        if (g_verbose) {
+            logSinkCapabilities();
+        }
     }
 
     return true;
@@ -196,15 +292,18 @@ bool DirettaSync::discoverTarget() {
     if (results.size() == 1 || m_targetIndex == 0) {
         auto it = results.begin();
         m_targetAddress = it->first;
+        m_targetName = it->second.targetName;
         DIRETTA_LOG("Selected: " << it->second.targetName);
     } else if (m_targetIndex > 0 && m_targetIndex < static_cast<int>(results.size())) {
         auto it = results.begin();
         std::advance(it, m_targetIndex);
         m_targetAddress = it->first;
+        m_targetName = it->second.targetName;
         DIRETTA_LOG("Selected target #" << (m_targetIndex + 1));
     } else {
         auto it = results.begin();
         m_targetAddress = it->first;
+        m_targetName = it->second.targetName;
         DIRETTA_LOG("Selected first target: " << it->second.targetName);
     }
 
@@ -305,6 +404,101 @@ void DirettaSync::logSinkCapabilities() {
     std::cout << "[DirettaSync]   DSD MSB: " << (info.checkSinkSupportDSDmsb() ? "YES" : "NO") << std::endl;
 }
 
+//=============================================================================
+// Target Cache (fast start)
+//=============================================================================
+
+bool DirettaSync::loadTargetCache(const std::string& path, const std::string& iface) {
+    m_targetCachePath = path;
+    m_targetCacheIface = iface;
+    m_cacheHit = false;
+    if (path.empty()) return false;
+
+    if (!m_targetCache.load(path)) {
+        std::cerr << "[DirettaSync] Cannot read target cache " << path << std::endl;
+        return false;
+    }
+    const TargetCache::Entry* entry = m_targetCache.find(iface, m_targetIndex);
+    if (!entry || !decodeAddress(entry->address, m_targetAddress)) return false;
+
+    m_cachedTarget = *entry;
+    m_cacheHit = true;
+    return true;
+}
+
+void DirettaSync::saveTargetCache() {
+    if (m_targetCachePath.empty()) return;
+
+    TargetCache::Entry entry;
+    entry.iface = m_targetCacheIface;
+    entry.index = m_targetIndex;
+    entry.name = m_targetName;
+    entry.address = encodeAddress(m_targetAddress);
+    entry.mtu = m_effectiveMTU;
+    if (entry.address.empty()) return;
+
+    // Reload first: keep the entries other instances wrote since our load
+    std::lock_guard<std::mutex> lock(stateFileMutex());
+    m_targetCache.load(m_targetCachePath);
+    m_targetCache.set(entry);
+    if (!m_targetCache.save(m_targetCachePath)) {
+        DIRETTA_LOG("Cannot write target cache " << m_targetCachePath);
+    }
+}
+
+void DirettaSync::revalidateTarget() {
+    // Owns the target fields until joined by awaitTargetValidation()
+    auto start = std::chrono::steady_clock::now();
+    const TargetCache::Entry cached = m_cachedTarget;
+
+    if (!discoverTarget()) {
+        std::cerr << "[DirettaSync] Cached target '" << cached.name
+                  << "' not found, full discovery on first open" << std::endl;
+        m_targetStale.store(true, std::memory_order_release);
+        return;
+    }
+    if (m_targetName != cached.name || encodeAddress(m_targetAddress) != cached.address) {
+        std::cout << "[DirettaSync] Target changed since last run: '" << cached.name
+                  << "' -> '" << m_targetName << "'" << std::endl;
+    }
+
+    uint32_t cachedMTU = m_effectiveMTU;
+    measureMTU();
+    if (m_effectiveMTU != cachedMTU) {
+        std::cout << "[DirettaSync] MTU changed since last run: " << cachedMTU
+                  << " -> " << m_effectiveMTU << std::endl;
+        m_calculator = std::make_unique<DirettaCycleCalculator>(m_effectiveMTU);
+    }
+
+    inquirySupportFormat(m_targetAddress);
+    if (g_verbose) {
+        logSinkCapabilities();
+    }
+
+    saveTargetCache();
+    DIRETTA_LOG("Target revalidated in " << std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count() << "ms");
+}
+
+bool DirettaSync::awaitTargetValidation() {
+    {
+        std::lock_guard<std::mutex> lock(m_validationMutex);
+        if (m_validationThread.joinable()) {
+            m_validationThread.join();
+        }
+    }
+    if (!m_targetStale.load(std::memory_order_acquire)) return true;
+
+    std::cout << "[DirettaSync] Rediscovering target..." << std::endl;
+    if (!discoverTarget()) return false;
+    measureMTU();
+    m_calculator = std::make_unique<DirettaCycleCalculator>(m_effectiveMTU);
+    inquirySupportFormat(m_targetAddress);
+    m_targetStale = false;
+    saveTargetCache();
+    return true;
+}
+
 //=============================================================================
 // Open/Close (Connection Management)
 //=============================================================================
@@ -315,23 +509,50 @@ bool DirettaSync::open(const AudioFormat& format) {
     std::cout << "[DirettaSync] Format: " << format.sampleRate << "Hz/"
               << format.bitDepth << "bit/" << format.channels << "ch "
               << (format.isDSD ? "DSD" : "PCM") << std::endl;
+    Trace::record(Trace::Event::FormatChange, format.isDSD ? 1 : 0, format.sampleRate,
+                  format.bitDepth, format.channels);
 
     if (!m_enabled) {
         std::cerr << "[DirettaSync] ERROR: Not enabled" << std::endl;
         return false;
     }
 
+    // A warm-up for this format is already configured: its bring-up keeps
+    // running while the caller prefills
+    bool warm = m_warm.exchange(false, std::memory_order_acq_rel);
+    if (warm && m_open && !m_sinkStartFailed.load(std::memory_order_acquire) &&
+        sameSinkFormat(m_currentFormat, format)) {
+        std::cout << "[DirettaSync] ========== OPEN COMPLETE (warm-up adopted) ==========" << std::endl;
+        return true;
+    }
+
+    // A fast-start sink bring-up still in flight finishes first. A failed
+    // warm-up is not this open's failure: it starts from scratch below
+    awaitSinkStart();
+    if (m_sinkStartFailed.exchange(false, std::memory_order_acq_rel) && !warm) {
+        std::cerr << "[DirettaSync] ERROR: Sink bring-up failed" << std::endl;
+        return false;
+    }
+    m_startup.mark(StartupTimeline::Phase::SinkOpen);
+
+    if (!awaitTargetValidation()) {
+        std::cerr << "[DirettaSync] ERROR: Diretta target not found" << std::endl;
+        return false;
+    }
+
     bool newIsDsd = format.isDSD;
     bool needFullConnect = true;  // Whether we need connectPrepare/connect/connectWait
 
+    // Format switch timing (reported per transition type at OPEN COMPLETE)
+    auto openStart = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration drainTime{0};
+    bool formatSwitch = false;
+    AudioFormat switchFrom;
+
     // Fast path: Already open with same format - just reset buffer and resume
     // This avoids the expensive setSink/connect sequence for same-format track transitions
     if (m_open && m_hasPreviousFormat) {
-        bool sameFormat = (m_previousFormat.sampleRate == format.sampleRate &&
-                          m_previousFormat.bitDepth == format.bitDepth &&
-                          m_previousFormat.channels == format.channels &&
-                          m_previousFormat.isDSD == format.isDSD &&
-                          m_previousFormat.isCompressed == format.isCompressed);
+        bool sameFormat = sameSinkFormat(m_previousFormat, format);
 
         std::cout << "[DirettaSync]   Previous: " << m_previousFormat.sampleRate << "Hz/"
                   << m_previousFormat.bitDepth << "bit/" << m_previousFormat.channels << "ch"
@@ -364,15 +585,34 @@ bool DirettaSync::open(const AudioFormat& format) {
             m_stopRequested = false;
             m_draining = false;
             m_silenceBuffersRemaining = 0;
+            invalidateConsumerState();
             play();
             m_playing = true;
             m_paused = false;
+            // Sink configuration reused: sink_configured stays unstamped
+            m_startup.mark(StartupTimeline::Phase::RingReady);
+            m_startup.mark(StartupTimeline::Phase::Online);
             std::cout << "[DirettaSync] ========== OPEN COMPLETE (quick) ==========" << std::endl;
             return true;
+        } else if (m_config.fastFormatSwitch) {
+            // Fast format switch: connection stays online. Play out what is
+            // queued, stop the stream, then only the sink format and ring
+            // geometry are reconfigured below (no setSink/connect from scratch)
+            std::cout << "[DirettaSync] Format change - fast switch (connection kept)" << std::endl;
+            formatSwitch = true;
+            switchFrom = m_previousFormat;
+
+            auto drainStart = std::chrono::steady_clock::now();
+            drainForFormatSwitch();
+            drainTime = std::chrono::steady_clock::now() - drainStart;
+
+            needFullConnect = false;
         } else {
             // Format change - need full reopen for reliable Target reconfiguration
             // Some Targets need DIRETTA::Sync to be fully closed and reopened
             std::cout << "[DirettaSync] Format change - full reopen" << std::endl;
+            formatSwitch = true;
+            switchFrom = m_previousFormat;
             if (!reopenForFormatChange()) {
                 std::cerr << "[DirettaSync] Failed to reopen for format change" << std::endl;
                 return false;
@@ -381,10 +621,8 @@ bool DirettaSync::open(const AudioFormat& format) {
         }
     }
 
-    // Full reset for first open or after format change reopen
-    if (needFullConnect) {
-        fullReset();
-    }
+    // Reset format/consumer state (first open, full reopen and fast switch alike)
+    fullReset();
     m_isDsdMode.store(newIsDsd, std::memory_order_release);
 
     uint32_t effectiveSampleRate;
@@ -413,10 +651,96 @@ bool DirettaSync::open(const AudioFormat& format) {
 
         configureRingPCM(format.sampleRate, format.channels, direttaBps, inputBps, format.isCompressed);
     }
+    m_startup.mark(StartupTimeline::Phase::RingReady);
 
     unsigned int cycleTimeUs = calculateCycleTime(effectiveSampleRate, effectiveChannels, bitsPerSample);
+    DirettaTransferMode transferMode = m_config.transferMode;
+    applyTuning(effectiveSampleRate, newIsDsd, cycleTimeUs, transferMode);
+    m_lastCycleTimeUs = cycleTimeUs;
     ACQUA::Clock cycleTime = ACQUA::Clock::MicroSeconds(cycleTimeUs);
 
+    if (m_config.fastStart) {
+        // Fast start: the ring takes pushes now, so decode and prefill run
+        // while the sink comes up on m_sinkStartThread. The producer only
+        // blocks (waitForSpace) once the ring is full
+        m_previousFormat = format;
+        m_hasPreviousFormat = true;
+        m_currentFormat = format;
+        m_open = true;
+        m_playing = true;
+        m_paused = false;
+        m_sinkStarting.store(true, std::memory_order_release);
+
+        std::lock_guard<std::mutex> lock(m_sinkStartMutex);
+        m_sinkStartThread = std::thread([this, format, needFullConnect, cycleTime, transferMode,
+                                         formatSwitch, switchFrom, openStart, drainTime]() {
+            // Spawned from the audio callback: drop its RT placement
+            ThreadPlacement::apply(ThreadPlacement::Role::Main);
+            bool started = connectSink(needFullConnect, cycleTime, transferMode, true);
+            if (started) {
+                if (formatSwitch) {
+                    recordFormatSwitch(switchFrom, format, !needFullConnect,
+                                       std::chrono::steady_clock::now() - openStart, drainTime);
+                }
+                std::cout << "[DirettaSync] Sink online after "
+                          << std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::steady_clock::now() - openStart).count()
+                          << "ms (fast start)" << std::endl;
+            } else {
+                // Back to a closed connection: the next open() reports the
+                // failure, the one after that starts from scratch
+                m_playing = false;
+                stop();
+                disconnect(true);
+                m_open = false;
+                m_hasPreviousFormat = false;
+                m_sinkStartFailed.store(true, std::memory_order_release);
+            }
+            m_sinkStarting.store(false, std::memory_order_release);
+            m_ringBuffer.wakeSpaceWaiter();
+        });
+
+        std::cout << "[DirettaSync] ========== OPEN COMPLETE (sink starting) ==========" << std::endl;
+        return true;
+    }
+
+    if (!connectSink(needFullConnect, cycleTime, transferMode, false)) {
+        return false;
+    }
+
+    // Save format state
+    m_previousFormat = format;
+    m_hasPreviousFormat = true;
+    m_currentFormat = format;
+
+    m_open = true;
+    m_playing = true;
+    m_paused = false;
+
+    if (formatSwitch) {
+        recordFormatSwitch(switchFrom, format, !needFullConnect,
+                           std::chrono::steady_clock::now() - openStart, drainTime);
+    }
+
+    std::cout << "[DirettaSync] ========== OPEN COMPLETE ==========" << std::endl;
+    return true;
+}
+
+bool DirettaSync::warmUp(const AudioFormat& format) {
+    if (!m_config.fastStart || !m_enabled || m_open) {
+        return false;
+    }
+    std::cout << "[DirettaSync] Warm-up: " << format.sampleRate << "Hz/"
+              << format.bitDepth << "bit/" << format.channels << "ch" << std::endl;
+    if (!open(format)) {
+        return false;
+    }
+    m_warm.store(true, std::memory_order_release);
+    return true;
+}
+
+bool DirettaSync::connectSink(bool needFullConnect, ACQUA::Clock cycleTime,
+                              DirettaTransferMode transferMode, bool prefilling) {
     // Initial delay - Target needs time to prepare for new format
     // Longer delay for first open/reconnect, shorter for reconfigure
     int initialDelayMs = needFullConnect ? 500 : 200;
@@ -438,8 +762,9 @@ bool DirettaSync::open(const AudioFormat& format) {
         std::cerr << "[DirettaSync] Failed to set sink after " << maxAttempts << " attempts" << std::endl;
         return false;
     }
+    m_startup.mark(StartupTimeline::Phase::SinkConfigured);
 
-    applyTransferMode(m_config.transferMode, cycleTime);
+    applyTransferMode(transferMode, cycleTime);
 
     // Connect sequence - only needed after disconnect
     if (needFullConnect) {
@@ -471,35 +796,118 @@ bool DirettaSync::open(const AudioFormat& format) {
         DIRETTA_LOG("Skipping connect sequence (still connected)");
     }
 
-    // Clear buffer and start playback
-    m_ringBuffer.clear();
-    m_prefillComplete = false;
+    // Clear buffer and start playback (fast start: keep what was prefilled meanwhile)
+    if (!prefilling) {
+        m_ringBuffer.clear();
+        m_prefillComplete = false;
+    }
     m_postOnlineDelayDone = false;
+    invalidateConsumerState();
 
     play();
 
     if (!waitForOnline(m_config.onlineWaitMs)) {
         DIRETTA_LOG("WARNING: Did not come online within timeout");
     }
+    m_startup.mark(StartupTimeline::Phase::Online);
 
     m_postOnlineDelayDone = false;
     m_stabilizationCount = 0;
+    invalidateConsumerState();
+    return true;
+}
 
-    // Save format state
-    m_previousFormat = format;
-    m_hasPreviousFormat = true;
-    m_currentFormat = format;
+void DirettaSync::awaitSinkStart() {
+    std::lock_guard<std::mutex> lock(m_sinkStartMutex);
+    if (m_sinkStartThread.joinable()) {
+        m_sinkStartThread.join();
+    }
+}
 
-    m_open = true;
-    m_playing = true;
-    m_paused = false;
+void DirettaSync::drainForFormatSwitch() {
+    // Only drain if the consumer is actually playing the ring
+    bool streaming = m_playing && !m_paused &&
+                     !m_stopRequested.load(std::memory_order_acquire) &&
+                     m_prefillComplete.load(std::memory_order_acquire);
+
+    if (streaming) {
+        size_t bytesPerBuffer = static_cast<size_t>(m_bytesPerBuffer.load(std::memory_order_acquire));
+        size_t avail = m_ringBuffer.getAvailable();
+
+        // Pad the tail to a whole buffer so the last samples are played
+        // instead of being left behind as a sub-buffer remainder
+        size_t tail = bytesPerBuffer > 0 ? avail % bytesPerBuffer : 0;
+        if (tail > 0) {
+            std::vector<uint8_t> pad(bytesPerBuffer - tail, m_ringBuffer.silenceByte());
+            m_ringBuffer.push(pad.data(), pad.size());
+            avail = m_ringBuffer.getAvailable();
+        }
 
-    std::cout << "[DirettaSync] ========== OPEN COMPLETE ==========" << std::endl;
-    return true;
+        // Wait (event-driven) until the consumer has taken everything:
+        // budget is the queued audio duration plus a margin
+        size_t ringSize = m_ringBuffer.size();
+        size_t bytesPerMs = std::max<size_t>(bytesPerBuffer, 1);  // One buffer per ms
+        auto budget = std::chrono::milliseconds(avail / bytesPerMs + 200);
+        auto deadline = std::chrono::steady_clock::now() + budget;
+
+        while (m_ringBuffer.getAvailable() > 0) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                DIRETTA_LOG("Format switch drain timeout, " << m_ringBuffer.getAvailable()
+                            << " bytes dropped");
+                break;
+            }
+            m_ringBuffer.waitForFreeSpace(ringSize - 1,
+                std::chrono::duration_cast<std::chrono::microseconds>(deadline - now));
+        }
+        DIRETTA_LOG("Format switch: ring drained (" << avail << " bytes played out)");
+    }
+
+    // Short silence so the DAC mutes on a clean edge, then stop the stream.
+    // Runs on the audio thread: sleep one cycle per pass instead of spinning
+    // (silence buffers don't move the ring, so there is no space wake)
+    requestShutdownSilence(m_isDsdMode.load(std::memory_order_acquire) ? 20 : 10);
+    auto cycle = std::chrono::microseconds(m_lastCycleTimeUs > 0 ? m_lastCycleTimeUs : 1000);
+    auto silenceDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+    while (m_silenceBuffersRemaining.load(std::memory_order_acquire) > 0 &&
+           std::chrono::steady_clock::now() < silenceDeadline) {
+        std::this_thread::sleep_for(cycle);
+    }
+
+    stop();
+    waitForPendingRelease(std::chrono::milliseconds(100));
+}
+
+void DirettaSync::recordFormatSwitch(const AudioFormat& from, const AudioFormat& to, bool fast,
+                                     std::chrono::steady_clock::duration total,
+                                     std::chrono::steady_clock::duration drain) {
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+    long totalMs = static_cast<long>(duration_cast<milliseconds>(total).count());
+    long drainMs = static_cast<long>(duration_cast<milliseconds>(drain).count());
+
+    int type = (from.isDSD ? 2 : 0) + (to.isDSD ? 1 : 0);
+    static const char* const kTypeNames[4] = { "PCM->PCM", "PCM->DSD", "DSD->PCM", "DSD->DSD" };
+
+    FormatSwitchStats& stats = m_switchStats[fast ? 1 : 0][type];
+    stats.count++;
+    stats.totalMs += static_cast<double>(totalMs);
+    stats.maxMs = std::max(stats.maxMs, static_cast<double>(totalMs));
+
+    std::cout << "[DirettaSync] Format switch " << kTypeNames[type]
+              << " (" << (fast ? "fast" : "full reopen") << "): " << totalMs << "ms";
+    if (fast) {
+        std::cout << " [drain " << drainMs << "ms, reconfigure " << (totalMs - drainMs) << "ms]";
+    }
+    std::cout << " | avg " << static_cast<long>(stats.totalMs / stats.count)
+              << "ms, max " << static_cast<long>(stats.maxMs)
+              << "ms over " << stats.count << std::endl;
 }
 
 void DirettaSync::close() {
     std::cout << "[DirettaSync] Close()" << std::endl;
+    awaitSinkStart();
+    m_warm.store(false, std::memory_order_release);
 
     if (!m_open) {
         DIRETTA_LOG("Not open");
@@ -519,6 +927,7 @@ void DirettaSync::close() {
     }
 
     m_stopRequested = true;
+    invalidateConsumerState();
 
     stop();
     disconnect(true);  // Wait for proper disconnection before returning
@@ -618,6 +1027,7 @@ void DirettaSync::fullReset() {
 
     m_stopRequested = true;
     m_draining = false;
+    invalidateConsumerState();
 
     int waitCount = 0;
     while (m_workerActive.load(std::memory_order_acquire) && waitCount < 50) {
@@ -644,6 +1054,7 @@ void DirettaSync::fullReset() {
         m_bytesPerFrame.store(0, std::memory_order_release);
         m_framesPerBufferRemainder.store(0, std::memory_order_release);
         m_framesPerBufferAccumulator.store(0, std::memory_order_release);
+        invalidateConsumerState();
 
         // Wait for SDK to release buffer before clear
         if (waitForPendingRelease(std::chrono::milliseconds(100))) {
@@ -798,6 +1209,11 @@ size_t DirettaSync::calculateAlignedPrefill(size_t bytesPerSecond, bool isDSD,
         targetMs = 150;
     }
 
+    // Adaptive: half the learned queue depth, whatever the format
+    if (m_config.adaptiveBuffer) {
+        targetMs = static_cast<int>(m_depth.prefillMs());
+    }
+
     // Convert to bytes
     size_t targetBytes = (bytesPerSecond * targetMs) / 1000;
 
@@ -845,6 +1261,8 @@ void DirettaSync::configureRingPCM(int rate, int channels, int direttaBps, int i
     m_framesPerBufferRemainder.store(static_cast<uint32_t>(framesRemainder), std::memory_order_release);
     m_framesPerBufferAccumulator.store(0, std::memory_order_release);
     m_bytesPerBuffer.store(framesBase * bytesPerFrame, std::memory_order_release);
+    m_depth.setFormat(bytesPerSecond, ringSize);
+    m_ringBytesPerSecond.store(bytesPerSecond, std::memory_order_release);
 
     size_t bytesPerBuffer = m_bytesPerBuffer.load(std::memory_order_acquire);
 
@@ -874,12 +1292,12 @@ void DirettaSync::configureRingPCM(int rate, int channels, int direttaBps, int i
 
     // Pre-allocate silence buffer for max possible bytes per callback
     size_t maxSilenceBytes = static_cast<size_t>((framesBase + 1) * bytesPerFrame);
-    if (m_silenceBuffer.size() < maxSilenceBytes) {
-        m_silenceBuffer.resize(maxSilenceBytes);
-    }
+    reserveSilenceBuffer(maxSilenceBytes);
 
     DIRETTA_LOG("Ring PCM: " << rate << "Hz " << channels << "ch "
                 << direttaBps << "bps, buffer=" << ringSize
+                << (m_ringBuffer.isMirrored() ? " [mirrored]" : "")
+                << " [" << m_ringBuffer.memoryDescription() << "]"
                 << ", prefill=" << m_prefillTargetBuffers << " buffers ("
                 << m_prefillTarget << " bytes, "
                 << (isCompressed ? "compressed" : "uncompressed") << ")");
@@ -917,6 +1335,8 @@ void DirettaSync::configureRingDSD(uint32_t byteRate, int channels) {
     m_bytesPerFrame.store(0, std::memory_order_release);
     m_framesPerBufferRemainder.store(0, std::memory_order_release);
     m_framesPerBufferAccumulator.store(0, std::memory_order_release);
+    m_depth.setFormat(bytesPerSecond, ringSize);
+    m_ringBytesPerSecond.store(bytesPerSecond, std::memory_order_release);
 
     // Aligned prefill calculation (DSD always uses 150ms)
     m_prefillTargetBuffers = calculateAlignedPrefill(
@@ -926,12 +1346,12 @@ void DirettaSync::configureRingDSD(uint32_t byteRate, int channels) {
 
     // Pre-allocate silence buffer for DSD
     size_t maxSilenceBytes = static_cast<size_t>(bytesPerBuffer) + 64;
-    if (m_silenceBuffer.size() < maxSilenceBytes) {
-        m_silenceBuffer.resize(maxSilenceBytes);
-    }
+    reserveSilenceBuffer(maxSilenceBytes);
 
     DIRETTA_LOG("Ring DSD: byteRate=" << byteRate << " ch=" << channels
                 << " buffer=" << ringSize
+                << (m_ringBuffer.isMirrored() ? " [mirrored]" : "")
+                << " [" << m_ringBuffer.memoryDescription() << "]"
                 << " prefill=" << m_prefillTargetBuffers << " buffers ("
                 << m_prefillTarget << " bytes)");
 
@@ -960,11 +1380,15 @@ bool DirettaSync::startPlayback() {
 }
 
 void DirettaSync::stopPlayback(bool immediate) {
+    awaitSinkStart();
+    m_warm.store(false, std::memory_order_release);
     if (!m_playing) return;
 
     // Set stop flag FIRST to prevent further underrun counting
     // getNewStream() checks this flag before counting underruns
     m_stopRequested = true;
+    invalidateConsumerState();
+    m_ringBuffer.wakeSpaceWaiter();
 
     // Report accumulated underruns (moved from hot path)
     uint32_t underruns = m_underrunCount.exchange(0, std::memory_order_relaxed);
@@ -994,6 +1418,7 @@ void DirettaSync::stopPlayback(bool immediate) {
 }
 
 void DirettaSync::pausePlayback() {
+    awaitSinkStart();
     if (!m_playing || m_paused) return;
 
     requestShutdownSilence(m_isDsdMode.load(std::memory_order_acquire) ? 30 : 10);
@@ -1024,6 +1449,7 @@ void DirettaSync::resumePlayback() {
         m_ringBuffer.clear();
     }
     m_prefillComplete = false;
+    invalidateConsumerState();
 
     play();
     m_paused = false;
@@ -1036,14 +1462,159 @@ void DirettaSync::resumePlayback() {
 // Audio Data (Push Interface)
 //=============================================================================
 
+template <DirettaSync::PushPath Path, int Channels>
+size_t DirettaSync::pushSpecialized(const uint8_t* data, size_t numSamples, float gain, size_t& inBytes) {
+    // Channels == 0: any count, from the format cache
+    const size_t channels = Channels ? static_cast<size_t>(Channels) : static_cast<size_t>(m_cachedChannels);
+
+    if constexpr (Path == PushPath::Dsd || Path == PushPath::DsdBitRev ||
+                  Path == PushPath::DsdSwap || Path == PushPath::DsdBitRevSwap) {
+        // DSD: numSamples encoding from AudioEngine
+        // numSamples = (totalBytes * 8) / channels
+        // Reverse: totalBytes = numSamples * channels / 8
+        constexpr bool bitRev = (Path == PushPath::DsdBitRev || Path == PushPath::DsdBitRevSwap);
+        constexpr bool swap = (Path == PushPath::DsdSwap || Path == PushPath::DsdBitRevSwap);
+        inBytes = (numSamples * channels) / 8;
+        if (gain == 0.0f) {
+            // DSD is never scaled, but mute must not pass the source through:
+            // the silence pattern, in the amount pushDSDPlanar() would write
+            size_t bytesPerChannel = channels ? inBytes / channels : 0;
+            size_t outputBytes = ((bytesPerChannel + 3) / 4) * 4 * channels;
+            return m_ringBuffer.pushSilence(outputBytes) ? bytesPerChannel * channels : 0;
+        }
+        return m_ringBuffer.pushDSDPlanar(data, inBytes, static_cast<int>(channels),
+                                          bitRev ? bitReverseTable : nullptr, swap);
+    } else if constexpr (Path == PushPath::Pack24) {
+        // PCM 24-bit: numSamples is sample count, S24_P32 input
+        numSamples = std::min(numSamples, wholeStagedFrames(3 * channels));
+        inBytes = numSamples * 4 * channels;
+        return m_ringBuffer.push24BitPacked(data, inBytes, gain);
+    } else if constexpr (Path == PushPath::Upsample16To32) {
+        numSamples = std::min(numSamples, wholeStagedFrames(4 * channels));
+        inBytes = numSamples * 2 * channels;
+        return m_ringBuffer.push16To32(data, inBytes, gain);
+    } else {
+        // PCM direct copy (gain stays a per-call check: setGain() is live)
+        size_t bytesPerSample = static_cast<size_t>(m_cachedBytesPerSample);
+        if (gain != 1.0f) {
+            numSamples = std::min(numSamples, wholeStagedFrames(bytesPerSample * channels));
+        }
+        inBytes = numSamples * bytesPerSample * channels;
+        return (gain == 1.0f)
+            ? m_ringBuffer.push(data, inBytes)
+            : m_ringBuffer.pushWithGain(data, inBytes, bytesPerSample, gain);
+    }
+}
+
+size_t DirettaSync::wholeStagedFrames(size_t ringFrameBytes) const {
+    // The staged converters cap a push at the staging size and free space in
+    // samples; at 5.1/7.1 that cut lands mid-frame and rotates the channels
+    // of every later push. Cap it here in whole frames instead.
+    if (ringFrameBytes == 0) return 0;
+    return std::min(m_ringBuffer.getFreeSpace(), DirettaRingBuffer::STAGING_SIZE) / ringFrameBytes;
+}
+
+template <DirettaSync::PushPath Path>
+DirettaSync::PushFn DirettaSync::selectPush(int channels) {
+    switch (channels) {
+        case 2:  return &DirettaSync::pushSpecialized<Path, 2>;
+        case 6:  return &DirettaSync::pushSpecialized<Path, 6>;
+        case 8:  return &DirettaSync::pushSpecialized<Path, 8>;
+        default: return &DirettaSync::pushSpecialized<Path, 0>;
+    }
+}
+
 size_t DirettaSync::sendAudio(const uint8_t* data, size_t numSamples) {
     if (m_draining.load(std::memory_order_acquire)) return 0;
     if (m_stopRequested.load(std::memory_order_acquire)) return 0;
-    if (!is_online()) return 0;
+    if (!is_online() && !m_sinkStarting.load(std::memory_order_acquire)) return 0;
 
     RingAccessGuard ringGuard(m_ringUsers, m_reconfiguring);
     if (!ringGuard.active()) return 0;
 
+    // Binds m_pushFn to the variant for the current format (cold path only)
+    refreshFormatCache();
+
+    // Hot path: no format branching
+    size_t totalBytes = 0;
+    size_t written = (this->*m_pushFn)(data, numSamples, m_gain.load(std::memory_order_relaxed), totalBytes);
+
+    onPushed(written, totalBytes);
+    return written;
+}
+
+size_t DirettaSync::writeDirect(size_t maxSamples, size_t bytesPerFrame, const DirectFill& fill) {
+    if (m_draining.load(std::memory_order_acquire)) return 0;
+    if (m_stopRequested.load(std::memory_order_acquire)) return 0;
+    if (!is_online() && !m_sinkStarting.load(std::memory_order_acquire)) return 0;
+
+    RingAccessGuard ringGuard(m_ringUsers, m_reconfiguring);
+    if (!ringGuard.active()) return 0;
+
+    refreshFormatCache();
+
+    // Ring bytes must equal input bytes: no conversion, no gain
+    if (m_cachedDsdMode || m_cachedPack24bit || m_cachedUpsample16to32) return 0;
+    if (m_gain.load(std::memory_order_relaxed) != 1.0f) return 0;
+    size_t ringBytesPerFrame = static_cast<size_t>(m_cachedBytesPerSample) * static_cast<size_t>(m_cachedChannels);
+    if (bytesPerFrame == 0 || bytesPerFrame != ringBytesPerFrame || maxSamples == 0) return 0;
+
+    uint8_t* region;
+    size_t contiguous;
+    if (!m_ringBuffer.getDirectWriteRegion(bytesPerFrame, region, contiguous)) return 0;
+    size_t room = contiguous;
+    if (m_config.adaptiveBuffer) {
+        // Same queue cap waitForSpace() applies to sendAudio()
+        size_t limit = m_ringBuffer.size() - 1;
+        size_t queueCap = std::min(std::max(m_depth.targetBytes(), 2 * maxSamples * bytesPerFrame), limit);
+        size_t avail = m_ringBuffer.getAvailable();
+        room = std::min(room, queueCap > avail ? queueCap - avail : 0);
+    }
+    size_t frames = std::min(maxSamples, room / bytesPerFrame);
+    if (frames == 0) return 0;
+
+    frames = std::min(fill(region, frames), frames);
+    if (frames == 0) return 0;
+
+    size_t written = frames * bytesPerFrame;
+    m_ringBuffer.commitDirectWrite(written);
+    onPushed(written, written);
+    return frames;
+}
+
+void DirettaSync::onPushed(size_t written, size_t inBytes) {
+    // Telemetry, prefill completion and adaptive depth, for every producer path
+    if (written == 0) {
+        m_telemetry.recordPushRejected();
+    } else {
+        m_telemetry.recordPush(written);
+        Trace::record(Trace::Event::Push, 0, static_cast<uint32_t>(inBytes), written,
+                      m_ringBuffer.getAvailable());
+        m_underrunActive.store(false, std::memory_order_release);
+        if (!m_prefillComplete.load(std::memory_order_acquire)) {
+            if (m_ringBuffer.getAvailable() >= m_prefillTarget) {
+                m_prefillComplete = true;
+                m_startup.mark(StartupTimeline::Phase::Prefilled);
+                DIRETTA_LOG(m_cachedFormatLabel << " prefill complete: " << m_ringBuffer.getAvailable() << " bytes");
+            }
+        }
+        if (m_config.adaptiveBuffer) {
+            m_depth.onPush(steadyMicros(std::chrono::steady_clock::now()), written,
+                           m_prefillComplete.load(std::memory_order_relaxed));
+        }
+
+        if (g_verbose) {
+            int count = m_pushCount.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (count <= 3 || count % 500 == 0) {
+                DIRETTA_LOG("sendAudio #" << count << " in=" << inBytes
+                            << " out=" << written << " avail=" << m_ringBuffer.getAvailable()
+                            << " [" << m_cachedFormatLabel << "]");
+            }
+        }
+    }
+}
+
+void DirettaSync::refreshFormatCache() {
     // Generation counter optimization: single atomic load in common case
     uint32_t gen = m_formatGeneration.load(std::memory_order_acquire);
     if (gen != m_cachedFormatGen) {
@@ -1055,80 +1626,152 @@ size_t DirettaSync::sendAudio(const uint8_t* data, size_t numSamples) {
         m_cachedNeedByteSwap = m_needDsdByteSwap.load(std::memory_order_acquire);
         m_cachedChannels = m_channels.load(std::memory_order_acquire);
         m_cachedBytesPerSample = m_bytesPerSample.load(std::memory_order_acquire);
+
+        // Same precedence sendAudio() always had: DSD, 24-bit pack, 16->32, copy
+        int ch = m_cachedChannels;
+        if (m_cachedDsdMode) {
+            if (m_cachedNeedBitReversal) {
+                m_pushFn = m_cachedNeedByteSwap ? selectPush<PushPath::DsdBitRevSwap>(ch)
+                                                : selectPush<PushPath::DsdBitRev>(ch);
+            } else {
+                m_pushFn = m_cachedNeedByteSwap ? selectPush<PushPath::DsdSwap>(ch)
+                                                : selectPush<PushPath::Dsd>(ch);
+            }
+            m_cachedFormatLabel = "DSD";
+        } else if (m_cachedPack24bit) {
+            m_pushFn = selectPush<PushPath::Pack24>(ch);
+            m_cachedFormatLabel = "PCM24";
+        } else if (m_cachedUpsample16to32) {
+            m_pushFn = selectPush<PushPath::Upsample16To32>(ch);
+            m_cachedFormatLabel = "PCM16->32";
+        } else {
+            m_pushFn = selectPush<PushPath::Copy>(ch);
+            m_cachedFormatLabel = "PCM";
+        }
         m_cachedFormatGen = gen;
-    }
 
-    // Hot path: use cached values
-    bool dsdMode = m_cachedDsdMode;
-    bool pack24bit = m_cachedPack24bit;
-    bool upsample16to32 = m_cachedUpsample16to32;
-    bool needBitReversal = m_cachedNeedBitReversal;
-    bool needByteSwap = m_cachedNeedByteSwap;
-    int numChannels = m_cachedChannels;
-    int bytesPerSample = m_cachedBytesPerSample;
+        float gain = m_gain.load(std::memory_order_relaxed);
+        if (gain != 1.0f && !softGainSupported()) {
+            std::cerr << "[DirettaSync] Software gain not applied to " << m_cachedFormatLabel
+                      << " (" << m_cachedBytesPerSample << " bytes/sample)"
+                      << (gain == 0.0f ? ", muted with silence" : "") << std::endl;
+        }
+    }
+}
 
-    size_t written = 0;
-    size_t totalBytes;
-    const char* formatLabel;
+void DirettaSync::invalidateConsumerState() {
+    // Call after entering a state getNewStream() must output silence for
+    // (stop, shutdown silence, prefill, stabilization): the worker drops its
+    // steady-state pull path on the next callback
+    m_consumerStateGen.fetch_add(1, std::memory_order_release);
+}
 
-    if (dsdMode) {
-        // DSD: numSamples encoding from AudioEngine
-        // numSamples = (totalBytes * 8) / channels
-        // Reverse: totalBytes = numSamples * channels / 8
-        totalBytes = (numSamples * numChannels) / 8;
+size_t DirettaSync::ringBytesFor(size_t numSamples) const {
+    size_t channels = static_cast<size_t>(m_cachedChannels);
+    if (m_cachedDsdMode) {
+        // pushDSDPlanar writes whole 4-byte groups per channel
+        size_t bytesPerChannel = numSamples / 8;
+        return ((bytesPerChannel + 3) / 4) * 4 * channels;
+    }
+    if (m_cachedPack24bit) return numSamples * 3 * channels;
+    if (m_cachedUpsample16to32) return numSamples * 4 * channels;
+    return numSamples * static_cast<size_t>(m_cachedBytesPerSample) * channels;
+}
 
-        written = m_ringBuffer.pushDSDPlanar(
-            data, totalBytes, numChannels,
-            needBitReversal ? bitReverseTable : nullptr,
-            needByteSwap);
-        formatLabel = "DSD";
+bool DirettaSync::waitForSpace(size_t numSamples, std::chrono::microseconds timeout) {
+    if (m_draining.load(std::memory_order_acquire)) return false;
+    if (m_stopRequested.load(std::memory_order_acquire)) return false;
+    if (!is_online() && !m_sinkStarting.load(std::memory_order_acquire)) return false;
 
-    } else if (pack24bit) {
-        // PCM 24-bit: numSamples is sample count
-        size_t bytesPerFrame = 4 * numChannels;  // S24_P32
-        totalBytes = numSamples * bytesPerFrame;
+    RingAccessGuard ringGuard(m_ringUsers, m_reconfiguring);
+    if (!ringGuard.active()) return false;
+
+    refreshFormatCache();
+    size_t needed = ringBytesFor(numSamples);
+    if (m_sinkStarting.load(std::memory_order_acquire)) {
+        // Fast start: nothing drains the ring before the sink is online, so
+        // a full ring waits for the bring-up instead of timing out
+        if (m_ringBuffer.getFreeSpace() >= needed) return true;
+        awaitSinkStart();
+        if (!is_online()) return false;
+    }
+    if (m_config.adaptiveBuffer) {
+        // Watermark: only top the queue up to the adaptive target (at least
+        // two chunks, so the producer is never starved by its own wait)
+        size_t limit = m_ringBuffer.size() - 1;
+        size_t queueCap = std::min(std::max(m_depth.targetBytes(), 2 * needed), limit);
+        needed += limit - queueCap;
+    }
+    uint64_t waitStart = Trace::ticks();
+    // Stop, drain and reconfigure wake the ring's waiter: give up on those
+    bool ready = m_ringBuffer.waitForFreeSpace(needed, timeout, [this] {
+        return m_stopRequested.load(std::memory_order_acquire) ||
+               m_draining.load(std::memory_order_acquire) ||
+               m_reconfiguring.load(std::memory_order_acquire);
+    });
+    m_telemetry.recordProducerWait(ready);
+    Trace::record(Trace::Event::ProducerWait, ready ? 1 : 0, static_cast<uint32_t>(needed),
+                  Trace::ticks() - waitStart);
+    return ready;
+}
 
-        written = m_ringBuffer.push24BitPacked(data, totalBytes);
-        formatLabel = "PCM24";
+void DirettaSync::discardForSeek() {
+    if (m_draining.load(std::memory_order_acquire)) return;
+    if (!is_online()) return;
 
-    } else if (upsample16to32) {
-        // PCM 16->32
-        size_t bytesPerFrame = 2 * numChannels;
-        totalBytes = numSamples * bytesPerFrame;
+    RingAccessGuard ringGuard(m_ringUsers, m_reconfiguring);
+    if (!ringGuard.active()) return;
 
-        written = m_ringBuffer.push16To32(data, totalBytes);
-        formatLabel = "PCM16->32";
+    // Whole buffers only, so the read position stays frame-aligned
+    size_t bytesPerBuffer = static_cast<size_t>(m_bytesPerBuffer.load(std::memory_order_acquire));
+    size_t keep = std::max(m_prefillTarget, 2 * bytesPerBuffer);
+    if (bytesPerBuffer > 0) {
+        keep = ((keep + bytesPerBuffer - 1) / bytesPerBuffer) * bytesPerBuffer;
+    }
 
-    } else {
-        // PCM direct copy
-        size_t bytesPerFrame = static_cast<size_t>(bytesPerSample) * numChannels;
-        totalBytes = numSamples * bytesPerFrame;
+    size_t dropped = m_ringBuffer.discardQueued(keep);
+    DIRETTA_LOG("Seek: dropped " << dropped << " queued bytes, kept " << keep);
+}
 
-        written = m_ringBuffer.push(data, totalBytes);
-        formatLabel = "PCM";
+bool DirettaSync::softGainSupported() const {
+    if (m_isDsdMode.load(std::memory_order_acquire)) return false;
+    if (m_need24BitPack.load(std::memory_order_acquire) ||
+        m_need16To32Upsample.load(std::memory_order_acquire)) {
+        return true;
     }
+    return DirettaRingBuffer::gainSupported(static_cast<size_t>(m_bytesPerSample.load(std::memory_order_acquire)));
+}
 
-    // Check prefill completion
-    if (written > 0) {
-        m_underrunActive.store(false, std::memory_order_release);
-        if (!m_prefillComplete.load(std::memory_order_acquire)) {
-            if (m_ringBuffer.getAvailable() >= m_prefillTarget) {
-                m_prefillComplete = true;
-                DIRETTA_LOG(formatLabel << " prefill complete: " << m_ringBuffer.getAvailable() << " bytes");
-            }
+bool DirettaSync::setGain(float gain) {
+    if (!(gain >= 0.0f)) gain = 0.0f;  // NaN and negative both mean silence
+    float previous = m_gain.exchange(gain, std::memory_order_relaxed);
+    bool supported = gain == 1.0f || !m_open || softGainSupported();
+    if (previous != gain) {
+        DIRETTA_LOG("Software gain " << previous << " -> " << gain
+                    << (gain == 1.0f ? " (bit-perfect)" : ""));
+        if (!supported) {
+            std::cerr << "[DirettaSync] Software gain not supported for the current format"
+                      << (gain == 0.0f ? ", muted with silence" : "") << std::endl;
         }
+    }
+    return supported;
+}
 
-        if (g_verbose) {
-            int count = m_pushCount.fetch_add(1, std::memory_order_relaxed) + 1;
-            if (count <= 3 || count % 500 == 0) {
-                DIRETTA_LOG("sendAudio #" << count << " in=" << totalBytes
-                            << " out=" << written << " avail=" << m_ringBuffer.getAvailable()
-                            << " [" << formatLabel << "]");
-            }
+std::string DirettaSync::statsJson() const {
+    size_t size = 0;
+    size_t avail = 0;
+    {
+        RingAccessGuard ringGuard(m_ringUsers, m_reconfiguring);
+        if (ringGuard.active()) {
+            size = m_ringBuffer.size();
+            avail = m_ringBuffer.getAvailable();
         }
     }
-
-    return written;
+    std::string json = m_telemetry.toJson(size, avail);
+    if (m_config.adaptiveBuffer) {
+        json.insert(json.size() - 1, ",\"depth\":" + m_depth.json());
+    }
+    return json;
 }
 
 float DirettaSync::getBufferLevel() const {
@@ -1139,6 +1782,14 @@ float DirettaSync::getBufferLevel() const {
     return static_cast<float>(m_ringBuffer.getAvailable()) / static_cast<float>(size);
 }
 
+double DirettaSync::getBufferedMs() const {
+    RingAccessGuard ringGuard(m_ringUsers, m_reconfiguring);
+    if (!ringGuard.active()) return 0.0;
+    size_t bytesPerSecond = m_ringBytesPerSecond.load(std::memory_order_acquire);
+    if (bytesPerSecond == 0) return 0.0;
+    return static_cast<double>(m_ringBuffer.getAvailable()) * 1000.0 / static_cast<double>(bytesPerSecond);
+}
+
 void DirettaSync::fillSilence(diretta_stream& stream, size_t bytes, uint8_t silenceByte) {
     // m_silenceBuffer pre-allocated on format change, always large enough
     std::memset(m_silenceBuffer.data(), silenceByte, bytes);
@@ -1146,39 +1797,31 @@ void DirettaSync::fillSilence(diretta_stream& stream, size_t bytes, uint8_t sile
     stream.Size = static_cast<unsigned long long>(bytes);
 }
 
+void DirettaSync::reserveSilenceBuffer(size_t bytes) {
+    // Grow only: the buffer (and its mlock) is reused across format changes
+    if (m_silenceBuffer.size() >= bytes) return;
+    if (m_config.lockMemory) {
+        RingMemory::unlock(m_silenceBuffer.data(), m_silenceBuffer.size());
+    }
+    m_silenceBuffer.resize(bytes);
+    if (m_config.lockMemory && !RingMemory::lock(m_silenceBuffer.data(), m_silenceBuffer.size())) {
+        DIRETTA_LOG("mlock of silence buffer denied (RLIMIT_MEMLOCK?)");
+    }
+}
+
 //=============================================================================
 // DIRETTA::Sync Overrides
 //=============================================================================
 
-bool DirettaSync::getNewStream(diretta_stream& stream) {
-    m_workerActive = true;
-
-    // Complete previous deferred advance (atomic load)
-    size_t pending = m_pendingAdvance.load(std::memory_order_acquire);
-    if (pending > 0) {
-        m_ringBuffer.advanceReadPos(pending);
-        m_pendingAdvance.store(0, std::memory_order_release);
-    }
-
-    // Generation counter optimization: single atomic load in common case
-    uint32_t gen = m_consumerStateGen.load(std::memory_order_acquire);
-    if (gen != m_cachedConsumerGen) {
-        // Cold path: reload stable configuration (only on format change)
-        m_cachedBytesPerBuffer = m_bytesPerBuffer.load(std::memory_order_acquire);
-        m_cachedFramesRemainder = m_framesPerBufferRemainder.load(std::memory_order_acquire);
-        m_cachedBytesPerFrame = m_bytesPerFrame.load(std::memory_order_acquire);
-        m_cachedConsumerIsDsd = m_isDsdMode.load(std::memory_order_acquire);
-        m_cachedSilenceByte = m_ringBuffer.silenceByte();
-        m_cachedConsumerGen = gen;
-    }
-
-    // Hot path: use cached values
+// Remainder: fractional frames per buffer (44.1k family); Gated: checks the
+// blocking states, for the first buffers after a consumer state change
+template <bool Remainder, bool Gated>
+bool DirettaSync::pullSpecialized(diretta_stream& stream, std::chrono::steady_clock::time_point callbackTime) {
     int currentBytesPerBuffer = m_cachedBytesPerBuffer;
-    uint32_t remainder = m_cachedFramesRemainder;
-    if (remainder != 0) {
+    if constexpr (Remainder) {
         int bytesPerFrame = m_cachedBytesPerFrame;
         uint32_t acc = m_framesPerBufferAccumulator.load(std::memory_order_relaxed);
-        acc += remainder;
+        acc += m_cachedFramesRemainder;
         if (acc >= 1000) {
             acc -= 1000;
             currentBytesPerBuffer += bytesPerFrame;
@@ -1190,66 +1833,81 @@ bool DirettaSync::getNewStream(diretta_stream& stream) {
     RingAccessGuard ringGuard(m_ringUsers, m_reconfiguring);
     if (!ringGuard.active()) {
         m_underrunActive.store(false, std::memory_order_release);
+        m_telemetry.recordSilence(DirettaTelemetry::SilenceReason::Reconfigure);
         fillSilence(stream, currentBytesPerBuffer, currentSilenceByte);
-        m_workerActive = false;
         return true;
     }
 
-    // Shutdown silence
-    int silenceRemaining = m_silenceBuffersRemaining.load(std::memory_order_acquire);
-    if (silenceRemaining > 0) {
-        m_underrunActive.store(false, std::memory_order_release);
-        fillSilence(stream, currentBytesPerBuffer, currentSilenceByte);
-        m_silenceBuffersRemaining.fetch_sub(1, std::memory_order_acq_rel);
-        m_workerActive = false;
-        return true;
-    }
+    if constexpr (Gated) {
+        // Shutdown silence
+        int silenceRemaining = m_silenceBuffersRemaining.load(std::memory_order_acquire);
+        if (silenceRemaining > 0) {
+            m_underrunActive.store(false, std::memory_order_release);
+            m_telemetry.recordSilence(DirettaTelemetry::SilenceReason::Shutdown);
+            fillSilence(stream, currentBytesPerBuffer, currentSilenceByte);
+            m_silenceBuffersRemaining.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
 
-    // Stop requested
-    if (m_stopRequested.load(std::memory_order_acquire)) {
-        m_underrunActive.store(false, std::memory_order_release);
-        fillSilence(stream, currentBytesPerBuffer, currentSilenceByte);
-        m_workerActive = false;
-        return true;
-    }
+        // Stop requested
+        if (m_stopRequested.load(std::memory_order_acquire)) {
+            m_underrunActive.store(false, std::memory_order_release);
+            m_telemetry.recordSilence(DirettaTelemetry::SilenceReason::Stopped);
+            fillSilence(stream, currentBytesPerBuffer, currentSilenceByte);
+            return true;
+        }
 
-    // Prefill not complete
-    if (!m_prefillComplete.load(std::memory_order_acquire)) {
-        m_underrunActive.store(false, std::memory_order_release);
-        fillSilence(stream, currentBytesPerBuffer, currentSilenceByte);
-        m_workerActive = false;
-        return true;
-    }
+        // Prefill not complete
+        if (!m_prefillComplete.load(std::memory_order_acquire)) {
+            // Fast start: the stabilization silence runs concurrently with the prefill
+            if (m_config.fastStart && !m_postOnlineDelayDone.load(std::memory_order_acquire)) {
+                countStabilizationBuffer();
+            }
+            m_underrunActive.store(false, std::memory_order_release);
+            m_telemetry.recordSilence(DirettaTelemetry::SilenceReason::Prefill);
+            fillSilence(stream, currentBytesPerBuffer, currentSilenceByte);
+            return true;
+        }
 
-    // Post-online stabilization
-    if (!m_postOnlineDelayDone.load(std::memory_order_acquire)) {
-        int count = m_stabilizationCount.fetch_add(1, std::memory_order_acq_rel) + 1;
-        if (count >= static_cast<int>(DirettaBuffer::POST_ONLINE_SILENCE_BUFFERS)) {
-            m_postOnlineDelayDone = true;
-            m_stabilizationCount = 0;
-            DIRETTA_LOG("Post-online stabilization complete");
+        // Post-online stabilization
+        if (!m_postOnlineDelayDone.load(std::memory_order_acquire)) {
+            countStabilizationBuffer();
+            m_underrunActive.store(false, std::memory_order_release);
+            m_telemetry.recordSilence(DirettaTelemetry::SilenceReason::Stabilization);
+            fillSilence(stream, currentBytesPerBuffer, currentSilenceByte);
+            return true;
         }
-        m_underrunActive.store(false, std::memory_order_release);
-        fillSilence(stream, currentBytesPerBuffer, currentSilenceByte);
-        m_workerActive = false;
-        return true;
+
+        // All clear: steady state until the next consumer state change
+        m_pullFn = &DirettaSync::pullSpecialized<Remainder, false>;
+        m_startup.mark(StartupTimeline::Phase::FirstAudio);
     }
 
     int count = m_streamCount.fetch_add(1, std::memory_order_relaxed) + 1;
 
     // Check available data first (distinguishes underrun vs wrap)
     size_t avail = m_ringBuffer.getAvailable();
+    m_telemetry.recordFill(avail, m_ringBuffer.size());
     if (avail < static_cast<size_t>(currentBytesPerBuffer)) {
         // True underrun - don't advance, just silence
         if (!m_underrunActive.exchange(true, std::memory_order_acq_rel)) {
             m_underrunCount.fetch_add(1, std::memory_order_relaxed);
+            m_telemetry.recordUnderrunEvent();
+            Trace::record(Trace::Event::Underrun, 0, static_cast<uint32_t>(currentBytesPerBuffer), avail);
+            Trace::trigger(Trace::FreezeReason::Underrun);
+            if (m_config.adaptiveBuffer) m_depth.onUnderrun(steadyMicros(callbackTime));
         }
+        m_telemetry.recordSilence(DirettaTelemetry::SilenceReason::Underrun);
         fillSilence(stream, currentBytesPerBuffer, currentSilenceByte);
-        m_workerActive = false;
         return true;
     }
     m_underrunActive.store(false, std::memory_order_release);
 
+    if (m_config.adaptiveBuffer && m_depth.onConsume(avail, steadyMicros(callbackTime))) {
+        DIRETTA_LOG("Adaptive buffer: target " << m_depth.targetMs() << " ms ("
+                    << m_depth.targetBytes() << " bytes), " << m_depth.json());
+    }
+
     if (g_verbose && (count <= 5 || count % 5000 == 0)) {
         size_t currentRingSize = m_ringBuffer.size();
         float fillPct = (currentRingSize > 0) ? (100.0f * avail / currentRingSize) : 0.0f;
@@ -1268,10 +1926,13 @@ bool DirettaSync::getNewStream(diretta_stream& stream) {
         stream.Size = static_cast<unsigned long long>(currentBytesPerBuffer);
         // Defer advance to next callback (SDK reads asynchronously)
         m_pendingAdvance.store(static_cast<size_t>(currentBytesPerBuffer), std::memory_order_release);
+        m_telemetry.recordZeroCopy();
     } else {
-        // Wrap case: data available but spans wrap point - copy to staging buffer
+        // Wrap case: data available but spans wrap point - copy to staging buffer.
+        // Only reachable when the ring fell back to non-mirrored storage;
         // pop() handles the two-part copy across wrap boundary
         size_t popped = m_ringBuffer.pop(m_silenceBuffer.data(), static_cast<size_t>(currentBytesPerBuffer));
+        m_telemetry.recordWrapCopy();
         if (popped == static_cast<size_t>(currentBytesPerBuffer)) {
             stream.Data.P = m_silenceBuffer.data();
             stream.Size = static_cast<unsigned long long>(currentBytesPerBuffer);
@@ -1281,10 +1942,58 @@ bool DirettaSync::getNewStream(diretta_stream& stream) {
         }
     }
 
-    m_workerActive = false;
     return true;
 }
 
+void DirettaSync::countStabilizationBuffer() {
+    int count = m_stabilizationCount.fetch_add(1, std::memory_order_acq_rel) + 1;
+    if (count >= static_cast<int>(DirettaBuffer::POST_ONLINE_SILENCE_BUFFERS)) {
+        m_postOnlineDelayDone = true;
+        m_stabilizationCount = 0;
+        DIRETTA_LOG("Post-online stabilization complete");
+    }
+}
+
+bool DirettaSync::getNewStream(diretta_stream& stream) {
+    m_workerActive = true;
+    uint64_t traceEntry = Trace::ticks();
+
+    auto callbackTime = std::chrono::steady_clock::now();
+    if (m_lastCallbackTime.time_since_epoch().count() != 0) {
+        m_telemetry.recordCallbackInterval(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(callbackTime - m_lastCallbackTime).count()));
+    }
+    m_lastCallbackTime = callbackTime;
+
+    // Complete previous deferred advance (atomic load)
+    size_t pending = m_pendingAdvance.load(std::memory_order_acquire);
+    if (pending > 0) {
+        m_ringBuffer.advanceReadPos(pending);
+        m_pendingAdvance.store(0, std::memory_order_release);
+    }
+
+    // Generation counter optimization: single atomic load in common case
+    uint32_t gen = m_consumerStateGen.load(std::memory_order_acquire);
+    if (gen != m_cachedConsumerGen) {
+        // Cold path: reload stable configuration (format or playback state change)
+        m_cachedBytesPerBuffer = m_bytesPerBuffer.load(std::memory_order_acquire);
+        m_cachedFramesRemainder = m_framesPerBufferRemainder.load(std::memory_order_acquire);
+        m_cachedBytesPerFrame = m_bytesPerFrame.load(std::memory_order_acquire);
+        m_cachedConsumerIsDsd = m_isDsdMode.load(std::memory_order_acquire);
+        m_cachedSilenceByte = m_ringBuffer.silenceByte();
+        // Re-enter through the gated variant: the blocking states are re-checked
+        m_pullFn = m_cachedFramesRemainder ? &DirettaSync::pullSpecialized<true, true>
+                                           : &DirettaSync::pullSpecialized<false, true>;
+        m_cachedConsumerGen = gen;
+    }
+
+    bool delivered = (this->*m_pullFn)(stream, callbackTime);
+    Trace::record(Trace::Event::Pull, m_telemetry.lastPull(), static_cast<uint32_t>(stream.Size),
+                  m_ringBuffer.getAvailable(), Trace::ticks() - traceEntry);
+    m_workerActive = false;
+    return delivered;
+}
+
 bool DirettaSync::startSyncWorker() {
     std::lock_guard<std::mutex> lock(m_workerMutex);
 
@@ -1303,6 +2012,7 @@ bool DirettaSync::startSyncWorker() {
     m_stopRequested = false;
 
     m_workerThread = std::thread([this]() {
+        ThreadPlacement::apply(ThreadPlacement::Role::SdkWorker);
         while (m_running.load(std::memory_order_acquire)) {
             if (!syncWorker()) {
                 std::this_thread::sleep_for(std::chrono::microseconds(100));
@@ -1320,6 +2030,8 @@ bool DirettaSync::startSyncWorker() {
 bool DirettaSync::beginReconfigure() {
     // Set m_reconfiguring FIRST to block new callbacks from using ring
     m_reconfiguring.store(true, std::memory_order_release);
+    // A producer blocked in waitForSpace() holds a ring user - release it now
+    m_ringBuffer.wakeSpaceWaiter();
 
     // Wait for ringUsers to drain (existing logic)
     while (m_ringUsers.load(std::memory_order_acquire) > 0) {
@@ -1354,7 +2066,9 @@ bool DirettaSync::waitForPendingRelease(std::chrono::milliseconds timeout) {
 
 void DirettaSync::shutdownWorker() {
     m_stopRequested = true;
+    invalidateConsumerState();
     m_running = false;
+    m_ringBuffer.wakeSpaceWaiter();
 
     int waitCount = 0;
     while (m_workerActive.load(std::memory_order_acquire) && waitCount < 100) {
@@ -1371,6 +2085,8 @@ void DirettaSync::shutdownWorker() {
 void DirettaSync::requestShutdownSilence(int buffers) {
     m_silenceBuffersRemaining = buffers;
     m_draining = true;
+    invalidateConsumerState();
+    m_ringBuffer.wakeSpaceWaiter();
     DIRETTA_LOG("Requested " << buffers << " shutdown silence buffers");
 }
 
@@ -1425,3 +2141,166 @@ unsigned int DirettaSync::calculateCycleTime(uint32_t sampleRate, int channels,
     }
     return m_calculator->calculate(sampleRate, channels, bitsPerSample);
 }
+
+void DirettaSync::applyTuning(uint32_t sampleRate, bool isDsd, unsigned int& cycleTimeUs,
+                              DirettaTransferMode& mode) {
+    if (m_trial.active) {
+        if (m_trial.cycleUs > 0) cycleTimeUs = m_trial.cycleUs;
+        mode = m_trial.mode;
+        return;
+    }
+
+    CycleTuning::Family family = CycleTuning::familyOf(sampleRate, isDsd);
+    const CycleTuning::Entry* entry = m_tuning.find(m_targetName, m_config.networkInterface, family);
+    if (!entry) return;
+
+    // Explicit settings win over learned ones
+    if (m_config.cycleTimeAuto) cycleTimeUs = entry->cycleUs;
+    if (m_config.transferMode == DirettaTransferMode::AUTO) {
+        mode = static_cast<DirettaTransferMode>(entry->mode);
+    }
+    DIRETTA_LOG("Tuned " << CycleTuning::familyName(family) << ": cycle " << cycleTimeUs
+                << " us, " << (mode == DirettaTransferMode::AUTO
+                                   ? "auto" : CycleTuning::kModeNames[static_cast<int>(mode)]));
+}
+
+//=============================================================================
+// Cycle Tuning (--auto-tune)
+//=============================================================================
+
+bool DirettaSync::runTuningTrial(const AudioFormat& format, double& score) {
+    static constexpr auto PREFILL_TIMEOUT = std::chrono::seconds(3);
+    static constexpr auto WARMUP = std::chrono::seconds(1);
+    static constexpr auto MEASURE = std::chrono::seconds(4);
+
+    close();
+    if (!open(format)) return false;
+
+    // 10 ms chunks of silence in the input encoding sendAudio() expects:
+    // S32 frames for 24-bit PCM, planar bytes for DSD (numSamples = bits per channel)
+    size_t chunkSamples = format.sampleRate / 100;
+    size_t chunkBytes = format.isDSD ? chunkSamples * format.channels / 8
+                                     : chunkSamples * format.channels * (format.bitDepth > 16 ? 4 : 2);
+    std::vector<uint8_t> silence(chunkBytes, format.isDSD ? 0x69 : 0x00);
+
+    auto feedUntil = [&](std::chrono::steady_clock::time_point end, bool untilPrefilled) {
+        while (std::chrono::steady_clock::now() < end) {
+            if (untilPrefilled && m_prefillComplete.load(std::memory_order_acquire)) return true;
+            if (waitForSpace(chunkSamples, std::chrono::milliseconds(50))) {
+                sendAudio(silence.data(), chunkSamples);
+            } else if (!is_online()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        }
+        return !untilPrefilled;
+    };
+
+    auto now = std::chrono::steady_clock::now();
+    if (!feedUntil(now + PREFILL_TIMEOUT, true)) {
+        DIRETTA_LOG("Tuning trial: prefill timeout");
+        return false;
+    }
+    feedUntil(std::chrono::steady_clock::now() + WARMUP, false);
+
+    DirettaTelemetry::Snapshot before = m_telemetry.snapshot();
+    feedUntil(std::chrono::steady_clock::now() + MEASURE, false);
+    DirettaTelemetry::Snapshot after = m_telemetry.snapshot();
+
+    if (after.intervals - before.intervals < 2) {
+        DIRETTA_LOG("Tuning trial: target did not pull");
+        return false;
+    }
+    score = CycleTuning::score(after.underrunEvents - before.underrunEvents,
+                               after.meanUs(before), after.stddevUs(before));
+    std::cout << "[DirettaSync]   cycle " << m_lastCycleTimeUs << " us, "
+              << CycleTuning::kModeNames[static_cast<int>(m_trial.mode)] << ": "
+              << (after.underrunEvents - before.underrunEvents) << " underruns, interval "
+              << static_cast<long>(after.meanUs(before)) << " +/- "
+              << static_cast<long>(after.stddevUs(before)) << " us, score " << score << std::endl;
+    return true;
+}
+
+bool DirettaSync::autoTune() {
+    if (!m_enabled || m_config.tuningFile.empty()) return false;
+    if (!awaitTargetValidation()) return false;
+
+    std::cout << "[DirettaSync] Auto-tune: target '" << m_targetName << "'"
+              << (m_config.networkInterface.empty() ? "" : " via " + m_config.networkInterface)
+              << ", MTU " << m_effectiveMTU << std::endl;
+
+    AudioFormat pcm44(44100, 24, 2);
+    AudioFormat pcm48(48000, 24, 2);
+    AudioFormat dsd64(2822400, 1, 2);
+    dsd64.isDSD = true;
+    dsd64.dsdFormat = AudioFormat::DSDFormat::DFF;
+    const std::pair<CycleTuning::Family, AudioFormat> probes[] = {
+        {CycleTuning::Family::Pcm44, pcm44},
+        {CycleTuning::Family::Pcm48, pcm48},
+        {CycleTuning::Family::Dsd, dsd64},
+    };
+    static const DirettaTransferMode kModes[] = {
+        DirettaTransferMode::VAR_MAX, DirettaTransferMode::VAR_AUTO, DirettaTransferMode::FIX_AUTO
+    };
+
+    std::vector<CycleTuning::Entry> tuned;
+    for (const auto& probe : probes) {
+        const char* family = CycleTuning::familyName(probe.first);
+        std::cout << "[DirettaSync] Auto-tune " << family << std::endl;
+
+        // Stage 1: transfer mode at the calculated cycle time
+        CycleTuning::Entry best;
+        best.score = -1.0;
+        m_trial = TuningTrial();
+        m_trial.active = true;
+        unsigned int baseCycleUs = 0;
+        for (DirettaTransferMode mode : kModes) {
+            m_trial.mode = mode;
+            double score;
+            if (!runTuningTrial(probe.second, score)) continue;
+            baseCycleUs = m_lastCycleTimeUs;
+            if (best.score < 0 || score < best.score) {
+                best.cycleUs = m_lastCycleTimeUs;
+                best.mode = static_cast<int>(mode);
+                best.score = score;
+            }
+        }
+        if (best.score < 0) {
+            std::cout << "[DirettaSync] Auto-tune " << family << ": not supported by target, skipped" << std::endl;
+            continue;
+        }
+
+        // Stage 2: cycle time around the calculated value, with the best mode
+        m_trial.mode = static_cast<DirettaTransferMode>(best.mode);
+        for (unsigned pct : CycleTuning::CYCLE_STEPS_PCT) {
+            m_trial.cycleUs = std::min(std::max(baseCycleUs * pct / 100, 100u), 50000u);
+            double score;
+            if (runTuningTrial(probe.second, score) && score < best.score) {
+                best.cycleUs = m_trial.cycleUs;
+                best.score = score;
+            }
+        }
+
+        best.target = m_targetName;
+        best.iface = m_config.networkInterface;
+        best.family = probe.first;
+        tuned.push_back(best);
+        std::cout << "[DirettaSync] Auto-tune " << family << ": cycle " << best.cycleUs << " us, "
+                  << CycleTuning::kModeNames[best.mode] << " (score " << best.score << ")" << std::endl;
+    }
+
+    m_trial = TuningTrial();
+    close();
+
+    if (tuned.empty()) return false;
+
+    // Merge into the file as it is now: followers tune the same file
+    std::lock_guard<std::mutex> lock(stateFileMutex());
+    m_tuning.load(m_config.tuningFile);
+    for (const CycleTuning::Entry& entry : tuned) m_tuning.set(entry);
+    if (!m_tuning.save(m_config.tuningFile)) {
+        std::cerr << "[DirettaSync] Cannot write tuning file " << m_config.tuningFile << std::endl;
+    } else {
+        std::cout << "[DirettaSync] Auto-tune saved to " << m_config.tuningFile << std::endl;
+    }
+    return true;
+}
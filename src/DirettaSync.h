@@ -10,6 +10,11 @@
 #define DIRETTA_SYNC_H
 
 #include "DirettaRingBuffer.h"
+#include "DirettaTelemetry.h"
+#include "AdaptiveDepth.h"
+#include "CycleTuning.h"
+#include "TargetCache.h"
+#include "StartupTimeline.h"
 
 extern "C" {
     #include "diretta_stream.h"
@@ -27,6 +32,7 @@ extern "C" {
 #include <string>
 #include <mutex>
 #include <atomic>
+#include <functional>
 #include <thread>
 #include <iostream>
 #include <cmath>
@@ -153,6 +159,15 @@ struct DirettaConfig {
     unsigned int dacStabilizationMs = DirettaBuffer::DAC_STABILIZATION_MS;
     unsigned int onlineWaitMs = DirettaBuffer::ONLINE_WAIT_MS;
     unsigned int formatSwitchDelayMs = DirettaBuffer::FORMAT_SWITCH_DELAY_MS;
+    bool fastFormatSwitch = false;  // Reconfigure in place on format change (no Sync close/reopen)
+    bool fastStart = false;         // open() returns once the ring is ready, the sink comes up behind the prefill
+    bool hugePages = false;         // Back the ring with 2 MiB pages where available
+    bool lockMemory = false;        // mlock ring, staging and silence buffers
+    bool adaptiveBuffer = false;    // Queue depth and prefill follow measured jitter (AdaptiveDepth.h)
+    unsigned int adaptiveMinMs = AdaptiveDepth::DEFAULT_MIN_MS;
+    unsigned int adaptiveMaxMs = AdaptiveDepth::DEFAULT_MAX_MS;
+    std::string tuningFile;         // Learned cycle time / transfer mode (CycleTuning.h), empty = off
+    std::string networkInterface;   // Tuning key only (the SDK picks the route)
 };
 
 //=============================================================================
@@ -199,8 +214,32 @@ public:
     void close();
 
     bool isOpen() const { return m_open; }
+    bool fastFormatSwitchEnabled() const { return m_config.fastFormatSwitch; }
+
+    /**
+     * @brief Fast start: open() returned, the sink is still being brought up
+     *
+     * sendAudio() already fills the ring meanwhile; stop/pause/close wait for
+     * the bring-up to finish.
+     */
+    bool isSinkStarting() const { return m_sinkStarting.load(std::memory_order_acquire); }
     bool isOnline() { return is_online(); }
 
+    /**
+     * @brief Fast start: bring a closed connection up for an expected format
+     *        before the first decoded audio arrives
+     *
+     * Opens as open() would, so the bring-up overlaps the decoder's open.
+     * The next open() adopts it if the format matches; otherwise it
+     * reconfigures as for a format change. stopPlayback()/close() drop it.
+     * @return false if fast start is off, the connection is already open,
+     *         or the open failed
+     */
+    bool warmUp(const AudioFormat& format);
+
+    /// Opened by warmUp() and not yet confirmed by open()
+    bool isWarm() const { return m_warm.load(std::memory_order_acquire); }
+
     //=========================================================================
     // Playback Control
     //=========================================================================
@@ -225,7 +264,78 @@ public:
      */
     size_t sendAudio(const uint8_t* data, size_t numSamples);
 
+    /**
+     * @brief Writes up to maxSamples PCM frames at region, returns frames written
+     */
+    using DirectFill = std::function<size_t(uint8_t* region, size_t maxSamples)>;
+
+    /**
+     * @brief Let the caller write PCM frames straight into the ring
+     *
+     * For the bit-perfect copy path only (PCM, no 24-bit pack or 16->32,
+     * gain 1.0): fill gets the ring's contiguous free region (all of it when
+     * mirrored, capped at the adaptive target) and what it writes is
+     * committed as if pushed by sendAudio(). Producer thread only.
+     * @param bytesPerFrame Caller's frame size, must match the ring's
+     * @return Frames committed; 0 if the ring converts this format, is full
+     *         or not streaming (use sendAudio())
+     */
+    size_t writeDirect(size_t maxSamples, size_t bytesPerFrame, const DirectFill& fill);
+
+    /**
+     * @brief Block until the ring can take numSamples (same encoding as sendAudio)
+     *
+     * Woken by the consumer when free space crosses the watermark, or early
+     * on stop/reconfigure. Producer thread only.
+     * @return true if the space is available, false on timeout or if not streaming
+     */
+    bool waitForSpace(size_t numSamples, std::chrono::microseconds timeout);
+
+    /**
+     * @brief After a seek: drop queued audio from the old position
+     *
+     * Keeps the prefill's worth already committed (at least two buffers),
+     * so playback continues from the new position without re-prefilling.
+     * Producer thread only.
+     */
+    void discardForSeek();
+
+    /**
+     * @brief Software gain for PCM (volume / ReplayGain), linear
+     *
+     * Applied in the ring push kernels from the next sendAudio() on. 1.0
+     * (the default) keeps the bit-perfect copy/pack path. DSD and PCM
+     * widths without a gain kernel are never scaled; gain 0 still mutes
+     * them with silence. Any thread.
+     * @return false if the open format cannot be scaled (logged)
+     */
+    bool setGain(float gain);
+
+    // Whether setGain() can scale the current format (see setGain())
+    bool softGainSupported() const;
+    float gain() const { return m_gain.load(std::memory_order_relaxed); }
+
     float getBufferLevel() const;
+
+    /**
+     * @brief Queued audio in the ring, in ms (fan-out slip reference)
+     */
+    double getBufferedMs() const;
+
+    /**
+     * @brief Buffer health counters (lock-free, readable from any thread)
+     */
+    const DirettaTelemetry& telemetry() const { return m_telemetry; }
+
+    /**
+     * @brief Time-to-first-sound stamps; the caller begin()s it on Play
+     */
+    StartupTimeline& startupTimeline() { return m_startup; }
+
+    /**
+     * @brief Telemetry snapshot plus current ring state as one-line JSON
+     */
+    std::string statsJson() const;
     const AudioFormat& getFormat() const { return m_currentFormat; }
 
     /**
@@ -241,9 +351,32 @@ public:
 
     void setTargetIndex(int index) { m_targetIndex = index; }
     void setMTU(uint32_t mtu) { m_mtuOverride = mtu; }
+
+    /**
+     * @brief Use the last known target from a cache file (see TargetCache.h)
+     *
+     * Call after setTargetIndex(), before enable(). With a hit, enable()
+     * skips discovery and the MTU probe; they run in the background and are
+     * awaited by the first open(). Discoveries are written back to the file.
+     * @param path Cache file, empty = off
+     * @param iface Network interface the entry is keyed by
+     * @return true if an entry for the selected target was found
+     */
+    bool loadTargetCache(const std::string& path, const std::string& iface);
     bool verifyTargetAvailable();
     static void listTargets();
 
+    /**
+     * @brief Probe cycle time and transfer mode per rate family on the live target
+     *
+     * Streams silence through short trials (see CycleTuning.h) and stores the
+     * best setting per target and interface in DirettaConfig::tuningFile, used
+     * by every later open(). Call after enable(), before playback; takes
+     * about a minute per family.
+     * @return true if at least one family was tuned
+     */
+    bool autoTune();
+
 protected:
     //=========================================================================
     // DIRETTA::Sync Overrides
@@ -261,8 +394,14 @@ private:
 
     bool discoverTarget();
     bool measureMTU();
-    bool openSyncConnection();
+    bool openSyncConnection(bool inquireSink = true);
+    void revalidateTarget();
+    bool awaitTargetValidation();
+    void saveTargetCache();
     bool reopenForFormatChange();
+    bool connectSink(bool needFullConnect, ACQUA::Clock cycleTime, DirettaTransferMode transferMode,
+                     bool prefilling);
+    void awaitSinkStart();
     void fullReset();
     void shutdownWorker();
 
@@ -275,13 +414,48 @@ private:
     void endReconfigure();
     bool waitForPendingRelease(std::chrono::milliseconds timeout);
     void fillSilence(diretta_stream& stream, size_t bytes, uint8_t silenceByte);
+    void reserveSilenceBuffer(size_t bytes);
+    void refreshFormatCache();
+    void onPushed(size_t written, size_t inBytes);
+    void invalidateConsumerState();
+    void countStabilizationBuffer();
+    void drainForFormatSwitch();
+    void recordFormatSwitch(const AudioFormat& from, const AudioFormat& to, bool fast,
+                            std::chrono::steady_clock::duration total,
+                            std::chrono::steady_clock::duration drain);
+    size_t ringBytesFor(size_t numSamples) const;
 
     void applyTransferMode(DirettaTransferMode mode, ACQUA::Clock cycleTime);
     unsigned int calculateCycleTime(uint32_t sampleRate, int channels, int bitsPerSample);
+    void applyTuning(uint32_t sampleRate, bool isDsd, unsigned int& cycleTimeUs, DirettaTransferMode& mode);
+    bool runTuningTrial(const AudioFormat& format, double& score);
     void requestShutdownSilence(int buffers);
     bool waitForOnline(unsigned int timeoutMs);
     void logSinkCapabilities();
 
+    //=========================================================================
+    // Specialized hot paths, bound once per generation
+    //=========================================================================
+
+    // Producer: one variant per ring conversion and channel count (0 = any)
+    enum class PushPath { Dsd, DsdBitRev, DsdSwap, DsdBitRevSwap, Pack24, Upsample16To32, Copy };
+    using PushFn = size_t (DirettaSync::*)(const uint8_t* data, size_t numSamples, float gain,
+                                           size_t& inBytes);
+    template <PushPath Path, int Channels>
+    size_t pushSpecialized(const uint8_t* data, size_t numSamples, float gain, size_t& inBytes);
+    template <PushPath Path>
+    static PushFn selectPush(int channels);
+    // Frames of ringFrameBytes that fit both the free space and one staging buffer
+    size_t wholeStagedFrames(size_t ringFrameBytes) const;
+
+    // Consumer: Gated variants check shutdown/stop/prefill/stabilization and
+    // rebind to the ungated one once all are clear; any transition back into
+    // those states bumps m_consumerStateGen (invalidateConsumerState())
+    using PullFn = bool (DirettaSync::*)(diretta_stream& stream,
+                                         std::chrono::steady_clock::time_point callbackTime);
+    template <bool Remainder, bool Gated>
+    bool pullSpecialized(diretta_stream& stream, std::chrono::steady_clock::time_point callbackTime);
+
     class ReconfigureGuard {
     public:
         explicit ReconfigureGuard(DirettaSync& sync) : sync_(sync), active_(sync_.beginReconfigure()) {}
@@ -304,10 +478,38 @@ private:
 
     // Target
     ACQUA::IPAddress m_targetAddress;
+    std::string m_targetName;
     int m_targetIndex = -1;
     uint32_t m_mtuOverride = 0;
     uint32_t m_effectiveMTU = 1500;
 
+    // Target cache: enable() starts from m_cachedTarget, revalidated on m_validationThread
+    std::string m_targetCachePath;
+    std::string m_targetCacheIface;
+    TargetCache::Store m_targetCache;
+    TargetCache::Entry m_cachedTarget;
+    bool m_cacheHit = false;
+    std::thread m_validationThread;
+    std::mutex m_validationMutex;
+    std::atomic<bool> m_targetStale{false};  // Not found in the background: rediscover
+
+    // Fast start: connectSink() on m_sinkStartThread while the producer prefills
+    std::thread m_sinkStartThread;
+    std::mutex m_sinkStartMutex;
+    std::atomic<bool> m_sinkStarting{false};
+    std::atomic<bool> m_sinkStartFailed{false};  // Reported by the next open()
+    std::atomic<bool> m_warm{false};             // Opened by warmUp(), see isWarm()
+    StartupTimeline m_startup;
+
+    // Cycle tuning: learned entries, and the candidate under test during autoTune()
+    CycleTuning::Store m_tuning;
+    struct TuningTrial {
+        bool active = false;
+        unsigned int cycleUs = 0;  // 0 = calculated
+        DirettaTransferMode mode = DirettaTransferMode::VAR_MAX;
+    } m_trial;
+    unsigned int m_lastCycleTimeUs = 0;
+
     // Connection state
     std::atomic<bool> m_enabled{false};
     std::atomic<bool> m_open{false};
@@ -319,6 +521,14 @@ private:
     AudioFormat m_previousFormat;
     bool m_hasPreviousFormat = false;
 
+    // Format switch latency, per transition type (PCM/DSD -> PCM/DSD) and mode
+    struct FormatSwitchStats {
+        uint32_t count = 0;
+        double totalMs = 0.0;
+        double maxMs = 0.0;
+    };
+    FormatSwitchStats m_switchStats[2][4];  // [fast][from*2 + to], 0 = PCM, 1 = DSD
+
     // Worker thread
     std::atomic<bool> m_running{false};
     std::atomic<bool> m_stopRequested{false};
@@ -350,6 +560,8 @@ private:
     bool m_cachedNeedByteSwap{false};
     int m_cachedChannels{2};
     int m_cachedBytesPerSample{2};
+    PushFn m_pushFn = &DirettaSync::pushSpecialized<PushPath::Copy, 2>;
+    const char* m_cachedFormatLabel = "PCM";
 
     // Consumer state generation - incremented on config changes
     std::atomic<uint32_t> m_consumerStateGen{0};
@@ -361,10 +573,16 @@ private:
     int m_cachedBytesPerFrame{0};
     bool m_cachedConsumerIsDsd{false};
     uint8_t m_cachedSilenceByte{0};
+    PullFn m_pullFn = &DirettaSync::pullSpecialized<false, true>;
 
     // Ring buffer
     DirettaRingBuffer m_ringBuffer;
 
+    // Telemetry (see DirettaTelemetry.h)
+    DirettaTelemetry m_telemetry;
+    AdaptiveDepth m_depth;  // Used when m_config.adaptiveBuffer
+    std::chrono::steady_clock::time_point m_lastCallbackTime{};  // Consumer thread only
+
     // Format parameters (atomic snapshot for audio thread)
     std::atomic<int> m_sampleRate{44100};
     std::atomic<int> m_channels{2};
@@ -372,6 +590,7 @@ private:
     std::atomic<int> m_inputBytesPerSample{2};
     std::atomic<int> m_bytesPerBuffer{176};
     std::atomic<int> m_bytesPerFrame{0};
+    std::atomic<size_t> m_ringBytesPerSecond{0};
     std::atomic<uint32_t> m_framesPerBufferRemainder{0};
     std::atomic<uint32_t> m_framesPerBufferAccumulator{0};
     std::atomic<bool> m_need24BitPack{false};
@@ -380,6 +599,7 @@ private:
     std::atomic<bool> m_needDsdBitReversal{false};
     std::atomic<bool> m_needDsdByteSwap{false};  // For LITTLE endian targets
     std::atomic<bool> m_isLowBitrate{false};
+    std::atomic<float> m_gain{1.0f};
 
     // Prefill and stabilization
     size_t m_prefillTarget = 0;
@@ -0,0 +1,203 @@
+/**
+ * @file DirettaTelemetry.h
+ * @brief Lock-free buffer health counters for DirettaSync
+ *
+ * Updated from the hot paths (getNewStream on the SDK worker, sendAudio on
+ * the audio thread) with relaxed single-writer increments, read at any time
+ * from another thread for the --stats dump. Counters are cumulative since
+ * enable(); graph deltas between dumps.
+ */
+
+#ifndef DIRETTA_TELEMETRY_H
+#define DIRETTA_TELEMETRY_H
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include "TraceRecorder.h"
+
+class DirettaTelemetry {
+public:
+    // Ring fill level seen by the consumer, in 10% steps
+    static constexpr size_t FILL_BUCKETS = 10;
+
+    // Inter-callback interval (us): <125, <250, <500, <1000, <2000, <4000,
+    // <8000, <16000, >=16000
+    static constexpr size_t INTERVAL_BUCKETS = 9;
+
+    enum class SilenceReason { Prefill, Stabilization, Underrun, Reconfigure, Shutdown, Stopped, Count };
+
+    //=========================================================================
+    // Consumer side (getNewStream - SDK worker thread only)
+    //=========================================================================
+
+    void recordCallbackInterval(uint64_t intervalUs) {
+        size_t bucket = 0;
+        uint64_t limit = 125;
+        while (bucket < INTERVAL_BUCKETS - 1 && intervalUs >= limit) {
+            limit <<= 1;
+            bucket++;
+        }
+        bump(m_intervalHist[bucket]);
+        bump(m_intervalCount);
+        add(m_intervalSumUs, intervalUs);
+        add(m_intervalSumSqUs, intervalUs * intervalUs);
+        if (intervalUs > m_maxIntervalUs.load(std::memory_order_relaxed)) {
+            m_maxIntervalUs.store(intervalUs, std::memory_order_relaxed);
+        }
+    }
+
+    void recordFill(size_t avail, size_t ringSize) {
+        if (ringSize == 0) return;
+        size_t bucket = (avail * FILL_BUCKETS) / ringSize;
+        if (bucket >= FILL_BUCKETS) bucket = FILL_BUCKETS - 1;
+        bump(m_fillHist[bucket]);
+    }
+
+    void recordZeroCopy() {
+        bump(m_zeroCopyHits);
+        m_lastPull = Trace::PULL_ZERO_COPY;
+    }
+    void recordWrapCopy() {
+        bump(m_wrapCopies);
+        m_lastPull = Trace::PULL_WRAP_COPY;
+    }
+    void recordSilence(SilenceReason reason) {
+        bump(m_silence[static_cast<size_t>(reason)]);
+        m_lastPull = static_cast<uint16_t>(Trace::PULL_SILENCE + static_cast<uint16_t>(reason));
+    }
+    void recordUnderrunEvent() { bump(m_underrunEvents); }
+
+    // Path of the last buffer served (Trace::PullPath), for the trace
+    uint16_t lastPull() const { return m_lastPull; }
+
+    //=========================================================================
+    // Producer side (sendAudio / waitForSpace - audio thread only)
+    //=========================================================================
+
+    void recordPush(size_t bytes) {
+        bump(m_pushes);
+        add(m_pushBytes, bytes);
+    }
+    void recordPushRejected() { bump(m_pushRejected); }
+    void recordProducerWait(bool satisfied) { bump(satisfied ? m_producerWaits : m_producerWaitTimeouts); }
+
+    //=========================================================================
+    // Reader side (any thread)
+    //=========================================================================
+
+    // Callback interval moments and underruns, for scoring a time span by delta
+    struct Snapshot {
+        uint64_t intervals = 0;
+        uint64_t intervalSumUs = 0;
+        uint64_t intervalSumSqUs = 0;
+        uint64_t underrunEvents = 0;
+
+        double meanUs(const Snapshot& since) const {
+            uint64_t n = intervals - since.intervals;
+            return n ? static_cast<double>(intervalSumUs - since.intervalSumUs) / n : 0.0;
+        }
+        double stddevUs(const Snapshot& since) const {
+            uint64_t n = intervals - since.intervals;
+            if (n < 2) return 0.0;
+            double mean = meanUs(since);
+            double var = static_cast<double>(intervalSumSqUs - since.intervalSumSqUs) / n - mean * mean;
+            return var > 0 ? std::sqrt(var) : 0.0;
+        }
+    };
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        s.intervals = load(m_intervalCount);
+        s.intervalSumUs = load(m_intervalSumUs);
+        s.intervalSumSqUs = load(m_intervalSumSqUs);
+        s.underrunEvents = load(m_underrunEvents);
+        return s;
+    }
+
+    /**
+     * @brief One-line JSON snapshot, e.g. for "[Stats] {...}" log scraping
+     * @param ringSize Current ring size (bytes)
+     * @param ringAvail Current ring fill (bytes)
+     */
+    std::string toJson(size_t ringSize, size_t ringAvail) const {
+        static const char* const kSilenceNames[] = {
+            "prefill", "stabilization", "underrun", "reconfigure", "shutdown", "stopped"
+        };
+        static_assert(sizeof(kSilenceNames) / sizeof(kSilenceNames[0]) ==
+                      static_cast<size_t>(SilenceReason::Count), "silence reason names");
+
+        std::ostringstream os;
+        os << "{\"ring\":{\"size\":" << ringSize << ",\"avail\":" << ringAvail << "}";
+
+        os << ",\"fill_hist\":[";
+        for (size_t i = 0; i < FILL_BUCKETS; i++) {
+            os << (i ? "," : "") << load(m_fillHist[i]);
+        }
+        os << "],\"interval_hist_us\":{\"bounds\":[125,250,500,1000,2000,4000,8000,16000],\"counts\":[";
+        for (size_t i = 0; i < INTERVAL_BUCKETS; i++) {
+            os << (i ? "," : "") << load(m_intervalHist[i]);
+        }
+        Snapshot all = snapshot();
+        os << "],\"max\":" << load(m_maxIntervalUs)
+           << ",\"mean\":" << static_cast<uint64_t>(all.meanUs(Snapshot()))
+           << ",\"stddev\":" << static_cast<uint64_t>(all.stddevUs(Snapshot())) << "}";
+
+        os << ",\"consumer\":{\"zero_copy\":" << load(m_zeroCopyHits)
+           << ",\"wrap_copy\":" << load(m_wrapCopies)
+           << ",\"underrun_events\":" << load(m_underrunEvents) << "}";
+
+        os << ",\"silence\":{";
+        for (size_t i = 0; i < static_cast<size_t>(SilenceReason::Count); i++) {
+            os << (i ? "," : "") << "\"" << kSilenceNames[i] << "\":" << load(m_silence[i]);
+        }
+        os << "}";
+
+        os << ",\"producer\":{\"pushes\":" << load(m_pushes)
+           << ",\"bytes\":" << load(m_pushBytes)
+           << ",\"rejected\":" << load(m_pushRejected)
+           << ",\"waits\":" << load(m_producerWaits)
+           << ",\"wait_timeouts\":" << load(m_producerWaitTimeouts) << "}}";
+        return os.str();
+    }
+
+private:
+    // Single writer per counter: plain load+store avoids a locked RMW
+    static void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    static void add(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+    static uint64_t load(const std::atomic<uint64_t>& counter) {
+        return counter.load(std::memory_order_relaxed);
+    }
+
+    // Consumer-written (own cache line, away from producer counters)
+    alignas(64) std::atomic<uint64_t> m_fillHist[FILL_BUCKETS] = {};
+    std::atomic<uint64_t> m_intervalHist[INTERVAL_BUCKETS] = {};
+    std::atomic<uint64_t> m_maxIntervalUs{0};
+    std::atomic<uint64_t> m_intervalCount{0};
+    std::atomic<uint64_t> m_intervalSumUs{0};
+    std::atomic<uint64_t> m_intervalSumSqUs{0};
+    std::atomic<uint64_t> m_zeroCopyHits{0};
+    std::atomic<uint64_t> m_wrapCopies{0};
+    std::atomic<uint64_t> m_underrunEvents{0};
+    std::atomic<uint64_t> m_silence[static_cast<size_t>(SilenceReason::Count)] = {};
+    uint16_t m_lastPull = Trace::PULL_ZERO_COPY;
+    static_assert(static_cast<size_t>(SilenceReason::Count) == Trace::SILENCE_REASONS,
+                  "trace pull codes follow SilenceReason");
+
+    // Producer-written
+    alignas(64) std::atomic<uint64_t> m_pushes{0};
+    std::atomic<uint64_t> m_pushBytes{0};
+    std::atomic<uint64_t> m_pushRejected{0};
+    std::atomic<uint64_t> m_producerWaits{0};
+    std::atomic<uint64_t> m_producerWaitTimeouts{0};
+};
+
+#endif // DIRETTA_TELEMETRY_H
@@ -0,0 +1,156 @@
+/**
+ * @file FanOut.h
+ * @brief Follower targets fed from one decoder (multi-room)
+ *
+ * With --fan-out, DirettaRenderer keeps one AudioEngine (one HTTP fetch,
+ * one decode, one resampler/modulator pass) and hands every chunk the
+ * primary DirettaSync accepted to each follower DirettaSync as well. Each
+ * target keeps its own ring, sink format conversion and prefill: targets
+ * may negotiate different bit depths or DSD bit orders, so the converted
+ * ring bytes cannot be shared.
+ *
+ * The primary paces the decoder. Followers never block it; their DACs run
+ * on their own clocks, so a follower's queue slowly drifts against the
+ * primary's. SlipControl compares the queued audio (ms) of both after each
+ * push and drops or repeats single frames (32-bit groups per channel for
+ * DSD) to keep the follower within DEADBAND_MS of the primary, which also
+ * keeps the rooms in step.
+ */
+
+#ifndef FAN_OUT_H
+#define FAN_OUT_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class SlipControl {
+public:
+    static constexpr double DEADBAND_MS = 2.0;
+    static constexpr double SMOOTHING = 0.05;           // EMA weight per push
+    static constexpr size_t MAX_SLIP_PER_MILLE = 5;      // Of the units in one push
+
+    void reset() {
+        m_errorMs = 0.0;
+        m_primed = false;
+    }
+
+    /**
+     * @brief Slip decision for the next push to the follower
+     * @param followerMs Audio queued in the follower ring
+     * @param primaryMs Audio queued in the primary ring
+     * @param units Frames (PCM) or 32-bit groups per channel (DSD) in the push
+     * @param unitsPerMs Units per ms of audio
+     * @return Units to drop (> 0) or repeat (< 0)
+     */
+    long update(double followerMs, double primaryMs, size_t units, double unitsPerMs) {
+        double error = followerMs - primaryMs;
+        m_errorMs = m_primed ? m_errorMs + SMOOTHING * (error - m_errorMs) : error;
+        m_primed = true;
+        m_offsetMs.store(m_errorMs, std::memory_order_relaxed);
+        if (units < 2 || (m_errorMs < DEADBAND_MS && m_errorMs > -DEADBAND_MS)) return 0;
+
+        // Proportional, at most 0.5% of the push: single frames in steady
+        // state, faster convergence after a late start
+        size_t cap = std::max<size_t>(1, units * MAX_SLIP_PER_MILLE / 1000);
+        double wanted = (m_errorMs > 0 ? m_errorMs : -m_errorMs) * unitsPerMs / 16.0;
+        long slip = static_cast<long>(std::min<double>(std::max(wanted, 1.0), static_cast<double>(cap)));
+        if (m_errorMs > 0) {
+            add(m_dropped, static_cast<uint64_t>(slip));
+            // Assume the correction landed: no overshoot while the EMA catches up
+            m_errorMs -= slip / unitsPerMs;
+            return slip;
+        }
+        add(m_repeated, static_cast<uint64_t>(slip));
+        m_errorMs += slip / unitsPerMs;
+        return -slip;
+    }
+
+    // Readers: any thread
+    double offsetMs() const { return m_offsetMs.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    uint64_t repeated() const { return m_repeated.load(std::memory_order_relaxed); }
+
+    std::string json() const {
+        std::ostringstream os;
+        os << "{\"offset_ms\":" << static_cast<long>(offsetMs() * 10) / 10.0
+           << ",\"dropped\":" << dropped() << ",\"repeated\":" << repeated() << "}";
+        return os.str();
+    }
+
+private:
+    static void add(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    // Producer (audio callback) only
+    double m_errorMs = 0.0;
+    bool m_primed = false;
+
+    std::atomic<double> m_offsetMs{0.0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_repeated{0};
+};
+
+namespace FanOut {
+
+/**
+ * @brief Apply a slip to interleaved PCM frames
+ * @param frames In: frames in data; out: frames in the returned buffer
+ * @return data itself (drop, no slip) or staging (repeat)
+ */
+inline const uint8_t* slipPcm(const uint8_t* data, size_t& frames, size_t bytesPerFrame,
+                              long slip, std::vector<uint8_t>& staging) {
+    if (slip == 0 || frames < 2) return data;
+    if (slip > 0) {
+        frames -= std::min(frames - 1, static_cast<size_t>(slip));  // Drop from the tail
+        return data;
+    }
+
+    size_t extra = static_cast<size_t>(-slip);
+    staging.resize((frames + extra) * bytesPerFrame);
+    std::memcpy(staging.data(), data, frames * bytesPerFrame);
+    const uint8_t* last = data + (frames - 1) * bytesPerFrame;
+    for (size_t i = 0; i < extra; i++) {
+        std::memcpy(staging.data() + (frames + i) * bytesPerFrame, last, bytesPerFrame);
+    }
+    frames += extra;
+    return staging.data();
+}
+
+/**
+ * @brief Apply a slip to planar DSD ([ch0 bytes][ch1 bytes]...)
+ * @param bitsPerChannel In/out: sendAudio() DSD sample count
+ * @return data itself (no slip) or staging
+ */
+inline const uint8_t* slipDsdPlanar(const uint8_t* data, size_t& bitsPerChannel, int channels,
+                                    long slip, std::vector<uint8_t>& staging) {
+    size_t bytes = bitsPerChannel / 8;
+    if (slip == 0 || bytes < 8 || channels <= 0) return data;
+
+    size_t delta = static_cast<size_t>(slip > 0 ? slip : -slip) * 4;
+    if (slip > 0) delta = std::min(delta, (bytes - 4) & ~static_cast<size_t>(3));
+    size_t outBytes = slip > 0 ? bytes - delta : bytes + delta;
+
+    staging.resize(outBytes * static_cast<size_t>(channels));
+    for (int ch = 0; ch < channels; ch++) {
+        const uint8_t* in = data + static_cast<size_t>(ch) * bytes;
+        uint8_t* out = staging.data() + static_cast<size_t>(ch) * outBytes;
+        std::memcpy(out, in, std::min(bytes, outBytes));
+        // Repeat the channel's last 32 bits
+        for (size_t i = bytes; i < outBytes; i += 4) {
+            std::memcpy(out + i, in + bytes - 4, 4);
+        }
+    }
+    bitsPerChannel = outBytes * 8;
+    return staging.data();
+}
+
+} // namespace FanOut
+
+#endif // FAN_OUT_H
@@ -12,7 +12,8 @@
 #define AUDIO_INLINE __forceinline
 #endif
 
-#ifdef __AVX512F__
+// Compiled under target("avx512f,avx512bw") by memcpyfast_audio.h
+#if defined(__AVX512F__) || defined(MEMCPY_AUDIO_X86)
 //---------------------------------------------------------------------
 // 1024-byte aligned copy (16 x 64-byte AVX-512 registers)
 //---------------------------------------------------------------------
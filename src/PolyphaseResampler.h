@@ -0,0 +1,432 @@
+/**
+ * @file PolyphaseResampler.h
+ * @brief Native polyphase FIR sample-rate converter (alternative to libswresample)
+ *
+ * Rational L/M conversion with one Kaiser-windowed sinc prototype per rate
+ * ratio, split into L phases. Coefficient tables are built once per ratio
+ * (AudioEngine precomputes the configured upsampling families at startup)
+ * and shared by every decoder, so a track change only allocates history.
+ * The dot products run on the AudioKernels table (AVX2 / AVX-512 / NEON),
+ * and channels are split across a small worker pool so long filters at 8x
+ * rates stay real-time on ARM boxes.
+ *
+ * The filter's group delay is compensated (output sample 0 lines up with
+ * input sample 0) and finish() plays out the tail, so a track converts to
+ * exactly ceil(in * L / M) samples: gapless joins and sample-accurate
+ * seeks survive resampling.
+ */
+
+#ifndef POLYPHASE_RESAMPLER_H
+#define POLYPHASE_RESAMPLER_H
+
+#include "AudioKernels.h"
+#include "ThreadPlacement.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Persistent helper threads running one job per channel
+ *
+ * run() blocks until every job is done; job 0 (and every (threads+1)-th
+ * after it) runs on the caller, so a stereo stream needs one helper.
+ */
+class ChannelWorkers {
+public:
+    using Job = void (*)(void* context, size_t index);
+
+    explicit ChannelWorkers(size_t threads) {
+        for (size_t t = 0; t < threads; t++) {
+            m_threads.emplace_back([this, t] { loop(t + 1); });
+        }
+    }
+
+    ~ChannelWorkers() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for (std::thread& t : m_threads) t.join();
+    }
+
+    ChannelWorkers(const ChannelWorkers&) = delete;
+    ChannelWorkers& operator=(const ChannelWorkers&) = delete;
+
+    void run(size_t count, Job job, void* context) {
+        size_t stride = m_threads.size() + 1;
+        if (count <= 1 || m_threads.empty()) {
+            for (size_t i = 0; i < count; i++) job(context, i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_job = job;
+            m_context = context;
+            m_count = count;
+            m_pending = std::min(m_threads.size(), count - 1);
+            m_generation++;
+        }
+        m_cv.notify_all();
+
+        for (size_t i = 0; i < count; i += stride) job(context, i);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCv.wait(lock, [this] { return m_pending == 0; });
+    }
+
+private:
+    void loop(size_t index) {
+        ThreadPlacement::apply(ThreadPlacement::Role::Decode);
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_cv.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop) return;
+            seen = m_generation;
+            if (index >= m_count) continue;  // Fewer jobs than threads this round
+
+            Job job = m_job;
+            void* context = m_context;
+            size_t count = m_count;
+            size_t stride = m_threads.size() + 1;
+            lock.unlock();
+            for (size_t i = index; i < count; i += stride) job(context, i);
+            lock.lock();
+            if (--m_pending == 0) m_doneCv.notify_one();
+        }
+    }
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_doneCv;
+    Job m_job = nullptr;
+    void* m_context = nullptr;
+    size_t m_count = 0;
+    size_t m_pending = 0;
+    uint64_t m_generation = 0;
+    bool m_stop = false;
+};
+
+class PolyphaseResampler {
+public:
+    // Taps per phase when upsampling: passband to 0.90, stopband from 1.00 of
+    // the lower Nyquist, ~146 dB rejection. Scaled by M/L when downsampling.
+    static constexpr size_t kTapsPerPhase = 192;
+    static constexpr size_t kMaxCoefficients = size_t(4) << 20;  // 16 MB per ratio
+
+    struct Filter {
+        uint32_t up = 1;        // L
+        uint32_t down = 1;      // M
+        size_t taps = 0;        // Per phase, multiple of 16
+        std::vector<float> coeffs;  // [phase * taps + j], time-reversed for a forward dot
+    };
+
+    /**
+     * @brief Coefficient table for inRate -> outRate (built on first use, then cached)
+     * @return nullptr if the ratio would need more than kMaxCoefficients
+     */
+    static std::shared_ptr<const Filter> filterFor(uint32_t inRate, uint32_t outRate) {
+        if (inRate == 0 || outRate == 0) return nullptr;
+        uint32_t g = std::gcd(inRate, outRate);
+        uint32_t up = outRate / g;
+        uint32_t down = inRate / g;
+
+        static std::mutex mutex;
+        static std::map<std::pair<uint32_t, uint32_t>, std::shared_ptr<const Filter>> cache;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = cache.find({up, down});
+        if (it != cache.end()) return it->second;
+
+        std::shared_ptr<const Filter> filter = design(up, down);
+        cache[{up, down}] = filter;
+        return filter;
+    }
+
+    PolyphaseResampler(uint32_t inRate, uint32_t outRate, size_t channels)
+        : m_filter(filterFor(inRate, outRate))
+        , m_channels(channels)
+        , m_history(channels)
+        , m_output(channels)
+    {
+        if (!m_filter || channels == 0) {
+            m_filter.reset();
+            return;
+        }
+        size_t cpus = std::max(1u, std::thread::hardware_concurrency());
+        size_t helpers = std::min(channels, cpus) - 1;
+        if (helpers > 0) m_workers = std::make_unique<ChannelWorkers>(helpers);
+        reset();
+    }
+
+    bool valid() const { return m_filter != nullptr; }
+    uint32_t up() const { return m_filter->up; }
+    uint32_t down() const { return m_filter->down; }
+    size_t taps() const { return m_filter->taps; }
+
+    /**
+     * @brief Back to the state of a fresh stream (after a seek)
+     */
+    void reset() {
+        const Filter& f = *m_filter;
+        for (std::vector<float>& h : m_history) h.assign(f.taps - 1, 0.0f);  // x[-taps+1 .. -1]
+        m_historyStart = -static_cast<int64_t>(f.taps - 1);
+        m_historyLength = f.taps - 1;
+        // Centre of the prototype: output 0 is the response peak of input 0
+        uint64_t centre = centreOf(f);
+        m_next = static_cast<int64_t>(centre / f.up);
+        m_phase = static_cast<uint32_t>(centre % f.up);
+        m_inputTotal = 0;
+        m_outputTotal = 0;
+        m_finished = false;
+    }
+
+    /**
+     * @brief Room for frames more input samples per channel
+     *
+     * Write planar float (full scale +-1.0) to input(ch)[0 .. frames), then commit(frames).
+     */
+    float* input(size_t channel, size_t frames) {
+        std::vector<float>& h = m_history[channel];
+        size_t used = historyLength();
+        if (h.size() < used + frames) h.resize(used + frames);
+        return h.data() + used;
+    }
+
+    void commit(size_t frames) {
+        m_inputTotal += frames;
+        m_historyLength += frames;
+    }
+
+    /**
+     * @brief End of stream: pad with silence so the tail of the last input comes out
+     */
+    void finish() {
+        if (m_finished) return;
+        size_t pad = m_filter->taps;  // > the centre's lookahead of taps / 2
+        for (size_t ch = 0; ch < m_channels; ch++) {
+            std::fill_n(input(ch, pad), pad, 0.0f);
+        }
+        m_historyLength += pad;
+        m_finished = true;
+    }
+
+    /**
+     * @brief Output samples producible from the input buffered so far
+     */
+    size_t available() const {
+        const Filter& f = *m_filter;
+        int64_t end = m_historyStart + static_cast<int64_t>(historyLength());
+        size_t count = 0;
+        if (m_next < end) {
+            uint64_t span = static_cast<uint64_t>(end - m_next) * f.up - m_phase;
+            count = static_cast<size_t>((span + f.down - 1) / f.down);
+        }
+        if (m_finished) {
+            uint64_t total = (m_inputTotal * f.up + f.down - 1) / f.down;
+            count = static_cast<size_t>(std::min<uint64_t>(count, total - m_outputTotal));
+        }
+        return count;
+    }
+
+    /**
+     * @brief Produce up to maxFrames interleaved frames
+     * @param outputBits 16 (S16, TPDF dither), 24 (S32 MSB-aligned, TPDF dither) or 32 (S32)
+     * @return Frames written to out
+     */
+    size_t produce(uint8_t* out, size_t maxFrames, uint32_t outputBits) {
+        size_t frames = runFilter(maxFrames);
+        if (frames == 0) return 0;
+        writeInterleaved(out, frames, outputBits);
+        advance(frames);
+        return frames;
+    }
+
+    /**
+     * @brief Produce up to maxFrames planar float frames into out[ch][0 .. frames)
+     *
+     * For stages that keep processing in float (DsdModulator).
+     */
+    size_t produce(float* const* out, size_t maxFrames) {
+        size_t frames = runFilter(maxFrames);
+        if (frames == 0) return 0;
+        for (size_t ch = 0; ch < m_channels; ch++) {
+            std::memcpy(out[ch], m_output[ch].data(), frames * sizeof(float));
+        }
+        advance(frames);
+        return frames;
+    }
+
+private:
+    // Run the FIR for up to maxFrames outputs into m_output
+    size_t runFilter(size_t maxFrames) {
+        size_t frames = std::min(available(), maxFrames);
+        if (frames == 0) return 0;
+
+        for (std::vector<float>& o : m_output) {
+            if (o.size() < frames) o.resize(frames);
+        }
+        m_jobFrames = frames;
+        // Worker wake-up costs a few microseconds: only worth it for real work
+        if (m_workers && frames * m_filter->taps >= 16384) {
+            m_workers->run(m_channels, &PolyphaseResampler::channelJob, this);
+        } else {
+            for (size_t ch = 0; ch < m_channels; ch++) channelJob(this, ch);
+        }
+        return frames;
+    }
+
+    static std::shared_ptr<const Filter> design(uint32_t up, uint32_t down) {
+        auto filter = std::make_shared<Filter>();
+        filter->up = up;
+        filter->down = down;
+
+        double ratio = static_cast<double>(down) / up;
+        size_t taps = static_cast<size_t>(std::ceil(kTapsPerPhase * std::max(1.0, ratio)));
+        taps = (taps + 15) & ~size_t(15);
+        if (taps * up > kMaxCoefficients) return nullptr;
+        filter->taps = taps;
+
+        // Prototype at the L-times rate; cycles per sample at that rate
+        size_t length = taps * up;
+        double nyquist = 0.5 / std::max<double>(up, down);
+        double cutoff = 0.95 * nyquist;
+        double transition = 0.10 * nyquist;
+        double attenuation = 2.285 * static_cast<double>(length - 1) * 2.0 * M_PI * transition + 8.0;
+        double beta = attenuation > 50.0 ? 0.1102 * (attenuation - 8.7)
+                    : attenuation > 21.0 ? 0.5842 * std::pow(attenuation - 21.0, 0.4) +
+                                           0.07886 * (attenuation - 21.0)
+                    : 0.0;
+
+        // Odd length (last coefficient stays zero) puts the centre on a sample:
+        // no half-sample delay left over after compensation
+        std::vector<double> h(length, 0.0);
+        double centre = static_cast<double>(centreOf(*filter));
+        double sum = 0.0;
+        for (size_t n = 0; n + 1 < length; n++) {
+            double t = static_cast<double>(n) - centre;
+            double x = 2.0 * cutoff * t;
+            double sinc = (x == 0.0) ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+            double r = t / centre;
+            double window = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / besselI0(beta);
+            h[n] = 2.0 * cutoff * sinc * window;
+            sum += h[n];
+        }
+
+        // Unity passband gain after zero-stuffing by L; phase p, tap j reversed:
+        // y = sum_j c[p][j] * x[i - taps + 1 + j]
+        double scale = static_cast<double>(up) / sum;
+        filter->coeffs.resize(length);
+        for (uint32_t p = 0; p < up; p++) {
+            for (size_t k = 0; k < taps; k++) {
+                filter->coeffs[p * taps + (taps - 1 - k)] = static_cast<float>(h[p + k * up] * scale);
+            }
+        }
+        return filter;
+    }
+
+    static uint64_t centreOf(const Filter& f) {
+        return (static_cast<uint64_t>(f.taps) * f.up - 2) / 2;
+    }
+
+    static double besselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        double half = x / 2.0;
+        for (int k = 1; k < 64; k++) {
+            term *= (half / k) * (half / k);
+            sum += term;
+            if (term < sum * 1e-16) break;
+        }
+        return sum;
+    }
+
+    size_t historyLength() const { return m_historyLength; }
+
+    static void channelJob(void* context, size_t channel) {
+        auto* self = static_cast<PolyphaseResampler*>(context);
+        const Filter& f = *self->m_filter;
+        AudioKernels::DotFn dot = AudioKernels::active().dot;
+        const float* history = self->m_history[channel].data();
+        float* out = self->m_output[channel].data();
+
+        int64_t next = self->m_next;
+        uint32_t phase = self->m_phase;
+        for (size_t n = 0; n < self->m_jobFrames; n++) {
+            const float* window = history + (next - static_cast<int64_t>(f.taps) + 1 - self->m_historyStart);
+            out[n] = dot(f.coeffs.data() + static_cast<size_t>(phase) * f.taps, window, f.taps);
+            phase += f.down;
+            next += phase / f.up;
+            phase %= f.up;
+        }
+    }
+
+    void writeInterleaved(uint8_t* out, size_t frames, uint32_t outputBits) {
+        for (size_t n = 0; n < frames; n++) {
+            for (size_t ch = 0; ch < m_channels; ch++) {
+                float v = m_output[ch][n];
+                size_t index = n * m_channels + ch;
+                if (outputBits == 16) {
+                    int16_t s = static_cast<int16_t>(AudioKernels::gainScaleClip(
+                        v, 32768.0f, AudioKernels::ditherTPDF(m_ditherIndex++), -32768.0f, 32767.0f));
+                    std::memcpy(out + index * 2, &s, 2);
+                } else if (outputBits == 24) {
+                    int32_t s = AudioKernels::gainScaleClip(
+                        v, 8388608.0f, AudioKernels::ditherTPDF(m_ditherIndex++), -8388608.0f, 8388607.0f);
+                    s = static_cast<int32_t>(static_cast<uint32_t>(s) << 8);
+                    std::memcpy(out + index * 4, &s, 4);
+                } else {
+                    int32_t s = AudioKernels::gainScaleClip(
+                        v, 2147483648.0f, 0.0f, -2147483648.0f, AudioKernels::kInt32MaxFloat);
+                    std::memcpy(out + index * 4, &s, 4);
+                }
+            }
+        }
+    }
+
+    void advance(size_t frames) {
+        const Filter& f = *m_filter;
+        uint64_t total = static_cast<uint64_t>(m_phase) + static_cast<uint64_t>(frames) * f.down;
+        m_next += static_cast<int64_t>(total / f.up);
+        m_phase = static_cast<uint32_t>(total % f.up);
+        m_outputTotal += frames;
+
+        // Drop input no future window reaches
+        int64_t keepFrom = m_next - static_cast<int64_t>(f.taps) + 1;
+        size_t drop = static_cast<size_t>(std::min<int64_t>(
+            std::max<int64_t>(keepFrom - m_historyStart, 0), static_cast<int64_t>(m_historyLength)));
+        if (drop == 0) return;
+        for (std::vector<float>& h : m_history) {
+            std::memmove(h.data(), h.data() + drop, (m_historyLength - drop) * sizeof(float));
+        }
+        m_historyStart += static_cast<int64_t>(drop);
+        m_historyLength -= drop;
+    }
+
+    std::shared_ptr<const Filter> m_filter;
+    size_t m_channels;
+    std::vector<std::vector<float>> m_history;   // Per channel: x[m_historyStart ..)
+    std::vector<std::vector<float>> m_output;    // Per channel scratch for produce()
+    std::unique_ptr<ChannelWorkers> m_workers;
+    size_t m_historyLength = 0;
+    int64_t m_historyStart = 0;
+    int64_t m_next = 0;          // Newest input index under the next output's window
+    uint32_t m_phase = 0;        // Filter phase of the next output
+    uint64_t m_inputTotal = 0;
+    uint64_t m_outputTotal = 0;
+    size_t m_jobFrames = 0;
+    uint32_t m_ditherIndex = 0;
+    bool m_finished = false;
+};
+
+#endif // POLYPHASE_RESAMPLER_H
@@ -16,11 +16,11 @@ public:
         // PCM capabilities
         std::vector<int> pcmRates;
         int pcmBits;              // 16, 24, or 32
-        int pcmChannels;          // typically 2 for stereo
+        int pcmChannels;          // Maximum: 2, 6 (5.1) or 8 (7.1)
         
         // DSD capabilities
         std::vector<int> dsdRates;
-        int dsdChannels;          // typically 2 for stereo
+        int dsdChannels;          // Maximum, as pcmChannels
         
         // Codec support flags
         bool supportFLAC;
@@ -69,8 +69,9 @@ public:
         };
         
         caps.pcmBits = 32;
-        caps.pcmChannels = 2;
-        caps.dsdChannels = 2;
+        // Up to 7.1: the sink's own limit is enforced at open()
+        caps.pcmChannels = 8;
+        caps.dsdChannels = 8;
         
         return caps;
     }
@@ -150,58 +151,78 @@ public:
 private:
     static void addPCMProtocols(std::vector<std::string>& protocols, 
                                 const AudioCapabilities& caps) {
-        for (int rate : caps.pcmRates) {
-            std::ostringstream oss;
-            
-            // Standard L16 format (network byte order, big-endian)
-            oss << "http-get:*:audio/L16;rate=" << rate 
-                << ";channels=" << caps.pcmChannels << ":*";
-            protocols.push_back(oss.str());
+        for (int channels : channelLayouts(caps.pcmChannels)) {
+            for (int rate : caps.pcmRates) {
+                std::ostringstream oss;
             
-            // Alternative L24 and L32 formats for high-resolution
-            if (caps.pcmBits >= 24) {
-                oss.str("");
-                oss << "http-get:*:audio/L24;rate=" << rate 
-                    << ";channels=" << caps.pcmChannels << ":*";
+                // Standard L16 format (network byte order, big-endian)
+                oss << "http-get:*:audio/L16;rate=" << rate 
+                    << ";channels=" << channels << ":*";
                 protocols.push_back(oss.str());
-            }
             
-            if (caps.pcmBits == 32) {
-                oss.str("");
-                oss << "http-get:*:audio/L32;rate=" << rate 
-                    << ";channels=" << caps.pcmChannels << ":*";
-                protocols.push_back(oss.str());
+                // Alternative L24 and L32 formats for high-resolution
+                if (caps.pcmBits >= 24) {
+                    oss.str("");
+                    oss << "http-get:*:audio/L24;rate=" << rate 
+                        << ";channels=" << channels << ":*";
+                    protocols.push_back(oss.str());
+                }
+            
+                if (caps.pcmBits == 32) {
+                    oss.str("");
+                    oss << "http-get:*:audio/L32;rate=" << rate 
+                        << ";channels=" << channels << ":*";
+                    protocols.push_back(oss.str());
+                }
             }
         }
     }
 
     static void addDSDProtocols(std::vector<std::string>& protocols, 
                                 const AudioCapabilities& caps) {
-        for (int rate : caps.dsdRates) {
-            std::ostringstream oss;
+        for (int channels : channelLayouts(caps.dsdChannels)) {
+            for (int rate : caps.dsdRates) {
+                std::ostringstream oss;
             
-            // Native DSD format
-            oss << "http-get:*:audio/dsd;rate=" << rate 
-                << ";channels=" << caps.dsdChannels << ":*";
-            protocols.push_back(oss.str());
-            
-            // Alternative DSD MIME types
-            oss.str("");
-            oss << "http-get:*:audio/x-dsd;rate=" << rate 
-                << ";channels=" << caps.dsdChannels << ":*";
-            protocols.push_back(oss.str());
+                // Native DSD format
+                oss << "http-get:*:audio/dsd;rate=" << rate 
+                    << ";channels=" << channels << ":*";
+                protocols.push_back(oss.str());
             
-            // DSD over PCM (DoP) - rate is doubled for DoP
-            if (rate <= 11289600) { // DoP typically limited to DSD256
-                int dopRate = rate / 16; // DoP packs 16 DSD bits into PCM samples
+                // Alternative DSD MIME types
                 oss.str("");
-                oss << "http-get:*:audio/L24;rate=" << dopRate 
-                    << ";channels=" << caps.dsdChannels << ":DLNA.ORG_PN=DSD";
+                oss << "http-get:*:audio/x-dsd;rate=" << rate 
+                    << ";channels=" << channels << ":*";
                 protocols.push_back(oss.str());
+            
+                // DSD over PCM (DoP) - rate is doubled for DoP
+                if (rate <= 11289600) { // DoP typically limited to DSD256
+                    int dopRate = rate / 16; // DoP packs 16 DSD bits into PCM samples
+                    oss.str("");
+                    oss << "http-get:*:audio/L24;rate=" << dopRate 
+                        << ";channels=" << channels << ":DLNA.ORG_PN=DSD";
+                    protocols.push_back(oss.str());
+                }
             }
         }
     }
 
+    /**
+     * @brief Advertised channel counts: stereo, 5.1 and 7.1 up to maxChannels,
+     * plus maxChannels itself when it is none of those
+     */
+    static std::vector<int> channelLayouts(int maxChannels) {
+        std::vector<int> layouts;
+        for (int channels : {2, 6, 8}) {
+            if (channels <= maxChannels) layouts.push_back(channels);
+        }
+        if (maxChannels > 0 &&
+            std::find(layouts.begin(), layouts.end(), maxChannels) == layouts.end()) {
+            layouts.push_back(maxChannels);
+        }
+        return layouts;
+    }
+
     static std::string joinProtocols(const std::vector<std::string>& protocols) {
         if (protocols.empty()) {
             return "";
@@ -0,0 +1,377 @@
+/**
+ * @file ReadAheadIO.h
+ * @brief Read-ahead I/O layer for network sources (custom AVIOContext)
+ *
+ * A dedicated network thread pulls the source through FFmpeg's own protocol
+ * layer (persistent HTTP connection, range requests on seek, reconnect) into
+ * a multi-megabyte byte ring. The demuxer reads from the ring through a
+ * custom AVIOContext, so av_read_frame() only blocks on the network when the
+ * ring is empty - a TCP hiccup is absorbed by whatever is buffered.
+ *
+ * Seeks inside the buffered window (including a short history behind the
+ * read position, for demuxer probing) are served from memory; others are
+ * forwarded to the network thread as a single range request.
+ */
+
+#ifndef READ_AHEAD_IO_H
+#define READ_AHEAD_IO_H
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ThreadPlacement.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavformat/avio.h>
+#include <libavutil/mem.h>
+}
+
+class ReadAheadIO {
+public:
+    // Process-wide counters for the --stats dump (all streams, cumulative)
+    struct Totals {
+        std::atomic<uint64_t> bytesFetched{0};
+        std::atomic<uint64_t> consumerStalls{0};   // Reads that found the ring empty
+        std::atomic<uint64_t> stallMicros{0};
+        std::atomic<uint64_t> windowSeeks{0};      // Served from the ring
+        std::atomic<uint64_t> networkSeeks{0};     // Range request
+        std::atomic<uint64_t> errors{0};
+        std::atomic<int64_t> bufferedBytes{0};     // Gauge: read-ahead held by open streams
+        std::atomic<int> activeStreams{0};
+    };
+
+    static Totals& totals() {
+        static Totals instance;
+        return instance;
+    }
+
+    static std::string statsJson() {
+        const Totals& t = totals();
+        std::ostringstream os;
+        os << "{\"read_ahead\":{\"streams\":" << t.activeStreams.load(std::memory_order_relaxed)
+           << ",\"buffered\":" << t.bufferedBytes.load(std::memory_order_relaxed)
+           << ",\"fetched\":" << t.bytesFetched.load(std::memory_order_relaxed)
+           << ",\"stalls\":" << t.consumerStalls.load(std::memory_order_relaxed)
+           << ",\"stall_ms\":" << t.stallMicros.load(std::memory_order_relaxed) / 1000
+           << ",\"window_seeks\":" << t.windowSeeks.load(std::memory_order_relaxed)
+           << ",\"network_seeks\":" << t.networkSeeks.load(std::memory_order_relaxed)
+           << ",\"errors\":" << t.errors.load(std::memory_order_relaxed) << "}}";
+        return os.str();
+    }
+
+    static bool isNetworkUrl(const std::string& url) {
+        return url.compare(0, 7, "http://") == 0 || url.compare(0, 8, "https://") == 0;
+    }
+
+    /**
+     * @param targetBytes Read-ahead the network thread keeps buffered
+     * @param verbose Log open/close summaries
+     */
+    ReadAheadIO(size_t targetBytes, bool verbose)
+        : m_target(std::max<size_t>(targetBytes, MIN_TARGET)), m_verbose(verbose) {
+        size_t capacity = 1;
+        while (capacity < m_target + m_target / 4) capacity <<= 1;
+        m_ring.resize(capacity);
+        m_mask = capacity - 1;
+        m_keepBehind = capacity / 8;
+    }
+
+    ~ReadAheadIO() { close(); }
+
+    ReadAheadIO(const ReadAheadIO&) = delete;
+    ReadAheadIO& operator=(const ReadAheadIO&) = delete;
+
+    /**
+     * @brief Open the source and start the network thread
+     * @param options Protocol options (consumed as by avio_open2)
+     */
+    bool open(const std::string& url, AVDictionary** options) {
+        AVIOInterruptCB interrupt{&ReadAheadIO::interruptCallback, this};
+        int ret = avio_open2(&m_source, url.c_str(), AVIO_FLAG_READ, &interrupt, options);
+        if (ret < 0) {
+            std::cerr << "[ReadAhead] Failed to open source (" << ret << ")" << std::endl;
+            return false;
+        }
+        m_size = avio_size(m_source);
+        m_seekable = (m_source->seekable & AVIO_SEEKABLE_NORMAL) != 0;
+
+        unsigned char* buffer = static_cast<unsigned char*>(av_malloc(AVIO_BUFFER_SIZE));
+        m_ctx = buffer ? avio_alloc_context(buffer, AVIO_BUFFER_SIZE, 0, this,
+                                            &ReadAheadIO::readPacket, nullptr,
+                                            &ReadAheadIO::seekPacket)
+                       : nullptr;
+        if (!m_ctx) {
+            av_free(buffer);
+            avio_closep(&m_source);
+            return false;
+        }
+        m_ctx->seekable = m_seekable ? AVIO_SEEKABLE_NORMAL : 0;
+
+        m_openTime = std::chrono::steady_clock::now();
+        totals().activeStreams.fetch_add(1, std::memory_order_relaxed);
+        m_thread = std::thread(&ReadAheadIO::networkThreadFunc, this);
+
+        if (m_verbose) {
+            std::cout << "[ReadAhead] Enabled: target " << (m_target >> 10) << " KB, ring "
+                      << (m_ring.size() >> 10) << " KB, size "
+                      << (m_size >= 0 ? std::to_string(m_size) : std::string("unknown"))
+                      << (m_seekable ? "" : " (not seekable)") << std::endl;
+        }
+        return true;
+    }
+
+    AVIOContext* context() const { return m_ctx; }
+
+    void close() {
+        if (!m_ctx && !m_source) return;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_abort = true;
+        }
+        m_producerCv.notify_all();
+        m_consumerCv.notify_all();
+        if (m_thread.joinable()) m_thread.join();
+
+        if (m_verbose) {
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_openTime).count();
+            std::cout << "[ReadAhead] Closed: fetched " << (m_fetched >> 10) << " KB in "
+                      << static_cast<int>(secs) << "s ("
+                      << (secs > 0 ? static_cast<uint64_t>(m_fetched / secs) >> 10 : 0) << " KB/s), "
+                      << m_stalls << " stalls" << std::endl;
+        }
+
+        totals().bufferedBytes.fetch_sub(m_writeEnd - m_readPos, std::memory_order_relaxed);
+        totals().activeStreams.fetch_sub(1, std::memory_order_relaxed);
+        m_readPos = m_writeEnd;
+
+        if (m_ctx) {
+            av_freep(&m_ctx->buffer);
+            avio_context_free(&m_ctx);
+        }
+        avio_closep(&m_source);
+    }
+
+    /**
+     * @brief Make a demuxer read waiting on the network return AVERROR_EXIT
+     *        while set (the network thread keeps buffering)
+     */
+    void interruptReads(bool on) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_readInterrupted = on;
+        }
+        if (on) m_consumerCv.notify_all();
+    }
+
+    size_t fill() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return static_cast<size_t>(m_writeEnd - m_readPos);
+    }
+
+private:
+    static constexpr int AVIO_BUFFER_SIZE = 64 * 1024;
+    static constexpr size_t NET_CHUNK = 64 * 1024;
+    static constexpr size_t MIN_TARGET = 256 * 1024;
+
+    static int interruptCallback(void* opaque) {
+        return static_cast<ReadAheadIO*>(opaque)->m_abort ? 1 : 0;
+    }
+
+    static int readPacket(void* opaque, uint8_t* buf, int size) {
+        return static_cast<ReadAheadIO*>(opaque)->read(buf, size);
+    }
+
+    static int64_t seekPacket(void* opaque, int64_t offset, int whence) {
+        return static_cast<ReadAheadIO*>(opaque)->seek(offset, whence);
+    }
+
+    // Demuxer side (audio / decode-ahead thread)
+    int read(uint8_t* buf, int size) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_writeEnd == m_readPos && !m_eof && m_error == 0 && !m_abort && !m_readInterrupted) {
+            // Ring ran dry: this is the only place the decoder waits on the network
+            auto start = std::chrono::steady_clock::now();
+            m_consumerCv.wait(lock, [this] {
+                return m_writeEnd > m_readPos || m_eof || m_error != 0 || m_abort ||
+                       m_readInterrupted;
+            });
+            auto waited = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            m_stalls++;
+            totals().consumerStalls.fetch_add(1, std::memory_order_relaxed);
+            totals().stallMicros.fetch_add(static_cast<uint64_t>(waited), std::memory_order_relaxed);
+        }
+        if (m_abort || m_readInterrupted) return AVERROR_EXIT;
+
+        size_t avail = static_cast<size_t>(m_writeEnd - m_readPos);
+        if (avail == 0) {
+            return m_error != 0 ? m_error : AVERROR_EOF;
+        }
+
+        size_t n = std::min(avail, static_cast<size_t>(size));
+        size_t pos = static_cast<size_t>(m_readPos) & m_mask;
+        size_t first = std::min(n, m_ring.size() - pos);
+        std::memcpy(buf, m_ring.data() + pos, first);
+        if (first < n) std::memcpy(buf + first, m_ring.data(), n - first);
+
+        m_readPos += static_cast<int64_t>(n);
+        m_histStart = std::max(m_histStart, m_readPos - static_cast<int64_t>(m_keepBehind));
+        totals().bufferedBytes.fetch_sub(static_cast<int64_t>(n), std::memory_order_relaxed);
+
+        // Producer resumes below 3/4 of target (see networkThreadFunc)
+        bool wake = m_producerWaiting &&
+                    static_cast<size_t>(m_writeEnd - m_readPos) < m_target - m_target / 4;
+        lock.unlock();
+        if (wake) m_producerCv.notify_one();
+        return static_cast<int>(n);
+    }
+
+    int64_t seek(int64_t offset, int whence) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (whence & AVSEEK_SIZE) {
+            return m_size >= 0 ? m_size : AVERROR(ENOSYS);
+        }
+        whence &= ~AVSEEK_FORCE;
+
+        int64_t target;
+        if (whence == SEEK_SET) target = offset;
+        else if (whence == SEEK_CUR) target = m_readPos + offset;
+        else if (whence == SEEK_END && m_size >= 0) target = m_size + offset;
+        else return AVERROR(EINVAL);
+        if (target < 0) return AVERROR(EINVAL);
+
+        if (target >= m_histStart && target <= m_writeEnd) {
+            totals().bufferedBytes.fetch_add(m_readPos - target, std::memory_order_relaxed);
+            m_readPos = target;
+            totals().windowSeeks.fetch_add(1, std::memory_order_relaxed);
+            return target;
+        }
+        if (!m_seekable) return AVERROR(ESPIPE);
+
+        // Outside the window: drop the ring, network thread re-requests from target
+        totals().bufferedBytes.fetch_sub(m_writeEnd - m_readPos, std::memory_order_relaxed);
+        totals().networkSeeks.fetch_add(1, std::memory_order_relaxed);
+        m_histStart = m_readPos = m_writeEnd = target;
+        m_seekPending = true;
+        m_generation++;
+        m_eof = false;
+        m_error = 0;
+        lock.unlock();
+        m_producerCv.notify_one();
+        return target;
+    }
+
+    // Network side
+    void networkThreadFunc() {
+        // Opened from the audio, preload or UPnP thread: never keep an RT placement
+        ThreadPlacement::apply(ThreadPlacement::Role::Io);
+        std::vector<uint8_t> chunk(NET_CHUNK);
+        bool refilling = true;  // Hysteresis: refill to target, resume below 3/4
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_abort) {
+            size_t fill = static_cast<size_t>(m_writeEnd - m_readPos);
+            size_t space = m_ring.size() - static_cast<size_t>(m_writeEnd - m_histStart);
+            if (fill >= m_target) refilling = false;
+            else if (fill < m_target - m_target / 4) refilling = true;
+
+            bool canRead = !m_eof && m_error == 0 && refilling && space > 0;
+            if (!m_seekPending && !canRead) {
+                m_producerWaiting = true;
+                m_producerCv.wait(lock);
+                m_producerWaiting = false;
+                continue;
+            }
+
+            uint64_t generation = m_generation;
+            if (m_seekPending) {
+                int64_t target = m_writeEnd;
+                m_seekPending = false;
+                lock.unlock();
+                int64_t ret = avio_seek(m_source, target, SEEK_SET);
+                lock.lock();
+                if (ret < 0 && generation == m_generation) {
+                    std::cerr << "[ReadAhead] Seek to " << target << " failed (" << ret << ")" << std::endl;
+                    totals().errors.fetch_add(1, std::memory_order_relaxed);
+                    m_error = static_cast<int>(ret);
+                    m_consumerCv.notify_all();
+                }
+                continue;
+            }
+
+            size_t want = std::min(space, NET_CHUNK);
+            lock.unlock();
+            int n = avio_read(m_source, chunk.data(), static_cast<int>(want));
+            lock.lock();
+
+            if (generation != m_generation) continue;  // Seeked meanwhile: discard
+            if (n == AVERROR_EOF || n == 0) {
+                m_eof = true;
+            } else if (n < 0) {
+                if (!m_abort) {
+                    std::cerr << "[ReadAhead] Read error (" << n << ") at " << m_writeEnd << std::endl;
+                    totals().errors.fetch_add(1, std::memory_order_relaxed);
+                }
+                m_error = n;
+            } else {
+                size_t pos = static_cast<size_t>(m_writeEnd) & m_mask;
+                size_t count = static_cast<size_t>(n);
+                size_t first = std::min(count, m_ring.size() - pos);
+                std::memcpy(m_ring.data() + pos, chunk.data(), first);
+                if (first < count) std::memcpy(m_ring.data(), chunk.data() + first, count - first);
+                m_writeEnd += n;
+                m_fetched += count;
+                totals().bytesFetched.fetch_add(count, std::memory_order_relaxed);
+                totals().bufferedBytes.fetch_add(n, std::memory_order_relaxed);
+            }
+            m_consumerCv.notify_all();
+        }
+    }
+
+    const size_t m_target;
+    const bool m_verbose;
+    std::vector<uint8_t> m_ring;
+    size_t m_mask = 0;
+    size_t m_keepBehind = 0;
+
+    AVIOContext* m_source = nullptr;   // FFmpeg protocol (network thread only after open)
+    AVIOContext* m_ctx = nullptr;      // Custom context handed to the demuxer
+    int64_t m_size = -1;
+    bool m_seekable = false;
+    std::thread m_thread;
+
+    // Ring window in absolute stream offsets: [histStart, readPos) already
+    // consumed but kept for backward seeks, [readPos, writeEnd) read-ahead
+    mutable std::mutex m_mutex;
+    std::condition_variable m_producerCv;
+    std::condition_variable m_consumerCv;
+    int64_t m_histStart = 0;
+    int64_t m_readPos = 0;
+    int64_t m_writeEnd = 0;
+    uint64_t m_generation = 0;
+    bool m_seekPending = false;
+    bool m_producerWaiting = false;
+    bool m_eof = false;
+    int m_error = 0;
+    bool m_readInterrupted = false;  // Demuxer side only, see interruptReads()
+    std::atomic<bool> m_abort{false};
+
+    // Per-stream summary (logged on close)
+    std::chrono::steady_clock::time_point m_openTime;
+    uint64_t m_fetched = 0;
+    uint64_t m_stalls = 0;
+};
+
+#endif // READ_AHEAD_IO_H
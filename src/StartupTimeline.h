@@ -0,0 +1,103 @@
+/**
+ * @file StartupTimeline.h
+ * @brief Time-to-first-sound breakdown for Play
+ *
+ * DirettaRenderer starts a timeline on Play; the renderer, DirettaSync::open()
+ * (or its fast-start sink thread), the producer and the SDK worker each stamp
+ * their phase once, as ms since Play. Stamps are relaxed atomics, so the SDK
+ * worker can mark first audio without locking or logging; the position thread
+ * prints the finished timeline as one "[Startup] {...}" line.
+ */
+
+#ifndef STARTUP_TIMELINE_H
+#define STARTUP_TIMELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+class StartupTimeline {
+public:
+    // In pipeline order, not necessarily in time order (fast start overlaps them)
+    enum class Phase {
+        DecoderOpen,     // AudioEngine::play() returned: URL opened, stream probed
+        FirstDecode,     // First decoded chunk reached the audio callback
+        SinkOpen,        // DirettaSync::open() entered
+        RingReady,       // Ring configured for the format: pushes accepted
+        SinkConfigured,  // setSink() accepted
+        Online,          // Target online (or the online wait gave up)
+        Prefilled,       // Prefill target reached
+        FirstAudio,      // SDK worker took the first buffer of audio
+        Count
+    };
+
+    // Play: restart all stamps from now
+    void begin() {
+        m_startNs.store(0, std::memory_order_relaxed);
+        for (auto& stamp : m_stamps) stamp.store(0, std::memory_order_relaxed);
+        m_reported.store(false, std::memory_order_relaxed);
+        m_startNs.store(nowNs(), std::memory_order_release);
+    }
+
+    // First mark per phase wins; one writer per phase. No-op before begin()
+    void mark(Phase phase) {
+        int64_t start = m_startNs.load(std::memory_order_acquire);
+        if (start == 0) return;
+        std::atomic<int64_t>& stamp = m_stamps[static_cast<size_t>(phase)];
+        if (stamp.load(std::memory_order_relaxed) != 0) return;
+        int64_t elapsed = nowNs() - start;
+        stamp.store(elapsed > 0 ? elapsed : 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return true once per begin(), when first audio has been stamped
+     */
+    bool takeReport() {
+        if (m_stamps[static_cast<size_t>(Phase::FirstAudio)].load(std::memory_order_relaxed) == 0) {
+            return false;
+        }
+        return !m_reported.exchange(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Stamps as ms since Play, e.g. {"decoder_open_ms":41.2,...};
+     *        phases never reached are null
+     */
+    std::string json() const {
+        static const char* const kNames[] = {
+            "decoder_open", "first_decode", "sink_open", "ring_ready",
+            "sink_configured", "online", "prefilled", "first_audio"
+        };
+        static_assert(sizeof(kNames) / sizeof(kNames[0]) == static_cast<size_t>(Phase::Count),
+                      "phase names");
+
+        std::ostringstream os;
+        os << "{";
+        for (size_t i = 0; i < static_cast<size_t>(Phase::Count); i++) {
+            int64_t ns = m_stamps[i].load(std::memory_order_relaxed);
+            os << (i ? "," : "") << "\"" << kNames[i] << "_ms\":";
+            if (ns == 0) {
+                os << "null";
+            } else {
+                os << static_cast<long long>(ns / 100000) / 10.0;
+            }
+        }
+        os << "}";
+        return os.str();
+    }
+
+private:
+    static int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::atomic<int64_t> m_startNs{0};  // 0 = no Play yet
+    std::atomic<int64_t> m_stamps[static_cast<size_t>(Phase::Count)] = {};
+    std::atomic<bool> m_reported{false};
+};
+
+#endif // STARTUP_TIMELINE_H
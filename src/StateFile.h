@@ -0,0 +1,74 @@
+/**
+ * @file StateFile.h
+ * @brief Tab-separated state files under /var/lib/diretta-renderer
+ *
+ * Shared by the target cache (TargetCache.h) and the cycle tuning results
+ * (CycleTuning.h): one entry per line, fields separated by tabs, '#'
+ * comments. A save writes <path>.tmp and renames it over the file, so a
+ * reader never sees a half-written file. Concurrent writers in one process
+ * must still be serialized by the caller.
+ */
+
+#ifndef STATE_FILE_H
+#define STATE_FILE_H
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+namespace StateFile {
+
+/**
+ * @brief Call onRow(fields) for every line with exactly `columns` fields;
+ *        comments, blank and malformed lines are skipped
+ * @return false if the file exists but could not be read; a missing
+ *         file has no rows
+ */
+template <typename OnRow>
+bool load(const std::string& path, size_t columns, OnRow&& onRow) {
+    std::ifstream in(path);
+    if (!in) return errno == ENOENT;
+
+    std::string line;
+    std::vector<std::string> fields;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        fields.clear();
+        std::istringstream ls(line);
+        std::string field;
+        while (std::getline(ls, field, '\t')) fields.push_back(field);
+        if (fields.size() != columns) continue;
+        onRow(fields);
+    }
+    return true;
+}
+
+/**
+ * @brief Replace the file with `header` (comment lines, written as is)
+ *        followed by whatever writeRows(std::ostream&) writes
+ */
+template <typename WriteRows>
+bool save(const std::string& path, const char* header, WriteRows&& writeRows) {
+    // Create the parent directory (one level, e.g. /var/lib/diretta-renderer)
+    size_t slash = path.find_last_of('/');
+    if (slash != std::string::npos && slash > 0) {
+        ::mkdir(path.substr(0, slash).c_str(), 0755);
+    }
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) return false;
+        out << header;
+        writeRows(out);
+        if (!out.flush()) return false;
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+} // namespace StateFile
+
+#endif // STATE_FILE_H
@@ -0,0 +1,131 @@
+/**
+ * @file TargetCache.h
+ * @brief Last known Diretta target, for a fast start
+ *
+ * Discovery (Find), the MTU probe and the sink capability inquiry take
+ * seconds at every start, and UPnP is only advertised once they are done.
+ * With a cache entry for the selected target (--target index and
+ * interface), DirettaSync::enable() starts from the stored address and MTU
+ * at once, and the real discovery runs in the background before the first
+ * open(). A stale entry (target not found, moved, new MTU) is corrected
+ * there, falling back to a full discovery. Sink capabilities are not
+ * cached: the SDK only takes them from a live inquiry, which runs with the
+ * background discovery.
+ *
+ * File format, one entry per line, '#' comments:
+ *   <interface>\t<index>\t<name>\t<address_hex>\t<mtu>
+ */
+
+#ifndef TARGET_CACHE_H
+#define TARGET_CACHE_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "StateFile.h"
+
+namespace TargetCache {
+
+struct Entry {
+    std::string iface;
+    int index = -1;        // --target index, -1 = first found
+    std::string name;
+    std::string address;   // Opaque hex of the SDK address object
+    uint32_t mtu = 0;
+};
+
+inline std::string toHex(const void* data, size_t size) {
+    static const char kDigits[] = "0123456789abcdef";
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    std::string out;
+    out.reserve(size * 2);
+    for (size_t i = 0; i < size; i++) {
+        out += kDigits[bytes[i] >> 4];
+        out += kDigits[bytes[i] & 0x0F];
+    }
+    return out;
+}
+
+inline bool fromHex(const std::string& hex, void* data, size_t size) {
+    if (hex.size() != size * 2) return false;
+    uint8_t* bytes = static_cast<uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        char pair[3] = {hex[2 * i], hex[2 * i + 1], 0};
+        char* end = nullptr;
+        unsigned long value = std::strtoul(pair, &end, 16);
+        if (end != pair + 2) return false;
+        bytes[i] = static_cast<uint8_t>(value);
+    }
+    return true;
+}
+
+class Store {
+public:
+    /**
+     * @return false if the file exists but could not be read; a missing
+     *         file is an empty store
+     */
+    bool load(const std::string& path) {
+        m_entries.clear();
+        return StateFile::load(path, 5, [this](const std::vector<std::string>& fields) {
+            Entry e;
+            e.iface = fields[0];
+            e.index = std::atoi(fields[1].c_str());
+            e.name = fields[2];
+            e.address = fields[3];
+            e.mtu = static_cast<uint32_t>(std::strtoul(fields[4].c_str(), nullptr, 10));
+            if (e.address.empty() || e.mtu == 0) return;
+            set(e);
+        });
+    }
+
+    bool save(const std::string& path) const {
+        return StateFile::save(path,
+            "# Diretta target cache (rewritten after every discovery)\n"
+            "# interface\tindex\tname\taddress\tmtu\n",
+            [this](std::ostream& out) {
+                for (const Entry& e : m_entries) {
+                    out << e.iface << '\t' << e.index << '\t' << e.name << '\t' << e.address << '\t'
+                        << e.mtu << '\n';
+                }
+            });
+    }
+
+    const Entry* find(const std::string& iface, int index) const {
+        for (const Entry& e : m_entries) {
+            if (e.iface == iface && e.index == index) return &e;
+        }
+        return nullptr;
+    }
+
+    void set(const Entry& entry) {
+        for (Entry& e : m_entries) {
+            if (e.iface == entry.iface && e.index == entry.index) {
+                e = entry;
+                return;
+            }
+        }
+        m_entries.push_back(entry);
+    }
+
+    void erase(const std::string& iface, int index) {
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->iface == iface && it->index == index) {
+                m_entries.erase(it);
+                return;
+            }
+        }
+    }
+
+    size_t size() const { return m_entries.size(); }
+
+private:
+    std::vector<Entry> m_entries;
+};
+
+} // namespace TargetCache
+
+#endif // TARGET_CACHE_H
@@ -0,0 +1,363 @@
+/**
+ * @file ThreadPlacement.h
+ * @brief Scheduling policy and CPU affinity plan for the renderer's threads
+ *
+ * Configured once from the command line (--sched role=policy[:prio][@cpus])
+ * before any thread starts, then applied by each thread on entry with
+ * ThreadPlacement::apply(role). Every placement is read back from the kernel
+ * and logged, so a silently ignored request (no CAP_SYS_NICE, CPU not in the
+ * cpuset, ...) shows up at startup rather than as a timing spike.
+ *
+ * Roles without their own entry fall back to "main", and fields neither
+ * sets fall back to the main thread's placement at startup. The main thread
+ * applies "main" before libupnp starts, so libupnp's pool inherits it too,
+ * and threads spawned from an RT thread (decode-ahead, preload, network I/O)
+ * do not inherit the RT placement by accident.
+ */
+
+#ifndef THREAD_PLACEMENT_H
+#define THREAD_PLACEMENT_H
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace ThreadPlacement {
+
+enum class Role { Main, SdkWorker, Audio, Decode, Preload, Position, UPnP, Io, Count };
+
+inline const char* roleName(Role role) {
+    static const char* const kNames[] = {
+        "main", "sdk", "audio", "decode", "preload", "position", "upnp", "io"
+    };
+    static_assert(sizeof(kNames) / sizeof(kNames[0]) == static_cast<size_t>(Role::Count),
+                  "thread role names");
+    return kNames[static_cast<size_t>(role)];
+}
+
+// Role the calling thread last applied (Main for threads that never do,
+// e.g. the libupnp pool); names the thread's lane in the trace
+inline Role& threadRole() {
+    thread_local Role role = Role::Main;
+    return role;
+}
+
+struct Spec {
+    bool configured = false;
+    int policy = 0;             // SCHED_OTHER / SCHED_FIFO / SCHED_RR
+    int priority = 0;           // 1..99 for FIFO/RR
+    bool setPolicy = false;     // false: leave policy as inherited
+    std::vector<int> cpus;      // empty: leave affinity as inherited
+};
+
+struct Plan {
+    Spec specs[static_cast<size_t>(Role::Count)];
+    Spec baseline;  // Main thread at startup (captureBaseline()), configured = captured
+    std::atomic<bool> reported[static_cast<size_t>(Role::Count)] = {};
+};
+
+inline Plan& plan() {
+    static Plan instance;
+    return instance;
+}
+
+inline const char* policyName(int policy) {
+#if defined(__linux__)
+    if (policy == SCHED_FIFO) return "fifo";
+    if (policy == SCHED_RR) return "rr";
+#endif
+    return "other";
+}
+
+inline std::string cpuListString(const std::vector<int>& cpus) {
+    std::ostringstream os;
+    for (size_t i = 0; i < cpus.size(); i++) {
+        os << (i ? "," : "") << cpus[i];
+    }
+    return os.str();
+}
+
+// "2", "2,3", "0-1,3"
+inline bool parseCpuList(const std::string& text, std::vector<int>& cpus) {
+    cpus.clear();
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) return false;
+        char* end = nullptr;
+        long first = std::strtol(item.c_str(), &end, 10);
+        long last = first;
+        if (*end == '-') {
+            last = std::strtol(end + 1, &end, 10);
+        }
+        if (*end != '\0' || first < 0 || last < first || last >= CPU_SETSIZE) return false;
+        for (long cpu = first; cpu <= last; cpu++) cpus.push_back(static_cast<int>(cpu));
+    }
+    return !cpus.empty();
+}
+
+/**
+ * @brief Parse one --sched entry: role=policy[:prio][@cpus] or role=@cpus
+ * @return Empty string on success, otherwise the error message
+ */
+inline std::string parse(const std::string& entry) {
+    size_t eq = entry.find('=');
+    if (eq == std::string::npos) return "expected role=policy[:prio][@cpus]";
+
+    std::string roleText = entry.substr(0, eq);
+    std::string rest = entry.substr(eq + 1);
+    Role role = Role::Count;
+    for (size_t i = 0; i < static_cast<size_t>(Role::Count); i++) {
+        if (roleText == roleName(static_cast<Role>(i))) role = static_cast<Role>(i);
+    }
+    if (role == Role::Count) {
+        return "unknown role '" + roleText + "' (main, sdk, audio, decode, preload, position, upnp, io)";
+    }
+
+    Spec spec;
+    spec.configured = true;
+    size_t at = rest.find('@');
+    std::string policyText = rest.substr(0, at);
+    if (at != std::string::npos && !parseCpuList(rest.substr(at + 1), spec.cpus)) {
+        return "invalid CPU list '" + rest.substr(at + 1) + "'";
+    }
+
+    if (!policyText.empty()) {
+        size_t colon = policyText.find(':');
+        std::string name = policyText.substr(0, colon);
+#if defined(__linux__)
+        if (name == "fifo") spec.policy = SCHED_FIFO;
+        else if (name == "rr") spec.policy = SCHED_RR;
+        else if (name == "other") spec.policy = SCHED_OTHER;
+        else return "unknown policy '" + name + "' (fifo, rr, other)";
+
+        if (colon != std::string::npos) {
+            spec.priority = std::atoi(policyText.c_str() + colon + 1);
+        } else if (spec.policy != SCHED_OTHER) {
+            return "priority required for " + name + " (e.g. " + name + ":80)";
+        }
+        if (spec.policy != SCHED_OTHER &&
+            (spec.priority < sched_get_priority_min(spec.policy) ||
+             spec.priority > sched_get_priority_max(spec.policy))) {
+            return "priority out of range for " + name;
+        }
+        if (spec.policy == SCHED_OTHER) spec.priority = 0;
+        spec.setPolicy = true;
+#else
+        (void)colon;
+        return "scheduling policies are only supported on Linux";
+#endif
+    }
+
+    plan().specs[static_cast<size_t>(role)] = spec;
+    return "";
+}
+
+inline bool anyConfigured() {
+    for (const Spec& spec : plan().specs) {
+        if (spec.configured) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Record the main thread's policy and affinity; call before any
+ *        other thread starts and before apply(Role::Main)
+ */
+inline void captureBaseline() {
+#if defined(__linux__)
+    Spec& baseline = plan().baseline;
+    int policy = SCHED_OTHER;
+    sched_param param{};
+    if (pthread_getschedparam(pthread_self(), &policy, &param) != 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) != 0) return;
+
+    baseline.policy = policy;
+    baseline.priority = param.sched_priority;
+    baseline.setPolicy = true;
+    baseline.cpus.clear();
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &set)) baseline.cpus.push_back(cpu);
+    }
+    baseline.configured = true;
+#endif
+}
+
+/**
+ * @brief Placement for role, field by field: its own entry, then "main",
+ *        then the startup baseline
+ *
+ * So a thread spawned from an RT thread (decode, preload, I/O, sink
+ * bring-up) never keeps that placement just because neither its role nor
+ * "main" is configured. The SDK worker is the exception: without an entry
+ * it keeps the priority the SDK gave it (--thread-mode).
+ * @return false if there is nothing to apply
+ */
+inline bool effectiveSpec(Role role, Spec& out) {
+    out = Spec();
+    if (role != Role::SdkWorker && plan().baseline.configured) out = plan().baseline;
+
+    const Spec* layers[] = {&plan().specs[static_cast<size_t>(Role::Main)],
+                            &plan().specs[static_cast<size_t>(role)]};
+    for (const Spec* layer : layers) {
+        if (!layer->configured) continue;
+        out.configured = true;
+        if (layer->setPolicy) {
+            out.setPolicy = true;
+            out.policy = layer->policy;
+            out.priority = layer->priority;
+        }
+        if (!layer->cpus.empty()) out.cpus = layer->cpus;
+    }
+    return out.configured;
+}
+
+/**
+ * @brief Startup sanity check: CPUs online and allowed, RT priority permitted
+ *
+ * Also warns when RT roles share a CPU with "main" or sit outside
+ * isolcpus= - both defeat the point of pinning.
+ */
+inline void validate() {
+#if defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+
+    std::vector<int> isolated;
+    {
+        std::ifstream f("/sys/devices/system/cpu/isolated");
+        std::string line;
+        if (f && std::getline(f, line) && !line.empty()) parseCpuList(line, isolated);
+    }
+
+    struct rlimit rtLimit{};
+    getrlimit(RLIMIT_RTPRIO, &rtLimit);
+    bool privileged = (geteuid() == 0);
+
+    const Spec& mainSpec = plan().specs[static_cast<size_t>(Role::Main)];
+    for (size_t i = 0; i < static_cast<size_t>(Role::Count); i++) {
+        const Spec& spec = plan().specs[i];
+        if (!spec.configured) continue;
+        const char* name = roleName(static_cast<Role>(i));
+
+        std::cout << "[Threads] " << name << ": "
+                  << (spec.setPolicy ? policyName(spec.policy) : "inherit");
+        if (spec.setPolicy && spec.policy != SCHED_OTHER) std::cout << "/" << spec.priority;
+        std::cout << " cpus=" << (spec.cpus.empty() ? "inherit" : cpuListString(spec.cpus)) << std::endl;
+
+        for (int cpu : spec.cpus) {
+            if (!CPU_ISSET(cpu, &allowed)) {
+                std::cerr << "[Threads] WARNING: " << name << " CPU " << cpu
+                          << " is offline or outside this process's cpuset" << std::endl;
+            }
+        }
+        bool realtime = spec.setPolicy && spec.policy != SCHED_OTHER;
+        if (realtime && !privileged && rtLimit.rlim_cur != RLIM_INFINITY &&
+            static_cast<rlim_t>(spec.priority) > rtLimit.rlim_cur) {
+            std::cerr << "[Threads] WARNING: " << name << " priority " << spec.priority
+                      << " exceeds RLIMIT_RTPRIO (" << rtLimit.rlim_cur
+                      << ") - needs root or CAP_SYS_NICE" << std::endl;
+        }
+        if (realtime && static_cast<Role>(i) != Role::Main) {
+            for (int cpu : spec.cpus) {
+                bool shared = false;
+                for (int mainCpu : mainSpec.cpus) shared = shared || (mainCpu == cpu);
+                bool isIsolated = false;
+                for (int iso : isolated) isIsolated = isIsolated || (iso == cpu);
+                if (shared) {
+                    std::cerr << "[Threads] WARNING: " << name << " CPU " << cpu
+                              << " is shared with main (UPnP/housekeeping)" << std::endl;
+                } else if (!isolated.empty() && !isIsolated) {
+                    std::cerr << "[Threads] NOTE: " << name << " CPU " << cpu
+                              << " is not in isolcpus=" << cpuListString(isolated) << std::endl;
+                }
+            }
+        }
+    }
+#endif
+}
+
+/**
+ * @brief Apply the plan for role to the calling thread and verify it
+ *
+ * Logs the outcome the first time each role is applied; later calls (the
+ * worker restarts on every track) only log if the result differs.
+ * @return true if nothing was requested or everything was granted
+ */
+inline bool apply(Role role) {
+    threadRole() = role;
+    Spec resolved;
+    if (!effectiveSpec(role, resolved)) return true;
+    const Spec* spec = &resolved;
+    // Only the baseline: restored silently, problems are still reported
+    bool entry = plan().specs[static_cast<size_t>(role)].configured ||
+                 plan().specs[static_cast<size_t>(Role::Main)].configured;
+#if defined(__linux__)
+    pthread_t self = pthread_self();
+    std::string problems;
+
+    if (!spec->cpus.empty()) {
+        cpu_set_t want;
+        CPU_ZERO(&want);
+        for (int cpu : spec->cpus) CPU_SET(cpu, &want);
+        int rc = pthread_setaffinity_np(self, sizeof(want), &want);
+        cpu_set_t got;
+        CPU_ZERO(&got);
+        pthread_getaffinity_np(self, sizeof(got), &got);
+        if (rc != 0 || !CPU_EQUAL(&want, &got)) {
+            problems += std::string(" affinity: ") + (rc ? std::strerror(rc) : "not applied");
+        }
+    }
+
+    if (spec->setPolicy) {
+        sched_param param{};
+        param.sched_priority = spec->priority;
+        int rc = pthread_setschedparam(self, spec->policy, &param);
+        int gotPolicy = -1;
+        sched_param gotParam{};
+        pthread_getschedparam(self, &gotPolicy, &gotParam);
+        if (rc != 0 || gotPolicy != spec->policy || gotParam.sched_priority != spec->priority) {
+            problems += std::string(" policy: ") + (rc ? std::strerror(rc) : "not applied") +
+                        " (running " + policyName(gotPolicy) + "/" +
+                        std::to_string(gotParam.sched_priority) + ")";
+        }
+    }
+
+    bool ok = problems.empty();
+    bool first = !plan().reported[static_cast<size_t>(role)].exchange(true, std::memory_order_relaxed);
+    if (!ok) {
+        std::cerr << "[Threads] " << roleName(role) << " placement NOT applied:" << problems << std::endl;
+    } else if (first && entry) {
+        std::cout << "[Threads] " << roleName(role) << " placement applied ("
+                  << (spec->setPolicy ? policyName(spec->policy) : "inherited policy");
+        if (spec->setPolicy && spec->policy != SCHED_OTHER) std::cout << "/" << spec->priority;
+        std::cout << ", cpus=" << (spec->cpus.empty() ? "inherited" : cpuListString(spec->cpus))
+                  << ")" << std::endl;
+    }
+    return ok;
+#else
+    (void)spec;
+    (void)entry;
+    return false;
+#endif
+}
+
+} // namespace ThreadPlacement
+
+#endif // THREAD_PLACEMENT_H
@@ -0,0 +1,446 @@
+/**
+ * @file TraceRecorder.h
+ * @brief Always-on event trace of the audio hot path, frozen on underrun
+ *
+ * The telemetry counters say how often something went wrong; the trace says
+ * in which order. Every thread that records gets its own lane: a fixed ring
+ * of 32-byte records with a raw TSC timestamp (x86 rdtsc, aarch64 cntvct),
+ * written with one relaxed load and one release store of its own head, so
+ * recording never locks, allocates (after the first record) or shares a
+ * cache line with another writer.
+ *
+ * An underrun (or SIGUSR2) triggers a dump. Recording goes on for
+ * AFTERMATH_MS, so an av_read_frame() still blocked at the underrun lands
+ * with its end event, then the position thread freezes all lanes (writers
+ * drop events), writes the dump and thaws the trace. Underrun triggers are
+ * held off for HOLDOFF_MS after a dump, so an underrun storm yields one
+ * dump, not one per second. trace_analyze turns a dump into a timeline and
+ * a verdict (network, decoder or scheduler).
+ *
+ * Dump file (native byte order, read on the same architecture):
+ *   FileHeader, then per lane: LaneHeader + count Records, oldest first
+ */
+
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ThreadPlacement.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Trace {
+
+enum class Event : uint16_t {
+    Pull,          // getNewStream: code = PullPath, a = bytes served, b = ring avail, c = ticks spent
+    Push,          // Ring push (sendAudio/writeDirect): a = input bytes, b = ring bytes written, c = ring avail
+    ProducerWait,  // waitForSpace: code = 1 if space came, a = bytes needed, b = ticks waited
+    Decode,        // readSamples / decode-ahead dequeue: code = DecodeSource, a = samples, b = ticks
+    ReadFrame,     // av_read_frame: code = 1 on error/EOF, a = packet bytes, b = ticks
+    Seek,          // Seek applied: code = 1 on failure, a = target ms, b = ticks
+    FormatChange,  // DirettaSync::open: code = 1 for DSD, a = rate, b = bits, c = channels
+    Underrun,      // Ring ran dry: a = bytes wanted, b = ring avail
+    Count
+};
+
+// Pull codes: the consumer path taken, silence codes follow
+// DirettaTelemetry::SilenceReason from PULL_SILENCE on
+enum PullPath : uint16_t { PULL_ZERO_COPY = 0, PULL_WRAP_COPY = 1, PULL_SILENCE = 2 };
+constexpr size_t SILENCE_REASONS = 6;
+
+// Decode codes: readSamples() ran on this thread, or process() took a
+// decode-ahead block (or found the queue empty)
+enum DecodeSource : uint16_t { DECODE_READ = 0, DECODE_QUEUE = 1, DECODE_QUEUE_EMPTY = 2 };
+
+enum class FreezeReason : uint32_t { None, Underrun, Signal };
+
+inline const char* eventName(Event event) {
+    static const char* const kNames[] = {
+        "pull", "push", "wait", "decode", "read_frame", "seek", "format", "underrun"
+    };
+    static_assert(sizeof(kNames) / sizeof(kNames[0]) == static_cast<size_t>(Event::Count),
+                  "trace event names");
+    size_t index = static_cast<size_t>(event);
+    return index < static_cast<size_t>(Event::Count) ? kNames[index] : "?";
+}
+
+inline const char* pullPathName(uint16_t code) {
+    static const char* const kNames[] = {
+        "zero_copy", "wrap_copy", "silence:prefill", "silence:stabilization", "silence:underrun",
+        "silence:reconfigure", "silence:shutdown", "silence:stopped"
+    };
+    static_assert(sizeof(kNames) / sizeof(kNames[0]) == PULL_SILENCE + SILENCE_REASONS,
+                  "pull path names");
+    return code < sizeof(kNames) / sizeof(kNames[0]) ? kNames[code] : "?";
+}
+
+inline const char* freezeReasonName(FreezeReason reason) {
+    switch (reason) {
+        case FreezeReason::Underrun: return "underrun";
+        case FreezeReason::Signal:   return "signal";
+        default:                     return "none";
+    }
+}
+
+struct Record {
+    uint64_t ticks;
+    uint16_t event;
+    uint16_t code;
+    uint32_t a;
+    uint64_t b;
+    uint64_t c;
+};
+static_assert(sizeof(Record) == 32, "trace record layout");
+
+struct FileHeader {
+    char magic[8];            // "DRTRACE1"
+    uint32_t laneCount;
+    uint32_t reason;          // FreezeReason
+    uint64_t triggerTicks;    // Underrun or signal
+    uint64_t freezeTicks;     // Recording stopped (AFTERMATH_MS or more later)
+    double ticksPerNs;
+    int64_t triggerUnixMs;
+};
+
+struct LaneHeader {
+    char name[16];            // ThreadPlacement role of the last owner
+    int32_t tid;
+    uint32_t count;
+};
+
+inline uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t value;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+inline int64_t steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class Recorder {
+public:
+    static constexpr size_t LANE_RECORDS = 8192;  // Power of 2; 256 KB per lane
+    static constexpr size_t MAX_LANES = 32;       // Threads that record (pool threads included)
+    static constexpr int64_t AFTERMATH_MS = 250;  // Recording after the trigger
+    static constexpr int64_t HOLDOFF_MS = 10000;  // No underrun trigger this soon after a dump
+
+    struct Lane {
+        std::atomic<bool> owned{false};
+        char name[16] = {};
+        int32_t tid = 0;
+        alignas(64) std::atomic<uint64_t> head{0};
+        Record records[LANE_RECORDS];
+    };
+
+    static Recorder& instance() {
+        static Recorder recorder;
+        return recorder;
+    }
+
+    // Any thread; the first call on a thread claims a lane
+    void record(Event event, uint16_t code, uint32_t a, uint64_t b, uint64_t c) {
+        if (m_state.load(std::memory_order_relaxed) != RECORDING) return;
+        Lane* lane = threadLane();
+        if (!lane) return;
+        uint64_t index = lane->head.load(std::memory_order_relaxed);
+        Record& r = lane->records[index & (LANE_RECORDS - 1)];
+        r.ticks = ticks();
+        r.event = static_cast<uint16_t>(event);
+        r.code = code;
+        r.a = a;
+        r.b = b;
+        r.c = c;
+        lane->head.store(index + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Ask for a dump; async-signal-safe
+     * @return false if a dump is already pending, the trace is off, or an
+     *         underrun comes within the holdoff
+     */
+    bool trigger(FreezeReason reason) {
+        uint64_t now = ticks();
+        if (m_state.load(std::memory_order_relaxed) != RECORDING) return false;
+        if (reason == FreezeReason::Underrun && now < m_holdoffUntil.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        int expected = IDLE;
+        if (!m_trigger.compare_exchange_strong(expected, CLAIMED, std::memory_order_acq_rel)) {
+            return false;
+        }
+        m_triggerTicks.store(now, std::memory_order_relaxed);
+        m_triggerNs.store(steadyNs(), std::memory_order_relaxed);
+        m_triggerUnixMs.store(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+        m_reason.store(static_cast<uint32_t>(reason), std::memory_order_relaxed);
+        m_trigger.store(TRIGGERED, std::memory_order_release);
+        return true;
+    }
+
+    // Triggered, and the aftermath has been recorded
+    bool dumpDue() const {
+        return m_trigger.load(std::memory_order_acquire) == TRIGGERED &&
+               steadyNs() - m_triggerNs.load(std::memory_order_relaxed) >= AFTERMATH_MS * 1000000;
+    }
+
+    FreezeReason reason() const {
+        return static_cast<FreezeReason>(m_reason.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Freeze all lanes and write them (one dumper); thaw() resumes
+     * @return Records written, -1 if the trace is off or the file could not be written
+     */
+    long dump(const std::string& path) {
+        int expected = RECORDING;
+        if (!m_state.compare_exchange_strong(expected, FROZEN, std::memory_order_acq_rel) &&
+            expected != FROZEN) {
+            return -1;
+        }
+        if (expected == RECORDING) {
+            m_freezeTicks.store(ticks(), std::memory_order_relaxed);
+            m_freezeNs.store(steadyNs(), std::memory_order_relaxed);
+        }
+
+        bool triggered = m_trigger.load(std::memory_order_acquire) == TRIGGERED;
+        FileHeader header{};
+        std::memcpy(header.magic, "DRTRACE1", 8);
+        header.reason = triggered ? m_reason.load(std::memory_order_relaxed) : 0;
+        header.freezeTicks = m_freezeTicks.load(std::memory_order_relaxed);
+        header.triggerTicks = triggered ? m_triggerTicks.load(std::memory_order_relaxed) : header.freezeTicks;
+        header.ticksPerNs = ticksPerNs();
+        header.triggerUnixMs = triggered ? m_triggerUnixMs.load(std::memory_order_relaxed)
+                                         : std::chrono::duration_cast<std::chrono::milliseconds>(
+                                               std::chrono::system_clock::now().time_since_epoch()).count();
+
+        std::vector<Lane*> lanes;
+        for (auto& slot : m_lanes) {
+            Lane* lane = slot.load(std::memory_order_acquire);
+            if (lane && lane->head.load(std::memory_order_acquire) > 0) lanes.push_back(lane);
+        }
+        header.laneCount = static_cast<uint32_t>(lanes.size());
+
+        std::string tmp = path + ".tmp";
+        FILE* file = std::fopen(tmp.c_str(), "wb");
+        if (!file) return -1;
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        long total = 0;
+        for (Lane* lane : lanes) {
+            uint64_t head = lane->head.load(std::memory_order_acquire);
+            uint64_t count = head < LANE_RECORDS ? head : LANE_RECORDS;
+            LaneHeader lh{};
+            std::memcpy(lh.name, lane->name, sizeof(lh.name));
+            lh.tid = lane->tid;
+            lh.count = static_cast<uint32_t>(count);
+            ok = ok && std::fwrite(&lh, sizeof(lh), 1, file) == 1;
+            // Oldest first: the ring from head (when full) around to head - 1
+            uint64_t first = head - count;
+            for (uint64_t i = first; ok && i < head;) {
+                size_t pos = static_cast<size_t>(i & (LANE_RECORDS - 1));
+                size_t run = static_cast<size_t>(std::min<uint64_t>(head - i, LANE_RECORDS - pos));
+                ok = std::fwrite(&lane->records[pos], sizeof(Record), run, file) == run;
+                i += run;
+            }
+            total += static_cast<long>(count);
+        }
+        ok = (std::fclose(file) == 0) && ok;
+        if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            return -1;
+        }
+        return total;
+    }
+
+    // Resume recording with empty lanes; underrun triggers wait out the holdoff
+    void thaw() {
+        for (auto& slot : m_lanes) {
+            Lane* lane = slot.load(std::memory_order_acquire);
+            if (lane) lane->head.store(0, std::memory_order_relaxed);
+        }
+        uint64_t holdoff = static_cast<uint64_t>(HOLDOFF_MS * 1e6 * ticksPerNs());
+        m_holdoffUntil.store(ticks() + holdoff, std::memory_order_relaxed);
+        m_trigger.store(IDLE, std::memory_order_release);
+        int expected = FROZEN;
+        m_state.compare_exchange_strong(expected, RECORDING, std::memory_order_acq_rel);
+    }
+
+    // --trace-file off: nothing is recorded from then on
+    void disable() { m_state.store(OFF, std::memory_order_relaxed); }
+    bool enabled() const { return m_state.load(std::memory_order_relaxed) != OFF; }
+
+private:
+    enum : int { RECORDING, FROZEN, OFF };
+    enum : int { IDLE, CLAIMED, TRIGGERED };
+
+    Recorder() : m_originTicks(ticks()), m_originNs(steadyNs()) {}
+
+    // Releases the lane when its thread exits (decoders and preloads come and go)
+    struct LaneHandle {
+        Lane* lane = nullptr;
+        bool claimed = false;
+        ~LaneHandle() {
+            if (lane) lane->owned.store(false, std::memory_order_release);
+        }
+    };
+
+    Lane* threadLane() {
+        thread_local LaneHandle handle;
+        if (!handle.claimed) {
+            handle.claimed = true;
+            handle.lane = claimLane();
+        }
+        return handle.lane;
+    }
+
+    Lane* claimLane() {
+        std::lock_guard<std::mutex> lock(m_claimMutex);
+        // A new lane while there are slots left; then the released lane
+        // whose newest event is oldest (exited threads keep their history)
+        Lane* lane = nullptr;
+        uint64_t oldest = UINT64_MAX;
+        for (auto& slot : m_lanes) {
+            Lane* existing = slot.load(std::memory_order_relaxed);
+            if (!existing) {
+                lane = new Lane();
+                slot.store(lane, std::memory_order_release);
+                break;
+            }
+            if (existing->owned.load(std::memory_order_acquire)) continue;
+            uint64_t head = existing->head.load(std::memory_order_relaxed);
+            uint64_t newest = head ? existing->records[(head - 1) & (LANE_RECORDS - 1)].ticks : 0;
+            if (newest < oldest) {
+                oldest = newest;
+                lane = existing;
+            }
+        }
+        if (!lane) return nullptr;  // All lanes taken: this thread is not traced
+        lane->head.store(0, std::memory_order_relaxed);
+
+        lane->owned.store(true, std::memory_order_release);
+        std::memset(lane->name, 0, sizeof(lane->name));
+        std::strncpy(lane->name, ThreadPlacement::roleName(ThreadPlacement::threadRole()),
+                     sizeof(lane->name) - 1);
+#if defined(__linux__)
+        lane->tid = static_cast<int32_t>(::syscall(SYS_gettid));
+#endif
+        return lane;
+    }
+
+    double ticksPerNs() const {
+        uint64_t endTicks = m_state.load(std::memory_order_relaxed) == FROZEN
+            ? m_freezeTicks.load(std::memory_order_relaxed) : ticks();
+        int64_t endNs = m_state.load(std::memory_order_relaxed) == FROZEN
+            ? m_freezeNs.load(std::memory_order_relaxed) : steadyNs();
+        int64_t spanNs = endNs - m_originNs;
+        if (spanNs < 1000000 || endTicks <= m_originTicks) return 1.0;  // Too short to calibrate
+        return static_cast<double>(endTicks - m_originTicks) / static_cast<double>(spanNs);
+    }
+
+    std::atomic<int> m_state{RECORDING};
+    std::atomic<int> m_trigger{IDLE};
+    std::atomic<uint32_t> m_reason{0};
+    std::atomic<uint64_t> m_triggerTicks{0};
+    std::atomic<int64_t> m_triggerNs{0};
+    std::atomic<int64_t> m_triggerUnixMs{0};
+    std::atomic<uint64_t> m_freezeTicks{0};
+    std::atomic<int64_t> m_freezeNs{0};
+    std::atomic<uint64_t> m_holdoffUntil{0};
+    const uint64_t m_originTicks;
+    const int64_t m_originNs;
+
+    std::mutex m_claimMutex;
+    std::atomic<Lane*> m_lanes[MAX_LANES] = {};
+};
+
+inline void record(Event event, uint16_t code = 0, uint32_t a = 0, uint64_t b = 0, uint64_t c = 0) {
+    Recorder::instance().record(event, code, a, b, c);
+}
+
+inline bool trigger(FreezeReason reason) { return Recorder::instance().trigger(reason); }
+
+//=============================================================================
+// Reading dumps (trace_analyze, tests)
+//=============================================================================
+
+struct LaneDump {
+    std::string name;
+    int tid = 0;
+    std::vector<Record> records;
+};
+
+struct Dump {
+    FreezeReason reason = FreezeReason::None;  // None: dumped without a trigger
+    uint64_t triggerTicks = 0;
+    uint64_t freezeTicks = 0;
+    double ticksPerNs = 1.0;
+    int64_t triggerUnixMs = 0;
+    std::vector<LaneDump> lanes;
+
+    // Signed ms relative to the trigger (negative = before)
+    double msFromTrigger(uint64_t t) const {
+        double delta = static_cast<double>(static_cast<int64_t>(t - triggerTicks));
+        return delta / ticksPerNs / 1e6;
+    }
+    double ticksToMs(uint64_t t) const { return static_cast<double>(t) / ticksPerNs / 1e6; }
+};
+
+/**
+ * @return false if the file is missing, truncated or not a trace dump
+ */
+inline bool load(const std::string& path, Dump& out) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    FileHeader header{};
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+              std::memcmp(header.magic, "DRTRACE1", 8) == 0 && header.laneCount <= Recorder::MAX_LANES;
+    if (ok) {
+        out.reason = static_cast<FreezeReason>(header.reason);
+        out.triggerTicks = header.triggerTicks;
+        out.freezeTicks = header.freezeTicks;
+        out.ticksPerNs = header.ticksPerNs > 0 ? header.ticksPerNs : 1.0;
+        out.triggerUnixMs = header.triggerUnixMs;
+        out.lanes.clear();
+    }
+    for (uint32_t i = 0; ok && i < header.laneCount; i++) {
+        LaneHeader lh{};
+        ok = std::fread(&lh, sizeof(lh), 1, file) == 1 && lh.count <= Recorder::LANE_RECORDS;
+        if (!ok) break;
+        LaneDump lane;
+        lane.name.assign(lh.name, strnlen(lh.name, sizeof(lh.name)));
+        lane.tid = lh.tid;
+        lane.records.resize(lh.count);
+        ok = lh.count == 0 || std::fread(lane.records.data(), sizeof(Record), lh.count, file) == lh.count;
+        out.lanes.push_back(std::move(lane));
+    }
+    std::fclose(file);
+    return ok;
+}
+
+} // namespace Trace
+
+#endif // TRACE_RECORDER_H
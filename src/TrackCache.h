@@ -0,0 +1,470 @@
+/**
+ * @file TrackCache.h
+ * @brief Whole-track RAM cache for network sources, keyed by URI
+ *
+ * setCurrentURI()/setNextURI() prefetch the track: a download thread pulls
+ * the whole file into an anonymous mapping sized from Content-Length. The
+ * decoder reads it through a TrackCacheReader (custom AVIOContext), so once
+ * the download is complete every seek is a pointer move and replaying the
+ * track does not touch the network. Reads ahead of the download wait for it.
+ *
+ * The cache is bounded by a byte budget. Entries no decoder or download
+ * holds are evicted least-recently-used first. Sources whose size is unknown
+ * or larger than the budget are not cached; the decoder opens them directly.
+ */
+
+#ifndef TRACK_CACHE_H
+#define TRACK_CACHE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <sys/mman.h>
+
+#include "ThreadPlacement.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavformat/avio.h>
+#include <libavutil/dict.h>
+#include <libavutil/mem.h>
+}
+
+/**
+ * @brief One cached track (download state + backing memory)
+ */
+struct TrackCacheEntry {
+    enum class State { Pending, Downloading, Complete, Failed };
+
+    explicit TrackCacheEntry(const std::string& u) : uri(u) {}
+
+    ~TrackCacheEntry() {
+        if (data) munmap(data, static_cast<size_t>(total));
+    }
+
+    TrackCacheEntry(const TrackCacheEntry&) = delete;
+    TrackCacheEntry& operator=(const TrackCacheEntry&) = delete;
+
+    const std::string uri;
+    uint8_t* data = nullptr;             // Anonymous mapping of total bytes
+    int64_t total = -1;
+    std::atomic<int64_t> downloaded{0};  // Published with release after each chunk
+    std::atomic<bool> abort{false};
+    bool tooLarge = false;               // Do not retry (unknown size / over budget)
+    uint64_t lastUse = 0;
+
+    // Guards state; cv signals progress and state changes
+    std::mutex mutex;
+    std::condition_variable cv;
+    State state = State::Pending;
+
+    std::thread worker;                  // Joined by TrackCache before release
+};
+
+/**
+ * @brief Per-decoder read position over a cache entry (custom AVIOContext)
+ */
+class TrackCacheReader {
+public:
+    explicit TrackCacheReader(std::shared_ptr<TrackCacheEntry> entry)
+        : m_entry(std::move(entry)) {
+        unsigned char* buffer = static_cast<unsigned char*>(av_malloc(AVIO_BUFFER_SIZE));
+        m_ctx = buffer ? avio_alloc_context(buffer, AVIO_BUFFER_SIZE, 0, this,
+                                            &TrackCacheReader::readPacket, nullptr,
+                                            &TrackCacheReader::seekPacket)
+                       : nullptr;
+        if (!m_ctx) {
+            av_free(buffer);
+        } else {
+            m_ctx->seekable = AVIO_SEEKABLE_NORMAL;
+        }
+    }
+
+    ~TrackCacheReader() {
+        if (m_ctx) {
+            av_freep(&m_ctx->buffer);
+            avio_context_free(&m_ctx);
+        }
+    }
+
+    TrackCacheReader(const TrackCacheReader&) = delete;
+    TrackCacheReader& operator=(const TrackCacheReader&) = delete;
+
+    AVIOContext* context() const { return m_ctx; }
+
+    /**
+     * @brief Make a read waiting ahead of the download return AVERROR_EXIT
+     *        while set
+     */
+    void interruptReads(bool on) {
+        TrackCacheEntry& e = *m_entry;
+        {
+            std::lock_guard<std::mutex> lock(e.mutex);
+            m_interrupted.store(on, std::memory_order_relaxed);
+        }
+        if (on) e.cv.notify_all();
+    }
+
+private:
+    static constexpr int AVIO_BUFFER_SIZE = 32 * 1024;
+
+    static int readPacket(void* opaque, uint8_t* buf, int size) {
+        return static_cast<TrackCacheReader*>(opaque)->read(buf, size);
+    }
+
+    static int64_t seekPacket(void* opaque, int64_t offset, int whence) {
+        return static_cast<TrackCacheReader*>(opaque)->seek(offset, whence);
+    }
+
+    int read(uint8_t* buf, int size) {
+        TrackCacheEntry& e = *m_entry;
+        if (m_pos >= e.total) return AVERROR_EOF;
+
+        int64_t avail = e.downloaded.load(std::memory_order_acquire) - m_pos;
+        if (avail <= 0) {
+            // Ahead of the download (only before it completes)
+            std::unique_lock<std::mutex> lock(e.mutex);
+            e.cv.wait(lock, [&] {
+                return e.downloaded.load(std::memory_order_acquire) > m_pos ||
+                       e.state == TrackCacheEntry::State::Failed ||
+                       m_interrupted.load(std::memory_order_relaxed);
+            });
+            if (m_interrupted.load(std::memory_order_relaxed)) return AVERROR_EXIT;
+            avail = e.downloaded.load(std::memory_order_acquire) - m_pos;
+            if (avail <= 0) return AVERROR(EIO);
+        }
+
+        int n = static_cast<int>(std::min<int64_t>(avail, size));
+        std::memcpy(buf, e.data + m_pos, static_cast<size_t>(n));
+        m_pos += n;
+        return n;
+    }
+
+    int64_t seek(int64_t offset, int whence) {
+        const int64_t total = m_entry->total;
+        if (whence & AVSEEK_SIZE) return total;
+        whence &= ~AVSEEK_FORCE;
+
+        int64_t target;
+        if (whence == SEEK_SET) target = offset;
+        else if (whence == SEEK_CUR) target = m_pos + offset;
+        else if (whence == SEEK_END) target = total + offset;
+        else return AVERROR(EINVAL);
+        if (target < 0 || target > total) return AVERROR(EINVAL);
+
+        m_pos = target;
+        return target;
+    }
+
+    std::shared_ptr<TrackCacheEntry> m_entry;
+    AVIOContext* m_ctx = nullptr;
+    int64_t m_pos = 0;
+    std::atomic<bool> m_interrupted{false};  // Set under the entry's mutex
+};
+
+class TrackCache {
+public:
+    // Process-wide counters for the --stats dump
+    struct Totals {
+        std::atomic<uint64_t> hits{0};        // Opened from a complete entry
+        std::atomic<uint64_t> partialHits{0}; // Opened while still downloading
+        std::atomic<uint64_t> misses{0};      // Not cacheable, opened from network
+        std::atomic<uint64_t> downloads{0};
+        std::atomic<uint64_t> bytesFetched{0};
+        std::atomic<uint64_t> evictions{0};
+        std::atomic<uint64_t> errors{0};
+        std::atomic<int64_t> usedBytes{0};
+        std::atomic<int> entries{0};
+    };
+
+    static Totals& totals() {
+        static Totals instance;
+        return instance;
+    }
+
+    static std::string statsJson() {
+        const Totals& t = totals();
+        std::ostringstream os;
+        os << "{\"track_cache\":{\"entries\":" << t.entries.load(std::memory_order_relaxed)
+           << ",\"used\":" << t.usedBytes.load(std::memory_order_relaxed)
+           << ",\"hits\":" << t.hits.load(std::memory_order_relaxed)
+           << ",\"partial_hits\":" << t.partialHits.load(std::memory_order_relaxed)
+           << ",\"misses\":" << t.misses.load(std::memory_order_relaxed)
+           << ",\"downloads\":" << t.downloads.load(std::memory_order_relaxed)
+           << ",\"fetched\":" << t.bytesFetched.load(std::memory_order_relaxed)
+           << ",\"evictions\":" << t.evictions.load(std::memory_order_relaxed)
+           << ",\"errors\":" << t.errors.load(std::memory_order_relaxed) << "}}";
+        return os.str();
+    }
+
+    static bool isCacheable(const std::string& uri) {
+        return uri.compare(0, 7, "http://") == 0 || uri.compare(0, 8, "https://") == 0;
+    }
+
+    /**
+     * @param budgetBytes Memory the cached tracks may occupy in total
+     * @param verbose Log downloads and evictions
+     * @param httpOptions Protocol options for every download (copied), the
+     *        same the decoder streams with
+     */
+    TrackCache(size_t budgetBytes, bool verbose, const AVDictionary* httpOptions = nullptr)
+        : m_budget(static_cast<int64_t>(budgetBytes)), m_verbose(verbose) {
+        if (httpOptions) av_dict_copy(&m_httpOptions, httpOptions, 0);
+    }
+
+    ~TrackCache() {
+        // Join outside m_mutex: a download may be about to reserve()
+        std::map<std::string, std::shared_ptr<TrackCacheEntry>> entries;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            entries.swap(m_entries);
+        }
+        for (auto& kv : entries) {
+            kv.second->abort = true;
+            kv.second->cv.notify_all();
+        }
+        for (auto& kv : entries) {
+            if (kv.second->worker.joinable()) kv.second->worker.join();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            releaseLocked(*kv.second);
+        }
+        av_dict_free(&m_httpOptions);
+    }
+
+    TrackCache(const TrackCache&) = delete;
+    TrackCache& operator=(const TrackCache&) = delete;
+
+    /**
+     * @brief Start downloading uri in the background if it is not cached yet
+     */
+    void prefetch(const std::string& uri) {
+        if (!isCacheable(uri)) return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        acquireLocked(uri);
+    }
+
+    /**
+     * @brief Reader over the cached track, or nullptr to open from the network
+     *
+     * Blocks until the download has learnt the size and reserved memory, so
+     * the caller never starts on an entry that is then refused.
+     */
+    std::unique_ptr<TrackCacheReader> open(const std::string& uri) {
+        if (!isCacheable(uri)) return nullptr;
+
+        std::shared_ptr<TrackCacheEntry> entry;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            entry = acquireLocked(uri);
+        }
+
+        bool complete;
+        {
+            std::unique_lock<std::mutex> lock(entry->mutex);
+            entry->cv.wait(lock, [&] { return entry->state != TrackCacheEntry::State::Pending; });
+            if (entry->state == TrackCacheEntry::State::Failed) {
+                totals().misses.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            complete = (entry->state == TrackCacheEntry::State::Complete);
+        }
+
+        auto reader = std::make_unique<TrackCacheReader>(entry);
+        if (!reader->context()) return nullptr;
+        (complete ? totals().hits : totals().partialHits).fetch_add(1, std::memory_order_relaxed);
+        if (m_verbose) {
+            std::cout << "[TrackCache] " << (complete ? "Hit" : "Partial hit") << " ("
+                      << (entry->total >> 10) << " KB)" << std::endl;
+        }
+        return reader;
+    }
+
+private:
+    static constexpr size_t NET_CHUNK = 256 * 1024;
+
+    // Caller holds m_mutex
+    std::shared_ptr<TrackCacheEntry> acquireLocked(const std::string& uri) {
+        auto it = m_entries.find(uri);
+        if (it != m_entries.end()) {
+            TrackCacheEntry& e = *it->second;
+            bool failed;
+            {
+                std::lock_guard<std::mutex> entryLock(e.mutex);
+                failed = (e.state == TrackCacheEntry::State::Failed);
+            }
+            if (!failed || e.tooLarge) {
+                e.lastUse = ++m_useClock;
+                return it->second;
+            }
+            // Network error last time: retry with a fresh entry
+            if (e.worker.joinable()) e.worker.join();
+            releaseLocked(e);
+            m_entries.erase(it);
+        }
+
+        auto entry = std::make_shared<TrackCacheEntry>(uri);
+        entry->lastUse = ++m_useClock;
+        m_entries[uri] = entry;
+        totals().entries.fetch_add(1, std::memory_order_relaxed);
+        entry->worker = std::thread(&TrackCache::downloadThreadFunc, this, entry);
+        return entry;
+    }
+
+    // Caller holds m_mutex; worker already joined
+    void releaseLocked(TrackCacheEntry& e) {
+        if (e.data) {
+            m_used -= e.total;
+            totals().usedBytes.fetch_sub(e.total, std::memory_order_relaxed);
+        }
+        totals().entries.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Make room for bytes, evicting idle entries LRU first
+     * @return false if the idle entries cannot free enough
+     */
+    bool reserve(TrackCacheEntry& entry, int64_t bytes) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (bytes > m_budget) return false;
+
+        while (m_used + bytes > m_budget) {
+            // Idle: only the map holds it (no reader, download finished)
+            auto victim = m_entries.end();
+            for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+                if (it->second.get() == &entry || it->second.use_count() > 1) continue;
+                if (victim == m_entries.end() || it->second->lastUse < victim->second->lastUse) {
+                    victim = it;
+                }
+            }
+            if (victim == m_entries.end()) return false;
+
+            if (m_verbose) {
+                std::cout << "[TrackCache] Evict " << (victim->second->total >> 10) << " KB" << std::endl;
+            }
+            if (victim->second->worker.joinable()) victim->second->worker.join();
+            releaseLocked(*victim->second);
+            m_entries.erase(victim);
+            totals().evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_used += bytes;
+        totals().usedBytes.fetch_add(bytes, std::memory_order_relaxed);
+        return true;
+    }
+
+    static int interruptCallback(void* opaque) {
+        return static_cast<TrackCacheEntry*>(opaque)->abort ? 1 : 0;
+    }
+
+    void setState(TrackCacheEntry& e, TrackCacheEntry::State state) {
+        {
+            std::lock_guard<std::mutex> lock(e.mutex);
+            e.state = state;
+        }
+        e.cv.notify_all();
+    }
+
+    void downloadThreadFunc(std::shared_ptr<TrackCacheEntry> entry) {
+        // Prefetched from the audio or UPnP thread: never keep an RT placement
+        ThreadPlacement::apply(ThreadPlacement::Role::Io);
+        TrackCacheEntry& e = *entry;
+        auto start = std::chrono::steady_clock::now();
+
+        AVDictionary* options = nullptr;
+        av_dict_copy(&options, m_httpOptions, 0);  // Read-only after construction
+
+        AVIOContext* source = nullptr;
+        AVIOInterruptCB interrupt{&TrackCache::interruptCallback, &e};
+        int ret = avio_open2(&source, e.uri.c_str(), AVIO_FLAG_READ, &interrupt, &options);
+        av_dict_free(&options);
+        if (ret < 0) {
+            if (!e.abort) {
+                std::cerr << "[TrackCache] Failed to open source (" << ret << ")" << std::endl;
+                totals().errors.fetch_add(1, std::memory_order_relaxed);
+            }
+            setState(e, TrackCacheEntry::State::Failed);
+            return;
+        }
+
+        int64_t total = avio_size(source);
+        void* mem = MAP_FAILED;
+        if (total > 0 && reserve(e, total)) {
+            mem = mmap(nullptr, static_cast<size_t>(total), PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mem == MAP_FAILED) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_used -= total;
+                totals().usedBytes.fetch_sub(total, std::memory_order_relaxed);
+            }
+        }
+        if (mem == MAP_FAILED) {
+            if (m_verbose) {
+                std::cout << "[TrackCache] Not caching (size "
+                          << (total > 0 ? std::to_string(total >> 10) + " KB" : std::string("unknown"))
+                          << ", budget " << (m_budget >> 10) << " KB)" << std::endl;
+            }
+            e.tooLarge = true;
+            avio_closep(&source);
+            setState(e, TrackCacheEntry::State::Failed);
+            return;
+        }
+
+        e.total = total;
+        e.data = static_cast<uint8_t*>(mem);
+        totals().downloads.fetch_add(1, std::memory_order_relaxed);
+        setState(e, TrackCacheEntry::State::Downloading);
+
+        int64_t done = 0;
+        while (done < total && !e.abort) {
+            int want = static_cast<int>(std::min<int64_t>(NET_CHUNK, total - done));
+            int n = avio_read(source, e.data + done, want);
+            if (n <= 0) break;
+            done += n;
+            totals().bytesFetched.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+            {
+                // Under the entry lock so a waiting reader cannot miss the wakeup
+                std::lock_guard<std::mutex> lock(e.mutex);
+                e.downloaded.store(done, std::memory_order_release);
+            }
+            e.cv.notify_all();
+        }
+        avio_closep(&source);
+
+        if (done < total) {
+            if (!e.abort) {
+                std::cerr << "[TrackCache] Download stopped at " << done << "/" << total << std::endl;
+                totals().errors.fetch_add(1, std::memory_order_relaxed);
+            }
+            setState(e, TrackCacheEntry::State::Failed);
+            return;
+        }
+
+        setState(e, TrackCacheEntry::State::Complete);
+        if (m_verbose) {
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "[TrackCache] Cached " << (total >> 10) << " KB in " << secs << "s" << std::endl;
+        }
+    }
+
+    const int64_t m_budget;
+    const bool m_verbose;
+    AVDictionary* m_httpOptions = nullptr;  // Copied into every download
+
+    std::mutex m_mutex;  // m_entries, m_used, m_useClock
+    std::map<std::string, std::shared_ptr<TrackCacheEntry>> m_entries;
+    int64_t m_used = 0;
+    uint64_t m_useClock = 0;
+};
+
+#endif // TRACK_CACHE_H
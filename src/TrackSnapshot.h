@@ -0,0 +1,62 @@
+/**
+ * @file TrackSnapshot.h
+ * @brief Versioned, immutable snapshots shared between threads (RCU style)
+ *
+ * The writer builds a complete new value and swaps it in; readers take a
+ * shared_ptr to whatever is current and keep a consistent view for as long
+ * as they hold it, while the writer never waits for them. Each publish bumps
+ * a version counter, so a hot-path reader that caches what it built from the
+ * last snapshot only compares one integer per call and loads the pointer
+ * again after a change. The pointer swap uses the C++17 shared_ptr atomic
+ * access functions; only version() is meant for per-buffer use.
+ */
+
+#ifndef TRACK_SNAPSHOT_H
+#define TRACK_SNAPSHOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+template <typename T>
+class SnapshotCell {
+public:
+    struct Snapshot {
+        uint64_t version;  // 0 = initial value, never published
+        T value;
+    };
+    using Ptr = std::shared_ptr<const Snapshot>;
+
+    SnapshotCell() : m_current(std::make_shared<const Snapshot>(Snapshot{0, T{}})) {}
+
+    /**
+     * @brief Replace the current value; writers are serialized by the owner
+     * @return Version of the new snapshot
+     */
+    uint64_t publish(T value) {
+        uint64_t version = m_version.load(std::memory_order_relaxed) + 1;
+        Ptr next = std::make_shared<const Snapshot>(Snapshot{version, std::move(value)});
+        std::atomic_store_explicit(&m_current, std::move(next), std::memory_order_release);
+        // After the swap: a reader seeing the new version loads the new value
+        m_version.store(version, std::memory_order_release);
+        return version;
+    }
+
+    // Current snapshot, never null; stays valid while held
+    Ptr load() const {
+        return std::atomic_load_explicit(&m_current, std::memory_order_acquire);
+    }
+
+    // Version of the latest publish: compare against the cached snapshot's
+    uint64_t version() const { return m_version.load(std::memory_order_acquire); }
+
+private:
+    Ptr m_current;
+    std::atomic<uint64_t> m_version{0};
+
+    SnapshotCell(const SnapshotCell&) = delete;
+    SnapshotCell& operator=(const SnapshotCell&) = delete;
+};
+
+#endif // TRACK_SNAPSHOT_H
@@ -1,11 +1,13 @@
 #include "UPnPDevice.hpp"
 #include "ProtocolInfoBuilder.h"
+#include <algorithm>
 #include <iostream>
 #include <sstream>
-#include <iomanip>
 #include <fstream>
 #include <cstring>
 #include <cstdlib>
+#include <cstdio>
+#include <sys/stat.h>
 
 // ============================================================================
 // Logging system - Variable globale définie dans main.cpp
@@ -24,6 +26,7 @@ UPnPDevice::UPnPDevice(const Config& config)
     , m_trackDuration(0)
     , m_volume(50)
     , m_mute(false)
+    , m_udn("uuid:" + config.uuid)
 {
     DEBUG_LOG("[UPnPDevice] Created: " << m_config.friendlyName);
     
@@ -36,10 +39,18 @@ UPnPDevice::UPnPDevice(const Config& config)
     DEBUG_LOG("[UPnPDevice] ProtocolInfo: " 
               << m_protocolInfo.length() << " chars, "
               << numFormats << " formats");
+
+    // Render static documents and response templates once
+    m_descriptionXML = generateDescriptionXML();
+    m_avtSCPD = generateAVTransportSCPD();
+    m_rcSCPD = generateRenderingControlSCPD();
+    m_cmSCPD = generateConnectionManagerSCPD();
+    initTemplates();
 }
 
 UPnPDevice::~UPnPDevice() {
     stop();
+    freeTemplates();
     DEBUG_LOG("[UPnPDevice] Destroyed");
 }
 
@@ -95,31 +106,32 @@ bool UPnPDevice::start() {
     // UpnpInitLog();
     // UpnpSetLogLevel(UPNP_INFO);
     
-    // 4. Generate device description
-    std::string descXML = generateDescriptionXML();
+    // 4. Device description (rendered in the constructor)
+    const std::string& descXML = m_descriptionXML;
     
     // 5. Create SCPD files on disk (needed for libupnp webserver)
     // Create temporary directory structure
-    system("mkdir -p /tmp/upnp_scpd/AVTransport");
-    system("mkdir -p /tmp/upnp_scpd/RenderingControl");
-    system("mkdir -p /tmp/upnp_scpd/ConnectionManager");
+    mkdir("/tmp/upnp_scpd", 0755);
+    mkdir("/tmp/upnp_scpd/AVTransport", 0755);
+    mkdir("/tmp/upnp_scpd/RenderingControl", 0755);
+    mkdir("/tmp/upnp_scpd/ConnectionManager", 0755);
     
-    // Write SCPD files to disk
+    // Write SCPD files to disk (pre-rendered, served as static files)
     std::ofstream avtFile("/tmp/upnp_scpd/AVTransport/scpd.xml");
     if (avtFile.is_open()) {
-        avtFile << generateAVTransportSCPD();
+        avtFile << m_avtSCPD;
         avtFile.close();
     }
     
     std::ofstream rcFile("/tmp/upnp_scpd/RenderingControl/scpd.xml");
     if (rcFile.is_open()) {
-        rcFile << generateRenderingControlSCPD();
+        rcFile << m_rcSCPD;
         rcFile.close();
     }
     
     std::ofstream cmFile("/tmp/upnp_scpd/ConnectionManager/scpd.xml");
     if (cmFile.is_open()) {
-        cmFile << generateConnectionManagerSCPD();
+        cmFile << m_cmSCPD;
         cmFile.close();
     }
     
@@ -160,6 +172,16 @@ bool UPnPDevice::start() {
     }
     
     m_running = true;
+
+    // 9. Start the GENA event thread (baseline = current state, nothing pending)
+    m_avtNotified = snapshotAVTState();
+    m_rcNotified = snapshotRCState();
+    {
+        std::lock_guard<std::mutex> eventLock(m_eventMutex);
+        m_eventThreadRunning = true;
+        m_eventPending = false;
+    }
+    m_eventThread = std::thread(&UPnPDevice::eventThreadFunc, this);
     
     std::cout << "[UPnPDevice] ✓ Device is now discoverable!" << std::endl;
     std::cout << "[UPnPDevice] Device URL: http://" << m_ipAddress 
@@ -169,6 +191,16 @@ bool UPnPDevice::start() {
 }
 
 void UPnPDevice::stop() {
+    // Event thread takes m_stateMutex for snapshots: join it first
+    {
+        std::lock_guard<std::mutex> eventLock(m_eventMutex);
+        m_eventThreadRunning = false;
+    }
+    m_eventCv.notify_all();
+    if (m_eventThread.joinable()) {
+        m_eventThread.join();
+    }
+
     std::lock_guard<std::mutex> lock(m_stateMutex);
     
     if (!m_running) {
@@ -288,11 +320,8 @@ int UPnPDevice::handleActionRequest(UpnpActionRequest* request) {
     // ConnectionManager actions
     if (serviceID.find("ConnectionManager") != std::string::npos) {
         if (actionName == "GetProtocolInfo") {
-            IXML_Document* response = createActionResponse("GetProtocolInfo");
-            addResponseArg(response, "Source", "");
-            // Use the protocol info generated by ProtocolInfoBuilder
-            addResponseArg(response, "Sink", m_protocolInfo);
-            UpnpActionRequest_set_ActionResult(request, response);
+            // Fully static: protocol info generated by ProtocolInfoBuilder at startup
+            UpnpActionRequest_set_ActionResult(request, cloneResponse(m_tplProtocolInfo));
             return UPNP_E_SUCCESS;
         }
     }
@@ -309,10 +338,36 @@ int UPnPDevice::handleSubscriptionRequest(UpnpSubscriptionRequest* request) {
         UpnpSubscriptionRequest_get_ServiceId(request)
     );
     
+    std::string udn = UpnpString_get_String(
+        UpnpSubscriptionRequest_get_UDN(request)
+    );
+    std::string sid = UpnpString_get_String(
+        UpnpSubscriptionRequest_get_SID(request)
+    );
+    
     DEBUG_LOG("[UPnPDevice] Subscription request for: " << serviceID);
     
-    // Accept all subscriptions
-    // UpnpSubscriptionRequest_set_ErrCode(request, UPNP_E_SUCCESS);
+    // Accept all subscriptions; the initial event carries the full state
+    IXML_Document* propSet = nullptr;
+    if (serviceID.find("AVTransport") != std::string::npos) {
+        UpnpAddToPropertySet(&propSet, "LastChange", cachedAVTLastChange().c_str());
+    } else if (serviceID.find("RenderingControl") != std::string::npos) {
+        UpnpAddToPropertySet(&propSet, "LastChange", cachedRCLastChange().c_str());
+    } else if (serviceID.find("ConnectionManager") != std::string::npos) {
+        UpnpAddToPropertySet(&propSet, "SourceProtocolInfo", "");
+        UpnpAddToPropertySet(&propSet, "SinkProtocolInfo", m_protocolInfo.c_str());
+        UpnpAddToPropertySet(&propSet, "CurrentConnectionIDs", "0");
+    }
+    
+    int ret = UpnpAcceptSubscriptionExt(m_deviceHandle, udn.c_str(), serviceID.c_str(),
+                                        propSet, sid.c_str());
+    if (ret != UPNP_E_SUCCESS) {
+        std::cerr << "[UPnPDevice] UpnpAcceptSubscriptionExt failed for "
+                  << serviceID << ": " << ret << std::endl;
+    }
+    if (propSet) {
+        ixmlDocument_free(propSet);
+    }
     
     return UPNP_E_SUCCESS;
 }
@@ -542,12 +597,13 @@ int UPnPDevice::actionPrevious(UpnpActionRequest* request) {
 }
 
 int UPnPDevice::actionGetTransportInfo(UpnpActionRequest* request) {
-    std::lock_guard<std::mutex> lock(m_stateMutex);
-    
-    IXML_Document* response = createActionResponse("GetTransportInfo");
-    addResponseArg(response, "CurrentTransportState", m_transportState);
-    addResponseArg(response, "CurrentTransportStatus", m_transportStatus);
-    addResponseArg(response, "CurrentSpeed", "1");
+    IXML_Document* response;
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        setSlot(m_tplTransportInfo, 0, m_transportState);
+        setSlot(m_tplTransportInfo, 1, m_transportStatus);
+        response = cloneResponse(m_tplTransportInfo);
+    }
     
     UpnpActionRequest_set_ActionResult(request, response);
     
@@ -555,17 +611,17 @@ int UPnPDevice::actionGetTransportInfo(UpnpActionRequest* request) {
 }
 
 int UPnPDevice::actionGetPositionInfo(UpnpActionRequest* request) {
-    std::lock_guard<std::mutex> lock(m_stateMutex);
-    
-    IXML_Document* response = createActionResponse("GetPositionInfo");
-    addResponseArg(response, "Track", "1");
-    addResponseArg(response, "TrackDuration", formatTime(m_trackDuration));
-    addResponseArg(response, "TrackMetaData", m_currentTrackMetadata);
-    addResponseArg(response, "TrackURI", m_currentTrackURI);
-    addResponseArg(response, "RelTime", formatTime(m_currentPosition));
-    addResponseArg(response, "AbsTime", formatTime(m_currentPosition));
-    addResponseArg(response, "RelCount", "2147483647");
-    addResponseArg(response, "AbsCount", "2147483647");
+    IXML_Document* response;
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        std::string position = formatTime(m_currentPosition);
+        setSlot(m_tplPositionInfo, 1, formatTime(m_trackDuration));
+        setSlot(m_tplPositionInfo, 2, m_currentTrackMetadata);
+        setSlot(m_tplPositionInfo, 3, m_currentTrackURI);
+        setSlot(m_tplPositionInfo, 4, position);
+        setSlot(m_tplPositionInfo, 5, position);
+        response = cloneResponse(m_tplPositionInfo);
+    }
     
     UpnpActionRequest_set_ActionResult(request, response);
     
@@ -573,18 +629,16 @@ int UPnPDevice::actionGetPositionInfo(UpnpActionRequest* request) {
 }
 
 int UPnPDevice::actionGetMediaInfo(UpnpActionRequest* request) {
-    std::lock_guard<std::mutex> lock(m_stateMutex);
-    
-    IXML_Document* response = createActionResponse("GetMediaInfo");
-    addResponseArg(response, "NrTracks", "1");
-    addResponseArg(response, "MediaDuration", formatTime(m_trackDuration));
-    addResponseArg(response, "CurrentURI", m_currentURI);
-    addResponseArg(response, "CurrentURIMetaData", m_currentMetadata);
-    addResponseArg(response, "NextURI", m_nextURI);
-    addResponseArg(response, "NextURIMetaData", m_nextMetadata);
-    addResponseArg(response, "PlayMedium", "NETWORK");
-    addResponseArg(response, "RecordMedium", "NOT_IMPLEMENTED");
-    addResponseArg(response, "WriteStatus", "NOT_IMPLEMENTED");
+    IXML_Document* response;
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        setSlot(m_tplMediaInfo, 1, formatTime(m_trackDuration));
+        setSlot(m_tplMediaInfo, 2, m_currentURI);
+        setSlot(m_tplMediaInfo, 3, m_currentMetadata);
+        setSlot(m_tplMediaInfo, 4, m_nextURI);
+        setSlot(m_tplMediaInfo, 5, m_nextMetadata);
+        response = cloneResponse(m_tplMediaInfo);
+    }
     
     UpnpActionRequest_set_ActionResult(request, response);
     
@@ -592,22 +646,13 @@ int UPnPDevice::actionGetMediaInfo(UpnpActionRequest* request) {
 }
 
 int UPnPDevice::actionGetTransportSettings(UpnpActionRequest* request) {
-    IXML_Document* response = createActionResponse("GetTransportSettings");
-    addResponseArg(response, "PlayMode", "NORMAL");
-    addResponseArg(response, "RecQualityMode", "NOT_IMPLEMENTED");
-    
-    UpnpActionRequest_set_ActionResult(request, response);
+    UpnpActionRequest_set_ActionResult(request, cloneResponse(m_tplTransportSettings));
     
     return UPNP_E_SUCCESS;
 }
 
 int UPnPDevice::actionGetDeviceCapabilities(UpnpActionRequest* request) {
-    IXML_Document* response = createActionResponse("GetDeviceCapabilities");
-    addResponseArg(response, "PlayMedia", "NETWORK");
-    addResponseArg(response, "RecMedia", "NOT_IMPLEMENTED");
-    addResponseArg(response, "RecQualityModes", "NOT_IMPLEMENTED");
-    
-    UpnpActionRequest_set_ActionResult(request, response);
+    UpnpActionRequest_set_ActionResult(request, cloneResponse(m_tplDeviceCapabilities));
     
     return UPNP_E_SUCCESS;
 }
@@ -617,10 +662,12 @@ int UPnPDevice::actionGetDeviceCapabilities(UpnpActionRequest* request) {
 // ============================================================================
 
 int UPnPDevice::actionGetVolume(UpnpActionRequest* request) {
-    std::lock_guard<std::mutex> lock(m_stateMutex);
-    
-    IXML_Document* response = createActionResponse("GetVolume");
-    addResponseArg(response, "CurrentVolume", std::to_string(m_volume));
+    IXML_Document* response;
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        setSlot(m_tplVolume, 0, std::to_string(m_volume));
+        response = cloneResponse(m_tplVolume);
+    }
     
     UpnpActionRequest_set_ActionResult(request, response);
     
@@ -635,9 +682,17 @@ int UPnPDevice::actionSetVolume(UpnpActionRequest* request) {
     
     std::cout << "[UPnPDevice] SetVolume: " << volume << std::endl;
     
+    int currentVolume;
+    bool currentMute;
     {
         std::lock_guard<std::mutex> lock(m_stateMutex);
-        m_volume = volume;
+        m_volume = std::max(0, std::min(100, volume));
+        currentVolume = m_volume;
+        currentMute = m_mute;
+    }
+    
+    if (m_callbacks.onVolume) {
+        m_callbacks.onVolume(currentVolume, currentMute);
     }
     
     // Send event notification
@@ -651,10 +706,12 @@ int UPnPDevice::actionSetVolume(UpnpActionRequest* request) {
 }
 
 int UPnPDevice::actionGetMute(UpnpActionRequest* request) {
-    std::lock_guard<std::mutex> lock(m_stateMutex);
-    
-    IXML_Document* response = createActionResponse("GetMute");
-    addResponseArg(response, "CurrentMute", m_mute ? "1" : "0");
+    IXML_Document* response;
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        setSlot(m_tplMute, 0, m_mute ? "1" : "0");
+        response = cloneResponse(m_tplMute);
+    }
     
     UpnpActionRequest_set_ActionResult(request, response);
     
@@ -669,9 +726,17 @@ int UPnPDevice::actionSetMute(UpnpActionRequest* request) {
     
     std::cout << "[UPnPDevice] SetMute: " << mute << std::endl;
     
+    int currentVolume;
+    bool currentMute;
     {
         std::lock_guard<std::mutex> lock(m_stateMutex);
         m_mute = mute;
+        currentVolume = m_volume;
+        currentMute = m_mute;
+    }
+    
+    if (m_callbacks.onVolume) {
+        m_callbacks.onVolume(currentVolume, currentMute);
     }
     
     // Send event notification
@@ -702,12 +767,9 @@ std::string UPnPDevice::formatTime(int seconds) const {
     int m = (seconds % 3600) / 60;
     int s = seconds % 60;
     
-    std::stringstream ss;
-    ss << std::setfill('0') 
-       << std::setw(2) << h << ":"
-       << std::setw(2) << m << ":"
-       << std::setw(2) << s;
-    return ss.str();
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%02d:%02d:%02d", h, m, s);
+    return buf;
 }
 
 // ============================================================================
@@ -725,6 +787,128 @@ IXML_Document* UPnPDevice::createActionResponse(const std::string& actionName) {
     return response;
 }
 
+// ============================================================================
+// Response templates
+// ============================================================================
+
+void UPnPDevice::initTemplate(ResponseTemplate& tpl, const std::string& actionName,
+                              ServiceKind service,
+                              std::initializer_list<std::pair<const char*, std::string>> args) {
+    const char* serviceType =
+        service == ServiceKind::RenderingControl ? "urn:schemas-upnp-org:service:RenderingControl:1"
+      : service == ServiceKind::ConnectionManager ? "urn:schemas-upnp-org:service:ConnectionManager:1"
+      : "urn:schemas-upnp-org:service:AVTransport:1";
+
+    tpl.actionName = actionName;
+    tpl.serviceType = serviceType;
+    tpl.doc = ixmlDocument_createDocument();
+    IXML_Element* actionResponse = ixmlDocument_createElement(tpl.doc,
+        (actionName + "Response").c_str());
+    ixmlElement_setAttribute(actionResponse, "xmlns:u", serviceType);
+    ixmlNode_appendChild(&tpl.doc->n, &actionResponse->n);
+
+    for (const auto& arg : args) {
+        IXML_Element* element = ixmlDocument_createElement(tpl.doc, arg.first);
+        IXML_Node* text = ixmlDocument_createTextNode(tpl.doc, arg.second.c_str());
+        ixmlNode_appendChild(&element->n, text);
+        ixmlNode_appendChild(&actionResponse->n, &element->n);
+        tpl.names.push_back(arg.first);
+        tpl.slots.push_back(text);
+        tpl.values.push_back(arg.second);
+    }
+}
+
+void UPnPDevice::setSlot(ResponseTemplate& tpl, size_t index, const std::string& value) {
+    // Unchanged values (metadata, URIs) are not copied again
+    if (tpl.values[index] == value) return;
+    ixmlNode_setNodeValue(tpl.slots[index], value.c_str());
+    tpl.values[index] = value;
+}
+
+IXML_Document* UPnPDevice::cloneResponse(const ResponseTemplate& tpl) const {
+    IXML_Node* clone = ixmlNode_cloneNode(&tpl.doc->n, 1);
+    if (clone) {
+        return reinterpret_cast<IXML_Document*>(clone);
+    }
+
+    // Fallback: build the DOM from the slot values
+    IXML_Document* response = ixmlDocument_createDocument();
+    IXML_Element* actionResponse = ixmlDocument_createElement(response,
+        (tpl.actionName + "Response").c_str());
+    ixmlElement_setAttribute(actionResponse, "xmlns:u", tpl.serviceType);
+    ixmlNode_appendChild(&response->n, &actionResponse->n);
+    for (size_t i = 0; i < tpl.names.size(); i++) {
+        IXML_Element* element = ixmlDocument_createElement(response, tpl.names[i].c_str());
+        ixmlNode_appendChild(&element->n, ixmlDocument_createTextNode(response, tpl.values[i].c_str()));
+        ixmlNode_appendChild(&actionResponse->n, &element->n);
+    }
+    return response;
+}
+
+// Slot order is the argument order below; variable slots start empty
+void UPnPDevice::initTemplates() {
+    const std::string maxCount = "2147483647";
+    initTemplate(m_tplTransportInfo, "GetTransportInfo", ServiceKind::AVTransport, {
+        {"CurrentTransportState", m_transportState},    // 0
+        {"CurrentTransportStatus", m_transportStatus},  // 1
+        {"CurrentSpeed", "1"},
+    });
+    initTemplate(m_tplPositionInfo, "GetPositionInfo", ServiceKind::AVTransport, {
+        {"Track", "1"},
+        {"TrackDuration", formatTime(0)},               // 1
+        {"TrackMetaData", ""},                          // 2
+        {"TrackURI", ""},                               // 3
+        {"RelTime", formatTime(0)},                     // 4
+        {"AbsTime", formatTime(0)},                     // 5
+        {"RelCount", maxCount},
+        {"AbsCount", maxCount},
+    });
+    initTemplate(m_tplMediaInfo, "GetMediaInfo", ServiceKind::AVTransport, {
+        {"NrTracks", "1"},
+        {"MediaDuration", formatTime(0)},               // 1
+        {"CurrentURI", ""},                             // 2
+        {"CurrentURIMetaData", ""},                     // 3
+        {"NextURI", ""},                                // 4
+        {"NextURIMetaData", ""},                        // 5
+        {"PlayMedium", "NETWORK"},
+        {"RecordMedium", "NOT_IMPLEMENTED"},
+        {"WriteStatus", "NOT_IMPLEMENTED"},
+    });
+    initTemplate(m_tplTransportSettings, "GetTransportSettings", ServiceKind::AVTransport, {
+        {"PlayMode", "NORMAL"},
+        {"RecQualityMode", "NOT_IMPLEMENTED"},
+    });
+    initTemplate(m_tplDeviceCapabilities, "GetDeviceCapabilities", ServiceKind::AVTransport, {
+        {"PlayMedia", "NETWORK"},
+        {"RecMedia", "NOT_IMPLEMENTED"},
+        {"RecQualityModes", "NOT_IMPLEMENTED"},
+    });
+    initTemplate(m_tplVolume, "GetVolume", ServiceKind::RenderingControl, {
+        {"CurrentVolume", std::to_string(m_volume)},    // 0
+    });
+    initTemplate(m_tplMute, "GetMute", ServiceKind::RenderingControl, {
+        {"CurrentMute", m_mute ? "1" : "0"},            // 0
+    });
+    initTemplate(m_tplProtocolInfo, "GetProtocolInfo", ServiceKind::ConnectionManager, {
+        {"Source", ""},
+        {"Sink", m_protocolInfo},
+    });
+}
+
+void UPnPDevice::freeTemplates() {
+    for (ResponseTemplate* tpl : {&m_tplTransportInfo, &m_tplPositionInfo, &m_tplMediaInfo,
+                                  &m_tplTransportSettings, &m_tplDeviceCapabilities,
+                                  &m_tplVolume, &m_tplMute, &m_tplProtocolInfo}) {
+        if (tpl->doc) {
+            ixmlDocument_free(tpl->doc);
+            tpl->doc = nullptr;
+        }
+        tpl->names.clear();
+        tpl->slots.clear();
+        tpl->values.clear();
+    }
+}
+
 // Helper: Add response argument
 void UPnPDevice::addResponseArg(IXML_Document* response, 
                                 const std::string& name, 
@@ -758,15 +942,209 @@ std::string UPnPDevice::getArgumentValue(IXML_Document* actionDoc,
     return result;
 }
 
-// Helper: Send AVTransport event
+// ============================================================================
+// GENA eventing (LastChange)
+// ============================================================================
+
+namespace {
+
+// LastChange values are attribute values of an XML document that is itself
+// sent as text: escape for the attribute here, libupnp escapes the rest
+std::string xmlEscapeAttr(const std::string& in) {
+    std::string out;
+    out.reserve(in.size() + in.size() / 8);
+    for (char c : in) {
+        switch (c) {
+            case '&':  out += "&amp;";  break;
+            case '<':  out += "&lt;";   break;
+            case '>':  out += "&gt;";   break;
+            case '"':  out += "&quot;"; break;
+            case '\'': out += "&apos;"; break;
+            default:   out += c;        break;
+        }
+    }
+    return out;
+}
+
+void appendVar(std::stringstream& ss, const char* name, const std::string& value) {
+    ss << "<" << name << " val=\"" << xmlEscapeAttr(value) << "\"/>";
+}
+
+} // namespace
+
+// Helper: Send AVTransport event (coalesced, see eventThreadFunc)
 void UPnPDevice::sendAVTransportEvent() {
-    // Event notification would go here
-    // For now, we just track state changes
+    scheduleEvent();
 }
 
-// Helper: Send RenderingControl event
+// Helper: Send RenderingControl event (coalesced, see eventThreadFunc)
 void UPnPDevice::sendRenderingControlEvent() {
-    // Event notification would go here
+    scheduleEvent();
+}
+
+void UPnPDevice::scheduleEvent() {
+    {
+        std::lock_guard<std::mutex> lock(m_eventMutex);
+        if (!m_eventThreadRunning || m_eventPending) return;
+        m_eventPending = true;
+    }
+    m_eventCv.notify_one();
+}
+
+void UPnPDevice::eventThreadFunc() {
+    std::unique_lock<std::mutex> lock(m_eventMutex);
+    while (m_eventThreadRunning) {
+        m_eventCv.wait(lock, [this] { return m_eventPending || !m_eventThreadRunning; });
+        if (!m_eventThreadRunning) break;
+
+        // Rate limit: changes arriving before the deadline ride along
+        auto due = m_lastEventTime + std::chrono::milliseconds(EVENT_MIN_INTERVAL_MS);
+        m_eventCv.wait_until(lock, due, [this] { return !m_eventThreadRunning; });
+        if (!m_eventThreadRunning) break;
+
+        m_eventPending = false;
+        lock.unlock();
+        flushEvents();
+        lock.lock();
+        m_lastEventTime = std::chrono::steady_clock::now();
+    }
+}
+
+void UPnPDevice::flushEvents() {
+    AVTEventState avt;
+    RCEventState rc;
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        avt = snapshotAVTState();
+        rc = snapshotRCState();
+    }
+
+    // Delta against what subscribers last saw; empty delta = nothing to send
+    std::string avtChange = buildAVTLastChange(avt, &m_avtNotified);
+    std::string rcChange = buildRCLastChange(rc, &m_rcNotified);
+
+    if (!avtChange.empty()) {
+        IXML_Document* propSet = UpnpCreatePropertySet(1, "LastChange", avtChange.c_str());
+        int ret = UpnpNotifyExt(m_deviceHandle, m_udn.c_str(),
+                                "urn:upnp-org:serviceId:AVTransport", propSet);
+        if (propSet) ixmlDocument_free(propSet);
+        DEBUG_LOG("[UPnPDevice] AVTransport LastChange sent (" << avtChange.size()
+                  << " bytes, ret=" << ret << ")");
+        m_avtNotified = avt;
+    }
+    if (!rcChange.empty()) {
+        IXML_Document* propSet = UpnpCreatePropertySet(1, "LastChange", rcChange.c_str());
+        int ret = UpnpNotifyExt(m_deviceHandle, m_udn.c_str(),
+                                "urn:upnp-org:serviceId:RenderingControl", propSet);
+        if (propSet) ixmlDocument_free(propSet);
+        DEBUG_LOG("[UPnPDevice] RenderingControl LastChange sent (ret=" << ret << ")");
+        m_rcNotified = rc;
+    }
+}
+
+UPnPDevice::AVTEventState UPnPDevice::snapshotAVTState() const {
+    AVTEventState state;
+    state.transportState = m_transportState;
+    state.transportStatus = m_transportStatus;
+    state.uri = m_currentURI;
+    state.metadata = m_currentMetadata;
+    state.trackURI = m_currentTrackURI;
+    state.trackMetadata = m_currentTrackMetadata;
+    state.nextURI = m_nextURI;
+    state.nextMetadata = m_nextMetadata;
+    state.duration = m_trackDuration;
+    return state;
+}
+
+UPnPDevice::RCEventState UPnPDevice::snapshotRCState() const {
+    RCEventState state;
+    state.volume = m_volume;
+    state.mute = m_mute;
+    return state;
+}
+
+// previous == nullptr: full state (initial event); otherwise only changed
+// variables, or "" when nothing changed. Position is not evented (polled
+// via GetPositionInfo, per the AVTransport spec)
+std::string UPnPDevice::buildAVTLastChange(const AVTEventState& state,
+                                           const AVTEventState* previous) const {
+    std::stringstream ss;
+    bool any = false;
+    auto var = [&](const char* name, const std::string& value, const std::string* old) {
+        if (old && *old == value) return;
+        appendVar(ss, name, value);
+        any = true;
+    };
+    std::string duration = formatTime(state.duration);
+    std::string oldDuration = previous ? formatTime(previous->duration) : "";
+
+    ss << "<Event xmlns=\"urn:schemas-upnp-org:metadata-1-0/AVT/\"><InstanceID val=\"0\">";
+    var("TransportState", state.transportState, previous ? &previous->transportState : nullptr);
+    var("TransportStatus", state.transportStatus, previous ? &previous->transportStatus : nullptr);
+    var("AVTransportURI", state.uri, previous ? &previous->uri : nullptr);
+    var("AVTransportURIMetaData", state.metadata, previous ? &previous->metadata : nullptr);
+    var("CurrentTrackURI", state.trackURI, previous ? &previous->trackURI : nullptr);
+    var("CurrentTrackMetaData", state.trackMetadata, previous ? &previous->trackMetadata : nullptr);
+    var("CurrentTrackDuration", duration, previous ? &oldDuration : nullptr);
+    var("CurrentMediaDuration", duration, previous ? &oldDuration : nullptr);
+    var("NextAVTransportURI", state.nextURI, previous ? &previous->nextURI : nullptr);
+    var("NextAVTransportURIMetaData", state.nextMetadata, previous ? &previous->nextMetadata : nullptr);
+    if (!previous) {
+        appendVar(ss, "NumberOfTracks", state.uri.empty() ? "0" : "1");
+        appendVar(ss, "CurrentTrack", state.uri.empty() ? "0" : "1");
+        appendVar(ss, "TransportPlaySpeed", "1");
+        appendVar(ss, "CurrentPlayMode", "NORMAL");
+        appendVar(ss, "PlaybackStorageMedium", "NETWORK");
+    }
+    ss << "</InstanceID></Event>";
+    return any ? ss.str() : std::string();
+}
+
+std::string UPnPDevice::buildRCLastChange(const RCEventState& state,
+                                          const RCEventState* previous) const {
+    std::stringstream ss;
+    bool any = false;
+    ss << "<Event xmlns=\"urn:schemas-upnp-org:metadata-1-0/RCS/\"><InstanceID val=\"0\">";
+    if (!previous || previous->volume != state.volume) {
+        ss << "<Volume channel=\"Master\" val=\"" << state.volume << "\"/>";
+        any = true;
+    }
+    if (!previous || previous->mute != state.mute) {
+        ss << "<Mute channel=\"Master\" val=\"" << (state.mute ? 1 : 0) << "\"/>";
+        any = true;
+    }
+    ss << "</InstanceID></Event>";
+    return any ? ss.str() : std::string();
+}
+
+// Full-state documents for subscription initial events, re-serialized only
+// when the evented state differs from the cached one
+std::string UPnPDevice::cachedAVTLastChange() {
+    AVTEventState state;
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        state = snapshotAVTState();
+    }
+    std::lock_guard<std::mutex> lock(m_eventMutex);
+    if (m_avtCache.empty() || !buildAVTLastChange(state, &m_avtCacheState).empty()) {
+        m_avtCache = buildAVTLastChange(state, nullptr);
+        m_avtCacheState = state;
+    }
+    return m_avtCache;
+}
+
+std::string UPnPDevice::cachedRCLastChange() {
+    RCEventState state;
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        state = snapshotRCState();
+    }
+    std::lock_guard<std::mutex> lock(m_eventMutex);
+    if (m_rcCache.empty() || state.volume != m_rcCacheState.volume || state.mute != m_rcCacheState.mute) {
+        m_rcCache = buildRCLastChange(state, nullptr);
+        m_rcCacheState = state;
+    }
+    return m_rcCache;
 }
 
 // Generate device description XML
@@ -1081,6 +1459,10 @@ std::string UPnPDevice::generateAVTransportSCPD() {
       <dataType>string</dataType>
     </stateVariable>
     <stateVariable sendEvents="yes">
+      <name>LastChange</name>
+      <dataType>string</dataType>
+    </stateVariable>
+    <stateVariable sendEvents="no">
       <name>TransportState</name>
       <dataType>string</dataType>
       <allowedValueList>
@@ -1212,6 +1594,10 @@ std::string UPnPDevice::generateRenderingControlSCPD() {
       </allowedValueList>
     </stateVariable>
     <stateVariable sendEvents="yes">
+      <name>LastChange</name>
+      <dataType>string</dataType>
+    </stateVariable>
+    <stateVariable sendEvents="no">
       <name>Volume</name>
       <dataType>ui2</dataType>
       <allowedValueRange>
@@ -1270,7 +1656,10 @@ std::string UPnPDevice::generateConnectionManagerSCPD() {
 
 // Notify state change via events
 void UPnPDevice::notifyStateChange(const std::string& state) {
-    m_transportState = state;
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_transportState = state;
+    }
     sendAVTransportEvent();
 }
 
@@ -1319,6 +1708,11 @@ void UPnPDevice::setCurrentMetadata(const std::string& metadata) {
     m_currentTrackMetadata = metadata;
 }
 
+void UPnPDevice::setVolume(int volume) {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    m_volume = std::max(0, std::min(100, volume));
+}
+
 // Notify track change (sends event to subscribers)
 void UPnPDevice::notifyTrackChange(const std::string& uri, const std::string& metadata) {
     {
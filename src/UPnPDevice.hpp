@@ -6,6 +6,12 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+#include <utility>
+#include <initializer_list>
 #include "ProtocolInfoBuilder.h"
 
 /**
@@ -14,7 +20,7 @@
  * Handles:
  * - SSDP Discovery (automatic)
  * - SOAP Actions (AVTransport, RenderingControl)
- * - Event Notifications (automatic subscriptions)
+ * - Event Notifications (GENA LastChange, coalesced and rate-limited)
  * - State management
  */
 class UPnPDevice {
@@ -26,6 +32,7 @@ public:
     using PauseCallback = std::function<void()>;
     using StopCallback = std::function<void()>;
     using SeekCallback = std::function<void(const std::string& target)>;
+    using VolumeCallback = std::function<void(int volume, bool mute)>;
     
     struct Callbacks {
         SetURICallback onSetURI;
@@ -34,6 +41,7 @@ public:
         PauseCallback onPause;
         StopCallback onStop;
         SeekCallback onSeek;
+        VolumeCallback onVolume;   // SetVolume / SetMute: new state of both
     };
     
     struct Config {
@@ -87,6 +95,7 @@ public:
     void setTrackDuration(int seconds);
     void setCurrentURI(const std::string& uri);
     void setCurrentMetadata(const std::string& metadata);
+    void setVolume(int volume);
 
 private:
     // libupnp callback (static)
@@ -131,9 +140,58 @@ private:
     std::string createPositionInfoXML() const;
     std::string formatTime(int seconds) const;
     
+    // GENA eventing: state changes only mark the event thread pending; it
+    // diffs against the last notified state and sends one LastChange per
+    // service at most every EVENT_MIN_INTERVAL_MS
+    static constexpr int EVENT_MIN_INTERVAL_MS = 200;
+
+    struct AVTEventState {
+        std::string transportState;
+        std::string transportStatus;
+        std::string uri;
+        std::string metadata;
+        std::string trackURI;
+        std::string trackMetadata;
+        std::string nextURI;
+        std::string nextMetadata;
+        int duration = 0;
+    };
+    struct RCEventState {
+        int volume = 0;
+        bool mute = false;
+    };
+
     void sendAVTransportEvent();
     void sendRenderingControlEvent();
+    void scheduleEvent();
+    void eventThreadFunc();
+    void flushEvents();
+    AVTEventState snapshotAVTState() const;   // Caller holds m_stateMutex
+    RCEventState snapshotRCState() const;     // Caller holds m_stateMutex
+    std::string buildAVTLastChange(const AVTEventState& state, const AVTEventState* previous) const;
+    std::string buildRCLastChange(const RCEventState& state, const RCEventState* previous) const;
+    std::string cachedAVTLastChange();
+    std::string cachedRCLastChange();
     
+    // Precompiled responses for hot read-only actions: built once, slot text
+    // nodes rewritten only when a value changes, deep-cloned per request
+    // (libupnp frees the ActionResult after sending)
+    enum class ServiceKind { AVTransport, RenderingControl, ConnectionManager };
+    struct ResponseTemplate {
+        IXML_Document* doc = nullptr;
+        std::string actionName;
+        const char* serviceType = nullptr;
+        std::vector<std::string> names;    // Argument names, in order
+        std::vector<IXML_Node*> slots;     // Text node per argument, in order
+        std::vector<std::string> values;   // Current slot contents
+    };
+    void initTemplate(ResponseTemplate& tpl, const std::string& actionName, ServiceKind service,
+                      std::initializer_list<std::pair<const char*, std::string>> args);
+    void setSlot(ResponseTemplate& tpl, size_t index, const std::string& value);
+    IXML_Document* cloneResponse(const ResponseTemplate& tpl) const;
+    void initTemplates();
+    void freeTemplates();
+
     IXML_Document* createActionResponse(const std::string& actionName);
     void addResponseArg(IXML_Document* response, 
                        const std::string& name, 
@@ -175,4 +233,35 @@ private:
     
     // Protocol Info (cached at initialization)
     std::string m_protocolInfo;
+
+    // Documents served by the libupnp webserver (rendered once in the constructor)
+    std::string m_descriptionXML;
+    std::string m_avtSCPD;
+    std::string m_rcSCPD;
+    std::string m_cmSCPD;
+
+    // Action response templates (mutated under m_stateMutex)
+    ResponseTemplate m_tplTransportInfo;
+    ResponseTemplate m_tplPositionInfo;
+    ResponseTemplate m_tplMediaInfo;
+    ResponseTemplate m_tplTransportSettings;
+    ResponseTemplate m_tplDeviceCapabilities;
+    ResponseTemplate m_tplVolume;
+    ResponseTemplate m_tplMute;
+    ResponseTemplate m_tplProtocolInfo;
+
+    // Eventing
+    std::string m_udn;                 // "uuid:..." as published in description.xml
+    std::thread m_eventThread;
+    std::mutex m_eventMutex;           // Guards the members below (never nested with m_stateMutex)
+    std::condition_variable m_eventCv;
+    bool m_eventThreadRunning = false;
+    bool m_eventPending = false;
+    std::chrono::steady_clock::time_point m_lastEventTime;
+    AVTEventState m_avtNotified;       // Event thread only
+    RCEventState m_rcNotified;         // Event thread only
+    AVTEventState m_avtCacheState;     // Full-state LastChange cache, for initial events
+    std::string m_avtCache;
+    RCEventState m_rcCacheState;
+    std::string m_rcCache;
 };
@@ -0,0 +1,548 @@
+/**
+ * @file bench_audio.cpp
+ * @brief Kernel and pipeline benchmark suite (make bench)
+ *
+ * Kernels: memcpy_audio and every DirettaRingBuffer conversion, per ISA the
+ * CPU supports, on mirrored and flat ring storage, at the chunk sizes the
+ * audio thread really pushes (AudioTiming::PCM_CHUNK_*, DSD_CHUNK). Every
+ * ring is offset so pushes and pops keep crossing the wrap.
+ *
+ * Pipeline: a generated WAV decoded by AudioEngine::process() on an audio
+ * thread paced like DirettaRenderer's, pushed into the ring the way
+ * DirettaSync::sendAudio() does, and drained by a mock getNewStream()
+ * consumer on the cycle time DirettaCycleCalculator picks for the format.
+ *
+ * One JSON document goes to stdout, logs to stderr, so runs can be diffed
+ * between releases:  ./bin/bench_audio [--quick] [--kernels-only] [--seconds N]
+ */
+
+#include "AudioKernels.h"
+#include "AudioTiming.h"
+#include "DirettaRingBuffer.h"
+#include "DirettaSync.h"    // AudioFormat, DirettaBuffer, DirettaCycleCalculator (inline only)
+#include "AudioEngine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+bool g_verbose = false;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    bool quick = false;
+    bool pipeline = true;
+    double seconds = 3.0;   // Per pipeline format
+};
+
+//=============================================================================
+// Latency samples
+//=============================================================================
+
+class Latency {
+public:
+    void reserve(size_t n) { m_ns.reserve(n); }
+    void record(double ns) { m_ns.push_back(ns); }
+    void record(Clock::time_point start, Clock::time_point end) {
+        m_ns.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    size_t count() const { return m_ns.size(); }
+
+    double total() const {
+        double sum = 0;
+        for (double ns : m_ns) sum += ns;
+        return sum;
+    }
+
+    // "p50_ns":..,"p99_ns":..,"p999_ns":..,"max_ns":.. (no braces)
+    std::string json() {
+        std::sort(m_ns.begin(), m_ns.end());
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(0)
+           << "\"mean_ns\":" << (m_ns.empty() ? 0.0 : total() / m_ns.size())
+           << ",\"p50_ns\":" << percentile(0.50)
+           << ",\"p99_ns\":" << percentile(0.99)
+           << ",\"p999_ns\":" << percentile(0.999)
+           << ",\"max_ns\":" << (m_ns.empty() ? 0.0 : m_ns.back());
+        return os.str();
+    }
+
+private:
+    // Nearest rank on the sorted samples
+    double percentile(double p) const {
+        if (m_ns.empty()) return 0;
+        size_t rank = static_cast<size_t>(std::ceil(p * m_ns.size()));
+        return m_ns[std::min(m_ns.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+    std::vector<double> m_ns;
+};
+
+//=============================================================================
+// Kernel benchmarks
+//=============================================================================
+
+constexpr int CHANNELS = 2;
+constexpr size_t RING_BYTES = DirettaBuffer::MIN_BUFFER_BYTES;
+constexpr size_t WRAP_OFFSET = 1476;    // One MTU payload: keeps chunks straddling the wrap
+
+// 1 ms of S32 stereo at the three PCM tiers: what getNewStream() takes per call
+constexpr size_t POP_SIZES[] = {44 * 8, 96 * 8, 192 * 8};
+
+struct KernelCase {
+    const char* op;
+    size_t chunkFrames;     // Per push (DSD: bits per channel, as sendAudio)
+    size_t inputBytes;      // Bytes handed to the kernel per call
+    int channels = CHANNELS;
+};
+
+struct KernelRun {
+    std::vector<std::string>& results;
+    const char* isa;
+    const char* storage;
+    int iterations;
+
+    void add(const KernelCase& kc, Latency& lat) {
+        std::ostringstream os;
+        double mbps = lat.total() > 0
+            ? (static_cast<double>(kc.inputBytes) * lat.count()) / (lat.total() / 1e9) / 1e6 : 0.0;
+        os << "{\"op\":\"" << kc.op << "\",\"isa\":\"" << isa << "\",\"ring\":\"" << storage
+           << "\",\"channels\":" << kc.channels
+           << ",\"chunk_frames\":" << kc.chunkFrames << ",\"bytes\":" << kc.inputBytes
+           << ",\"iterations\":" << lat.count()
+           << ",\"mb_s\":" << std::fixed << std::setprecision(1) << mbps
+           << "," << lat.json() << "}";
+        results.push_back(os.str());
+    }
+};
+
+// Bytes per push for a PCM chunk of S32 (S24_P32) frames
+constexpr size_t pcmBytes(size_t frames, size_t bytesPerSample = 4, int channels = CHANNELS) {
+    return frames * static_cast<size_t>(channels) * bytesPerSample;
+}
+
+std::vector<uint8_t> makeInput(size_t bytes) {
+    std::vector<uint8_t> data(bytes);
+    uint32_t x = 0x12345678;
+    for (auto& b : data) {
+        x = x * 1664525u + 1013904223u;
+        b = static_cast<uint8_t>(x >> 24);
+    }
+    return data;
+}
+
+void prepareRing(DirettaRingBuffer& ring, bool mirrored, uint8_t silence) {
+    ring.setMirrorMode(mirrored);
+    ring.resize(RING_BYTES, silence);
+    // Start off the page grid so every lap crosses the wrap mid-chunk
+    std::vector<uint8_t> pad(WRAP_OFFSET, silence);
+    ring.push(pad.data(), pad.size());
+    ring.advanceReadPos(ring.getAvailable());
+}
+
+// Time one push kernel; the consumer side is drained untimed after each call
+template <typename Push>
+void benchPush(KernelRun& run, DirettaRingBuffer& ring, const KernelCase& kc, Push push) {
+    std::vector<uint8_t> input = makeInput(kc.inputBytes);
+    Latency lat;
+    lat.reserve(run.iterations);
+    for (int i = 0; i < run.iterations + run.iterations / 10; i++) {
+        auto t0 = Clock::now();
+        size_t written = push(input.data(), input.size());
+        auto t1 = Clock::now();
+        if (i >= run.iterations / 10) lat.record(t0, t1);   // First 10% is warm-up
+        if (written == 0) {
+            std::cerr << "[Bench] " << kc.op << " rejected a push" << std::endl;
+            return;
+        }
+        ring.advanceReadPos(ring.getAvailable());
+    }
+    run.add(kc, lat);
+}
+
+// Consumer side: half-full ring, timed pop or zero-copy read, untimed refill
+void benchPop(KernelRun& run, DirettaRingBuffer& ring, size_t bytes, bool zeroCopy) {
+    std::vector<uint8_t> input = makeInput(bytes);
+    std::vector<uint8_t> out(bytes);
+    while (ring.getAvailable() < RING_BYTES / 2) ring.push(input.data(), input.size());
+
+    KernelCase kc{zeroCopy ? "read_region" : "pop", bytes / (CHANNELS * 4), bytes};
+    Latency lat;
+    int iterations = run.iterations * 4;
+    lat.reserve(iterations);
+    size_t wrapCopies = 0;
+    for (int i = 0; i < iterations + iterations / 10; i++) {
+        auto t0 = Clock::now();
+        if (zeroCopy) {
+            // getNewStream(): point at the ring, fall back to pop() on a split wrap
+            const uint8_t* region;
+            size_t avail;
+            if (ring.getDirectReadRegion(bytes, region, avail)) {
+                ring.advanceReadPos(bytes);
+            } else {
+                ring.pop(out.data(), bytes);
+                wrapCopies++;
+            }
+        } else {
+            ring.pop(out.data(), bytes);
+        }
+        auto t1 = Clock::now();
+        if (i >= iterations / 10) lat.record(t0, t1);
+        ring.push(input.data(), input.size());
+    }
+    run.add(kc, lat);
+    if (zeroCopy && wrapCopies > 0 && ring.isMirrored()) {
+        std::cerr << "[Bench] mirrored ring needed " << wrapCopies << " wrap copies" << std::endl;
+    }
+}
+
+void runKernels(const Options& opt, std::vector<std::string>& results) {
+    using AudioKernels::Isa;
+    const AudioKernels::Table saved = AudioKernels::g_active;
+    const int iterations = opt.quick ? 200 : 2000;
+
+    // LSB-first <-> MSB-first, as DirettaSync hands pushDSDPlanar()
+    uint8_t bitReverse[256];
+    for (int i = 0; i < 256; i++) {
+        uint8_t r = 0;
+        for (int b = 0; b < 8; b++) r |= ((i >> b) & 1) << (7 - b);
+        bitReverse[i] = r;
+    }
+
+    for (Isa isa : {Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::AVX512, Isa::NEON}) {
+        // tableFor() falls back off-architecture: only bench ISAs that bind
+        if (!AudioKernels::isSupported(isa) || AudioKernels::tableFor(isa).isa != isa) continue;
+        AudioKernels::g_active = AudioKernels::tableFor(isa);
+        const char* isaLabel = AudioKernels::isaName(isa);
+        std::cerr << "[Bench] Kernels: " << isaLabel << std::endl;
+
+        // memcpy_audio on its own (bulk PCM/DSD copies, pop)
+        {
+            KernelRun run{results, isaLabel, "none", iterations};
+            for (size_t frames : {AudioTiming::PCM_CHUNK_LOW, AudioTiming::PCM_CHUNK_MID,
+                                  AudioTiming::PCM_CHUNK_HIGH}) {
+                KernelCase kc{"memcpy_audio", frames, pcmBytes(frames)};
+                std::vector<uint8_t> src = makeInput(kc.inputBytes);
+                std::vector<uint8_t> dst(kc.inputBytes);
+                Latency lat;
+                lat.reserve(iterations);
+                for (int i = 0; i < iterations + iterations / 10; i++) {
+                    auto t0 = Clock::now();
+                    memcpy_audio(dst.data(), src.data(), src.size());
+                    auto t1 = Clock::now();
+                    if (i >= iterations / 10) lat.record(t0, t1);
+                }
+                run.add(kc, lat);
+            }
+        }
+
+        for (bool mirrored : {true, false}) {
+            DirettaRingBuffer ring;
+            prepareRing(ring, mirrored, 0x00);
+            if (mirrored && !ring.isMirrored()) {
+                std::cerr << "[Bench] Mirrored storage unavailable, skipping" << std::endl;
+                continue;
+            }
+            KernelRun run{results, isaLabel, mirrored ? "mirrored" : "flat", iterations};
+
+            for (size_t frames : {AudioTiming::PCM_CHUNK_LOW, AudioTiming::PCM_CHUNK_MID,
+                                  AudioTiming::PCM_CHUNK_HIGH}) {
+                benchPush(run, ring, {"push", frames, pcmBytes(frames)},
+                    [&](const uint8_t* d, size_t n) { return ring.push(d, n); });
+                benchPush(run, ring, {"push_gain", frames, pcmBytes(frames)},
+                    [&](const uint8_t* d, size_t n) { return ring.pushWithGain(d, n, 4, 0.5f); });
+
+                ring.setS24PackModeHint(DirettaRingBuffer::S24PackMode::LsbAligned);
+                benchPush(run, ring, {"push24_packed", frames, pcmBytes(frames)},
+                    [&](const uint8_t* d, size_t n) { return ring.push24BitPacked(d, n); });
+                benchPush(run, ring, {"push24_packed_gain", frames, pcmBytes(frames)},
+                    [&](const uint8_t* d, size_t n) { return ring.push24BitPacked(d, n, 0.5f); });
+                ring.setS24PackModeHint(DirettaRingBuffer::S24PackMode::MsbAligned);
+                benchPush(run, ring, {"push24_packed_msb", frames, pcmBytes(frames)},
+                    [&](const uint8_t* d, size_t n) { return ring.push24BitPacked(d, n); });
+
+                benchPush(run, ring, {"push16to32", frames, pcmBytes(frames, 2)},
+                    [&](const uint8_t* d, size_t n) { return ring.push16To32(d, n); });
+                benchPush(run, ring, {"push16to32_gain", frames, pcmBytes(frames, 2)},
+                    [&](const uint8_t* d, size_t n) { return ring.push16To32(d, n, 0.5f); });
+            }
+
+            const size_t dsdBytes = AudioTiming::DSD_CHUNK * CHANNELS / 8;
+            benchPush(run, ring, {"push_dsd_planar", AudioTiming::DSD_CHUNK, dsdBytes},
+                [&](const uint8_t* d, size_t n) { return ring.pushDSDPlanar(d, n, CHANNELS, nullptr); });
+            benchPush(run, ring, {"push_dsd_planar_bitrev", AudioTiming::DSD_CHUNK, dsdBytes},
+                [&](const uint8_t* d, size_t n) { return ring.pushDSDPlanar(d, n, CHANNELS, bitReverse); });
+            benchPush(run, ring, {"push_dsd_planar_swap", AudioTiming::DSD_CHUNK, dsdBytes},
+                [&](const uint8_t* d, size_t n) { return ring.pushDSDPlanar(d, n, CHANNELS, bitReverse, true); });
+
+            // 5.1 / 7.1 at the mid PCM tier and one DSD chunk
+            for (int channels : {6, 8}) {
+                const size_t frames = AudioTiming::PCM_CHUNK_MID;
+                ring.setS24PackModeHint(DirettaRingBuffer::S24PackMode::LsbAligned);
+                benchPush(run, ring, {"push", frames, pcmBytes(frames, 4, channels), channels},
+                    [&](const uint8_t* d, size_t n) { return ring.push(d, n); });
+                benchPush(run, ring, {"push24_packed", frames, pcmBytes(frames, 4, channels), channels},
+                    [&](const uint8_t* d, size_t n) { return ring.push24BitPacked(d, n); });
+                benchPush(run, ring, {"push16to32", frames, pcmBytes(frames, 2, channels), channels},
+                    [&](const uint8_t* d, size_t n) { return ring.push16To32(d, n); });
+
+                const size_t mcDsdBytes = AudioTiming::DSD_CHUNK * static_cast<size_t>(channels) / 8;
+                benchPush(run, ring, {"push_dsd_planar", AudioTiming::DSD_CHUNK, mcDsdBytes, channels},
+                    [&](const uint8_t* d, size_t n) { return ring.pushDSDPlanar(d, n, channels, nullptr); });
+                benchPush(run, ring, {"push_dsd_planar_bitrev", AudioTiming::DSD_CHUNK, mcDsdBytes, channels},
+                    [&](const uint8_t* d, size_t n) { return ring.pushDSDPlanar(d, n, channels, bitReverse); });
+                benchPush(run, ring, {"push_dsd_planar_swap", AudioTiming::DSD_CHUNK, mcDsdBytes, channels},
+                    [&](const uint8_t* d, size_t n) { return ring.pushDSDPlanar(d, n, channels, bitReverse, true); });
+            }
+
+            for (size_t bytes : POP_SIZES) {
+                benchPop(run, ring, bytes, false);
+                benchPop(run, ring, bytes, true);
+            }
+        }
+    }
+
+    AudioKernels::g_active = saved;
+}
+
+//=============================================================================
+// Pipeline benchmark
+//=============================================================================
+
+struct PipelineFormat {
+    uint32_t rate;
+    uint32_t bits;
+};
+
+constexpr PipelineFormat PIPELINE_FORMATS[] = {{44100, 16}, {96000, 24}, {192000, 24}};
+
+// -6 dBFS 997 Hz stereo tone, 16- or 24-bit PCM WAV
+bool writeWav(const std::string& path, uint32_t rate, uint32_t bits, double seconds) {
+    std::ofstream f(path, std::ios::binary);
+    if (!f) return false;
+
+    const uint32_t bytesPerSample = bits / 8;
+    const uint32_t frames = static_cast<uint32_t>(rate * seconds);
+    const uint32_t dataBytes = frames * CHANNELS * bytesPerSample;
+    auto u32 = [&](uint32_t v) { f.write(reinterpret_cast<const char*>(&v), 4); };
+    auto u16 = [&](uint16_t v) { f.write(reinterpret_cast<const char*>(&v), 2); };
+
+    f.write("RIFF", 4); u32(36 + dataBytes); f.write("WAVE", 4);
+    f.write("fmt ", 4); u32(16); u16(1); u16(CHANNELS); u32(rate);
+    u32(rate * CHANNELS * bytesPerSample); u16(CHANNELS * bytesPerSample); u16(bits);
+    f.write("data", 4); u32(dataBytes);
+
+    std::vector<uint8_t> frame(CHANNELS * bytesPerSample);
+    const double peak = std::ldexp(0.5, bits - 1) - 1;
+    for (uint32_t n = 0; n < frames; n++) {
+        int32_t v = static_cast<int32_t>(std::lround(peak * std::sin(2 * M_PI * 997.0 * n / rate)));
+        for (int c = 0; c < CHANNELS; c++) {
+            for (uint32_t b = 0; b < bytesPerSample; b++) {
+                frame[c * bytesPerSample + b] = static_cast<uint8_t>(v >> (8 * b));
+            }
+        }
+        f.write(reinterpret_cast<const char*>(frame.data()), frame.size());
+    }
+    return static_cast<bool>(f);
+}
+
+// Same tiers as DirettaRenderer::selectChunkSize()
+size_t chunkFor(uint32_t rate) {
+    if (rate <= 48000) return AudioTiming::PCM_CHUNK_LOW;
+    if (rate <= 96000) return AudioTiming::PCM_CHUNK_MID;
+    return AudioTiming::PCM_CHUNK_HIGH;
+}
+
+std::string runPipeline(const PipelineFormat& fmt, double seconds) {
+    std::cerr << "[Bench] Pipeline: " << fmt.rate << "Hz/" << fmt.bits << "bit" << std::endl;
+
+    char path[] = "/tmp/bench_audio_XXXXXX.wav";
+    int fd = mkstemps(path, 4);
+    if (fd < 0) return "";
+    close(fd);
+    if (!writeWav(path, fmt.rate, fmt.bits, seconds + 2.0)) {
+        std::remove(path);
+        return "";
+    }
+
+    // Sink accepts 24-bit: 16-bit goes 16->32, 24-bit (S24_P32 from the
+    // decoder) is packed, as DirettaSync::configureRingPCM() would pick
+    const bool pack24 = fmt.bits == 24;
+    const int ringBytesPerSample = pack24 ? 3 : 4;
+    const size_t inBytesPerFrame = CHANNELS * (pack24 ? 4 : 2);
+    const size_t ringBytesPerFrame = CHANNELS * ringBytesPerSample;
+    const size_t bytesPerSecond = static_cast<size_t>(fmt.rate) * ringBytesPerFrame;
+
+    DirettaRingBuffer ring;
+    ring.resize(DirettaBuffer::calculateBufferSize(bytesPerSecond, DirettaBuffer::PCM_BUFFER_SECONDS), 0x00);
+    ring.setS24PackModeHint(DirettaRingBuffer::S24PackMode::LsbAligned);
+    const size_t prefill = DirettaBuffer::calculatePrefill(bytesPerSecond, false, fmt.rate <= 48000 && !pack24);
+    const unsigned int cycleUs = DirettaCycleCalculator().calculate(fmt.rate, CHANNELS, ringBytesPerSample * 8);
+
+    Latency sendLat, processLat, wakeLat, readLat;
+    std::atomic<bool> running{true};
+    std::atomic<size_t> rejected{0};
+
+    AudioEngine engine;
+    engine.setAudioCallback([&](const AudioBuffer& buffer, size_t samples, uint32_t, uint32_t, uint32_t) {
+        auto t0 = Clock::now();
+        size_t in = samples * inBytesPerFrame;
+        size_t written = pack24 ? ring.push24BitPacked(buffer.data(), in)
+                                : ring.push16To32(buffer.data(), in);
+        sendLat.record(t0, Clock::now());
+        if (written == 0) rejected.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    });
+    engine.setCurrentURI(path, "");
+    if (!engine.play()) {
+        std::remove(path);
+        return "";
+    }
+
+    // Mock getNewStream(): one cycle's worth of frames per call, with the
+    // fractional remainder carried like DirettaSync's accumulator
+    size_t underruns = 0, cycles = 0;
+    size_t minFill = ring.size();
+    std::thread consumer([&] {
+        while (running && ring.getAvailable() < prefill) std::this_thread::sleep_for(std::chrono::microseconds(200));
+        const uint64_t framesNum = static_cast<uint64_t>(fmt.rate) * cycleUs;
+        uint64_t remainder = 0;
+        std::vector<uint8_t> staging(ringBytesPerFrame * (framesNum / 1000000 + 1));
+        auto next = Clock::now();
+        while (running) {
+            next += std::chrono::microseconds(cycleUs);
+            std::this_thread::sleep_until(next);
+            auto woke = Clock::now();
+            wakeLat.record(next, woke);
+
+            remainder += framesNum;
+            size_t bytes = static_cast<size_t>(remainder / 1000000) * ringBytesPerFrame;
+            remainder %= 1000000;
+            cycles++;
+
+            size_t avail = ring.getAvailable();
+            minFill = std::min(minFill, avail);
+            if (avail < bytes) {
+                underruns++;
+                continue;
+            }
+            const uint8_t* region;
+            size_t contiguous;
+            if (ring.getDirectReadRegion(bytes, region, contiguous)) {
+                ring.advanceReadPos(bytes);
+            } else {
+                ring.pop(staging.data(), bytes);
+            }
+            readLat.record(woke, Clock::now());
+        }
+    });
+
+    // Audio thread, event-driven like DirettaRenderer::audioThreadFunc()
+    const size_t chunk = chunkFor(fmt.rate);
+    const auto period = std::chrono::microseconds((chunk * 1000000ULL) / fmt.rate);
+    const auto deadline = Clock::now() + std::chrono::duration<double>(seconds);
+    while (Clock::now() < deadline && engine.getState() == AudioEngine::State::PLAYING) {
+        auto t0 = Clock::now();
+        bool produced = engine.process(chunk);
+        processLat.record(t0, Clock::now());
+        if (produced) {
+            ring.waitForFreeSpace(chunk * ringBytesPerFrame, period * 2);
+        } else {
+            std::this_thread::sleep_for(period);
+        }
+    }
+    running = false;
+    consumer.join();
+    engine.stop();
+    std::remove(path);
+
+    std::ostringstream os;
+    os << "{\"rate\":" << fmt.rate << ",\"bits\":" << fmt.bits
+       << ",\"ring_bytes_per_sample\":" << ringBytesPerSample
+       << ",\"chunk_frames\":" << chunk << ",\"cycle_us\":" << cycleUs
+       << ",\"ring_bytes\":" << ring.size() << ",\"prefill_bytes\":" << prefill
+       << ",\"seconds\":" << seconds << ",\"cycles\":" << cycles
+       << ",\"underruns\":" << underruns << ",\"rejected_pushes\":" << rejected.load()
+       << ",\"min_fill_pct\":" << std::fixed << std::setprecision(1)
+       << (100.0 * minFill / std::max<size_t>(ring.size(), 1))
+       << ",\"process\":{" << processLat.json() << "}"
+       << ",\"send_audio\":{" << sendLat.json() << "}"
+       << ",\"consumer_wake_late\":{" << wakeLat.json() << "}"
+       << ",\"consumer_read\":{" << readLat.json() << "}}";
+    return os.str();
+}
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " [--quick] [--kernels-only] [--seconds N]\n"
+              << "  --quick         Fewer kernel iterations, 1 s per pipeline format\n"
+              << "  --kernels-only  Skip the AudioEngine pipeline run\n"
+              << "  --seconds N     Pipeline run time per format (default 3)\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            opt.quick = true;
+            opt.seconds = 1.0;
+        } else if (arg == "--kernels-only") {
+            opt.pipeline = false;
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            opt.seconds = std::max(0.5, std::atof(argv[++i]));
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // JSON owns stdout; everything the engine and kernels log goes to stderr
+    std::ostream json(std::cout.rdbuf());
+    std::cout.rdbuf(std::cerr.rdbuf());
+
+    AudioKernels::init();
+
+    std::vector<std::string> kernels;
+    runKernels(opt, kernels);
+
+    std::vector<std::string> pipeline;
+    if (opt.pipeline) {
+        for (const auto& fmt : PIPELINE_FORMATS) {
+            std::string result = runPipeline(fmt, opt.seconds);
+            if (result.empty()) {
+                std::cerr << "[Bench] Pipeline " << fmt.rate << "Hz/" << fmt.bits << "bit failed" << std::endl;
+                continue;
+            }
+            pipeline.push_back(result);
+        }
+    }
+
+    auto join = [](const std::vector<std::string>& items) {
+        std::string s;
+        for (size_t i = 0; i < items.size(); i++) s += (i ? ",\n    " : "\n    ") + items[i];
+        return s + "\n  ";
+    };
+    json << "{\n  \"schema\":1,\"isa\":\"" << AudioKernels::isaName(AudioKernels::active().isa)
+         << "\",\"cpus\":" << std::thread::hardware_concurrency() << ",\"quick\":" << (opt.quick ? "true" : "false")
+         << ",\n  \"kernels\":[" << join(kernels) << "],\n  \"pipeline\":[" << join(pipeline) << "]\n}" << std::endl;
+
+    std::cout.rdbuf(json.rdbuf());
+    return 0;
+}
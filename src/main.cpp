@@ -5,9 +5,13 @@
 
 #include "DirettaRenderer.h"
 #include "DirettaSync.h"
+#include "ThreadPlacement.h"
+#include "TraceRecorder.h"
 #include <iostream>
 #include <csignal>
+#include <cstdio>
 #include <memory>
+#include <sstream>
 #include <thread>
 #include <chrono>
 
@@ -25,6 +29,16 @@ void signalHandler(int signal) {
     exit(0);
 }
 
+void statsSignalHandler(int) {
+    if (g_renderer) {
+        g_renderer->requestStatsDump();
+    }
+}
+
+void traceSignalHandler(int) {
+    Trace::trigger(Trace::FreezeReason::Signal);
+}
+
 bool g_verbose = false;
 
 void listTargets() {
@@ -62,6 +76,129 @@ DirettaRenderer::Config parseArguments(int argc, char* argv[]) {
         else if (arg == "--no-gapless") {
             config.gaplessEnabled = false;
         }
+        else if (arg == "--decode-ahead") {
+            config.decodeAhead = true;
+        }
+        else if (arg == "--read-ahead" && i + 1 < argc) {
+            config.readAheadMB = std::atoi(argv[++i]);
+            if (config.readAheadMB < 0 || config.readAheadMB > 1024) {
+                std::cerr << "Invalid read-ahead size. Must be 0-1024 (MB)" << std::endl;
+                exit(1);
+            }
+        }
+        else if (arg == "--track-cache" && i + 1 < argc) {
+            config.trackCacheMB = std::atoi(argv[++i]);
+            if (config.trackCacheMB < 0 || config.trackCacheMB > 65536) {
+                std::cerr << "Invalid track cache size. Must be 0-65536 (MB)" << std::endl;
+                exit(1);
+            }
+        }
+        else if (arg == "--soft-volume") {
+            config.softVolume = true;
+        }
+        else if (arg == "--replaygain" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "off") config.replayGain = DirettaRenderer::ReplayGainMode::Off;
+            else if (mode == "track") config.replayGain = DirettaRenderer::ReplayGainMode::Track;
+            else if (mode == "album") config.replayGain = DirettaRenderer::ReplayGainMode::Album;
+            else {
+                std::cerr << "Invalid ReplayGain mode. Must be off, track or album" << std::endl;
+                exit(1);
+            }
+        }
+        else if (arg == "--replaygain-preamp" && i + 1 < argc) {
+            config.replayGainPreampDb = static_cast<float>(std::atof(argv[++i]));
+            if (config.replayGainPreampDb < -20.0f || config.replayGainPreampDb > 20.0f) {
+                std::cerr << "Invalid ReplayGain preamp. Must be -20 to 20 (dB)" << std::endl;
+                exit(1);
+            }
+        }
+        else if (arg == "--upsample" && i + 1 < argc) {
+            // <family>=<rate>[:polyphase|:swr], e.g. 44k=352800 or 48k=384000:swr
+            std::string spec = argv[++i];
+            size_t eq = spec.find('=');
+            size_t colon = spec.find(':', eq == std::string::npos ? 0 : eq);
+            std::string family = spec.substr(0, eq);
+            std::string rate = eq == std::string::npos ? "" : spec.substr(eq + 1, colon - eq - 1);
+            std::string engine = colon == std::string::npos ? "polyphase" : spec.substr(colon + 1);
+            DirettaRenderer::Upsample* target = family == "44k" ? &config.upsample44
+                                              : family == "48k" ? &config.upsample48 : nullptr;
+            char* end = nullptr;
+            unsigned long value = std::strtoul(rate.c_str(), &end, 10);
+            if (!target || rate.empty() || *end != '\0' || (value != 0 && (value < 8000 || value > 1536000))
+                || (engine != "polyphase" && engine != "swr")) {
+                std::cerr << "Invalid --upsample '" << spec
+                          << "'. Use 44k=<rate> or 48k=<rate> (8000-1536000, 0=off), optional :polyphase or :swr"
+                          << std::endl;
+                exit(1);
+            }
+            target->rate = static_cast<uint32_t>(value);
+            target->native = (engine == "polyphase");
+        }
+        else if (arg == "--pcm-to-dsd" && i + 1 < argc) {
+            config.pcmToDsd = std::atoi(argv[++i]);
+            if (config.pcmToDsd != 0 && config.pcmToDsd != 64 && config.pcmToDsd != 128 && config.pcmToDsd != 256) {
+                std::cerr << "Invalid PCM->DSD rate. Must be 64, 128, 256 or 0 (off)" << std::endl;
+                exit(1);
+            }
+        }
+        else if (arg == "--fast-start") {
+            config.fastStart = true;
+        }
+        else if (arg == "--fast-format-switch") {
+            config.fastFormatSwitch = true;
+        }
+        else if (arg == "--adaptive-buffer" && i + 1 < argc) {
+            // "auto" or <min>-<max> in ms
+            std::string spec = argv[++i];
+            config.adaptiveBuffer = true;
+            if (spec != "auto") {
+                int minMs = 0, maxMs = 0;
+                char tail = 0;
+                if (std::sscanf(spec.c_str(), "%d-%d%c", &minMs, &maxMs, &tail) != 2 ||
+                    minMs < 10 || maxMs < minMs || maxMs > 16000) {
+                    std::cerr << "Invalid --adaptive-buffer '" << spec
+                              << "'. Use auto or <min>-<max> in ms (e.g. 60-1000)" << std::endl;
+                    exit(1);
+                }
+                config.adaptiveMinMs = minMs;
+                config.adaptiveMaxMs = maxMs;
+            }
+        }
+        else if (arg == "--auto-tune") {
+            config.autoTune = true;
+        }
+        else if (arg == "--tuning-file" && i + 1 < argc) {
+            config.tuningFile = argv[++i];
+        }
+        else if (arg == "--target-cache" && i + 1 < argc) {
+            std::string path = argv[++i];
+            config.targetCacheFile = (path == "off") ? std::string() : path;
+        }
+        else if (arg == "--trace-file" && i + 1 < argc) {
+            std::string path = argv[++i];
+            config.traceFile = (path == "off") ? std::string() : path;
+        }
+        else if (arg == "--hugepages") {
+            config.hugePages = true;
+        }
+        else if (arg == "--mlock") {
+            config.lockMemory = true;
+        }
+        else if (arg == "--sched" && i + 1 < argc) {
+            std::string error = ThreadPlacement::parse(argv[++i]);
+            if (!error.empty()) {
+                std::cerr << "Invalid --sched '" << argv[i] << "': " << error << std::endl;
+                exit(1);
+            }
+        }
+        else if (arg == "--stats" && i + 1 < argc) {
+            config.statsIntervalSec = std::atoi(argv[++i]);
+            if (config.statsIntervalSec < 0) {
+                std::cerr << "Invalid stats interval. Must be >= 0" << std::endl;
+                exit(1);
+            }
+        }
         else if ((arg == "--target" || arg == "-t") && i + 1 < argc) {
             config.targetIndex = std::atoi(argv[++i]) - 1;
             if (config.targetIndex < 0) {
@@ -69,6 +206,19 @@ DirettaRenderer::Config parseArguments(int argc, char* argv[]) {
                 exit(1);
             }
         }
+        else if (arg == "--fan-out" && i + 1 < argc) {
+            // Comma-separated target indices, as for --target
+            std::stringstream list(argv[++i]);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                int index = std::atoi(item.c_str()) - 1;
+                if (index < 0) {
+                    std::cerr << "Invalid --fan-out target '" << item << "'. Must be >= 1" << std::endl;
+                    exit(1);
+                }
+                config.fanOutTargets.push_back(index);
+            }
+        }
         else if (arg == "--interface" && i + 1 < argc) {
             config.networkInterface = argv[++i];
         }
@@ -97,8 +247,40 @@ DirettaRenderer::Config parseArguments(int argc, char* argv[]) {
                       << "  --port, -p <port>     UPnP port (default: auto)\n"
                       << "  --uuid <uuid>         Device UUID (default: auto-generated)\n"
                       << "  --no-gapless          Disable gapless playback\n"
+                      << "  --decode-ahead        Decode on a separate thread (absorbs network/decode stalls)\n"
+                      << "  --read-ahead <MB>     Buffer HTTP sources MB ahead on a network thread (0=off)\n"
+                      << "  --track-cache <MB>    Keep whole HTTP tracks (current + next) in RAM (0=off)\n"
+                      << "  --soft-volume         Apply UPnP Volume/Mute as PCM gain (unity stays bit-perfect)\n"
+                      << "  --replaygain <mode>   Apply ReplayGain tags: off, track, album (default: off)\n"
+                      << "  --replaygain-preamp <dB>  Extra gain on top of ReplayGain (-20..20)\n"
+                      << "  --upsample <family>=<rate>[:polyphase|:swr]\n"
+                      << "                        Upsample a PCM family (44k or 48k) to rate, repeatable\n"
+                      << "                        (e.g. --upsample 44k=352800 --upsample 48k=384000)\n"
+                      << "  --pcm-to-dsd <rate>   Send PCM tracks as DSD64, DSD128 or DSD256 (64/128/256)\n"
+                      << "  --fast-start          Start decoding and prefill while the target comes online\n"
+                      << "  --fast-format-switch  Reconfigure in place on rate/format change (no reconnect)\n"
+                      << "  --adaptive-buffer <auto|min-max>\n"
+                      << "                        Queue depth and prefill follow source jitter (ms, default 60-1000)\n"
+                      << "  --auto-tune           Probe cycle time and transfer mode on the target at startup\n"
+                      << "  --tuning-file <path>  Learned per-target settings (default: /var/lib/diretta-renderer/tuning.conf)\n"
+                      << "  --hugepages           Back the Diretta ring with 2 MiB pages where available\n"
+                      << "  --mlock               Lock audio buffers in RAM (needs RLIMIT_MEMLOCK/CAP_IPC_LOCK)\n"
+                      << "  --sched <role>=<policy>[:<prio>][@<cpus>]\n"
+                      << "                        Thread placement, repeatable. Roles: main, sdk, audio,\n"
+                      << "                        decode, preload, position, upnp, io.\n"
+                      << "                        Policy: fifo, rr, other\n"
+                      << "                        (e.g. --sched sdk=fifo:80@3 --sched main=other@0-1)\n"
+                      << "  --stats <seconds>     Dump buffer telemetry as JSON every N seconds\n"
+                      << "                        (send SIGUSR1 for a one-off dump at any time)\n"
+                      << "  --trace-file <path|off>\n"
+                      << "                        Hot-path event trace, dumped on underrun or SIGUSR2\n"
+                      << "                        (default: /var/lib/diretta-renderer/trace.bin)\n"
                       << "  --target, -t <index>  Select Diretta target by index (1, 2, 3...)\n"
+                      << "  --fan-out <i>[,<j>...]\n"
+                      << "                        Also play to these targets from the same decoder (multi-room)\n"
                       << "  --interface <name>    Network interface to bind (e.g., eth0)\n"
+                      << "  --target-cache <path|off>\n"
+                      << "                        Last known target for a fast start (default: /var/lib/diretta-renderer/target.cache)\n"
                       << "  --list-targets, -l    List available Diretta targets and exit\n"
                       << "  --verbose, -v         Enable verbose debug output\n"
                       << "  --version, -V         Show version information\n"
@@ -119,6 +301,8 @@ DirettaRenderer::Config parseArguments(int argc, char* argv[]) {
 int main(int argc, char* argv[]) {
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
+    signal(SIGUSR1, statsSignalHandler);
+    signal(SIGUSR2, traceSignalHandler);
 
     std::cout << "═══════════════════════════════════════════════════════\n"
               << "  Diretta UPnP Renderer v" << RENDERER_VERSION << "\n"
@@ -131,12 +315,77 @@ int main(int argc, char* argv[]) {
     std::cout << "  Name:     " << config.name << std::endl;
     std::cout << "  Port:     " << (config.port == 0 ? "auto" : std::to_string(config.port)) << std::endl;
     std::cout << "  Gapless:  " << (config.gaplessEnabled ? "enabled" : "disabled") << std::endl;
+    std::cout << "  Decode:   " << (config.decodeAhead ? "decode-ahead thread" : "inline") << std::endl;
+    if (config.readAheadMB > 0) {
+        std::cout << "  Source:   " << config.readAheadMB << " MB read-ahead (HTTP)" << std::endl;
+    }
+    if (config.trackCacheMB > 0) {
+        std::cout << "  Cache:    " << config.trackCacheMB << " MB whole-track (HTTP)" << std::endl;
+    }
+    if (config.softVolume || config.replayGain != DirettaRenderer::ReplayGainMode::Off) {
+        const char* rgMode = config.replayGain == DirettaRenderer::ReplayGainMode::Track ? "track"
+                           : config.replayGain == DirettaRenderer::ReplayGainMode::Album ? "album" : "off";
+        std::cout << "  Gain:     " << (config.softVolume ? "soft volume, " : "")
+                  << "ReplayGain " << rgMode;
+        if (config.replayGain != DirettaRenderer::ReplayGainMode::Off) {
+            std::cout << " (preamp " << config.replayGainPreampDb << " dB)";
+        }
+        std::cout << std::endl;
+    }
+    if (config.upsample44.rate > 0 || config.upsample48.rate > 0) {
+        std::cout << "  Upsample:";
+        for (const auto* rule : {&config.upsample44, &config.upsample48}) {
+            if (rule->rate == 0) continue;
+            std::cout << " " << (rule == &config.upsample44 ? "44k" : "48k") << "->" << rule->rate << "Hz"
+                      << (rule->native ? " (polyphase)" : " (swr)");
+        }
+        std::cout << std::endl;
+    }
+    if (config.pcmToDsd > 0) {
+        std::cout << "  PCM->DSD: DSD" << config.pcmToDsd << " (" << 44100 * config.pcmToDsd << " Hz)" << std::endl;
+    }
+    if (config.fastStart) {
+        std::cout << "  Start:    fast (sink online behind prefill)" << std::endl;
+    }
+    std::cout << "  Format:   " << (config.fastFormatSwitch ? "fast switch" : "full reopen") << std::endl;
+    if (config.adaptiveBuffer) {
+        std::cout << "  Buffer:   adaptive " << config.adaptiveMinMs << "-" << config.adaptiveMaxMs << " ms" << std::endl;
+    }
+    if (config.autoTune) {
+        std::cout << "  Tuning:   auto-tune at startup -> " << config.tuningFile << std::endl;
+    } else if (!config.tuningFile.empty()) {
+        std::cout << "  Tuning:   " << config.tuningFile << std::endl;
+    }
+    if (config.hugePages || config.lockMemory) {
+        std::cout << "  Memory:   " << (config.hugePages ? "hugepages " : "")
+                  << (config.lockMemory ? "mlock" : "") << std::endl;
+    }
+    if (config.statsIntervalSec > 0) {
+        std::cout << "  Stats:    every " << config.statsIntervalSec << "s" << std::endl;
+    }
+    std::cout << "  Trace:    " << (config.traceFile.empty() ? "off" : "dump to " + config.traceFile) << std::endl;
     if (!config.networkInterface.empty()) {
         std::cout << "  Network:  " << config.networkInterface << std::endl;
     }
+    if (!config.fanOutTargets.empty()) {
+        std::cout << "  Fan-out:  targets";
+        for (int index : config.fanOutTargets) std::cout << " " << (index + 1);
+        std::cout << std::endl;
+    }
+    std::cout << "  Target:   " << (config.targetCacheFile.empty() ? "discover at startup"
+                                                         : "cached (" + config.targetCacheFile + ")") << std::endl;
     std::cout << "  UUID:     " << config.uuid << std::endl;
     std::cout << std::endl;
 
+    // What a thread without any --sched entry returns to (see effectiveSpec())
+    ThreadPlacement::captureBaseline();
+    if (ThreadPlacement::anyConfigured()) {
+        ThreadPlacement::validate();
+        // Before libupnp starts: its thread pool inherits the main placement
+        ThreadPlacement::apply(ThreadPlacement::Role::Main);
+        std::cout << std::endl;
+    }
+
     try {
         g_renderer = std::make_unique<DirettaRenderer>(config);
 
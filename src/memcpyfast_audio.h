@@ -1,46 +1,105 @@
 #ifndef __MEMCPYFAST_AUDIO_H__
 #define __MEMCPYFAST_AUDIO_H__
 
-#include "FastMemcpy_Audio.h"
-#include <immintrin.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <cstdint>
 #include <cstddef>
 #include <cstring>
 
-#ifdef __AVX512F__
+//---------------------------------------------------------------------
+// Copy kernels for audio buffers
+//
+// Every ISA variant is compiled into the binary; the x86 kernels carry
+// their own target attributes so the rest of the program can be built
+// for the x86-64 baseline. AudioKernels.h binds the best one at runtime
+// and provides the memcpy_audio() / memcpy_audio_fixed() entry points.
+//---------------------------------------------------------------------
+#if defined(__x86_64__) || defined(__i386__)
+#define MEMCPY_AUDIO_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MEMCPY_AUDIO_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(MEMCPY_AUDIO_X86)
+#if defined(__clang__)
+#define AUDIO_TARGET_BEGIN_AVX2 \
+    _Pragma("clang attribute push (__attribute__((target(\"avx2\"))), apply_to = function)")
+#define AUDIO_TARGET_BEGIN_AVX512 \
+    _Pragma("clang attribute push (__attribute__((target(\"avx2,avx512f,avx512bw\"))), apply_to = function)")
+#define AUDIO_TARGET_END _Pragma("clang attribute pop")
+#else
+#define AUDIO_TARGET_BEGIN_AVX2 _Pragma("GCC push_options") _Pragma("GCC target(\"avx2\")")
+#define AUDIO_TARGET_BEGIN_AVX512 \
+    _Pragma("GCC push_options") _Pragma("GCC target(\"avx2,avx512f,avx512bw\")")
+#define AUDIO_TARGET_END _Pragma("GCC pop_options")
+#endif
+#define AUDIO_TARGET_AVX2 __attribute__((target("avx2")))
+
+AUDIO_TARGET_BEGIN_AVX2
+#include "FastMemcpy_Audio.h"
+AUDIO_TARGET_END
+
+AUDIO_TARGET_BEGIN_AVX512
 #include "FastMemcpy_Audio_AVX512.h"
+AUDIO_TARGET_END
 #endif
 
 //---------------------------------------------------------------------
 // Runtime CPU feature detection
 //---------------------------------------------------------------------
-static int g_avx512_checked = 0;
-static int g_has_avx512 = 0;
-
-static inline int detect_avx512(void) {
-    if (!g_avx512_checked) {
-        g_avx512_checked = 1;
-#if defined(__GNUC__) && defined(__AVX512F__)
-        __builtin_cpu_init();
-        g_has_avx512 = __builtin_cpu_supports("avx512f") &&
-                       __builtin_cpu_supports("avx512bw");
-        if (g_has_avx512) {
-            fprintf(stderr, "[memcpy_audio] AVX-512 detected and enabled\n");
-        }
-#else
-        g_has_avx512 = 0;
+struct AudioCpuFeatures {
+    bool sse2 = false;
+    bool avx2 = false;
+    bool avx512 = false;   // avx512f + avx512bw
+    bool neon = false;
+};
+
+static inline AudioCpuFeatures detect_audio_cpu_features(void) {
+    AudioCpuFeatures f;
+#if defined(MEMCPY_AUDIO_X86) && defined(__GNUC__)
+    __builtin_cpu_init();
+    f.sse2 = __builtin_cpu_supports("sse2");
+    f.avx2 = __builtin_cpu_supports("avx2");
+    f.avx512 = __builtin_cpu_supports("avx512f") &&
+               __builtin_cpu_supports("avx512bw");
+#elif defined(MEMCPY_AUDIO_NEON)
+    f.neon = true;
 #endif
+    return f;
+}
+
+//---------------------------------------------------------------------
+// Consistent-timing memcpy for audio buffers (128-4096 bytes)
+// Uses overlapping stores for tail handling to eliminate timing variance
+//---------------------------------------------------------------------
+static inline void memcpy_audio_fixed_tail16(uint8_t* d, const uint8_t* s, size_t size) {
+    if (size >= 8) {
+        uint64_t a;
+        uint64_t b;
+        std::memcpy(&a, s, 8);
+        std::memcpy(&b, s + size - 8, 8);
+        std::memcpy(d, &a, 8);
+        std::memcpy(d + size - 8, &b, 8);
+    } else if (size >= 4) {
+        uint32_t a;
+        uint32_t b;
+        std::memcpy(&a, s, 4);
+        std::memcpy(&b, s + size - 4, 4);
+        std::memcpy(d, &a, 4);
+        std::memcpy(d + size - 4, &b, 4);
+    } else if (size > 0) {
+        d[0] = s[0];
+        if (size > 1) d[size - 1] = s[size - 1];
+        if (size > 2) d[1] = s[1];
     }
-    return g_has_avx512;
 }
 
-/**
- * Consistent-timing memcpy for audio buffers (128-4096 bytes)
- * Uses overlapping stores for tail handling to eliminate timing variance
- */
-static inline void memcpy_audio_fixed(void* dst, const void* src, size_t size) {
+#if defined(MEMCPY_AUDIO_X86)
+AUDIO_TARGET_AVX2
+static inline void memcpy_audio_fixed_avx2(void* dst, const void* src, size_t size) {
     uint8_t* d = static_cast<uint8_t*>(dst);
     const uint8_t* s = static_cast<const uint8_t*>(src);
 
@@ -77,29 +136,104 @@ static inline void memcpy_audio_fixed(void* dst, const void* src, size_t size) {
         __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + size - 16));
         _mm_storeu_si128(reinterpret_cast<__m128i*>(d), a);
         _mm_storeu_si128(reinterpret_cast<__m128i*>(d + size - 16), b);
-    } else if (size >= 8) {
-        uint64_t a;
-        uint64_t b;
-        std::memcpy(&a, s, 8);
-        std::memcpy(&b, s + size - 8, 8);
-        std::memcpy(d, &a, 8);
-        std::memcpy(d + size - 8, &b, 8);
-    } else if (size >= 4) {
-        uint32_t a;
-        uint32_t b;
-        std::memcpy(&a, s, 4);
-        std::memcpy(&b, s + size - 4, 4);
-        std::memcpy(d, &a, 4);
-        std::memcpy(d + size - 4, &b, 4);
-    } else if (size > 0) {
-        d[0] = s[0];
-        if (size > 1) d[size - 1] = s[size - 1];
-        if (size > 2) d[1] = s[1];
+    } else {
+        memcpy_audio_fixed_tail16(d, s, size);
     }
 
     _mm256_zeroupper();
 }
 
+// SSE2 is part of the x86-64 baseline, no target attribute needed
+static inline void memcpy_audio_fixed_sse2(void* dst, const void* src, size_t size) {
+    uint8_t* d = static_cast<uint8_t*>(dst);
+    const uint8_t* s = static_cast<const uint8_t*>(src);
+
+    while (size >= 64) {
+        __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 0));
+        __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16));
+        __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32));
+        __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 48));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 0), r0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 16), r1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 32), r2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 48), r3);
+        s += 64;
+        d += 64;
+        size -= 64;
+    }
+
+    if (size >= 32) {
+        __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+        __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16));
+        __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + size - 32));
+        __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + size - 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d), a0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 16), a1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + size - 32), b0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + size - 16), b1);
+    } else if (size >= 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + size - 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d), a);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + size - 16), b);
+    } else {
+        memcpy_audio_fixed_tail16(d, s, size);
+    }
+}
+#endif // MEMCPY_AUDIO_X86
+
+#if defined(MEMCPY_AUDIO_NEON)
+static inline void memcpy_audio_fixed_neon(void* dst, const void* src, size_t size) {
+    uint8_t* d = static_cast<uint8_t*>(dst);
+    const uint8_t* s = static_cast<const uint8_t*>(src);
+
+    while (size >= 64) {
+        uint8x16_t r0 = vld1q_u8(s + 0);
+        uint8x16_t r1 = vld1q_u8(s + 16);
+        uint8x16_t r2 = vld1q_u8(s + 32);
+        uint8x16_t r3 = vld1q_u8(s + 48);
+        vst1q_u8(d + 0, r0);
+        vst1q_u8(d + 16, r1);
+        vst1q_u8(d + 32, r2);
+        vst1q_u8(d + 48, r3);
+        s += 64;
+        d += 64;
+        size -= 64;
+    }
+
+    if (size >= 32) {
+        uint8x16_t a0 = vld1q_u8(s);
+        uint8x16_t a1 = vld1q_u8(s + 16);
+        uint8x16_t b0 = vld1q_u8(s + size - 32);
+        uint8x16_t b1 = vld1q_u8(s + size - 16);
+        vst1q_u8(d, a0);
+        vst1q_u8(d + 16, a1);
+        vst1q_u8(d + size - 32, b0);
+        vst1q_u8(d + size - 16, b1);
+    } else if (size >= 16) {
+        uint8x16_t a = vld1q_u8(s);
+        uint8x16_t b = vld1q_u8(s + size - 16);
+        vst1q_u8(d, a);
+        vst1q_u8(d + size - 16, b);
+    } else {
+        memcpy_audio_fixed_tail16(d, s, size);
+    }
+}
+#endif // MEMCPY_AUDIO_NEON
+
+static inline void memcpy_audio_fixed_scalar(void* dst, const void* src, size_t size) {
+    uint8_t* d = static_cast<uint8_t*>(dst);
+    const uint8_t* s = static_cast<const uint8_t*>(src);
+
+    while (size >= 16) {
+        std::memcpy(d, s, 16);
+        s += 16;
+        d += 16;
+        size -= 16;
+    }
+    memcpy_audio_fixed_tail16(d, s, size);
+}
+
 /**
  * Prefetch audio buffer for upcoming memcpy
  * Tuned for 180-1500 byte buffers on Zen 4
@@ -107,13 +241,13 @@ static inline void memcpy_audio_fixed(void* dst, const void* src, size_t size) {
 static inline void prefetch_audio_buffer(const void* src, size_t size) {
     const char* p = static_cast<const char*>(src);
 
-    _mm_prefetch(p, _MM_HINT_T0);
+    __builtin_prefetch(p, 0, 3);
 
     if (size > 256) {
-        _mm_prefetch(p + 64, _MM_HINT_T0);
+        __builtin_prefetch(p + 64, 0, 3);
     }
     if (size > 512) {
-        _mm_prefetch(p + size - 64, _MM_HINT_T0);
+        __builtin_prefetch(p + size - 64, 0, 3);
     }
 }
 
@@ -123,9 +257,29 @@ static inline void prefetch_audio_buffer(const void* src, size_t size) {
 #define AVX512_THRESHOLD (32 * 1024)
 
 //---------------------------------------------------------------------
-// Main dispatcher - selects optimal path based on size and CPU
+// Bulk copy kernels (bound at runtime by AudioKernels::init)
 //---------------------------------------------------------------------
-static inline void* memcpy_audio(void *dst, const void *src, size_t len) {
+#if defined(MEMCPY_AUDIO_X86)
+AUDIO_TARGET_AVX2
+static inline void* memcpy_audio_bulk_avx2(void* dst, const void* src, size_t len) {
+    return memcpy_audio_fast(dst, src, len);
+}
+
+__attribute__((target("avx2,avx512f,avx512bw")))
+static inline void* memcpy_audio_bulk_avx512(void* dst, const void* src, size_t len) {
+    if (len >= AVX512_THRESHOLD) {
+        return memcpy_audio_avx512(dst, src, len);
+    }
+    return memcpy_audio_fast(dst, src, len);
+}
+#endif
+
+// glibc memcpy is itself ifunc-dispatched (SSE2/ERMS on x86, NEON/SVE on arm64)
+static inline void* memcpy_audio_bulk_libc(void* dst, const void* src, size_t len) {
+    return std::memcpy(dst, src, len);
+}
+
+static inline void memcpy_audio_check_overlap(const void* dst, const void* src, size_t len) {
 #ifndef NDEBUG
     const char *s = (const char *)src;
     const char *d = (const char *)dst;
@@ -134,15 +288,11 @@ static inline void* memcpy_audio(void *dst, const void *src, size_t len) {
         fprintf(stderr, "  src=%p, dst=%p, len=%zu\n", src, dst, len);
         abort();
     }
+#else
+    (void)dst;
+    (void)src;
+    (void)len;
 #endif
-
-#ifdef __AVX512F__
-    if (len >= AVX512_THRESHOLD && detect_avx512()) {
-        return memcpy_audio_avx512(dst, src, len);
-    }
-#endif
-
-    return memcpy_audio_fast(dst, src, len);
 }
 
 #endif // __MEMCPYFAST_AUDIO_H__
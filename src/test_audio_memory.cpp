@@ -1,6 +1,16 @@
 #include "AudioMemoryTest.h"
-#include "memcpyfast_audio.h"
+#include "AudioKernels.h"
 #include "DirettaRingBuffer.h"
+#include "PolyphaseResampler.h"
+#include "DsdModulator.h"
+#include "AdaptiveDepth.h"
+#include "CycleTuning.h"
+#include "TargetCache.h"
+#include "FanOut.h"
+#include "TraceRecorder.h"
+#include "TrackSnapshot.h"
+#include "ThreadPlacement.h"
+#include <thread>
 
 bool test_memcpy_audio_fixed_correctness();
 bool test_memcpy_audio_fixed_timing_variance();
@@ -9,11 +19,28 @@ bool test_24bit_packing_correctness();
 bool test_24bit_packing_timing();
 bool test_16to32_correctness();
 bool test_dsd_stereo_correctness();
+bool test_simd_matches_scalar();
+bool test_dsd_multichannel_correctness();
 bool test_ring_buffer_wraparound();
+bool test_dsd_push_direct_and_wrap();
+bool test_free_space_watermark();
+bool test_mirrored_ring_wrap();
+bool test_discard_queued_keeps_head();
+bool test_gain_kernels();
+bool test_polyphase_resampler();
+bool test_dsd_modulator();
+bool test_adaptive_depth();
+bool test_cycle_tuning_store();
+bool test_target_cache_store();
+bool test_fanout_slip();
+bool test_trace_recorder_dump();
+bool test_snapshot_cell_publish();
+bool test_thread_placement_fallback();
 bool test_full_integration();
 
 int main() {
     std::cout << "=== Audio Memory Optimization Tests ===" << std::endl;
+    AudioKernels::init();
     std::cout << std::endl;
 
     int passed = 0;
@@ -26,7 +53,23 @@ int main() {
     RUN_TEST(test_24bit_packing_timing);
     RUN_TEST(test_16to32_correctness);
     RUN_TEST(test_dsd_stereo_correctness);
+    RUN_TEST(test_simd_matches_scalar);
+    RUN_TEST(test_dsd_multichannel_correctness);
     RUN_TEST(test_ring_buffer_wraparound);
+    RUN_TEST(test_dsd_push_direct_and_wrap);
+    RUN_TEST(test_free_space_watermark);
+    RUN_TEST(test_mirrored_ring_wrap);
+    RUN_TEST(test_discard_queued_keeps_head);
+    RUN_TEST(test_gain_kernels);
+    RUN_TEST(test_polyphase_resampler);
+    RUN_TEST(test_dsd_modulator);
+    RUN_TEST(test_adaptive_depth);
+    RUN_TEST(test_cycle_tuning_store);
+    RUN_TEST(test_target_cache_store);
+    RUN_TEST(test_fanout_slip);
+    RUN_TEST(test_trace_recorder_dump);
+    RUN_TEST(test_snapshot_cell_publish);
+    RUN_TEST(test_thread_placement_fallback);
     RUN_TEST(test_full_integration);
 
     std::cout << std::endl;
@@ -154,7 +197,7 @@ bool test_24bit_packing_correctness() {
     DirettaRingBuffer ring;
     ring.resize(1024 * 1024, 0x00);
 
-    size_t converted = ring.convert24BitPacked_AVX2(output, input, NUM_SAMPLES);
+    size_t converted = AudioKernels::active().pack24(output, input, NUM_SAMPLES);
 
     TEST_ASSERT_EQ(converted, NUM_SAMPLES * 3, "Wrong output size");
     TEST_ASSERT(std::memcmp(output, expected, NUM_SAMPLES * 3) == 0,
@@ -182,7 +225,7 @@ bool test_24bit_packing_timing() {
     auto measure = [&](int loops) {
         auto start = std::chrono::steady_clock::now();
         for (int j = 0; j < loops; j++) {
-            ring.convert24BitPacked_AVX2(output, input, NUM_SAMPLES);
+            AudioKernels::active().pack24(output, input, NUM_SAMPLES);
         }
         auto end = std::chrono::steady_clock::now();
         return std::chrono::duration<double, std::micro>(end - start).count();
@@ -233,7 +276,7 @@ bool test_16to32_correctness() {
     DirettaRingBuffer ring;
     ring.resize(1024 * 1024, 0x00);
 
-    size_t converted = ring.convert16To32_AVX2(output, input, NUM_SAMPLES);
+    size_t converted = AudioKernels::active().convert16To32(output, input, NUM_SAMPLES);
 
     TEST_ASSERT_EQ(converted, NUM_SAMPLES * 4, "Wrong output size");
     TEST_ASSERT(std::memcmp(output, expected, NUM_SAMPLES * 4) == 0,
@@ -270,7 +313,7 @@ bool test_dsd_stereo_correctness() {
     DirettaRingBuffer ring;
     ring.resize(1024 * 1024, 0x69);
 
-    size_t converted = ring.convertDSDPlanar_AVX2(
+    size_t converted = AudioKernels::active().dsdPlanar(
         output, input, TOTAL_INPUT, 2,
         nullptr,
         false
@@ -283,6 +326,164 @@ bool test_dsd_stereo_correctness() {
     return true;
 }
 
+bool test_simd_matches_scalar() {
+    // Odd sizes exercise the vector body plus the scalar tail
+    std::vector<size_t> sampleCounts = {1, 7, 15, 16, 17, 31, 32, 33, 63, 257, 1001};
+
+    std::vector<uint8_t> input(1001 * 4);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = static_cast<uint8_t>((i * 37 + 11) & 0xFF);
+    }
+
+    std::vector<uint8_t> out(1001 * 8 + 64);
+    std::vector<uint8_t> ref(1001 * 8 + 64);
+    std::vector<uint8_t> src(64 * 1024 + 7);
+    std::vector<uint8_t> dst(64 * 1024 + 7);
+    for (size_t i = 0; i < src.size(); i++) {
+        src[i] = static_cast<uint8_t>((i * 131 + 7) & 0xFF);
+    }
+
+    uint8_t bitReverse[256];
+    for (int i = 0; i < 256; i++) {
+        uint8_t r = 0;
+        for (int bit = 0; bit < 8; bit++) {
+            if (i & (1 << bit)) r |= static_cast<uint8_t>(0x80 >> bit);
+        }
+        bitReverse[i] = r;
+    }
+
+    const AudioKernels::Isa isas[] = {
+        AudioKernels::Isa::Scalar, AudioKernels::Isa::SSE2, AudioKernels::Isa::AVX2,
+        AudioKernels::Isa::AVX512, AudioKernels::Isa::NEON
+    };
+
+    for (AudioKernels::Isa isa : isas) {
+        if (!AudioKernels::isSupported(isa)) continue;
+        const AudioKernels::Table k = AudioKernels::tableFor(isa);
+
+        for (size_t n : sampleCounts) {
+            size_t a = k.pack24(out.data(), input.data(), n);
+            size_t b = AudioKernels::convert24BitPacked_Scalar(ref.data(), input.data(), n);
+            TEST_ASSERT_EQ(a, b, "24-bit pack size mismatch");
+            TEST_ASSERT(std::memcmp(out.data(), ref.data(), a) == 0,
+                "24-bit pack differs from scalar (" << AudioKernels::isaName(isa) << ")");
+
+            a = k.pack24Shifted(out.data(), input.data(), n);
+            b = AudioKernels::convert24BitPackedShifted_Scalar(ref.data(), input.data(), n);
+            TEST_ASSERT_EQ(a, b, "24-bit shifted pack size mismatch");
+            TEST_ASSERT(std::memcmp(out.data(), ref.data(), a) == 0,
+                "24-bit shifted pack differs from scalar (" << AudioKernels::isaName(isa) << ")");
+
+            a = k.convert16To32(out.data(), input.data(), n);
+            b = AudioKernels::convert16To32_Scalar(ref.data(), input.data(), n);
+            TEST_ASSERT_EQ(a, b, "16->32 size mismatch");
+            TEST_ASSERT(std::memcmp(out.data(), ref.data(), a) == 0,
+                "16->32 differs from scalar (" << AudioKernels::isaName(isa) << ")");
+        }
+
+        // DSD: whole 4-byte groups per channel, sizes around the 16/32-byte vector widths
+        std::vector<size_t> bytesPerChannel = {4, 12, 16, 20, 28, 32, 36, 60, 64, 68, 1000};
+        for (size_t bpc : bytesPerChannel) {
+            for (int variant = 0; variant < 4; variant++) {
+                const uint8_t* table = (variant & 1) ? bitReverse : nullptr;
+                bool byteSwap = (variant & 2) != 0;
+
+                size_t a = k.dsdPlanar(out.data(), input.data(), bpc * 2, 2, table, byteSwap);
+                size_t b = AudioKernels::convertDSDPlanar_Scalar(ref.data(), input.data(), bpc * 2, 2,
+                                                                 table, byteSwap);
+                TEST_ASSERT_EQ(a, b, "DSD size mismatch");
+                TEST_ASSERT(std::memcmp(out.data(), ref.data(), a) == 0,
+                    "DSD stereo differs from scalar (" << AudioKernels::isaName(isa) << ")");
+            }
+        }
+
+        // Copies: below and above the AVX-512 threshold, odd lengths
+        for (size_t len : {size_t(1), size_t(15), size_t(180), size_t(4097), src.size()}) {
+            std::fill(dst.begin(), dst.end(), 0);
+            k.copy(dst.data(), src.data(), len);
+            TEST_ASSERT(std::memcmp(dst.data(), src.data(), len) == 0,
+                "memcpy_audio failed at size " << len << " (" << AudioKernels::isaName(isa) << ")");
+
+            std::fill(dst.begin(), dst.end(), 0);
+            k.copyFixed(dst.data(), src.data(), len);
+            TEST_ASSERT(std::memcmp(dst.data(), src.data(), len) == 0,
+                "memcpy_audio_fixed failed at size " << len << " (" << AudioKernels::isaName(isa) << ")");
+        }
+    }
+
+    return true;
+}
+
+bool test_dsd_multichannel_correctness() {
+    // 5.1 / 7.1: every ISA against the scalar reference, sizes around the
+    // 16/32-byte vector widths, nothing written past the output
+    std::vector<uint8_t> input(1000 * 8);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = static_cast<uint8_t>((i * 53 + 29) & 0xFF);
+    }
+    std::vector<uint8_t> out(1000 * 8 + 64);
+    std::vector<uint8_t> ref(1000 * 8 + 64);
+
+    uint8_t bitReverse[256];
+    for (int i = 0; i < 256; i++) {
+        uint8_t r = 0;
+        for (int bit = 0; bit < 8; bit++) {
+            if (i & (1 << bit)) r |= static_cast<uint8_t>(0x80 >> bit);
+        }
+        bitReverse[i] = r;
+    }
+
+    const AudioKernels::Isa isas[] = {
+        AudioKernels::Isa::Scalar, AudioKernels::Isa::SSE2, AudioKernels::Isa::AVX2,
+        AudioKernels::Isa::AVX512, AudioKernels::Isa::NEON
+    };
+    std::vector<size_t> bytesPerChannel = {4, 12, 16, 20, 28, 32, 36, 60, 64, 68, 96, 1000};
+
+    for (AudioKernels::Isa isa : isas) {
+        if (!AudioKernels::isSupported(isa)) continue;
+        const AudioKernels::Table k = AudioKernels::tableFor(isa);
+
+        for (int channels : {6, 8}) {
+            for (size_t bpc : bytesPerChannel) {
+                size_t total = bpc * static_cast<size_t>(channels);
+                for (int variant = 0; variant < 4; variant++) {
+                    const uint8_t* table = (variant & 1) ? bitReverse : nullptr;
+                    bool byteSwap = (variant & 2) != 0;
+
+                    std::fill(out.begin(), out.end(), 0xA5);
+                    size_t a = k.dsdPlanar(out.data(), input.data(), total, channels, table, byteSwap);
+                    size_t b = AudioKernels::convertDSDPlanar_Scalar(ref.data(), input.data(), total,
+                                                                     channels, table, byteSwap);
+                    TEST_ASSERT_EQ(a, b, "multichannel DSD size mismatch");
+                    TEST_ASSERT(std::memcmp(out.data(), ref.data(), a) == 0,
+                        "DSD " << channels << "ch differs from scalar at " << bpc << " bytes/ch ("
+                        << AudioKernels::isaName(isa) << ")");
+                    for (size_t i = a; i < out.size(); i++) {
+                        TEST_ASSERT(out[i] == 0xA5, "DSD " << channels << "ch wrote past its output ("
+                            << AudioKernels::isaName(isa) << ")");
+                    }
+                }
+            }
+        }
+    }
+
+    // Through the ring: one 7.1 block converted in place, one straddling the wrap
+    DirettaRingBuffer ring;
+    ring.resize(4096, 0x69);
+    size_t block = 96 * 8;
+    std::vector<uint8_t> popped(block);
+    AudioKernels::convertDSDPlanar_Scalar(ref.data(), input.data(), block, 8, nullptr, false);
+    for (int pass = 0; pass < 8; pass++) {
+        TEST_ASSERT_EQ(ring.pushDSDPlanar(input.data(), block, 8, nullptr), block,
+            "7.1 DSD push should take the whole block");
+        TEST_ASSERT_EQ(ring.pop(popped.data(), block), block, "7.1 DSD pop size");
+        TEST_ASSERT(std::memcmp(popped.data(), ref.data(), block) == 0,
+            "7.1 DSD ring contents differ (pass " << pass << ")");
+    }
+
+    return true;
+}
+
 bool test_ring_buffer_wraparound() {
     DirettaRingBuffer ring;
     ring.resize(1024, 0x00);
@@ -314,6 +515,734 @@ bool test_ring_buffer_wraparound() {
     return true;
 }
 
+bool test_dsd_push_direct_and_wrap() {
+    constexpr size_t BLOCK = 256;  // 128 bytes per channel
+    std::vector<uint8_t> planar(BLOCK);
+    for (size_t i = 0; i < BLOCK; i++) planar[i] = static_cast<uint8_t>(i * 7 + 3);
+
+    std::vector<uint8_t> expected(BLOCK);
+    AudioKernels::convertDSDPlanar_Scalar(expected.data(), planar.data(), BLOCK, 2, nullptr, true);
+
+    DirettaRingBuffer ring;
+    ring.resize(1024, 0x69);
+
+    // Contiguous: converted straight into the ring
+    size_t consumed = ring.pushDSDPlanar(planar.data(), BLOCK, 2, nullptr, true);
+    TEST_ASSERT_EQ(consumed, BLOCK, "DSD direct push wrong size");
+
+    std::vector<uint8_t> readBack(BLOCK);
+    TEST_ASSERT_EQ(ring.pop(readBack.data(), BLOCK), BLOCK, "DSD direct pop wrong size");
+    TEST_ASSERT(std::memcmp(readBack.data(), expected.data(), BLOCK) == 0,
+        "DSD direct push corrupted");
+
+    // Move the write position so the next block straddles the wrap point
+    std::vector<uint8_t> filler(1024 - BLOCK - 100, 0x00);
+    ring.push(filler.data(), filler.size());
+    std::vector<uint8_t> sink(filler.size());
+    ring.pop(sink.data(), sink.size());
+
+    consumed = ring.pushDSDPlanar(planar.data(), BLOCK, 2, nullptr, true);
+    TEST_ASSERT_EQ(consumed, BLOCK, "DSD wrap push wrong size");
+    TEST_ASSERT_EQ(ring.pop(readBack.data(), BLOCK), BLOCK, "DSD wrap pop wrong size");
+    TEST_ASSERT(std::memcmp(readBack.data(), expected.data(), BLOCK) == 0,
+        "DSD wrap push corrupted");
+
+    // All or nothing: a block larger than the free space is not split
+    std::vector<uint8_t> big(ring.size(), 0x69);
+    TEST_ASSERT_EQ(ring.pushDSDPlanar(big.data(), big.size(), 2, nullptr, false), size_t(0),
+        "Oversized DSD push should be rejected");
+    TEST_ASSERT_EQ(ring.getAvailable(), size_t(0), "Rejected DSD push wrote data");
+
+    return true;
+}
+
+bool test_free_space_watermark() {
+    DirettaRingBuffer ring;
+    ring.resize(4096, 0x00);
+
+    std::vector<uint8_t> fill(4000, 0x11);
+    TEST_ASSERT_EQ(ring.push(fill.data(), fill.size()), fill.size(), "Fill push wrong size");
+
+    // Nobody frees space: the wait must time out
+    TEST_ASSERT(!ring.waitForFreeSpace(2048, std::chrono::microseconds(2000)),
+        "Wait should time out on a full ring");
+
+    // Consumer crosses the watermark: the producer wakes well before its timeout
+    auto start = std::chrono::steady_clock::now();
+    std::thread consumer([&ring]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        std::vector<uint8_t> out(2048);
+        ring.pop(out.data(), out.size());
+    });
+    bool woke = ring.waitForFreeSpace(2048, std::chrono::microseconds(500000));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    consumer.join();
+
+    TEST_ASSERT(woke, "Producer not woken by consumer");
+    TEST_ASSERT(elapsed < std::chrono::milliseconds(250),
+        "Producer slept through the watermark");
+
+    // A wake that leaves the watermark unmet does not end the wait early
+    TEST_ASSERT_EQ(ring.push(fill.data(), 2048), static_cast<size_t>(2048), "Refill push wrong size");
+    std::thread waker([&ring]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        ring.wakeSpaceWaiter();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        std::vector<uint8_t> out(2048);
+        ring.pop(out.data(), out.size());
+    });
+    woke = ring.waitForFreeSpace(2048, std::chrono::microseconds(500000));
+    waker.join();
+    TEST_ASSERT(woke, "Early wake returned before the watermark");
+
+    // Abort predicate ends the wait before the deadline
+    TEST_ASSERT_EQ(ring.push(fill.data(), 2048), static_cast<size_t>(2048), "Refill push wrong size");
+    std::atomic<bool> aborted{false};
+    start = std::chrono::steady_clock::now();
+    std::thread stopper([&ring, &aborted]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        aborted.store(true);
+        ring.wakeSpaceWaiter();
+    });
+    woke = ring.waitForFreeSpace(2048, std::chrono::microseconds(500000),
+                                 [&aborted] { return aborted.load(); });
+    elapsed = std::chrono::steady_clock::now() - start;
+    stopper.join();
+    TEST_ASSERT(!woke && elapsed < std::chrono::milliseconds(250), "Abort did not end the wait");
+    std::vector<uint8_t> drain(2048);
+    ring.pop(drain.data(), drain.size());
+
+    // Space already free: returns immediately
+    TEST_ASSERT(ring.waitForFreeSpace(1024, std::chrono::microseconds(0)),
+        "Wait with free space should succeed");
+
+    return true;
+}
+
+bool test_mirrored_ring_wrap() {
+    constexpr size_t RING = 4096;
+    constexpr size_t BLOCK = 512;
+
+    for (int mirror = 0; mirror < 2; mirror++) {
+        DirettaRingBuffer ring;
+        ring.setMirrorMode(mirror != 0);
+        ring.resize(RING, 0x00);
+        TEST_ASSERT(mirror != 0 || !ring.isMirrored(), "Mirror mode not disabled");
+
+        // Park read/write positions 100 bytes before the wrap point
+        std::vector<uint8_t> filler(RING - 100, 0x00);
+        ring.push(filler.data(), filler.size());
+        ring.pop(filler.data(), filler.size());
+
+        std::vector<uint8_t> block(BLOCK);
+        for (size_t i = 0; i < BLOCK; i++) block[i] = static_cast<uint8_t>(i * 13 + 1);
+        TEST_ASSERT_EQ(ring.push(block.data(), BLOCK), BLOCK, "Wrap push wrong size");
+
+        const uint8_t* region = nullptr;
+        size_t avail = 0;
+        bool direct = ring.getDirectReadRegion(BLOCK, region, avail);
+        if (ring.isMirrored()) {
+            TEST_ASSERT(direct, "Mirrored ring should expose a contiguous region across wrap");
+            TEST_ASSERT(std::memcmp(region, block.data(), BLOCK) == 0,
+                "Mirrored region corrupted across wrap");
+            ring.advanceReadPos(BLOCK);
+        } else {
+            TEST_ASSERT(!direct, "Plain ring should report the wrap");
+            std::vector<uint8_t> readBack(BLOCK);
+            TEST_ASSERT_EQ(ring.pop(readBack.data(), BLOCK), BLOCK, "Wrap pop wrong size");
+            TEST_ASSERT(std::memcmp(readBack.data(), block.data(), BLOCK) == 0,
+                "Plain ring wrap corrupted");
+        }
+        TEST_ASSERT_EQ(ring.getAvailable(), size_t(0), "Ring not drained");
+    }
+
+    return true;
+}
+
+bool test_discard_queued_keeps_head() {
+    constexpr size_t RING = 4096;
+    constexpr size_t BLOCK = 256;
+
+    DirettaRingBuffer ring;
+    ring.resize(RING, 0x00);
+
+    // Old position: 8 blocks queued, consumer took 1
+    std::vector<uint8_t> oldData(8 * BLOCK, 0x11);
+    ring.push(oldData.data(), oldData.size());
+    std::vector<uint8_t> sink(BLOCK);
+    ring.pop(sink.data(), BLOCK);
+
+    TEST_ASSERT_EQ(ring.discardQueued(2 * BLOCK), 5 * BLOCK, "Wrong bytes dropped");
+    TEST_ASSERT_EQ(ring.getAvailable(), 2 * BLOCK, "Head not kept");
+    TEST_ASSERT_EQ(ring.discardQueued(4 * BLOCK), size_t(0), "Short ring should be left alone");
+
+    // New position continues right after the kept head
+    std::vector<uint8_t> newData(BLOCK, 0x22);
+    TEST_ASSERT_EQ(ring.push(newData.data(), BLOCK), BLOCK, "Push after discard failed");
+    std::vector<uint8_t> readBack(3 * BLOCK);
+    TEST_ASSERT_EQ(ring.pop(readBack.data(), readBack.size()), 3 * BLOCK, "Pop after discard failed");
+    for (size_t i = 0; i < readBack.size(); i++) {
+        TEST_ASSERT_EQ(readBack[i], static_cast<uint8_t>(i < 2 * BLOCK ? 0x11 : 0x22),
+            "Wrong byte after discard at " << i);
+    }
+    TEST_ASSERT_EQ(ring.getAvailable(), size_t(0), "Ring not drained");
+
+    return true;
+}
+
+// Output sample i of a gain kernel as a signed integer
+static int64_t gainSampleAt(const uint8_t* p, size_t i, size_t width) {
+    if (width == 3) {
+        int32_t v = p[i * 3] | (p[i * 3 + 1] << 8) | (p[i * 3 + 2] << 16);
+        return (v << 8) >> 8;
+    }
+    if (width == 2) {
+        int16_t v;
+        std::memcpy(&v, p + i * 2, 2);
+        return v;
+    }
+    int32_t v;
+    std::memcpy(&v, p + i * 4, 4);
+    return v;
+}
+
+bool test_gain_kernels() {
+    std::vector<uint8_t> input(1001 * 4);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = static_cast<uint8_t>((i * 53 + 29) & 0xFF);
+    }
+    std::vector<uint8_t> out(1001 * 4 + 64);
+    std::vector<uint8_t> ref(1001 * 4 + 64);
+
+    // Dither: triangular in (-1, 1) LSB, zero mean
+    double sum = 0;
+    for (uint32_t i = 0; i < 65536; i++) {
+        float d = AudioKernels::ditherTPDF(i);
+        TEST_ASSERT(d > -1.0f && d < 1.0f, "dither out of range at " << i);
+        sum += d;
+    }
+    TEST_ASSERT(std::fabs(sum / 65536.0) < 0.01, "dither not zero-mean: " << sum / 65536.0);
+
+    // Scalar reference: -6 dB halves, within the +-1 LSB dither
+    AudioKernels::applyGain16_Scalar(out.data(), input.data(), 1001, 0.5f, 0);
+    for (size_t i = 0; i < 1001; i++) {
+        int64_t x = gainSampleAt(input.data(), i, 2);
+        TEST_ASSERT(std::llabs(gainSampleAt(out.data(), i, 2) * 2 - x) <= 2,
+            "16-bit gain 0.5 off at sample " << i);
+    }
+    // +12 dB on full-scale input clips instead of wrapping
+    const int16_t loud[2] = {32000, -32000};
+    AudioKernels::applyGain16_Scalar(out.data(), reinterpret_cast<const uint8_t*>(loud), 2, 4.0f, 0);
+    TEST_ASSERT_EQ(gainSampleAt(out.data(), 0, 2), 32767, "16-bit positive clip");
+    TEST_ASSERT_EQ(gainSampleAt(out.data(), 1, 2), -32768, "16-bit negative clip");
+    // 16->32 at unity through the gain kernel is the plain shift
+    AudioKernels::convert16To32Gain_Scalar(out.data(), input.data(), 1001, 1.0f, 0);
+    AudioKernels::convert16To32_Scalar(ref.data(), input.data(), 1001);
+    TEST_ASSERT(std::memcmp(out.data(), ref.data(), 1001 * 4) == 0, "16->32 unity gain not exact");
+
+    // Vector kernels follow the scalar reference (+-1 LSB for FMA contraction)
+    struct Case { AudioKernels::GainFn AudioKernels::Table::*fn; AudioKernels::GainFn scalar;
+                  size_t width; const char* name; };
+    const Case cases[] = {
+        {&AudioKernels::Table::pack24Gain, AudioKernels::convert24BitPackedGain_Scalar, 3, "pack24"},
+        {&AudioKernels::Table::pack24ShiftedGain, AudioKernels::convert24BitPackedShiftedGain_Scalar,
+         3, "pack24Shifted"},
+        {&AudioKernels::Table::convert16To32Gain, AudioKernels::convert16To32Gain_Scalar, 4, "16->32"},
+        {&AudioKernels::Table::gain16, AudioKernels::applyGain16_Scalar, 2, "gain16"},
+        {&AudioKernels::Table::gain32, AudioKernels::applyGain32_Scalar, 4, "gain32"},
+    };
+    const AudioKernels::Isa isas[] = {
+        AudioKernels::Isa::SSE2, AudioKernels::Isa::AVX2, AudioKernels::Isa::AVX512,
+        AudioKernels::Isa::NEON
+    };
+    for (AudioKernels::Isa isa : isas) {
+        if (!AudioKernels::isSupported(isa)) continue;
+        const AudioKernels::Table k = AudioKernels::tableFor(isa);
+        for (const Case& c : cases) {
+            for (float gain : {0.5f, 0.1234f, 1.7f}) {
+                for (size_t n : {size_t(1), size_t(7), size_t(8), size_t(17), size_t(33), size_t(1001)}) {
+                    size_t a = (k.*(c.fn))(out.data(), input.data(), n, gain, 12345);
+                    size_t b = c.scalar(ref.data(), input.data(), n, gain, 12345);
+                    TEST_ASSERT_EQ(a, b, c.name << " gain size mismatch");
+                    for (size_t i = 0; i < n; i++) {
+                        int64_t diff = gainSampleAt(out.data(), i, c.width) -
+                                       gainSampleAt(ref.data(), i, c.width);
+                        TEST_ASSERT(std::llabs(diff) <= 1, c.name << " gain differs from scalar ("
+                            << AudioKernels::isaName(isa) << ", n=" << n << ", i=" << i << ")");
+                    }
+                }
+            }
+        }
+    }
+
+    // Width without a gain kernel (packed 24-bit copy): unscaled, but mute
+    // writes silence rather than passing the source through
+    DirettaRingBuffer ring;
+    ring.resize(4096, 0x00);
+    TEST_ASSERT(!DirettaRingBuffer::gainSupported(3), "24-bit copy reported as scalable");
+    TEST_ASSERT_EQ(ring.pushWithGain(input.data(), 300, 3, 0.5f), static_cast<size_t>(300),
+                   "unscaled fallback length");
+    TEST_ASSERT_EQ(ring.pop(out.data(), 300), static_cast<size_t>(300), "unscaled fallback pop");
+    TEST_ASSERT(std::memcmp(out.data(), input.data(), 300) == 0, "unsupported width was scaled");
+    TEST_ASSERT_EQ(ring.pushWithGain(input.data(), 301, 3, 0.0f), static_cast<size_t>(300),
+                   "mute fallback consumes whole samples");
+    TEST_ASSERT_EQ(ring.pop(out.data(), 300), static_cast<size_t>(300), "mute fallback pop");
+    for (size_t i = 0; i < 300; i++) {
+        TEST_ASSERT_EQ(out[i], 0u, "mute leaked the source at byte " << i);
+    }
+
+    return true;
+}
+
+bool test_polyphase_resampler() {
+    constexpr uint32_t IN_RATE = 44100;
+    constexpr uint32_t OUT_RATE = 88200;
+    constexpr size_t IN_FRAMES = 8821;  // Odd length: the last output is a partial phase
+    const double freq = 997.0;
+
+    PolyphaseResampler resampler(IN_RATE, OUT_RATE, 2);
+    TEST_ASSERT(resampler.valid(), "no filter for 44.1k -> 88.2k");
+    TEST_ASSERT_EQ(resampler.up(), 2u, "interpolation factor");
+    TEST_ASSERT_EQ(resampler.down(), 1u, "decimation factor");
+
+    auto run = [&](std::vector<int32_t>& out, uint32_t bits) {
+        std::vector<uint8_t> buf(700 * 2 * sizeof(int32_t));
+        size_t fed = 0;
+        while (fed < IN_FRAMES) {
+            size_t n = std::min<size_t>(1021, IN_FRAMES - fed);
+            for (size_t ch = 0; ch < 2; ch++) {
+                float* in = resampler.input(ch, n);
+                for (size_t i = 0; i < n; i++) {
+                    in[i] = static_cast<float>(0.5 * std::sin(2 * M_PI * freq * (fed + i) / IN_RATE));
+                }
+            }
+            resampler.commit(n);
+            fed += n;
+            size_t k;
+            while ((k = resampler.produce(buf.data(), 700, bits)) > 0) {
+                const int32_t* p = reinterpret_cast<const int32_t*>(buf.data());
+                out.insert(out.end(), p, p + k * 2);
+            }
+        }
+        resampler.finish();
+        size_t k;
+        while ((k = resampler.produce(buf.data(), 700, bits)) > 0) {
+            const int32_t* p = reinterpret_cast<const int32_t*>(buf.data());
+            out.insert(out.end(), p, p + k * 2);
+        }
+    };
+
+    // Exactly ceil(in * L / M) frames, no group delay
+    std::vector<int32_t> out;
+    run(out, 32);
+    TEST_ASSERT_EQ(out.size() / 2, IN_FRAMES * 2, "output length");
+
+    double err = 0, sig = 0;
+    for (size_t n = 2000; n < out.size() / 2 - 2000; n++) {
+        double ideal = 0.5 * std::sin(2 * M_PI * freq * n / OUT_RATE);
+        double diff = out[n * 2] / 2147483648.0 - ideal;
+        err += diff * diff;
+        sig += ideal * ideal;
+        TEST_ASSERT(out[n * 2] == out[n * 2 + 1], "channels differ at frame " << n);
+    }
+    double snr = 10 * std::log10(sig / err);
+    TEST_ASSERT(snr > 120.0, "SNR " << snr << " dB");
+
+    // After reset(): 24-bit output is MSB-aligned in S32 (low byte clear)
+    resampler.reset();
+    std::vector<int32_t> out24;
+    run(out24, 24);
+    TEST_ASSERT_EQ(out24.size(), out.size(), "length after reset");
+    for (size_t i = 0; i < out24.size(); i++) {
+        TEST_ASSERT((out24[i] & 0xFF) == 0, "24-bit sample " << i << " not MSB-aligned");
+        TEST_ASSERT(std::abs((out24[i] >> 8) - (out[i] >> 8)) <= 2, "24-bit sample " << i << " off");  // Rounding + TPDF
+    }
+
+    return true;
+}
+
+// Mean of the +-1 bit stream over one channel's bytes
+static double dsdMean(const uint8_t* bytes, size_t count) {
+    long ones = 0;
+    for (size_t i = 0; i < count; i++) ones += __builtin_popcount(bytes[i]);
+    return (2.0 * ones - 8.0 * count) / (8.0 * count);
+}
+
+bool test_dsd_modulator() {
+    // 352.8 kHz input skips the front end: exactly 8 bits per frame at DSD64
+    DsdModulator direct(64, 352800, 2);
+    TEST_ASSERT(direct.valid(), "DSD64 modulator not created");
+    const size_t frames = 3528;
+    std::vector<int16_t> pcm(frames * 2);
+    for (size_t n = 0; n < frames; n++) {
+        pcm[n * 2] = 16384;       // -6 dBFS DC -> 25% modulation
+        pcm[n * 2 + 1] = 0;       // Silence
+    }
+    std::vector<uint8_t> out;
+    uint64_t resetsBefore = DsdModulator::totals().resets.load();
+    size_t bits = direct.process(reinterpret_cast<const uint8_t*>(pcm.data()), frames, 16, 1.0f, out);
+    TEST_ASSERT_EQ(bits, frames * 8, "DSD samples per channel");
+    TEST_ASSERT_EQ(out.size(), frames * 2, "planar output size");
+
+    // Second half: past the settling of the noise shaper
+    double left = dsdMean(out.data() + frames / 2, frames / 2);
+    double right = dsdMean(out.data() + frames + frames / 2, frames / 2);
+    TEST_ASSERT(std::fabs(left - 0.25) < 0.01, "DC level " << left << " (expected 0.25)");
+    TEST_ASSERT(std::fabs(right) < 0.01, "silence level " << right);
+
+    // Gain reaches the modulator input
+    direct.process(reinterpret_cast<const uint8_t*>(pcm.data()), frames, 16, 0.5f, out);
+    left = dsdMean(out.data() + frames / 2, frames / 2);
+    TEST_ASSERT(std::fabs(left - 0.125) < 0.01, "DC level at -6 dB gain " << left);
+
+    // 44.1 kHz through the front end: full-scale tone at DSD256 stays stable
+    DsdModulator resampled(256, 44100, 2);
+    TEST_ASSERT(resampled.valid(), "DSD256 modulator not created");
+    std::vector<int16_t> tone(441 * 2);
+    size_t total = 0;
+    for (size_t chunk = 0; chunk < 10; chunk++) {
+        for (size_t n = 0; n < 441; n++) {
+            int16_t v = static_cast<int16_t>(32767.0 * std::sin(2 * M_PI * 1000.0 * (chunk * 441 + n) / 44100.0));
+            tone[n * 2] = v;
+            tone[n * 2 + 1] = v;
+        }
+        size_t produced = resampled.process(reinterpret_cast<const uint8_t*>(tone.data()), 441, 16, 1.0f, out);
+        TEST_ASSERT(produced % 8 == 0, "partial DSD byte");
+        TEST_ASSERT(std::memcmp(out.data(), out.data() + produced / 8, produced / 8) == 0,
+                    "identical channels modulated differently");
+        total += produced;
+    }
+    TEST_ASSERT(total > 4410 * 256 - 256 * 256, "front end swallowed " << 4410 * 256 - total << " samples");
+    TEST_ASSERT_EQ(DsdModulator::totals().resets.load(), resetsBefore, "modulator resets");
+
+    return true;
+}
+
+bool test_adaptive_depth() {
+    // 44.1k S32 stereo in a 4 MiB ring; simulated clock, 1 ms callbacks
+    const size_t bytesPerSecond = 44100 * 8;
+    const size_t chunkBytes = 2048 * 8;
+    const uint64_t chunkUs = 2048ULL * 1000000 / 44100;
+    AdaptiveDepth depth;
+    depth.configure(60, 1000);
+    depth.setFormat(bytesPerSecond, 4 << 20);
+    TEST_ASSERT_EQ(depth.targetMs(), AdaptiveDepth::INITIAL_MS, "initial target");
+
+    uint64_t now = 1000000;
+    uint64_t nextPush = now;
+    // Run for seconds; pushes every chunk (+ stallUs once), consumer sees fill at level
+    auto run = [&](double seconds, uint64_t stallUs, double fillShare) {
+        uint64_t end = now + static_cast<uint64_t>(seconds * 1e6);
+        for (; now < end; now += 1000) {
+            if (now >= nextPush) {
+                depth.onPush(now, chunkBytes, true);
+                nextPush = now + chunkUs + stallUs;
+                stallUs = 0;
+            }
+            depth.onConsume(static_cast<size_t>(depth.targetBytes() * fillShare), now);
+        }
+    };
+
+    // Steady LAN source: steps down, one 10% step per QUIET_WINDOWS windows
+    run(60.0, 0, 1.0);
+    uint32_t settled = depth.targetMs();
+    TEST_ASSERT(settled < AdaptiveDepth::INITIAL_MS, "target did not step down (" << settled << " ms)");
+    TEST_ASSERT(settled >= 60, "target below minimum (" << settled << " ms)");
+
+    // A 300 ms delivery stall: the next window needs the stall plus low-water headroom
+    run(0.5, 300000, 1.0);
+    run(2.5, 0, 1.0);
+    TEST_ASSERT(depth.targetMs() >= 400, "stall of 300 ms gave target " << depth.targetMs() << " ms");
+
+    // Near-underrun while the producer is active: raised by half
+    uint32_t before = depth.targetMs();
+    run(2.5, 0, 0.1);
+    TEST_ASSERT(depth.targetMs() >= before * AdaptiveDepth::RAISE_PCT / 100,
+                "near-underrun raised " << before << " -> " << depth.targetMs() << " ms");
+
+    // Ring draining after the last push (end of track): not trouble
+    before = depth.targetMs();
+    size_t queued = depth.targetBytes();
+    for (uint64_t end = now + 5000000; now < end; now += 1000) {
+        queued -= std::min(queued, bytesPerSecond / 1000);
+        depth.onConsume(queued, now);
+        if (queued == 0) depth.onUnderrun(now);
+    }
+    TEST_ASSERT(depth.targetMs() <= before, "drain raised the target to " << depth.targetMs() << " ms");
+
+    // Bounded by the configured maximum and by the ring
+    for (int i = 0; i < 20; i++) run(2.5, 0, 0.0);
+    TEST_ASSERT(depth.targetMs() <= 1000, "target above maximum");
+    TEST_ASSERT(depth.targetBytes() <= bytesPerSecond, "target bytes above 1000 ms");
+    return true;
+}
+
+bool test_cycle_tuning_store() {
+    using namespace CycleTuning;
+    TEST_ASSERT(familyOf(88200, false) == Family::Pcm44, "88.2k family");
+    TEST_ASSERT(familyOf(192000, false) == Family::Pcm48, "192k family");
+    TEST_ASSERT(familyOf(2822400, true) == Family::Dsd, "DSD family");
+
+    // Any underrun outweighs jitter; steadier callbacks score lower
+    TEST_ASSERT(score(1, 1000.0, 0.0) > score(0, 1000.0, 900.0), "underrun vs jitter");
+    TEST_ASSERT(score(0, 1000.0, 50.0) < score(0, 1000.0, 200.0), "jitter ordering");
+
+    Store store;
+    Entry e;
+    e.target = "Target A";
+    e.iface = "eth0";
+    e.family = Family::Pcm48;
+    e.cycleUs = 1747;
+    e.mode = 1;
+    e.score = 0.125;
+    store.set(e);
+    e.family = Family::Dsd;
+    e.cycleUs = 2620;
+    e.mode = 0;
+    store.set(e);
+    e.cycleUs = 1310;
+    store.set(e);  // Replaces, not appends
+    TEST_ASSERT_EQ(store.size(), static_cast<size_t>(2), "entries after replace");
+
+    std::string path = "/tmp/diretta_tuning_test.conf";
+    TEST_ASSERT(store.save(path), "save failed");
+    {
+        std::ofstream out(path, std::ios::app);
+        out << "# comment\nmalformed line\nTarget A\teth0\tpcm44\t0\tvar_max\t0\n";
+    }
+
+    Store loaded;
+    TEST_ASSERT(loaded.load(path), "load failed");
+    TEST_ASSERT_EQ(loaded.size(), static_cast<size_t>(2), "loaded entries (bad lines skipped)");
+    const Entry* dsd = loaded.find("Target A", "eth0", Family::Dsd);
+    TEST_ASSERT(dsd != nullptr, "DSD entry missing");
+    TEST_ASSERT_EQ(dsd->cycleUs, 1310u, "DSD cycle");
+    TEST_ASSERT_EQ(dsd->mode, 0, "DSD mode");
+    const Entry* pcm = loaded.find("Target A", "eth0", Family::Pcm48);
+    TEST_ASSERT(pcm != nullptr && pcm->mode == 1 && pcm->cycleUs == 1747, "PCM48 entry");
+    TEST_ASSERT(loaded.find("Target A", "eth1", Family::Dsd) == nullptr, "keyed by interface");
+    TEST_ASSERT(loaded.find("Target A", "eth0", Family::Pcm44) == nullptr, "zero cycle row should be dropped");
+    std::remove(path.c_str());
+
+    Store missing;
+    TEST_ASSERT(missing.load("/tmp/diretta_tuning_missing.conf") && missing.size() == 0,
+                "missing file is an empty store");
+    return true;
+}
+
+bool test_target_cache_store() {
+    struct Address { uint8_t bytes[20]; uint32_t scope; } addr = {}, decoded = {};
+    for (size_t i = 0; i < sizeof(addr.bytes); i++) addr.bytes[i] = static_cast<uint8_t>(i * 37);
+    addr.scope = 0xA5A50102;
+    std::string hex = TargetCache::toHex(&addr, sizeof(addr));
+    TEST_ASSERT_EQ(hex.size(), sizeof(addr) * 2, "hex length");
+    TEST_ASSERT(TargetCache::fromHex(hex, &decoded, sizeof(decoded)), "hex decode");
+    TEST_ASSERT(std::memcmp(&addr, &decoded, sizeof(addr)) == 0, "hex round trip");
+    TEST_ASSERT(!TargetCache::fromHex(hex.substr(2), &decoded, sizeof(decoded)), "short hex accepted");
+    TEST_ASSERT(!TargetCache::fromHex("zz" + hex.substr(2), &decoded, sizeof(decoded)), "bad hex accepted");
+
+    TargetCache::Store store;
+    TargetCache::Entry e;
+    e.iface = "";
+    e.index = -1;
+    e.name = "Diretta Target";
+    e.address = hex;
+    e.mtu = 9000;
+    store.set(e);
+    e.iface = "eth1";
+    e.index = 1;
+    e.mtu = 1500;
+    store.set(e);
+
+    std::string path = "/tmp/diretta_target_cache_test";
+    TEST_ASSERT(store.save(path), "save failed");
+    TargetCache::Store loaded;
+    TEST_ASSERT(loaded.load(path), "load failed");
+    std::remove(path.c_str());
+    TEST_ASSERT_EQ(loaded.size(), static_cast<size_t>(2), "loaded entries");
+    const TargetCache::Entry* first = loaded.find("", -1);
+    TEST_ASSERT(first != nullptr, "entry without interface missing");
+    TEST_ASSERT_EQ(first->mtu, 9000u, "cached MTU");
+    TEST_ASSERT(first->name == "Diretta Target" && first->address == hex, "cached name/address");
+    TEST_ASSERT(loaded.find("eth1", 0) == nullptr, "keyed by target index");
+    return true;
+}
+
+bool test_fanout_slip() {
+    // Frame slips: drop shortens in place, repeat appends copies of the last frame
+    std::vector<uint8_t> staging;
+    uint8_t pcm[4 * 8];
+    for (size_t i = 0; i < sizeof(pcm); i++) pcm[i] = static_cast<uint8_t>(i);
+    size_t frames = 4;
+    TEST_ASSERT(FanOut::slipPcm(pcm, frames, 8, 1, staging) == pcm && frames == 3, "PCM drop");
+    frames = 4;
+    const uint8_t* out = FanOut::slipPcm(pcm, frames, 8, -2, staging);
+    TEST_ASSERT_EQ(frames, static_cast<size_t>(6), "PCM repeat frames");
+    TEST_ASSERT(std::memcmp(out, pcm, sizeof(pcm)) == 0, "PCM repeat keeps the chunk");
+    TEST_ASSERT(std::memcmp(out + 5 * 8, pcm + 3 * 8, 8) == 0, "PCM repeat copies the last frame");
+
+    // Planar DSD, 16 bytes per channel: 32 bits per channel per unit
+    uint8_t dsd[32];
+    for (size_t i = 0; i < sizeof(dsd); i++) dsd[i] = static_cast<uint8_t>(i < 16 ? 0x10 + i : 0x80 + i);
+    size_t bits = 16 * 8;
+    out = FanOut::slipDsdPlanar(dsd, bits, 2, 1, staging);
+    TEST_ASSERT_EQ(bits, static_cast<size_t>(12 * 8), "DSD drop");
+    TEST_ASSERT(out[12] == dsd[16], "DSD drop keeps channel 1 planar");
+    bits = 16 * 8;
+    out = FanOut::slipDsdPlanar(dsd, bits, 2, -1, staging);
+    TEST_ASSERT_EQ(bits, static_cast<size_t>(20 * 8), "DSD repeat");
+    TEST_ASSERT(out[20] == dsd[16] && std::memcmp(out + 36, dsd + 28, 4) == 0, "DSD repeat per channel");
+
+    // Follower starts 30 ms late and its DAC runs 200 ppm fast; 10 ms pushes at 44.1k
+    SlipControl slip;
+    const double primaryMs = 200.0;
+    double followerMs = primaryMs + 30.0;  // Queued after each push, like the primary
+    const size_t chunk = 441;
+    double worst = 0.0;
+    for (int push = 0; push < 6000; push++) {
+        long s = slip.update(followerMs, primaryMs, chunk, 44.1);
+        followerMs += -static_cast<double>(s) / 44.1 + 10.0 - 10.0 * 1.0002;
+        if (push > 3000) worst = std::max(worst, std::fabs(followerMs - primaryMs));
+    }
+    TEST_ASSERT(worst < 3.0, "follower offset " << worst << " ms after convergence");
+    TEST_ASSERT(slip.dropped() > 0 && slip.repeated() > 0, "late start dropped, fast clock repeated");
+    return true;
+}
+
+bool test_trace_recorder_dump() {
+    Trace::Recorder& recorder = Trace::Recorder::instance();
+
+    // One lane per thread; a lane wraps to its newest LANE_RECORDS
+    const size_t extra = 100;
+    std::thread producer([]() {
+        for (uint32_t i = 0; i < Trace::Recorder::LANE_RECORDS + extra; i++) {
+            Trace::record(Trace::Event::Push, 0, i, 2 * i, 3 * i);
+        }
+    });
+    producer.join();
+    for (uint32_t i = 0; i < 10; i++) {
+        Trace::record(Trace::Event::Pull, Trace::PULL_ZERO_COPY, i);
+    }
+    Trace::record(Trace::Event::Underrun, 0, 4096, 0);
+
+    TEST_ASSERT(Trace::trigger(Trace::FreezeReason::Signal), "trigger refused");
+    TEST_ASSERT(!Trace::trigger(Trace::FreezeReason::Signal), "second trigger accepted");
+    TEST_ASSERT(!recorder.dumpDue(), "dump due before the aftermath");
+    Trace::record(Trace::Event::Pull, Trace::PULL_ZERO_COPY, 10);  // Aftermath: still recorded
+
+    std::string path = "/tmp/diretta_trace_test.bin";
+    long written = recorder.dump(path);
+    Trace::record(Trace::Event::Pull, Trace::PULL_ZERO_COPY, 99);  // Frozen: dropped
+    recorder.thaw();
+    TEST_ASSERT(!recorder.dumpDue(), "dump still due after thaw");
+    TEST_ASSERT(!Trace::trigger(Trace::FreezeReason::Underrun), "underrun trigger inside the holdoff");
+
+    Trace::Dump dump;
+    bool loaded = Trace::load(path, dump);
+    std::remove(path.c_str());
+    TEST_ASSERT(loaded, "dump not readable");
+    TEST_ASSERT_EQ(written, static_cast<long>(Trace::Recorder::LANE_RECORDS + 12), "records written");
+    TEST_ASSERT(dump.reason == Trace::FreezeReason::Signal, "freeze reason");
+    TEST_ASSERT_EQ(dump.lanes.size(), static_cast<size_t>(2), "lanes");
+
+    const Trace::LaneDump* pushes = nullptr;
+    const Trace::LaneDump* pulls = nullptr;
+    for (const Trace::LaneDump& lane : dump.lanes) {
+        if (lane.records.empty()) continue;
+        (lane.records.front().event == static_cast<uint16_t>(Trace::Event::Push) ? pushes : pulls) = &lane;
+    }
+    TEST_ASSERT(pushes && pulls, "lane contents");
+    TEST_ASSERT_EQ(pushes->records.size(), Trace::Recorder::LANE_RECORDS, "wrapped lane size");
+    for (size_t i = 0; i < pushes->records.size(); i++) {
+        const Trace::Record& r = pushes->records[i];
+        uint32_t expected = static_cast<uint32_t>(extra + i);  // Oldest first, oldest 100 overwritten
+        TEST_ASSERT(r.a == expected && r.b == 2 * expected && r.c == 3 * expected, "push record order");
+        TEST_ASSERT(i == 0 || r.ticks >= pushes->records[i - 1].ticks, "timestamps not monotonic");
+    }
+    TEST_ASSERT_EQ(pulls->records.size(), static_cast<size_t>(12), "pull lane size");
+    const Trace::Record& underrun = pulls->records[10];
+    TEST_ASSERT_EQ(underrun.event, static_cast<uint16_t>(Trace::Event::Underrun), "underrun event");
+    TEST_ASSERT(dump.msFromTrigger(underrun.ticks) <= 0.0, "underrun after the trigger");
+    TEST_ASSERT(dump.msFromTrigger(pulls->records.back().ticks) >= 0.0, "aftermath before the trigger");
+    TEST_ASSERT_EQ(pulls->records.back().a, 10u, "aftermath record");
+    return true;
+}
+
+bool test_snapshot_cell_publish() {
+    struct Format {
+        uint32_t rate = 0;
+        uint32_t bits = 0;
+        std::string codec;
+    };
+    SnapshotCell<Format> cell;
+    TEST_ASSERT_EQ(cell.version(), 0ull, "initial version");
+    TEST_ASSERT(cell.load() && cell.load()->version == 0, "initial snapshot");
+
+    TEST_ASSERT_EQ(cell.publish(Format{44100, 16, "flac"}), 1ull, "first publish");
+    auto held = cell.load();
+    TEST_ASSERT_EQ(cell.publish(Format{96000, 24, "alac"}), 2ull, "second publish");
+    TEST_ASSERT(held->version == 1 && held->value.rate == 44100 && held->value.codec == "flac",
+                "held snapshot changed");
+    TEST_ASSERT(cell.load()->version == cell.version() && cell.load()->value.rate == 96000,
+                "current snapshot");
+
+    // Readers never see a half-written value, or a version ahead of the value
+    cell.publish(Format{1000, 0, "1000"});
+    std::atomic<bool> stop{false};
+    std::atomic<bool> torn{false};
+    std::thread reader([&]() {
+        while (!stop.load(std::memory_order_relaxed)) {
+            uint64_t version = cell.version();
+            auto snap = cell.load();
+            if (snap->version < version || snap->value.bits != snap->value.rate % 1000 ||
+                snap->value.codec != std::to_string(snap->value.rate)) {
+                torn.store(true, std::memory_order_relaxed);
+            }
+        }
+    });
+    for (uint32_t rate = 1001; rate < 21000; rate++) {
+        cell.publish(Format{rate, rate % 1000, std::to_string(rate)});
+    }
+    stop.store(true, std::memory_order_relaxed);
+    reader.join();
+    TEST_ASSERT(!torn.load(), "inconsistent snapshot");
+    TEST_ASSERT_EQ(cell.version(), 20002ull, "final version");
+    return true;
+}
+
+bool test_thread_placement_fallback() {
+    using namespace ThreadPlacement;
+    // Only the audio thread is placed, "main" is not configured
+    plan().baseline = Spec();
+    plan().baseline.configured = true;
+    plan().baseline.setPolicy = true;
+    plan().baseline.policy = SCHED_OTHER;
+    plan().baseline.cpus = {0, 1, 2, 3};
+    TEST_ASSERT(parse("audio=fifo:80@3").empty(), "audio entry rejected");
+
+    Spec spec;
+    TEST_ASSERT(effectiveSpec(Role::Audio, spec), "audio placement missing");
+    TEST_ASSERT(spec.policy == SCHED_FIFO && spec.priority == 80, "audio policy");
+    TEST_ASSERT(spec.cpus == std::vector<int>{3}, "audio cpus");
+
+    // Spawned from the audio thread: back to the startup placement
+    TEST_ASSERT(effectiveSpec(Role::Io, spec), "io placement missing");
+    TEST_ASSERT(spec.setPolicy && spec.policy == SCHED_OTHER && spec.priority == 0, "io keeps RT policy");
+    TEST_ASSERT_EQ(spec.cpus.size(), static_cast<size_t>(4), "io keeps the audio CPU");
+    TEST_ASSERT(!effectiveSpec(Role::SdkWorker, spec), "sdk worker loses its --thread-mode priority");
+
+    // "main" pins only: policy still from the baseline, CPUs from main
+    TEST_ASSERT(parse("main=@0-1").empty(), "main entry rejected");
+    TEST_ASSERT(effectiveSpec(Role::Decode, spec), "decode placement missing");
+    TEST_ASSERT(spec.policy == SCHED_OTHER && spec.cpus == std::vector<int>({0, 1}), "decode via main");
+    TEST_ASSERT(effectiveSpec(Role::SdkWorker, spec) && !spec.setPolicy, "sdk worker pinned only");
+
+    plan().specs[static_cast<size_t>(Role::Audio)] = Spec();
+    plan().specs[static_cast<size_t>(Role::Main)] = Spec();
+    plan().baseline = Spec();
+    return true;
+}
+
 bool test_full_integration() {
     DirettaRingBuffer ring;
     ring.resize(1024 * 1024, 0x00);
@@ -0,0 +1,298 @@
+/**
+ * @file trace_analyze.cpp
+ * @brief Timeline and verdict for a trace dump (see TraceRecorder.h)
+ *
+ * Usage: trace_analyze <dump> [--window <ms>] [--all]
+ *
+ * Prints the events of every thread merged into one timeline, relative to
+ * the underrun that triggered the dump (or to the SIGUSR2), including the
+ * aftermath recorded before the freeze. Then the longest stretch without a
+ * ring push before the underrun is broken down into time spent in
+ * av_read_frame (network), in the decoder, waiting for ring space, and
+ * unaccounted (the producer was not running: scheduler). Reads and decodes
+ * still running at the underrun count with their full span. Runs of
+ * identical callbacks are folded unless --all is given.
+ */
+
+#include "TraceRecorder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Item {
+    uint64_t ticks;
+    size_t lane;
+    Trace::Record record;
+};
+
+struct Span {
+    uint64_t begin;
+    uint64_t end;
+};
+
+// Overlap of [begin, end] with the union of spans (spans may overlap)
+double overlapMs(const Trace::Dump& dump, std::vector<Span> spans, uint64_t begin, uint64_t end) {
+    std::sort(spans.begin(), spans.end(), [](const Span& x, const Span& y) { return x.begin < y.begin; });
+    uint64_t total = 0;
+    uint64_t covered = begin;
+    for (const Span& s : spans) {
+        uint64_t from = std::max(s.begin, covered);
+        uint64_t to = std::min(s.end, end);
+        if (to > from) {
+            total += to - from;
+            covered = to;
+        }
+    }
+    return dump.ticksToMs(total);
+}
+
+std::string describe(const Trace::Dump& dump, const Trace::Record& r) {
+    char text[160];
+    switch (static_cast<Trace::Event>(r.event)) {
+        case Trace::Event::Pull:
+            std::snprintf(text, sizeof(text), "%s %u B, avail %llu B, %.3f ms", Trace::pullPathName(r.code),
+                          r.a, static_cast<unsigned long long>(r.b), dump.ticksToMs(r.c));
+            break;
+        case Trace::Event::Push:
+            std::snprintf(text, sizeof(text), "in %u B, written %llu B, avail %llu B", r.a,
+                          static_cast<unsigned long long>(r.b), static_cast<unsigned long long>(r.c));
+            break;
+        case Trace::Event::ProducerWait:
+            std::snprintf(text, sizeof(text), "need %u B, %.3f ms%s", r.a, dump.ticksToMs(r.b),
+                          r.code ? "" : " (timeout)");
+            break;
+        case Trace::Event::Decode: {
+            static const char* const kSources[] = {"read", "queue", "queue empty"};
+            std::snprintf(text, sizeof(text), "%s, %u samples, %.3f ms", r.code < 3 ? kSources[r.code] : "?",
+                          r.a, dump.ticksToMs(r.b));
+            break;
+        }
+        case Trace::Event::ReadFrame:
+            std::snprintf(text, sizeof(text), "%u B, %.3f ms%s", r.a, dump.ticksToMs(r.b),
+                          r.code ? " (error/EOF)" : "");
+            break;
+        case Trace::Event::Seek:
+            std::snprintf(text, sizeof(text), "to %.3f s, %.3f ms%s", r.a / 1000.0, dump.ticksToMs(r.b),
+                          r.code ? " (failed)" : "");
+            break;
+        case Trace::Event::FormatChange:
+            std::snprintf(text, sizeof(text), "%s %u Hz/%llubit/%lluch", r.code ? "DSD" : "PCM", r.a,
+                          static_cast<unsigned long long>(r.b), static_cast<unsigned long long>(r.c));
+            break;
+        case Trace::Event::Underrun:
+            std::snprintf(text, sizeof(text), "wanted %u B, avail %llu B", r.a,
+                          static_cast<unsigned long long>(r.b));
+            break;
+        default:
+            std::snprintf(text, sizeof(text), "event %u", r.event);
+            break;
+    }
+    return text;
+}
+
+int usage() {
+    std::fprintf(stderr, "Usage: trace_analyze <dump> [--window <ms>] [--all]\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string path;
+    double windowMs = 500.0;
+    bool all = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--window" && i + 1 < argc) {
+            windowMs = std::atof(argv[++i]);
+        } else if (arg == "--all") {
+            all = true;
+        } else if (!arg.empty() && arg[0] != '-' && path.empty()) {
+            path = arg;
+        } else {
+            return usage();
+        }
+    }
+    if (path.empty() || windowMs <= 0) return usage();
+
+    Trace::Dump dump;
+    if (!Trace::load(path, dump)) {
+        std::fprintf(stderr, "%s: not a readable trace dump\n", path.c_str());
+        return 1;
+    }
+
+    std::time_t wall = static_cast<std::time_t>(dump.triggerUnixMs / 1000);
+    char when[64] = "?";
+    std::strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", std::localtime(&wall));
+    std::printf("Trace dump on %s at %s.%03lld, frozen %.1f ms later (%.3f ticks/ns)\n",
+                Trace::freezeReasonName(dump.reason), when, static_cast<long long>(dump.triggerUnixMs % 1000),
+                dump.msFromTrigger(dump.freezeTicks), dump.ticksPerNs);
+
+    std::vector<Item> items;
+    for (size_t l = 0; l < dump.lanes.size(); l++) {
+        const Trace::LaneDump& lane = dump.lanes[l];
+        if (!lane.records.empty()) {
+            std::printf("  lane %zu: %-8s tid %-7d %5zu events from %.1f ms\n", l, lane.name.c_str(),
+                        lane.tid, lane.records.size(), dump.msFromTrigger(lane.records.front().ticks));
+        }
+        for (const Trace::Record& r : lane.records) items.push_back({r.ticks, l, r});
+    }
+    std::stable_sort(items.begin(), items.end(), [](const Item& x, const Item& y) { return x.ticks < y.ticks; });
+    if (items.empty()) {
+        std::printf("No events\n");
+        return 0;
+    }
+
+    // Anchor: the underrun that triggered the dump, else the trigger itself
+    uint64_t anchor = dump.triggerTicks;
+    bool underrun = false;
+    for (auto it = items.rbegin(); it != items.rend(); ++it) {
+        if (it->ticks <= dump.triggerTicks && it->record.event == static_cast<uint16_t>(Trace::Event::Underrun)) {
+            anchor = it->ticks;
+            underrun = true;
+            break;
+        }
+    }
+    const char* anchorName = underrun ? "underrun" : "trigger";
+    uint64_t windowTicks = static_cast<uint64_t>(windowMs * 1e6 * dump.ticksPerNs);
+    uint64_t begin = std::max(anchor > windowTicks ? anchor - windowTicks : 0, items.front().ticks);
+    auto msAt = [&](uint64_t t) { return static_cast<double>(static_cast<int64_t>(t - anchor)) / dump.ticksPerNs / 1e6; };
+
+    //=========================================================================
+    // Timeline
+    //=========================================================================
+
+    std::printf("\nTimeline (ms relative to the %s):\n", anchorName);
+    for (size_t i = 0; i < items.size(); i++) {
+        const Item& item = items[i];
+        if (item.ticks < begin) continue;
+        const Trace::Record& r = item.record;
+
+        // Fold a run of same-path pulls with nothing else in between
+        size_t run = 1;
+        if (!all && r.event == static_cast<uint16_t>(Trace::Event::Pull)) {
+            while (i + run < items.size() && items[i + run].record.event == r.event &&
+                   items[i + run].record.code == r.code && items[i + run].lane == item.lane) {
+                run++;
+            }
+        }
+        if (run > 2) {
+            const Item& last = items[i + run - 1];
+            double span = dump.ticksToMs(last.ticks - item.ticks) / static_cast<double>(run - 1);
+            std::printf("%10.3f  %-8s %-10s x%zu %s, avail %llu -> %llu B, every %.3f ms\n", msAt(item.ticks),
+                        dump.lanes[item.lane].name.c_str(), "pull", run, Trace::pullPathName(r.code),
+                        static_cast<unsigned long long>(r.b), static_cast<unsigned long long>(last.record.b), span);
+            i += run - 1;
+            continue;
+        }
+        std::printf("%10.3f  %-8s %-10s %s\n", msAt(item.ticks), dump.lanes[item.lane].name.c_str(),
+                    Trace::eventName(static_cast<Trace::Event>(r.event)), describe(dump, r).c_str());
+    }
+
+    //=========================================================================
+    // Verdict
+    //=========================================================================
+
+    std::vector<uint64_t> pulls;
+    std::vector<uint64_t> pushes;
+    std::vector<Span> reads, decodes, waits;
+    std::vector<const Item*> notable;
+    for (const Item& item : items) {
+        if (item.ticks < begin) continue;
+        const Trace::Record& r = item.record;
+        // After the anchor: only spans that were already running at it
+        if (item.ticks > anchor && (r.event == static_cast<uint16_t>(Trace::Event::Pull) ||
+                                    r.event == static_cast<uint16_t>(Trace::Event::Push) ||
+                                    item.ticks - r.b > anchor)) {
+            continue;
+        }
+        switch (static_cast<Trace::Event>(r.event)) {
+            case Trace::Event::Pull:
+                pulls.push_back(item.ticks);
+                break;
+            case Trace::Event::Push:
+                pushes.push_back(item.ticks);
+                break;
+            case Trace::Event::ReadFrame:
+                reads.push_back({item.ticks - r.b, item.ticks});
+                break;
+            case Trace::Event::Decode:
+                if (r.code == Trace::DECODE_READ) decodes.push_back({item.ticks - r.b, item.ticks});
+                break;
+            case Trace::Event::ProducerWait:
+                waits.push_back({item.ticks - r.b, item.ticks});
+                break;
+            case Trace::Event::Seek:
+            case Trace::Event::FormatChange:
+                notable.push_back(&item);
+                break;
+            default:
+                break;
+        }
+    }
+
+    std::printf("\nVerdict (%.0f ms before the %s):\n", dump.ticksToMs(anchor - begin), anchorName);
+
+    if (pulls.size() > 2) {
+        std::vector<double> intervals;
+        for (size_t i = 1; i < pulls.size(); i++) intervals.push_back(dump.ticksToMs(pulls[i] - pulls[i - 1]));
+        std::vector<double> sorted = intervals;
+        std::sort(sorted.begin(), sorted.end());
+        double median = sorted[sorted.size() / 2];
+        double worst = sorted.back();
+        std::printf("  Diretta callbacks: %zu, interval median %.3f ms, max %.3f ms%s\n", pulls.size(), median, worst,
+                    worst > 3 * median + 1.0 ? "  <- SDK worker ran late (scheduler)" : "");
+    }
+
+    // Longest stretch without a push, up to the underrun
+    uint64_t gapBegin = begin;
+    uint64_t gapEnd = pushes.empty() ? anchor : pushes.front();
+    uint64_t previous = pushes.empty() ? anchor : pushes.front();
+    for (size_t i = 1; i <= pushes.size(); i++) {
+        uint64_t next = i < pushes.size() ? pushes[i] : anchor;
+        if (next - previous > gapEnd - gapBegin) {
+            gapBegin = previous;
+            gapEnd = next;
+        }
+        previous = next;
+    }
+    double gapMs = dump.ticksToMs(gapEnd - gapBegin);
+    if (gapMs <= 0.0) {
+        std::printf("  Producer: no gap before the %s\n", anchorName);
+        return 0;
+    }
+
+    double networkMs = overlapMs(dump, reads, gapBegin, gapEnd);
+    double decodeMs = std::max(0.0, overlapMs(dump, decodes, gapBegin, gapEnd) - networkMs);
+    double waitMs = overlapMs(dump, waits, gapBegin, gapEnd);
+    double idleMs = std::max(0.0, gapMs - networkMs - decodeMs - waitMs);
+    std::printf("  Longest producer gap: %.3f ms (%.3f to %.3f)%s\n", gapMs, msAt(gapBegin), msAt(gapEnd),
+                pushes.empty() ? ", no push in the window" : "");
+    std::printf("    network (av_read_frame)  %8.3f ms  %5.1f%%\n", networkMs, 100.0 * networkMs / gapMs);
+    std::printf("    decoder                  %8.3f ms  %5.1f%%\n", decodeMs, 100.0 * decodeMs / gapMs);
+    std::printf("    waiting for ring space   %8.3f ms  %5.1f%%\n", waitMs, 100.0 * waitMs / gapMs);
+    std::printf("    not running (scheduler)  %8.3f ms  %5.1f%%\n", idleMs, 100.0 * idleMs / gapMs);
+
+    for (const Item* item : notable) {
+        std::printf("  Note: %s at %.3f ms (%s): an underrun around it is expected\n",
+                    Trace::eventName(static_cast<Trace::Event>(item->record.event)), msAt(item->ticks),
+                    describe(dump, item->record).c_str());
+    }
+
+    const char* cause = "scheduler: the producer was runnable but not running";
+    if (networkMs >= decodeMs && networkMs >= idleMs && networkMs >= waitMs) {
+        cause = "network: av_read_frame blocked the producer";
+    } else if (decodeMs >= idleMs && decodeMs >= waitMs) {
+        cause = "decoder: decoding could not keep up";
+    } else if (waitMs >= idleMs) {
+        cause = "none on the producer side: it was waiting for ring space (consumer or ring size)";
+    }
+    std::printf("  Most likely cause: %s\n", cause);
+    return 0;
+}
@@ -15,6 +15,7 @@ CYCLE_TIME="${CYCLE_TIME:-}"
 CYCLE_MIN_TIME="${CYCLE_MIN_TIME:-}"
 INFO_CYCLE="${INFO_CYCLE:-}"
 MTU_OVERRIDE="${MTU_OVERRIDE:-}"
+THREAD_PLACEMENT="${THREAD_PLACEMENT:-}"
 
 RENDERER_BIN="/opt/diretta-renderer-upnp/DirettaRendererUPnP"
 
@@ -67,6 +68,10 @@ if [ -n "$MTU_OVERRIDE" ]; then
     CMD="$CMD --mtu $MTU_OVERRIDE"
 fi
 
+if [ -n "$THREAD_PLACEMENT" ]; then
+    CMD="$CMD $THREAD_PLACEMENT"
+fi
+
 # Log the command being executed
 echo "════════════════════════════════════════════════════════"
 echo "  Starting Diretta UPnP Renderer"